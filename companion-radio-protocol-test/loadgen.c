@@ -0,0 +1,655 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+// Load generator for companion servers. Drives a number of links at once, either pseudo terminals with a
+// companion_server started on each, existing serial devices, or TCP or WebSocket connections to one server
+// accepting remote apps, and keeps a window of commands in flight on every link. Commands are picked at
+// random from a weighted mix, and the time from writing a command to its final response is reported per
+// command type.
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <arpa/inet.h>
+#include <libgen.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_companion.h"
+#include "mc_companion_client.h"
+#include "mc_companion_websocket.h"
+
+// Definitions
+
+#define LOADGEN_MAX_WINDOW     64
+#define LOADGEN_READY_TIMEOUT  5000  // ms to wait for a server to answer its first command
+#define LOADGEN_REPLY_TIMEOUT  5000  // ms after which a command is given up
+#define LOADGEN_QUIET_TIME     200   // ms without traffic after which the links are considered drained
+
+// Any key will do, the server only has to prove it read the handshake
+#define LOADGEN_WEBSOCKET_KEY "bWVzaGNvcmUgbG9hZGdlbg=="
+
+typedef enum {
+    LOADGEN_GET_CONTACTS = 0,
+    LOADGEN_GET_CONTACTS_SINCE,
+    LOADGEN_SEND_TXT_MSG,
+    LOADGEN_SYNC_NEXT_MESSAGE,
+    LOADGEN_DEVICE_QUERY,
+    LOADGEN_TYPES,
+} loadgen_type_t;
+
+static const char* const loadgen_type_names[LOADGEN_TYPES] = {
+    "get_contacts", "get_contacts_since", "send_txt_msg", "sync_next_message", "device_query",
+};
+
+typedef struct {
+    uint64_t* latencies_ns;
+    uint64_t  count;
+    uint64_t  capacity;
+    uint64_t  errors;  // ERR responses
+    uint64_t  timeouts;
+} loadgen_results_t;
+
+typedef struct {
+    uint8_t  type;
+    uint64_t sent_ns;
+} loadgen_pending_t;
+
+typedef struct {
+    int                              fd;
+    pid_t                            pid;
+    int                              slave_fd;
+    bool                             ready;
+    uint32_t                         head;
+    uint32_t                         count;
+    loadgen_pending_t                pending[LOADGEN_MAX_WINDOW];
+    uint64_t                         unexpected;  // Final responses without a command in flight
+    mc_companion_client_t            client;
+    bool                             websocket;  // Frames travel in WebSocket messages
+    mc_companion_websocket_decoder_t websocket_decoder;
+} loadgen_link_t;
+
+typedef struct {
+    uint32_t          weights[LOADGEN_TYPES];
+    uint32_t          weight_total;
+    uint32_t          window;
+    uint32_t          random;
+    bool              measuring;
+    loadgen_results_t results[LOADGEN_TYPES];
+} loadgen_t;
+
+static loadgen_t loadgen;
+
+// Functions
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t loadgen_random(void) {
+    // xorshift32
+    uint32_t x      = loadgen.random;
+    x              ^= x << 13;
+    x              ^= x >> 17;
+    x              ^= x << 5;
+    loadgen.random  = x;
+    return x;
+}
+
+static void loadgen_record(loadgen_type_t type, uint64_t latency_ns) {
+    loadgen_results_t* results = &loadgen.results[type];
+    if (results->count == results->capacity) {
+        results->capacity     = (results->capacity > 0) ? results->capacity * 2 : 1024;
+        results->latencies_ns = realloc(results->latencies_ns, results->capacity * sizeof(uint64_t));
+        if (results->latencies_ns == NULL) {
+            printf("Out of memory\r\n");
+            exit(1);
+        }
+    }
+    results->latencies_ns[results->count++] = latency_ns;
+}
+
+static int loadgen_write_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data   += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+static int loadgen_send(loadgen_link_t* link, loadgen_type_t type) {
+    static const uint8_t pub_key_prefix[6] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+    uint8_t              frame[MESHCORE_COMPANION_MAX_FRAME_SIZE];
+    size_t               length = 0;
+    uint32_t             now_s  = (uint32_t)time(NULL);
+    int                  result = -1;
+
+    switch (type) {
+        case LOADGEN_GET_CONTACTS:
+            result = mc_companion_write_get_contacts(0, sizeof(frame), frame, &length);
+            break;
+        case LOADGEN_GET_CONTACTS_SINCE:
+            result = mc_companion_write_get_contacts(now_s - 3600, sizeof(frame), frame, &length);
+            break;
+        case LOADGEN_SEND_TXT_MSG:
+            result = mc_companion_write_send_txt_msg(0, 0, now_s, pub_key_prefix, "Load generator message", sizeof(frame), frame, &length);
+            break;
+        case LOADGEN_SYNC_NEXT_MESSAGE:
+            result = mc_companion_write_simple_command(COMPANION_CMD_SYNC_NEXT_MESSAGE, sizeof(frame), frame, &length);
+            break;
+        case LOADGEN_DEVICE_QUERY: {
+            companion_command_packet_t packet                   = {.command = COMPANION_CMD_DEVICE_QUERY};
+            packet.command_device_query_args.app_target_version = 3;
+            result = mc_companion_write_command(&packet, sizeof(companion_cmd_device_query_args_t), sizeof(frame), frame, &length);
+            break;
+        }
+        default:
+            break;
+    }
+    if (result < 0) {
+        return -1;
+    }
+
+    loadgen_pending_t* pending = &link->pending[(link->head + link->count) % LOADGEN_MAX_WINDOW];
+    pending->type              = (uint8_t)type;
+    pending->sent_ns           = monotonic_ns();
+    link->count++;
+    if (link->websocket) {
+        // Frames from a client are masked
+        uint8_t  message[MC_COMPANION_WEBSOCKET_MAX_HEADER + sizeof(frame)];
+        uint32_t key  = loadgen_random();
+        uint8_t  mask[4];
+        memcpy(mask, &key, sizeof(mask));
+        size_t header = mc_companion_websocket_header(MC_COMPANION_WEBSOCKET_OPCODE_BINARY, length, mask, message);
+        memcpy(&message[header], frame, length);
+        mc_companion_websocket_mask(&message[header], length, mask, 0);
+        return loadgen_write_all(link->fd, message, header + length);
+    }
+    return loadgen_write_all(link->fd, frame, length);
+}
+
+static loadgen_type_t loadgen_pick(void) {
+    uint32_t pick = loadgen_random() % loadgen.weight_total;
+    for (uint32_t type = 0; type < LOADGEN_TYPES; type++) {
+        if (pick < loadgen.weights[type]) {
+            return (loadgen_type_t)type;
+        }
+        pick -= loadgen.weights[type];
+    }
+    return LOADGEN_GET_CONTACTS;
+}
+
+static void loadgen_response(mc_companion_client_t* client, const companion_response_packet_t* response, uint16_t args_length, void* context) {
+    loadgen_link_t* link = (loadgen_link_t*)context;
+    (void)client;
+    (void)args_length;
+
+    if (!mc_companion_response_is_final(response->response)) {
+        return;
+    }
+    if (link->count == 0) {
+        link->unexpected++;
+        return;
+    }
+
+    loadgen_pending_t* pending = &link->pending[link->head];
+    link->head                 = (link->head + 1) % LOADGEN_MAX_WINDOW;
+    link->count--;
+    link->ready = true;
+
+    if (loadgen.measuring) {
+        loadgen_record((loadgen_type_t)pending->type, monotonic_ns() - pending->sent_ns);
+        if (response->response == COMPANION_RESPONSE_CODE_ERR) {
+            loadgen.results[pending->type].errors++;
+        }
+    }
+}
+
+static int loadgen_raw(int fd) {
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0) {
+        return -1;
+    }
+    cfmakeraw(&tty);
+    return tcsetattr(fd, TCSANOW, &tty);
+}
+
+// Create a pseudo terminal and start a server on its slave side
+static int loadgen_spawn(loadgen_link_t* link, const char* server) {
+    link->slave_fd = -1;
+    link->pid      = -1;
+    link->fd       = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (link->fd < 0 || grantpt(link->fd) != 0 || unlockpt(link->fd) != 0) {
+        return -1;
+    }
+    const char* slave_name = ptsname(link->fd);
+    if (slave_name == NULL) {
+        return -1;
+    }
+
+    // Keep a slave descriptor open so the master does not see a hang-up before the server opened it, and make
+    // the line raw from the start so nothing is echoed back
+    link->slave_fd = open(slave_name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (link->slave_fd < 0 || loadgen_raw(link->slave_fd) != 0) {
+        return -1;
+    }
+
+    char slave_path[64];
+    snprintf(slave_path, sizeof(slave_path), "%s", slave_name);
+
+    link->pid = fork();
+    if (link->pid < 0) {
+        return -1;
+    }
+    if (link->pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+        }
+        execl(server, server, slave_path, "115200", (char*)NULL);
+        _exit(127);
+    }
+    return 0;
+}
+
+static int loadgen_open(loadgen_link_t* link, const char* device) {
+    link->fd       = open(device, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    link->slave_fd = -1;
+    link->pid      = -1;
+    if (link->fd < 0) {
+        return -1;
+    }
+    return loadgen_raw(link->fd);
+}
+
+static void loadgen_websocket(uint8_t opcode, const uint8_t* data, size_t length, void* context) {
+    loadgen_link_t* link = (loadgen_link_t*)context;
+    if (opcode == MC_COMPANION_WEBSOCKET_OPCODE_BINARY) {
+        mc_companion_client_read(&link->client, data, length);
+    }
+}
+
+// Connect to a server accepting remote apps, "tcp://address:port" or "ws://address:port"
+static int loadgen_connect(loadgen_link_t* link, const char* url) {
+    char     address[64];
+    unsigned port   = 0;
+    int      scheme = 0;
+    link->slave_fd  = -1;
+    link->pid       = -1;
+    link->fd        = -1;
+    if (sscanf(url, "tcp://%63[^:]:%u%n", address, &port, &scheme) == 2 && url[scheme] == '\0') {
+        link->websocket = false;
+    } else if (sscanf(url, "ws://%63[^:]:%u%n", address, &port, &scheme) == 2 && url[scheme] == '\0') {
+        link->websocket = true;
+    } else {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct sockaddr_in server = {.sin_family = AF_INET, .sin_port = htons((uint16_t)port)};
+    if (port == 0 || port > 0xFFFF || inet_pton(AF_INET, address, &server.sin_addr) != 1) {
+        errno = EINVAL;
+        return -1;
+    }
+    link->fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (link->fd < 0 || connect(link->fd, (const struct sockaddr*)&server, sizeof(server)) != 0) {
+        return -1;
+    }
+
+    // Every command goes out in a write of its own, without waiting for the previous one to be acknowledged
+    int enable = 1;
+    setsockopt(link->fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    if (!link->websocket) {
+        return 0;
+    }
+
+    char request[256];
+    int  request_length = snprintf(request, sizeof(request),
+                                   "GET / HTTP/1.1\r\nHost: %s:%u\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                   "Sec-WebSocket-Key: " LOADGEN_WEBSOCKET_KEY "\r\nSec-WebSocket-Version: 13\r\n\r\n",
+                                   address, port);
+    if (loadgen_write_all(link->fd, (const uint8_t*)request, (size_t)request_length) < 0) {
+        return -1;
+    }
+
+    // Read the response up to its blank line one byte at a time, the frames behind it are left for the decoder
+    char   response[512];
+    size_t response_length = 0;
+    while (response_length < 4 || memcmp(&response[response_length - 4], "\r\n\r\n", 4) != 0) {
+        if (response_length == sizeof(response) - 1 || read(link->fd, &response[response_length], 1) != 1) {
+            errno = EPROTO;
+            return -1;
+        }
+        response_length++;
+    }
+    response[response_length] = '\0';
+
+    char accept[MC_COMPANION_WEBSOCKET_ACCEPT_SIZE];
+    char expected[64];
+    mc_companion_websocket_accept(LOADGEN_WEBSOCKET_KEY, strlen(LOADGEN_WEBSOCKET_KEY), accept);
+    snprintf(expected, sizeof(expected), "Sec-WebSocket-Accept: %s\r\n", accept);
+    if (strncmp(response, "HTTP/1.1 101 ", 13) != 0 || strstr(response, expected) == NULL) {
+        errno = EPROTO;
+        return -1;
+    }
+    mc_companion_websocket_decoder_init(&link->websocket_decoder, false, loadgen_websocket, link);
+    return 0;
+}
+
+// Feed whatever the links have sent, waiting up to timeout_ms for the first byte. Returns the number of links
+// that had data, or -1 when a link failed.
+static int loadgen_receive(loadgen_link_t* links, struct pollfd* descriptors, uint32_t link_count, int timeout_ms) {
+    int ready = poll(descriptors, link_count, timeout_ms);
+    if (ready < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    int active = ready;
+    for (uint32_t index = 0; index < link_count && ready > 0; index++) {
+        if (descriptors[index].revents == 0) {
+            continue;
+        }
+        ready--;
+        if ((descriptors[index].revents & POLLIN) == 0) {
+            printf("Link %" PRIu32 " closed\r\n", index);
+            return -1;
+        }
+        uint8_t buffer[4096];
+        ssize_t received = read(links[index].fd, buffer, sizeof(buffer));
+        if (received < 0 && errno != EINTR && errno != EAGAIN) {
+            printf("Failed to read from link %" PRIu32 " (%i): %s\r\n", index, errno, strerror(errno));
+            return -1;
+        }
+        if (received > 0 && links[index].websocket) {
+            if (mc_companion_websocket_decode(&links[index].websocket_decoder, buffer, (size_t)received) < 0) {
+                printf("WebSocket protocol error on link %" PRIu32 "\r\n", index);
+                return -1;
+            }
+        } else if (received > 0) {
+            mc_companion_client_read(&links[index].client, buffer, (size_t)received);
+        }
+    }
+    return active;
+}
+
+static int loadgen_compare(const void* a, const void* b) {
+    uint64_t left  = *(const uint64_t*)a;
+    uint64_t right = *(const uint64_t*)b;
+    return (left > right) - (left < right);
+}
+
+static double loadgen_percentile_us(const loadgen_results_t* results, uint32_t permille) {
+    uint64_t index = results->count * permille / 1000;
+    if (index >= results->count) {
+        index = results->count - 1;
+    }
+    return results->latencies_ns[index] / 1e3;
+}
+
+static void loadgen_report(double elapsed_s, uint32_t link_count, loadgen_link_t* links) {
+    uint64_t total      = 0;
+    uint64_t unexpected = 0;
+    uint64_t unanswered = 0;
+
+    printf("%-20s %10s %10s %10s %10s %10s %10s %8s %8s\r\n", "command", "count", "per s", "p50 us", "p99 us", "p999 us", "max us", "errors",
+           "timeouts");
+    for (uint32_t type = 0; type < LOADGEN_TYPES; type++) {
+        loadgen_results_t* results = &loadgen.results[type];
+        if (results->count == 0 && loadgen.weights[type] == 0) {
+            continue;
+        }
+        total += results->count;
+        if (results->count == 0) {
+            printf("%-20s %10d\r\n", loadgen_type_names[type], 0);
+            continue;
+        }
+        qsort(results->latencies_ns, results->count, sizeof(uint64_t), loadgen_compare);
+        printf("%-20s %10" PRIu64 " %10.0f %10.1f %10.1f %10.1f %10.1f %8" PRIu64 " %8" PRIu64 "\r\n", loadgen_type_names[type], results->count,
+               results->count / elapsed_s, loadgen_percentile_us(results, 500), loadgen_percentile_us(results, 990),
+               loadgen_percentile_us(results, 999), results->latencies_ns[results->count - 1] / 1e3, results->errors, results->timeouts);
+    }
+
+    for (uint32_t index = 0; index < link_count; index++) {
+        unexpected += links[index].unexpected;
+        unanswered += links[index].count;
+    }
+    printf("Total: %" PRIu64 " commands in %.2f s over %" PRIu32 " links, %.0f per s\r\n", total, elapsed_s, link_count, total / elapsed_s);
+    if (unexpected > 0 || unanswered > 0) {
+        printf("Unexpected responses: %" PRIu64 ", unanswered at the end: %" PRIu64 "\r\n", unexpected, unanswered);
+    }
+}
+
+// Parse a mix like "get_contacts:1,send_txt_msg:2", names without a weight count once
+static int loadgen_parse_mix(const char* mix) {
+    char  buffer[256];
+    char* save = NULL;
+    snprintf(buffer, sizeof(buffer), "%s", mix);
+    memset(loadgen.weights, 0, sizeof(loadgen.weights));
+    loadgen.weight_total = 0;
+
+    for (char* entry = strtok_r(buffer, ",", &save); entry != NULL; entry = strtok_r(NULL, ",", &save)) {
+        char*    colon  = strchr(entry, ':');
+        uint32_t weight = 1;
+        if (colon != NULL) {
+            *colon = '\0';
+            weight = (uint32_t)strtoul(colon + 1, NULL, 10);
+        }
+        uint32_t type = 0;
+        while (type < LOADGEN_TYPES && strcmp(entry, loadgen_type_names[type]) != 0) {
+            type++;
+        }
+        if (type == LOADGEN_TYPES) {
+            printf("Unknown command '%s'\r\n", entry);
+            return -1;
+        }
+        loadgen.weights[type] += weight;
+        loadgen.weight_total  += weight;
+    }
+    return (loadgen.weight_total > 0) ? 0 : -1;
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-n links] [-t seconds] [-w window] [-m mix] [-s server] [-c url] [device ...]\r\n", name);
+    printf("  -n  number of servers to start on pseudo terminals or connections to open (default 4), ignored when devices are given\r\n");
+    printf("  -t  measurement time in seconds (default 5)\r\n");
+    printf("  -w  commands in flight per link (default 1, at most %u)\r\n", LOADGEN_MAX_WINDOW);
+    printf("  -m  weighted command mix (default get_contacts:1,send_txt_msg:2,sync_next_message:1)\r\n");
+    printf("      commands: get_contacts, get_contacts_since, send_txt_msg, sync_next_message, device_query\r\n");
+    printf("  -s  server to start (default companion_server next to this program)\r\n");
+    printf("  -c  connect to a running server instead, tcp://address:port or ws://address:port\r\n");
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t    link_count = 4;
+    double      duration_s = 5.0;
+    const char* mix        = "get_contacts:1,send_txt_msg:2,sync_next_message:1";
+    const char* url        = NULL;
+    char        server[512];
+    int         option;
+
+    char self[512];
+    snprintf(self, sizeof(self), "%s", argv[0]);
+    snprintf(server, sizeof(server), "%s/companion_server", dirname(self));
+
+    loadgen.window = 1;
+    loadgen.random = (uint32_t)monotonic_ns() | 1;
+
+    while ((option = getopt(argc, argv, "n:t:w:m:s:c:")) != -1) {
+        switch (option) {
+            case 'n':
+                link_count = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                duration_s = strtod(optarg, NULL);
+                break;
+            case 'w':
+                loadgen.window = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                mix = optarg;
+                break;
+            case 's':
+                snprintf(server, sizeof(server), "%s", optarg);
+                break;
+            case 'c':
+                url = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (loadgen_parse_mix(mix) < 0 || loadgen.window == 0 || loadgen.window > LOADGEN_MAX_WINDOW || duration_s <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (optind < argc) {
+        link_count = (uint32_t)(argc - optind);
+    }
+    if (link_count == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    loadgen_link_t* links       = calloc(link_count, sizeof(loadgen_link_t));
+    struct pollfd*  descriptors = calloc(link_count, sizeof(struct pollfd));
+    if (links == NULL || descriptors == NULL) {
+        printf("Out of memory\r\n");
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    int status = 0;
+    for (uint32_t index = 0; index < link_count; index++) {
+        loadgen_link_t* link = &links[index];
+        int             result;
+        if (optind < argc) {
+            result = loadgen_open(link, argv[optind + index]);
+        } else if (url != NULL) {
+            result = loadgen_connect(link, url);
+        } else {
+            result = loadgen_spawn(link, server);
+        }
+        if (result < 0) {
+            printf("Failed to set up link %" PRIu32 " (%i): %s\r\n", index, errno, strerror(errno));
+            link_count = index + 1;
+            status     = 1;
+            break;
+        }
+        mc_companion_client_init(&link->client, loadgen_response, link);
+        descriptors[index] = (struct pollfd){.fd = link->fd, .events = POLLIN};
+    }
+
+    // A server flushes its line when it starts, so ask until every link has answered once
+    uint64_t deadline_ns = monotonic_ns() + LOADGEN_READY_TIMEOUT * 1000000ull;
+    uint32_t ready       = 0;
+    while (status == 0 && ready < link_count) {
+        if (monotonic_ns() > deadline_ns) {
+            printf("Only %" PRIu32 " of %" PRIu32 " links answered\r\n", ready, link_count);
+            status = 1;
+            break;
+        }
+        for (uint32_t index = 0; index < link_count; index++) {
+            if (!links[index].ready) {
+                links[index].count = 0;
+                loadgen_send(&links[index], LOADGEN_DEVICE_QUERY);
+            }
+        }
+        uint64_t until_ns = monotonic_ns() + 100000000ull;
+        while (status == 0 && monotonic_ns() < until_ns) {
+            status = (loadgen_receive(links, descriptors, link_count, 10) < 0) ? 1 : 0;
+        }
+        ready = 0;
+        for (uint32_t index = 0; index < link_count; index++) {
+            ready += links[index].ready;
+        }
+    }
+
+    // Every query that was sent again is answered as well, wait for those answers to pass before measuring so
+    // that they are not taken for the answers to the first measured commands
+    int received = 1;
+    deadline_ns  = monotonic_ns() + LOADGEN_READY_TIMEOUT * 1000000ull;
+    while (status == 0 && received > 0 && monotonic_ns() < deadline_ns) {
+        received = loadgen_receive(links, descriptors, link_count, LOADGEN_QUIET_TIME);
+        status   = (received < 0) ? 1 : 0;
+    }
+
+    uint64_t start_ns = monotonic_ns();
+    if (status == 0) {
+        for (uint32_t index = 0; index < link_count; index++) {
+            links[index].head       = 0;
+            links[index].count      = 0;
+            links[index].unexpected = 0;
+            mc_companion_client_init(&links[index].client, loadgen_response, &links[index]);
+        }
+        loadgen.measuring = true;
+        start_ns          = monotonic_ns();
+        uint64_t end_ns   = start_ns + (uint64_t)(duration_s * 1e9);
+
+        while (status == 0 && monotonic_ns() < end_ns) {
+            uint64_t now_ns = monotonic_ns();
+            for (uint32_t index = 0; index < link_count && status == 0; index++) {
+                loadgen_link_t* link = &links[index];
+
+                // Give up on the oldest command when the server did not answer it in time
+                while (link->count > 0 && now_ns - link->pending[link->head].sent_ns > LOADGEN_REPLY_TIMEOUT * 1000000ull) {
+                    loadgen.results[link->pending[link->head].type].timeouts++;
+                    link->head = (link->head + 1) % LOADGEN_MAX_WINDOW;
+                    link->count--;
+                }
+                while (link->count < loadgen.window) {
+                    if (loadgen_send(link, loadgen_pick()) < 0) {
+                        printf("Failed to write to link %" PRIu32 " (%i): %s\r\n", index, errno, strerror(errno));
+                        status = 1;
+                        break;
+                    }
+                }
+            }
+            if (status == 0) {
+                status = (loadgen_receive(links, descriptors, link_count, 100) < 0) ? 1 : 0;
+            }
+        }
+        loadgen.measuring = false;
+        loadgen_report((monotonic_ns() - start_ns) / 1e9, link_count, links);
+    }
+
+    for (uint32_t index = 0; index < link_count; index++) {
+        if (links[index].pid > 0) {
+            kill(links[index].pid, SIGTERM);
+            waitpid(links[index].pid, NULL, 0);
+        }
+        if (links[index].slave_fd >= 0) {
+            close(links[index].slave_fd);
+        }
+        if (links[index].fd >= 0) {
+            close(links[index].fd);
+        }
+    }
+    for (uint32_t type = 0; type < LOADGEN_TYPES; type++) {
+        free(loadgen.results[type].latencies_ns);
+    }
+    free(links);
+    free(descriptors);
+    return status;
+}
@@ -0,0 +1,456 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+// Provisions a companion radio with a contact bundle. The bundle is read from a file or made up for a fleet
+// of the given size, streamed with IMPORT_BUNDLE keeping a window of chunks in flight, and read back with
+// EXPORT_BUNDLE to check that the radio holds every contact. Reports the time taken and the bytes moved
+// next to what the same contacts cost as one ADD_UPDATE_CONTACT frame each. With -f the tool asks the radio
+// for larger frames and packs the chunks in flight into BATCH commands.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_companion.h"
+#include "mc_companion_batch.h"
+#include "mc_companion_bundle.h"
+#include "mc_companion_client.h"
+
+// Definitions
+
+#define PROVISION_MAX_WINDOW 64
+#define PROVISION_TIMEOUT    5000  // ms without a response after which an export is given up
+#define PROVISION_RETRY      500   // ms without a response after which chunks are sent again
+#define PROVISION_RETRIES    10
+#define PROVISION_ATTEMPTS   3  // Times a rejected bundle is sent
+#define PROVISION_CHUNK_SIZE (sizeof(((companion_cmd_import_bundle_args_t*)0)->data))
+
+typedef struct {
+    int                           fd;
+    mc_companion_client_t         client;
+    bool                          done;
+    bool                          failed;
+    bool                          importing;
+    uint32_t                      next;        // Next chunk to send
+    uint32_t                      acked;       // Chunks the radio has taken
+    uint32_t                      in_flight;   // Commands without a response
+    uint32_t                      rewound_to;  // Chunk of the last resend, repeated requests for it are ignored
+    uint32_t                      resends;
+    uint32_t                      contacts;  // Contacts the radio reported
+    uint64_t                      written;   // Bytes sent to the radio
+    uint32_t                      frames;    // Frames sent to the radio
+    mc_companion_bundle_decoder_t decoder;   // Exported bundle
+    FILE*                         export_file;
+} provision_t;
+
+static provision_t provision;
+
+// Functions
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int provision_write_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data              += written;
+        length            -= (size_t)written;
+        provision.written += (uint64_t)written;
+    }
+    return 0;
+}
+
+// Make up a fleet: nodes named in sequence, behind a handful of repeater paths, close to each other
+static uint8_t* provision_generate(uint32_t count, size_t* out_length) {
+    size_t   size   = MC_COMPANION_BUNDLE_HEADER_SIZE + (size_t)count * MC_COMPANION_BUNDLE_MAX_RECORD + MC_COMPANION_BUNDLE_MAX_RECORD;
+    uint8_t* bundle = malloc(size);
+    if (bundle == NULL) {
+        return NULL;
+    }
+
+    static mc_companion_bundle_encoder_t encoder;
+    uint32_t                             random = 0x2545F491;
+    size_t                               length = 0;
+    mc_companion_bundle_encoder_init(&encoder);
+    length += (size_t)mc_companion_bundle_encode_header(&encoder, count, bundle, size);
+    for (uint32_t index = 0; index < count; index++) {
+        companion_contact_t contact = {
+            .type                  = (index % 16 == 0) ? COMPANION_ADV_TYPE_REPEATER : COMPANION_ADV_TYPE_CHAT,
+            .out_path_len          = (int8_t)(1 + index % 3),
+            .last_advert_timestamp = 1767225600 + index * 37,
+            .gps_latitude          = 52370216 + (int32_t)(index % 100) * 150,
+            .gps_longitude         = 4895168 + (int32_t)(index / 100) * 220,
+        };
+        contact.last_modified = contact.last_advert_timestamp;
+        for (size_t byte = 0; byte < sizeof(contact.public_key); byte++) {
+            // xorshift32
+            random                   ^= random << 13;
+            random                   ^= random >> 17;
+            random                   ^= random << 5;
+            contact.public_key[byte]  = (uint8_t)random;
+        }
+        for (int8_t hop = 0; hop < contact.out_path_len; hop++) {
+            contact.out_path[hop] = (uint8_t)(0x10 * (hop + 1) + index % 4);
+        }
+        snprintf(contact.name, sizeof(contact.name), "fleet-%05" PRIu32, index);
+        length += (size_t)mc_companion_bundle_encode_contact(&encoder, &contact, &bundle[length], size - length);
+    }
+    length      += (size_t)mc_companion_bundle_encode_end(&encoder, &bundle[length], size - length);
+    *out_length  = length;
+    return bundle;
+}
+
+static uint8_t* provision_load(const char* path, size_t* out_length) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    size_t   size   = 0;
+    size_t   length = 0;
+    uint8_t* bundle = NULL;
+    while (!feof(file) && !ferror(file)) {
+        if (length == size) {
+            size             = (size > 0) ? size * 2 : 65536;
+            uint8_t* resized = realloc(bundle, size);
+            if (resized == NULL) {
+                free(bundle);
+                fclose(file);
+                return NULL;
+            }
+            bundle = resized;
+        }
+        length += fread(&bundle[length], 1, size - length, file);
+    }
+    fclose(file);
+    *out_length = length;
+    return bundle;
+}
+
+static bool provision_count_contact(const companion_contact_t* contact, void* context) {
+    (void)contact;
+    (void)context;
+    return true;
+}
+
+static void provision_response(mc_companion_client_t* client, const companion_response_packet_t* response, uint16_t args_length, void* context) {
+    (void)client;
+    (void)context;
+
+    switch (response->response) {
+        case COMPANION_RESPONSE_CODE_BUNDLE_ACK: {
+            const companion_resp_bundle_ack_args_t* ack = &response->response_bundle_ack_args;
+            provision.contacts                          = ack->contacts;
+            if (ack->status == COMPANION_BUNDLE_STATUS_APPLIED) {
+                provision.acked = ack->sequence;
+                provision.done  = true;
+            } else if (ack->status == COMPANION_BUNDLE_STATUS_RESEND) {
+                // Chunks already in flight are refused for the same gap, rewind once
+                if (ack->sequence != provision.rewound_to) {
+                    provision.rewound_to = ack->sequence;
+                    provision.next       = ack->sequence;
+                    provision.acked      = ack->sequence;
+                    provision.resends++;
+                }
+            } else if (ack->status == COMPANION_BUNDLE_STATUS_REJECTED) {
+                if (!provision.failed) {
+                    printf("The radio rejected the bundle after %" PRIu32 " contacts\r\n", ack->contacts);
+                }
+                provision.failed = true;
+            } else if (ack->sequence > provision.acked) {
+                provision.acked = ack->sequence;
+            }
+            break;
+        }
+        case COMPANION_RESPONSE_CODE_BUNDLE_DATA: {
+            size_t length = args_length - sizeof(response->response_bundle_data_args.sequence);
+            mc_companion_bundle_decode(&provision.decoder, response->response_bundle_data_args.data, length);
+            if (provision.export_file != NULL) {
+                fwrite(response->response_bundle_data_args.data, 1, length, provision.export_file);
+            }
+            break;
+        }
+        case COMPANION_RESPONSE_CODE_OK:
+        case COMPANION_RESPONSE_CODE_DEVICE_INFO:
+            provision.done = true;
+            break;
+        case COMPANION_RESPONSE_CODE_ERR:
+            // A chunk garbled on the way is sent again like a lost one
+            if (!provision.importing) {
+                printf("The radio answered with error %u\r\n", response->response_err_args.error_code);
+                provision.failed = true;
+            }
+            break;
+        default:
+            break;
+    }
+    if (mc_companion_response_is_final(response->response) && provision.in_flight > 0) {
+        provision.in_flight--;
+    }
+}
+
+// Feed whatever the radio sent, waiting up to timeout_ms for it. Returns 1 when something was read, 0 on a
+// timeout or -1 when the link failed.
+static int provision_receive(int timeout_ms) {
+    struct pollfd descriptor = {.fd = provision.fd, .events = POLLIN};
+    int           ready      = poll(&descriptor, 1, timeout_ms);
+    if (ready <= 0) {
+        return (ready == 0 || errno == EINTR) ? 0 : -1;
+    }
+    uint8_t buffer[4096];
+    ssize_t received = read(provision.fd, buffer, sizeof(buffer));
+    if (received < 0) {
+        return (errno == EINTR || errno == EAGAIN) ? 0 : -1;
+    }
+    if (received == 0) {
+        printf("The radio closed the link\r\n");
+        return -1;
+    }
+    mc_companion_client_read(&provision.client, buffer, (size_t)received);
+    return 1;
+}
+
+static int provision_import(const uint8_t* bundle, size_t length, uint32_t window) {
+    uint32_t chunks = (uint32_t)((length + PROVISION_CHUNK_SIZE - 1) / PROVISION_CHUNK_SIZE);
+    if (chunks > UINT16_MAX) {
+        printf("The bundle does not fit in %u chunks\r\n", UINT16_MAX);
+        return -1;
+    }
+
+    uint32_t timeouts    = 0;
+    provision.done       = false;
+    provision.importing  = true;
+    provision.next       = 0;
+    provision.acked      = 0;
+    provision.in_flight  = 0;
+    provision.rewound_to = UINT32_MAX;
+    while (!provision.done && !provision.failed) {
+        // The chunks that fit in the window go out together, packed into as few frames as the frame size allows
+        static uint8_t                     frames[2 * MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE];
+        mc_companion_batch_t               batch;
+        companion_cmd_import_bundle_args_t args;
+        mc_companion_batch_init_commands(&batch, provision.client.frame_size, sizeof(frames), frames);
+        while (provision.next < chunks && provision.next - provision.acked < window) {
+            size_t offset = (size_t)provision.next * PROVISION_CHUNK_SIZE;
+            size_t chunk  = (length - offset < PROVISION_CHUNK_SIZE) ? length - offset : PROVISION_CHUNK_SIZE;
+            args.sequence = (uint16_t)provision.next;
+            memcpy(args.data, &bundle[offset], chunk);
+            uint16_t args_length = (uint16_t)(sizeof(args.sequence) + chunk);
+            if (mc_companion_batch_add(&batch, COMPANION_CMD_IMPORT_BUNDLE, (const uint8_t*)&args, args_length) < 0) {
+                if (provision_write_all(provision.fd, frames, mc_companion_batch_length(&batch)) < 0) {
+                    printf("Failed to send chunk %" PRIu32 "\r\n", provision.next);
+                    return -1;
+                }
+                provision.frames += batch.frames;
+                mc_companion_batch_init_commands(&batch, provision.client.frame_size, sizeof(frames), frames);
+                mc_companion_batch_add(&batch, COMPANION_CMD_IMPORT_BUNDLE, (const uint8_t*)&args, args_length);
+            }
+            provision.next++;
+            provision.in_flight++;
+        }
+        if (provision_write_all(provision.fd, frames, mc_companion_batch_length(&batch)) < 0) {
+            printf("Failed to send chunk %" PRIu32 "\r\n", provision.next);
+            return -1;
+        }
+        provision.frames += batch.frames;
+        int result = provision_receive(PROVISION_RETRY);
+        if (result < 0) {
+            return -1;
+        }
+        if (result > 0) {
+            timeouts = 0;
+            continue;
+        }
+
+        // A chunk or its response was lost, go back to the first chunk the radio has not taken
+        if (++timeouts > PROVISION_RETRIES) {
+            printf("No response from the radio\r\n");
+            return -1;
+        }
+        provision.next       = provision.acked;
+        provision.in_flight  = 0;
+        provision.rewound_to = UINT32_MAX;
+        provision.resends++;
+    }
+    // Collect the responses to chunks still in flight, so they are not taken for the export or a new attempt
+    while (provision.in_flight > 0 && provision_receive(PROVISION_RETRY) > 0) {
+    }
+    provision.importing = false;
+    return provision.failed ? -1 : 0;
+}
+
+// Ask the radio for frames of up to frame_size bytes, the client takes over the size the radio settles on
+static int provision_negotiate(uint16_t frame_size) {
+    uint8_t frame[MESHCORE_COMPANION_MAX_FRAME_SIZE];
+    size_t  frame_length = 0;
+    provision.done       = false;
+    provision.in_flight  = 1;
+    if (mc_companion_write_device_query(3, frame_size, sizeof(frame), frame, &frame_length) < 0 ||
+        provision_write_all(provision.fd, frame, frame_length) < 0) {
+        return -1;
+    }
+    while (!provision.done) {
+        if (provision_receive(PROVISION_TIMEOUT) <= 0) {
+            printf("No response from the radio\r\n");
+            return -1;
+        }
+    }
+    printf("Using frames of up to %u bytes\r\n", provision.client.frame_size);
+    return 0;
+}
+
+static int provision_export(const char* path) {
+    uint8_t frame[MESHCORE_COMPANION_MAX_FRAME_SIZE];
+    size_t  frame_length  = 0;
+    provision.done        = false;
+    provision.in_flight   = 1;
+    provision.export_file = NULL;
+    if (path != NULL && (provision.export_file = fopen(path, "wb")) == NULL) {
+        printf("Failed to open %s (%i): %s\r\n", path, errno, strerror(errno));
+        return -1;
+    }
+    mc_companion_bundle_decoder_init(&provision.decoder, provision_count_contact, NULL);
+    int result = 0;
+    if (mc_companion_write_export_bundle(0, sizeof(frame), frame, &frame_length) < 0 || provision_write_all(provision.fd, frame, frame_length) < 0) {
+        result = -1;
+    }
+    while (result == 0 && !provision.done && !provision.failed) {
+        if (provision_receive(PROVISION_TIMEOUT) <= 0) {
+            printf("No response from the radio\r\n");
+            result = -1;
+        }
+    }
+    if (provision.export_file != NULL) {
+        fclose(provision.export_file);
+    }
+    return (result < 0 || provision.failed) ? -1 : 0;
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-n contacts] [-i bundle] [-o bundle] [-w window] [-f frame size] device\r\n", name);
+    printf("  -n  make up a fleet of this many contacts (default 2000)\r\n");
+    printf("  -i  import this bundle file instead\r\n");
+    printf("  -o  write the bundle exported after the import to this file\r\n");
+    printf("  -w  chunks in flight (default 8, at most %u)\r\n", PROVISION_MAX_WINDOW);
+    printf("  -f  ask the radio for frames of up to this many bytes (default %u)\r\n", MESHCORE_COMPANION_MAX_FRAME_SIZE);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t    count       = 2000;
+    uint32_t    window      = 8;
+    uint32_t    frame_size  = 0;
+    const char* import_path = NULL;
+    const char* export_path = NULL;
+    int         option;
+
+    while ((option = getopt(argc, argv, "n:i:o:w:f:")) != -1) {
+        switch (option) {
+            case 'n':
+                count = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'i':
+                import_path = optarg;
+                break;
+            case 'o':
+                export_path = optarg;
+                break;
+            case 'w':
+                window = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                frame_size = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind != argc - 1 || window == 0 || window > PROVISION_MAX_WINDOW || frame_size > UINT16_MAX) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    size_t   length = 0;
+    uint8_t* bundle = (import_path != NULL) ? provision_load(import_path, &length) : provision_generate(count, &length);
+    if (bundle == NULL) {
+        printf("Failed to prepare the bundle (%i): %s\r\n", errno, strerror(errno));
+        return 1;
+    }
+    if (import_path != NULL) {
+        // Count the contacts up front for the report
+        mc_companion_bundle_decoder_init(&provision.decoder, provision_count_contact, NULL);
+        if (mc_companion_bundle_decode(&provision.decoder, bundle, length) != MC_COMPANION_BUNDLE_COMPLETE) {
+            printf("%s is not a complete bundle\r\n", import_path);
+            free(bundle);
+            return 1;
+        }
+        count = provision.decoder.count;
+    }
+
+    provision.fd = open(argv[optind], O_RDWR | O_NOCTTY);
+    struct termios tty;
+    if (provision.fd < 0 || tcgetattr(provision.fd, &tty) != 0) {
+        printf("Failed to open %s (%i): %s\r\n", argv[optind], errno, strerror(errno));
+        free(bundle);
+        return 1;
+    }
+    cfmakeraw(&tty);
+    tcsetattr(provision.fd, TCSANOW, &tty);
+    mc_companion_client_init(&provision.client, provision_response, NULL);
+    if (frame_size != 0 && provision_negotiate((uint16_t)frame_size) < 0) {
+        close(provision.fd);
+        free(bundle);
+        return 1;
+    }
+
+    // A bundle that was corrupted on the way is rejected as a whole and sent again from the start
+    int      status   = 0;
+    int      result   = -1;
+    uint64_t start_ms = monotonic_ms();
+    provision.written = 0;
+    provision.frames  = 0;
+    for (int attempt = 0; attempt < PROVISION_ATTEMPTS && result < 0; attempt++) {
+        provision.failed = false;
+        result           = provision_import(bundle, length, window);
+    }
+    if (result < 0) {
+        printf("Import failed after %" PRIu32 " of %" PRIu32 " contacts\r\n", provision.contacts, count);
+        status = 1;
+    } else {
+        uint64_t elapsed_ms = monotonic_ms() - start_ms;
+        size_t   chunks     = (length + PROVISION_CHUNK_SIZE - 1) / PROVISION_CHUNK_SIZE;
+        size_t   single     = (size_t)count * (3 + 1 + sizeof(companion_contact_t));
+        printf("Imported %" PRIu32 " contacts in %" PRIu64 " ms: %zu bundle bytes in %zu chunks (window %" PRIu32 ", %" PRIu32 " resends)\r\n", count,
+               elapsed_ms, length, chunks, window, provision.resends);
+        printf("  %" PRIu64 " bytes in %" PRIu32 " frames on the link, %zu bytes and %" PRIu32 " round trips as ADD_UPDATE_CONTACT frames\r\n",
+               provision.written, provision.frames, single, count);
+
+        start_ms = monotonic_ms();
+        if (provision_export(export_path) < 0 || provision.decoder.status != MC_COMPANION_BUNDLE_COMPLETE) {
+            printf("Export failed\r\n");
+            status = 1;
+        } else {
+            printf("Exported %" PRIu32 " contacts in %" PRIu64 " ms, %" PRIu32 " bundle bytes\r\n", provision.decoder.count, monotonic_ms() - start_ms,
+                   provision.decoder.offset);
+        }
+    }
+
+    close(provision.fd);
+    free(bundle);
+    return status;
+}
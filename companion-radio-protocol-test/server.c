@@ -1,23 +1,423 @@
+#define _GNU_SOURCE
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <termios.h>
+#include <time.h>
 #include <unistd.h>
 #include "mc_companion.h"
+#include "mc_companion_batch.h"
+#include "mc_companion_bundle.h"
+#include "mc_companion_contact_store.h"
+#include "mc_companion_fanout.h"
+#include "mc_companion_rx_log.h"
 #include "mc_companion_serial_interface.h"
+#include "mc_companion_shm.h"
+#include "mc_companion_signer.h"
+#include "mc_companion_socket.h"
+#include "meshcore/ack_table.h"
+#include "meshcore/compact.h"
+#include "meshcore/link.h"
+#include "meshcore/latency.h"
+#include "meshcore/link_udp.h"
+#include "meshcore/packet.h"
+#include "meshcore/session.h"
+#include "meshcore/stats.h"
+#include "meshcore/trace_monitor.h"
+#include "meshcore/tx_scheduler.h"
+#include "meshcore/payload/ack.h"
+#include "meshcore/payload/txt_msg.h"
+#include "sha256.h"
 
 #define FIELD_SIZE(type, field) (sizeof(((type*)0)->field))
 
+#define BUNDLE_IMPORT_TIMEOUT_MS 10000  // An import without a chunk for this long is abandoned
+
 static int                         serial_port                                  = -1;
 static companion_response_packet_t tx_packet                                    = {0};
 static uint8_t                     tx_buffer[MESHCORE_COMPANION_MAX_FRAME_SIZE] = {0};
+static meshcore_trace_collector_t  trace_collector                              = {0};
+static meshcore_timer_wheel_t      timer_wheel                                  = {0};
+static meshcore_timer_t            advert_timer                                 = {0};
+static meshcore_ack_table_t        ack_table                                    = {0};
+static meshcore_session_table_t    login_sessions                               = {0};
+static meshcore_radio_params_t     radio_params = {.frequency = 868000, .bandwidth = 62500, .spreading_factor = 8, .coding_rate = 8,
+                                                   .preamble_length = MESHCORE_TX_DEFAULT_PREAMBLE_LENGTH};
+static const uint8_t               self_public_key[MESHCORE_PUB_KEY_SIZE]       = {0};
+static meshcore_link_t             radio_link                                   = {0};
+static meshcore_link_udp_t         radio_link_udp                               = {0};
+static bool                        radio_link_open                              = false;
+static meshcore_stats_t            node_stats                                   = {0};
+static meshcore_stats_shard_t*     node_stats_shard                             = NULL;
+static meshcore_timer_t            metrics_timer                                = {0};
+static const char*                 metrics_path                                 = NULL;
+static uint32_t                    start_ms                                     = 0;
+static mc_companion_rx_log_t       rx_log                                       = {0};
+static mc_companion_fanout_t       fanout                                       = {0};
+static mc_companion_signer_t       signer                                       = {0};
+
+// Contacts, changed one at a time or a bundle at a time
+static mc_companion_contact_store_t  contact_store   = {0};
+static mc_companion_bundle_decoder_t bundle_decoder  = {0};
+static mc_companion_bundle_encoder_t bundle_encoder  = {0};
+static uint16_t                      bundle_sequence = 0;  // Next IMPORT_BUNDLE chunk expected
+static uint32_t                      bundle_chunk_ms = 0;  // When the last IMPORT_BUNDLE chunk arrived
+
+// Responses of bulk operations, packed into frames of the negotiated size
+static mc_companion_batch_t bulk                                                    = {0};
+static uint8_t              bulk_buffer[2 * MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE] = {0};
+
+// Remote apps over TCP and WebSocket, a command that came in on a connection is answered on it
+static mc_companion_socket_server_t sockets            = {0};
+static int                          current_connection = -1;  // Connection of the command being handled, -1 for the serial port
+
+// Local apps reading heard frames and channel messages straight from shared memory
+static mc_companion_shm_t shm_ring = {0};
+
+// The well-known key of the public channel, channel index 0
+static const uint8_t public_channel_key[16] = {0x8b, 0x33, 0x87, 0xe9, 0xc5, 0xcd, 0xea, 0x6a, 0xc9, 0xe5, 0xed, 0xba, 0xa1, 0x15, 0xcd, 0x72};
+
+static void transmit(uint8_t* data, size_t length);
+
+static uint32_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+#define TIMER_TICK_MS           10
+#define SELF_ADVERT_INTERVAL_MS (60 * 60 * 1000)
+#define METRICS_INTERVAL_MS     10000
+
+// Share of the serial link the RX log may use, in percent
+#define RX_LOG_SHARE 50
+
+static void advert_callback(meshcore_timer_t* timer, void* context) {
+    printf("Periodic self advert due, next one in %u s\r\n", SELF_ADVERT_INTERVAL_MS / 1000);
+}
+
+static void session_callback(meshcore_session_table_t* table, meshcore_session_t* session, meshcore_session_event_t event, void* context) {
+    printf("Session with %02X%02X%02X%02X%02X%02X %s\r\n", session->public_key[0], session->public_key[1], session->public_key[2], session->public_key[3],
+           session->public_key[4], session->public_key[5], (event == MESHCORE_SESSION_EVENT_EXPIRED) ? "expired" : "evicted");
+}
+
+// Export the node statistics for a Prometheus textfile collector, replacing the file in one step
+static void metrics_callback(meshcore_timer_t* timer, void* context) {
+    static char             text[4096];
+    meshcore_stats_totals_t totals;
+    meshcore_stats_snapshot(&node_stats, &totals);
+    int length = meshcore_stats_format_prometheus(&totals, text, sizeof(text));
+    if (length < 0) {
+        return;
+    }
+
+    char temporary[256];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", metrics_path);
+    FILE* file = fopen(temporary, "w");
+    if (file == NULL) {
+        printf("Failed to write metrics to %s (%i): %s\r\n", temporary, errno, strerror(errno));
+        return;
+    }
+    fwrite(text, 1, (size_t)length, file);
+    fclose(file);
+    rename(temporary, metrics_path);
+}
+
+static void ack_callback(meshcore_ack_table_t* table, meshcore_ack_pending_t* pending, meshcore_ack_event_t event, void* context) {
+    switch (event) {
+        case MESHCORE_ACK_EVENT_CONFIRMED: {
+            printf("Message %08" PRIX32 " confirmed after %" PRIu32 " ms\r\n", pending->crc, pending->rtt_ms);
+            companion_response_packet_t push   = {0};
+            uint8_t                     buffer[MESHCORE_COMPANION_MAX_FRAME_SIZE];
+            size_t                      length = 0;
+            push.response                      = COMPANION_PUSH_CODE_SEND_CONFIRMED;
+            memcpy(push.push_ack_args.code, &pending->crc, sizeof(pending->crc));
+            mc_companion_write_serial_response(&push, sizeof(companion_push_ack_args_t), sizeof(buffer), buffer, &length);
+            transmit(buffer, length);
+            break;
+        }
+        case MESHCORE_ACK_EVENT_RETRY:
+            printf("No ACK for message %08" PRIX32 ", attempt %u of %u\r\n", pending->crc, pending->attempts, pending->max_attempts);
+            break;
+        case MESHCORE_ACK_EVENT_TIMEOUT:
+            printf("Message %08" PRIX32 " was not acknowledged\r\n", pending->crc);
+            break;
+    }
+}
 
 static void transmit(uint8_t* data, size_t length) {
-    write(serial_port, data, length);
+    if (current_connection >= 0) {
+        mc_companion_socket_send(&sockets, current_connection, data, length);
+    } else if (serial_port >= 0) {
+        write(serial_port, data, length);
+    }
+}
+
+// Frame size negotiated on the link the command being handled came in on
+static uint16_t link_frame_size(void) {
+    return (current_connection >= 0) ? sockets.connections[current_connection].framer.frame_size : mc_companion_serial_frame_size();
+}
+
+// Flood a text message on the link. There are no shared secrets in this test server, so the encrypted part
+// carries the plain timestamp, flags and text.
+static void send_txt_msg(const companion_cmd_send_txt_msg_args_t* message, uint8_t flags, size_t text_length) {
+    meshcore_txt_msg_t text = {
+        .destination_hash = message->pub_key_prefix[0],
+        .source_hash      = self_public_key[0],
+    };
+    if (text_length > sizeof(text.ciphertext) - sizeof(uint32_t) - 1) {
+        text_length = sizeof(text.ciphertext) - sizeof(uint32_t) - 1;
+    }
+    memcpy(&text.ciphertext[0], &message->msg_timestamp, sizeof(uint32_t));
+    text.ciphertext[sizeof(uint32_t)] = flags;
+    memcpy(&text.ciphertext[sizeof(uint32_t) + 1], message->text, text_length);
+    text.ciphertext_length = (uint8_t)(sizeof(uint32_t) + 1 + text_length);
+
+    meshcore_message_t frame = {
+        .type  = MESHCORE_PAYLOAD_TYPE_TXT_MSG,
+        .route = MESHCORE_ROUTE_TYPE_FLOOD,
+    };
+    if (meshcore_txt_msg_serialize(&text, frame.payload, &frame.payload_length) < 0 || meshcore_link_send_message(&radio_link, &frame, now_ms()) < 0) {
+        printf("Failed to send the message on the link\r\n");
+        return;
+    }
+    // The frame size on air is the payload plus header and path length bytes
+    meshcore_stats_add(node_stats_shard, MESHCORE_STATS_TX_AIRTIME_MS, meshcore_lora_airtime_us(&radio_params, frame.payload_length + 2) / 1000);
+}
+
+// Frame a heard frame as an RX log push right in the shared memory ring
+static void shm_publish_rx(const uint8_t* frame, uint8_t frame_size) {
+    uint8_t* data = mc_companion_shm_reserve(&shm_ring, 6 + (size_t)frame_size);
+    if (data == NULL) {
+        return;
+    }
+    uint16_t length = 3 + frame_size;
+    data[0]         = '>';
+    data[1]         = (length >> 0) & 0xFF;
+    data[2]         = (length >> 8) & 0xFF;
+    data[3]         = COMPANION_PUSH_CODE_LOG_RX_DATA;
+    data[4]         = 0;  // There is no radio, the link has no noise or signal strength to report
+    data[5]         = 0;
+    memcpy(&data[6], frame, frame_size);
+    mc_companion_shm_commit(&shm_ring);
+}
+
+// Same layout as the channel messages of the fan-out, the shared memory ring takes link sized frames
+static void shm_publish_channel_msg(uint8_t path_length, const meshcore_compact_grp_txt_t* grp_txt) {
+    companion_response_packet_t packet = {0};
+    size_t                      header = sizeof(companion_resp_channel_msg_recv_args_t) - sizeof(packet.response_channel_msg_recv_args.text);
+    size_t                      text   = grp_txt->text_length;
+    if (text > sizeof(packet.response_channel_msg_recv_args.text)) {
+        text = sizeof(packet.response_channel_msg_recv_args.text);
+    }
+
+    packet.response                                        = COMPANION_RESPONSE_CODE_CHANNEL_MSG_RECV;
+    packet.response_channel_msg_recv_args.channel_idx      = 0;
+    packet.response_channel_msg_recv_args.path_length      = path_length;
+    packet.response_channel_msg_recv_args.txt_type         = grp_txt->text_type;
+    packet.response_channel_msg_recv_args.sender_timestamp = grp_txt->timestamp;
+    memcpy(packet.response_channel_msg_recv_args.text, grp_txt->text, text);
+    mc_companion_shm_publish(&shm_ring, &packet, (uint16_t)(header + text));
+}
+
+// Handle a frame heard on the link, ACKs confirm pending messages
+static void link_receive(const meshcore_message_t* message) {
+    printf("Link frame: type %u route %u path %u payload %u\r\n", message->type, message->route, message->path_length, message->payload_length);
+    meshcore_ack_t ack;
+    if (message->type == MESHCORE_PAYLOAD_TYPE_ACK && meshcore_ack_deserialize((uint8_t*)message->payload, message->payload_length, &ack) >= 0) {
+        meshcore_ack_received(&ack_table, ack.crc, now_ms());
+    }
+
+    // Channel messages are decrypted and framed once for every attached client
+    if (message->type == MESHCORE_PAYLOAD_TYPE_GRP_TXT) {
+        _Alignas(4) uint8_t         storage[MESHCORE_COMPACT_MAX_SIZE];
+        meshcore_compact_message_t* compact = (meshcore_compact_message_t*)storage;
+        meshcore_compact_grp_txt_t  grp_txt;
+        if (meshcore_compact_from_message(message, compact, sizeof(storage)) >= 0 &&
+            meshcore_compact_decrypt(compact, public_channel_key, sizeof(public_channel_key)) >= 0 && meshcore_compact_grp_txt(compact, &grp_txt) >= 0) {
+            int clients = mc_companion_fanout_publish_channel_msg(&fanout, 0, message->path_length, &grp_txt);
+            printf("Channel message for %i clients: '%.*s'\r\n", clients, grp_txt.text_length, grp_txt.text);
+            if (shm_ring.header != NULL) {
+                shm_publish_channel_msg(message->path_length, &grp_txt);
+            }
+        }
+    }
+}
+
+// There is no identity key in this test server, the prehash stands in for the Ed25519ph signature so that a
+// host can check it hashed the same document
+static int sign_prehashed(const uint8_t digest[SHA512_HASH_SIZE], uint8_t out_signature[MC_COMPANION_SIGNATURE_SIZE], void* context) {
+    memcpy(out_signature, digest, MC_COMPANION_SIGNATURE_SIZE);
+    return 0;
+}
+
+// Write to a companion client without blocking, a full client takes no bytes
+static int fanout_write(void* context, const uint8_t* data, size_t length) {
+    ssize_t written = write((int)(intptr_t)context, data, length);
+    if (written < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+    return (int)written;
+}
+
+// Open a pseudo terminal that mirrors channel messages, an app attaches to the printed device
+static int open_mirror(void) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+        printf("Failed to open a pseudo terminal (%i): %s\r\n", errno, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    if (mc_companion_fanout_attach(&fanout, fanout_write, (void*)(intptr_t)fd, 0) < 0) {
+        printf("No room for another client\r\n");
+        close(fd);
+        return -1;
+    }
+    printf("Mirroring channel messages to %s\r\n", ptsname(fd));
+    return 0;
+}
+
+// Contacts the store starts out with
+static const companion_contact_t seed_contacts[] = {
+    {
+        .public_key            = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+                                  0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20},
+        .type                  = 1,
+        .flags                 = 0,
+        .out_path_len          = 3,
+        .out_path              = {1, 2, 3},
+        .name                  = "Alice",
+        .last_advert_timestamp = 1625158800,
+        .gps_latitude          = 52345678,
+        .gps_longitude         = 13456789,
+        .last_modified         = 1625158800,
+    },
+    {
+        .public_key            = {0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
+                                  0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x40},
+        .type                  = 1,
+        .flags                 = 0,
+        .out_path_len          = 2,
+        .out_path              = {4, 5},
+        .name                  = "Bob",
+        .last_advert_timestamp = 1625158800,
+        .gps_latitude          = 52345678,
+        .gps_longitude         = 13456789,
+        .last_modified         = 1625158800,
+    },
+};
+
+// Contacts of an imported bundle are staged and only applied once the whole bundle has been checked
+static bool bundle_contact(const companion_contact_t* contact, void* context) {
+    return mc_companion_contact_store_stage(&contact_store, contact) >= 0;
+}
+
+// Take the next chunk of an imported bundle. Chunk 0 starts over, a chunk out of order is answered with the
+// chunk the host has to resend from, so a host can keep a window of chunks in flight.
+static companion_bundle_status_t import_bundle_chunk(const companion_cmd_import_bundle_args_t* chunk, size_t length) {
+    bundle_chunk_ms = now_ms();
+    if (chunk->sequence == 0) {
+        mc_companion_contact_store_rollback(&contact_store);
+        mc_companion_bundle_decoder_init(&bundle_decoder, bundle_contact, NULL);
+        bundle_sequence = 0;
+    }
+    if (bundle_decoder.status == MC_COMPANION_BUNDLE_COMPLETE) {
+        return COMPANION_BUNDLE_STATUS_APPLIED;
+    }
+    if (bundle_decoder.status == MC_COMPANION_BUNDLE_ERROR) {
+        return COMPANION_BUNDLE_STATUS_REJECTED;
+    }
+    if (chunk->sequence != bundle_sequence) {
+        return COMPANION_BUNDLE_STATUS_RESEND;
+    }
+
+    bundle_sequence++;
+    switch (mc_companion_bundle_decode(&bundle_decoder, chunk->data, length)) {
+        case MC_COMPANION_BUNDLE_COMPLETE: {
+            uint16_t added = mc_companion_contact_store_commit(&contact_store);
+            printf("Applied a bundle of %" PRIu32 " contacts, %u new, %u stored\r\n", bundle_decoder.count, added, contact_store.count);
+            return COMPANION_BUNDLE_STATUS_APPLIED;
+        }
+        case MC_COMPANION_BUNDLE_ERROR:
+            printf("Rejected a bundle after %" PRIu32 " bytes and %" PRIu32 " contacts\r\n", bundle_decoder.offset, bundle_decoder.count);
+            mc_companion_contact_store_rollback(&contact_store);
+            return COMPANION_BUNDLE_STATUS_REJECTED;
+        default:
+            return COMPANION_BUNDLE_STATUS_IN_PROGRESS;
+    }
+}
+
+// Drop the contacts of an import the host stopped sending, for example because it disconnected. A chunk that
+// still arrives for it is answered with a resend from chunk 0, which starts the import over.
+static void import_bundle_expire(void) {
+    if (contact_store.staged > 0 && now_ms() - bundle_chunk_ms >= BUNDLE_IMPORT_TIMEOUT_MS) {
+        printf("Abandoned a bundle import after %" PRIu32 " contacts\r\n", bundle_decoder.count);
+        mc_companion_contact_store_rollback(&contact_store);
+        bundle_sequence = 0;
+    }
+}
+
+static void bulk_begin(void) {
+    mc_companion_batch_init_responses(&bulk, link_frame_size(), sizeof(bulk_buffer), bulk_buffer);
+}
+
+// Queue a response of a bulk operation, the buffer is written out whenever it is full
+static void bulk_add(const companion_response_packet_t* packet, uint16_t args_length) {
+    if (mc_companion_batch_add(&bulk, packet->response, packet->args, args_length) < 0) {
+        transmit(bulk_buffer, mc_companion_batch_length(&bulk));
+        bulk_begin();
+        mc_companion_batch_add(&bulk, packet->response, packet->args, args_length);
+    }
+}
+
+static void bulk_end(void) {
+    transmit(bulk_buffer, mc_companion_batch_length(&bulk));
+}
+
+static void send_bundle_data(uint16_t sequence, const uint8_t* data, size_t length) {
+    tx_packet.response                           = COMPANION_RESPONSE_CODE_BUNDLE_DATA;
+    tx_packet.response_bundle_data_args.sequence = sequence;
+    memcpy(tx_packet.response_bundle_data_args.data, data, length);
+    bulk_add(&tx_packet, (uint16_t)(FIELD_SIZE(companion_resp_bundle_data_args_t, sequence) + length));
+}
+
+// Send the contacts modified after since as a bundle in full BUNDLE_DATA frames, the serial port paces them
+static void export_bundle(uint32_t since) {
+    uint8_t  pending[FIELD_SIZE(companion_resp_bundle_data_args_t, data) + MC_COMPANION_BUNDLE_MAX_RECORD];
+    size_t   pending_length = 0;
+    size_t   chunk_size     = FIELD_SIZE(companion_resp_bundle_data_args_t, data);
+    uint16_t sequence       = 0;
+    uint32_t count          = 0;
+    for (uint16_t i = 0; i < contact_store.count; i++) {
+        count += (contact_store.contacts[i].last_modified > since) ? 1 : 0;
+    }
+
+    mc_companion_bundle_encoder_init(&bundle_encoder);
+    pending_length += (size_t)mc_companion_bundle_encode_header(&bundle_encoder, count, pending, sizeof(pending));
+    for (uint16_t i = 0; i < contact_store.count; i++) {
+        if (contact_store.contacts[i].last_modified > since) {
+            pending_length += (size_t)mc_companion_bundle_encode_contact(&bundle_encoder, &contact_store.contacts[i], &pending[pending_length],
+                                                                         sizeof(pending) - pending_length);
+        }
+        if (pending_length >= chunk_size) {
+            send_bundle_data(sequence++, pending, chunk_size);
+            pending_length -= chunk_size;
+            memmove(pending, &pending[chunk_size], pending_length);
+        }
+    }
+    pending_length += (size_t)mc_companion_bundle_encode_end(&bundle_encoder, &pending[pending_length], sizeof(pending) - pending_length);
+    for (size_t offset = 0; offset < pending_length; offset += chunk_size) {
+        send_bundle_data(sequence++, &pending[offset], (pending_length - offset < chunk_size) ? pending_length - offset : chunk_size);
+    }
+    printf("Exported %" PRIu32 " contacts in %u chunks\r\n", count, sequence);
 }
 
 void packet_callback(companion_command_packet_t* packet, mc_companion_command_parser_error_t error) {
@@ -67,67 +467,87 @@ void packet_callback(companion_command_packet_t* packet, mc_companion_command_pa
                    packet->command_send_txt_msg_args.pub_key_prefix[2], packet->command_send_txt_msg_args.pub_key_prefix[3],
                    packet->command_send_txt_msg_args.pub_key_prefix[4], packet->command_send_txt_msg_args.pub_key_prefix[5],
                    packet->command_send_txt_msg_args.text);
-            tx_packet.response                           = COMPANION_RESPONSE_CODE_SENT;
-            tx_packet.response_sent_args.type            = packet->command_send_txt_msg_args.txt_type;
-            tx_packet.response_sent_args.expected_ack[0] = 0x12;
-            tx_packet.response_sent_args.expected_ack[1] = 0x34;
-            tx_packet.response_sent_args.expected_ack[2] = 0x56;
-            tx_packet.response_sent_args.expected_ack[3] = 0x78;
-            tx_packet.response_sent_args.est_timeout     = 10000;
+            {
+                companion_cmd_send_txt_msg_args_t* message = &packet->command_send_txt_msg_args;
+                size_t  text_length = packet->args_length - (sizeof(companion_cmd_send_txt_msg_args_t) - FIELD_SIZE(companion_cmd_send_txt_msg_args_t, text));
+                uint8_t flags       = (uint8_t)((message->attempt & 3) | (message->txt_type << 2));
+                uint32_t expected_ack = meshcore_ack_expected_crc(message->msg_timestamp, flags, (const uint8_t*)message->text, text_length, self_public_key);
+                uint32_t timeout      = 0;
+                meshcore_ack_track(&ack_table, expected_ack, message->pub_key_prefix[0], 3, now_ms(), NULL, &timeout);
+                meshcore_session_t* session = meshcore_session_find(&login_sessions, message->pub_key_prefix, sizeof(message->pub_key_prefix));
+                if (session != NULL) {
+                    meshcore_session_touch(&login_sessions, session, now_ms());
+                }
+                if (radio_link_open) {
+                    send_txt_msg(message, flags, text_length);
+                }
+
+                tx_packet.response                       = COMPANION_RESPONSE_CODE_SENT;
+                tx_packet.response_sent_args.type        = message->txt_type;
+                tx_packet.response_sent_args.est_timeout = timeout;
+                memcpy(tx_packet.response_sent_args.expected_ack, &expected_ack, sizeof(expected_ack));
+            }
             mc_companion_write_serial_response(&tx_packet, sizeof(companion_resp_sent_args_t), sizeof(tx_buffer), tx_buffer, &tx_length);
             transmit(tx_buffer, tx_length);
             break;
         case COMPANION_CMD_GET_CONTACTS:
-            companion_contact_t contacts[] = {
-                {
-                    .public_key            = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
-                                              0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20},
-                    .type                  = 1,
-                    .flags                 = 0,
-                    .out_path_len          = 3,
-                    .out_path              = {1, 2, 3},
-                    .name                  = "Alice",
-                    .last_advert_timestamp = 1625158800,
-                    .gps_latitude          = 52345678,
-                    .gps_longitude         = 13456789,
-                    .last_modified         = 1625158800,
-                },
-                {
-                    .public_key            = {0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
-                                              0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x40},
-                    .type                  = 1,
-                    .flags                 = 0,
-                    .out_path_len          = 2,
-                    .out_path              = {4, 5},
-                    .name                  = "Bob",
-                    .last_advert_timestamp = 1625158800,
-                    .gps_latitude          = 52345678,
-                    .gps_longitude         = 13456789,
-                    .last_modified         = 1625158800,
-                },
-            };
-
-            printf("Received get contacts command, sending %u contacts\r\n", sizeof(contacts) / sizeof(companion_contact_t));
+            printf("Received get contacts command, sending %u contacts\r\n", contact_store.count);
 
+            bulk_begin();
             tx_packet.response                           = COMPANION_RESPONSE_CODE_CONTACTS_START;
-            tx_packet.response_contacts_start_args.count = sizeof(contacts) / sizeof(companion_contact_t);
-            mc_companion_write_serial_response(&tx_packet, sizeof(companion_resp_contacts_start_t), sizeof(tx_buffer), tx_buffer, &tx_length);
-            transmit(tx_buffer, tx_length);
+            tx_packet.response_contacts_start_args.count = contact_store.count;
+            bulk_add(&tx_packet, sizeof(companion_resp_contacts_start_t));
 
             tx_packet.response = COMPANION_RESPONSE_CODE_CONTACT;
-            for (size_t i = 0; i < sizeof(contacts) / sizeof(companion_contact_t); i++) {
-                memcpy(&tx_packet.response_contact_args, &contacts[i], sizeof(companion_contact_t));
-                mc_companion_write_serial_response(&tx_packet, sizeof(companion_contact_t), sizeof(tx_buffer), tx_buffer, &tx_length);
-                transmit(tx_buffer, tx_length);
+            for (uint16_t i = 0; i < contact_store.count; i++) {
+                memcpy(&tx_packet.response_contact_args, &contact_store.contacts[i], sizeof(companion_contact_t));
+                bulk_add(&tx_packet, sizeof(companion_contact_t));
             }
 
             tx_packet.response                            = COMPANION_RESPONSE_CODE_END_OF_CONTACTS;
             tx_packet.response_end_of_contacts_args.since = 0;
-            mc_companion_write_serial_response(&tx_packet, sizeof(companion_resp_end_of_contacts_t), sizeof(tx_buffer), tx_buffer, &tx_length);
+            bulk_add(&tx_packet, sizeof(companion_resp_end_of_contacts_t));
+            bulk_end();
+            break;
+        case COMPANION_CMD_ADD_UPDATE_CONTACT: {
+            companion_contact_t* contact = &packet->command_add_update_contact_args;
+            printf("Received add or update contact command for '%.32s'\r\n", contact->name);
+            import_bundle_expire();
+            if (contact->out_path_len < -1 || contact->out_path_len > (int8_t)sizeof(contact->out_path)) {
+                tx_packet.response                     = COMPANION_RESPONSE_CODE_ERR;
+                tx_packet.response_err_args.error_code = COMPANION_ERROR_CODE_ILLEGAL_ARG;
+            } else if (contact_store.staged > 0) {
+                // Committing this contact would apply the bundle being imported before it is complete, the
+                // import is abandoned once it has been idle for BUNDLE_IMPORT_TIMEOUT_MS
+                tx_packet.response                     = COMPANION_RESPONSE_CODE_ERR;
+                tx_packet.response_err_args.error_code = COMPANION_ERROR_CODE_BAD_STATE;
+            } else if (mc_companion_contact_store_stage(&contact_store, contact) < 0) {
+                tx_packet.response                     = COMPANION_RESPONSE_CODE_ERR;
+                tx_packet.response_err_args.error_code = COMPANION_ERROR_CODE_TABLE_FULL;
+            } else {
+                mc_companion_contact_store_commit(&contact_store);
+                tx_packet.response = COMPANION_RESPONSE_CODE_OK;
+            }
+            mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+            break;
+        }
+        case COMPANION_CMD_SET_RADIO_PARAMS:
+            radio_params.frequency        = packet->command_set_radio_params_args.frequency;
+            radio_params.bandwidth        = packet->command_set_radio_params_args.bandwidth;
+            radio_params.spreading_factor = packet->command_set_radio_params_args.spreading_factor;
+            radio_params.coding_rate      = packet->command_set_radio_params_args.coding_rate;
+            printf("Received set radio params command. %" PRIu32 " kHz, %" PRIu32 " Hz, SF%u, CR 4/%u, a full frame takes %" PRIu32 " ms\r\n",
+                   radio_params.frequency, radio_params.bandwidth, radio_params.spreading_factor, radio_params.coding_rate,
+                   meshcore_lora_airtime_us(&radio_params, MESHCORE_MAX_TRANS_UNIT) / 1000);
+            tx_packet.response = COMPANION_RESPONSE_CODE_OK;
+            mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
             transmit(tx_buffer, tx_length);
             break;
         case COMPANION_CMD_SEND_SELF_ADVERT:
             printf("Received send self advert command, should send advertisement\r\n");
+            // Keep advertising periodically from now on
+            meshcore_timer_start_periodic(&timer_wheel, &advert_timer, now_ms() + SELF_ADVERT_INTERVAL_MS, SELF_ADVERT_INTERVAL_MS);
             tx_packet.response = COMPANION_RESPONSE_CODE_OK;
             mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
             transmit(tx_buffer, tx_length);
@@ -138,8 +558,19 @@ void packet_callback(companion_command_packet_t* packet, mc_companion_command_pa
             mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
             transmit(tx_buffer, tx_length);
             break;
-        case COMPANION_CMD_DEVICE_QUERY:
-            printf("Received device query command. Target app version is %u\r\n", packet->command_device_query_args.app_target_version);
+        case COMPANION_CMD_DEVICE_QUERY: {
+            // An app that does not ask for larger frames gets the base frame size, also after a larger one was in use
+            uint16_t requested  = (packet->args_length >= sizeof(companion_cmd_device_query_args_t)) ? packet->command_device_query_args.max_frame_size : 0;
+            uint16_t frame_size;
+            if (current_connection >= 0) {
+                frame_size = mc_companion_framer_set_frame_size(&sockets.connections[current_connection].framer, requested);
+            } else {
+                // RX log pushes only go to the serial port
+                frame_size = mc_companion_set_serial_frame_size(requested);
+                mc_companion_rx_log_set_frame_size(&rx_log, frame_size);
+            }
+            printf("Received device query command. Target app version is %u, frames of up to %u bytes\r\n",
+                   packet->command_device_query_args.app_target_version, frame_size);
             // Respond with device info
             tx_packet.response                                        = COMPANION_RESPONSE_CODE_DEVICE_INFO;
             tx_packet.response_device_info_args.firmware_version_code = 8;
@@ -153,9 +584,11 @@ void packet_callback(companion_command_packet_t* packet, mc_companion_command_pa
             snprintf(tx_packet.response_device_info_args.board_manufacturer_name, FIELD_SIZE(companion_resp_device_info_args_t, board_manufacturer_name),
                      "Acme Corporation");
             snprintf(tx_packet.response_device_info_args.firmware_version, FIELD_SIZE(companion_resp_device_info_args_t, firmware_version), "v1.11.0");
+            tx_packet.response_device_info_args.max_frame_size = frame_size;
             mc_companion_write_serial_response(&tx_packet, sizeof(companion_resp_device_info_args_t), sizeof(tx_buffer), tx_buffer, &tx_length);
             transmit(tx_buffer, tx_length);
             break;
+        }
         case COMPANION_CMD_GET_CHANNEL:
             printf("Received get channel command for channel ID %u\r\n", packet->command_get_channel_args.channel_idx);
             tx_packet.response                     = COMPANION_RESPONSE_CODE_ERR;
@@ -163,6 +596,120 @@ void packet_callback(companion_command_packet_t* packet, mc_companion_command_pa
             mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
             transmit(tx_buffer, tx_length);
             break;
+        case COMPANION_CMD_SEND_TRACE_PATH: {
+            companion_cmd_send_trace_path_args_t* trace = &packet->command_send_trace_path_args;
+            size_t path_length = packet->args_length - (sizeof(companion_cmd_send_trace_path_args_t) - FIELD_SIZE(companion_cmd_send_trace_path_args_t, path));
+            uint8_t hash_size  = MESHCORE_TRACE_HASH_SIZE(trace->flags);
+            size_t  hops       = path_length / hash_size;
+            printf("Received send trace path command. Tag %08" PRIX32 ", %zu hops\r\n", trace->tag, hops);
+
+            tx_packet.response                       = COMPANION_RESPONSE_CODE_SENT;
+            tx_packet.response_sent_args.type        = 0;
+            memcpy(tx_packet.response_sent_args.expected_ack, &trace->tag, sizeof(trace->tag));
+            tx_packet.response_sent_args.est_timeout = 5000;
+            mc_companion_write_serial_response(&tx_packet, sizeof(companion_resp_sent_args_t), sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+
+            // There is no radio, let every listed hop forward the trace with a made up SNR
+            meshcore_message_t message = {
+                .type           = MESHCORE_PAYLOAD_TYPE_TRACE,
+                .route          = MESHCORE_ROUTE_TYPE_DIRECT,
+                .payload_length = MESHCORE_TRACE_HEADER_SIZE + hops * hash_size,
+            };
+            memcpy(&message.payload[0], &trace->tag, sizeof(trace->tag));
+            memcpy(&message.payload[sizeof(uint32_t)], &trace->auth, sizeof(trace->auth));
+            message.payload[MESHCORE_TRACE_FLAGS_OFFSET] = trace->flags;
+            memcpy(&message.payload[MESHCORE_TRACE_HEADER_SIZE], trace->path, hops * hash_size);
+            for (size_t hop = 0; hop < hops; hop++) {
+                if (meshcore_trace_forward(&message, &trace->path[hop * hash_size], (int8_t)(40 - (int)hop * 6)) != MESHCORE_TRACE_FORWARD) {
+                    break;
+                }
+            }
+            int8_t final_snr = 32;
+            if (meshcore_trace_collect(&trace_collector, 0, &message, final_snr, 0) < 0) {
+                printf("Trace did not complete\r\n");
+                break;
+            }
+
+            memset(&tx_packet, 0, sizeof(tx_packet));
+            tx_packet.response                                     = COMPANION_PUSH_CODE_TRACE_DATA;
+            tx_packet.push_trace_data_args.path_length             = message.path_length;
+            tx_packet.push_trace_data_args.flags                   = trace->flags;
+            tx_packet.push_trace_data_args.tag                     = trace->tag;
+            tx_packet.push_trace_data_args.authentication_code     = trace->auth;
+            uint8_t* data                                          = tx_packet.push_trace_data_args.data;
+            memcpy(data, trace->path, hops * hash_size);
+            memcpy(&data[hops * hash_size], message.path, message.path_length);
+            data[hops * hash_size + message.path_length] = (uint8_t)final_snr;
+            mc_companion_write_serial_response(&tx_packet,
+                                               sizeof(companion_push_trace_data_args_t) - FIELD_SIZE(companion_push_trace_data_args_t, data) +
+                                                   hops * hash_size + message.path_length + 1,
+                                               sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+
+            for (size_t hop = 0; hop <= hops; hop++) {
+                uint8_t from = (hop == 0) ? 0 : trace->path[(hop - 1) * hash_size];
+                uint8_t to   = (hop == hops) ? 0 : trace->path[hop * hash_size];
+                const meshcore_trace_link_t* link = meshcore_trace_collector_find(&trace_collector, from, to);
+                if (link != NULL) {
+                    printf("  link %02X -> %02X: %" PRIu32 " samples, mean %.2f dB, p10 %.2f dB, p90 %.2f dB\r\n", from, to, link->samples,
+                           meshcore_trace_link_mean(link) / 4.0, meshcore_trace_link_percentile(link, 10) / 4.0,
+                           meshcore_trace_link_percentile(link, 90) / 4.0);
+                }
+            }
+            break;
+        }
+        case COMPANION_CMD_SIGN_START:
+            printf("Received sign start command\r\n");
+            tx_packet.response                                = COMPANION_RESPONSE_CODE_SIGN_START;
+            tx_packet.response_sign_start_args.maximum_length = mc_companion_signer_start(&signer);
+            mc_companion_write_serial_response(&tx_packet, sizeof(companion_resp_sign_start_args_t), sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+            break;
+        case COMPANION_CMD_SIGN_DATA: {
+            mc_companion_signer_status_t status = mc_companion_signer_data(&signer, packet->command_sign_data_args.data, packet->args_length);
+            if (status != MC_COMPANION_SIGNER_OK) {
+                printf("Sign data rejected after %" PRIu32 " bytes\r\n", signer.length);
+                tx_packet.response                     = COMPANION_RESPONSE_CODE_ERR;
+                tx_packet.response_err_args.error_code =
+                    (status == MC_COMPANION_SIGNER_TOO_LONG) ? COMPANION_ERROR_CODE_TABLE_FULL : COMPANION_ERROR_CODE_BAD_STATE;
+            } else {
+                tx_packet.response = COMPANION_RESPONSE_CODE_OK;
+            }
+            mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+            break;
+        }
+        case COMPANION_CMD_SIGN_FINISH:
+            printf("Received sign finish command after %" PRIu32 " bytes\r\n", signer.length);
+            if (mc_companion_signer_finish(&signer, tx_packet.response_signature_args.signature) < 0) {
+                tx_packet.response                     = COMPANION_RESPONSE_CODE_ERR;
+                tx_packet.response_err_args.error_code = COMPANION_ERROR_CODE_BAD_STATE;
+                mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
+            } else {
+                tx_packet.response = COMPANION_RESPONSE_CODE_SIGNATURE;
+                mc_companion_write_serial_response(&tx_packet, sizeof(companion_resp_signature_args_t), sizeof(tx_buffer), tx_buffer, &tx_length);
+            }
+            transmit(tx_buffer, tx_length);
+            break;
+        case COMPANION_CMD_IMPORT_BUNDLE: {
+            size_t length = packet->args_length - FIELD_SIZE(companion_cmd_import_bundle_args_t, sequence);
+            tx_packet.response                          = COMPANION_RESPONSE_CODE_BUNDLE_ACK;
+            tx_packet.response_bundle_ack_args.status   = import_bundle_chunk(&packet->command_import_bundle_args, length);
+            tx_packet.response_bundle_ack_args.sequence = bundle_sequence;
+            tx_packet.response_bundle_ack_args.contacts = bundle_decoder.count;
+            mc_companion_write_serial_response(&tx_packet, sizeof(companion_resp_bundle_ack_args_t), sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+            break;
+        }
+        case COMPANION_CMD_EXPORT_BUNDLE:
+            printf("Received export bundle command\r\n");
+            bulk_begin();
+            export_bundle((packet->args_length > 0) ? packet->command_export_bundle_args.since : 0);
+            tx_packet.response = COMPANION_RESPONSE_CODE_OK;
+            bulk_add(&tx_packet, 0);
+            bulk_end();
+            break;
         case COMPANION_CMD_GET_CUSTOM_VARS:
             printf("Received get custom vars command\r\n");
             tx_packet.response = COMPANION_RESPONSE_CODE_CUSTOM_VARS;
@@ -170,12 +717,103 @@ void packet_callback(companion_command_packet_t* packet, mc_companion_command_pa
             mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
             transmit(tx_buffer, tx_length);
             break;
+        case COMPANION_CMD_SEND_LOGIN: {
+            // There is no remote server behind the link and no key agreement here: the session is granted
+            // right away and a hash of both keys stands in for the ECDH secret
+            const uint8_t* public_key = packet->command_login_args.pub_key;
+            printf("Received login command for %02X%02X%02X%02X%02X%02X\r\n", public_key[0], public_key[1], public_key[2], public_key[3], public_key[4],
+                   public_key[5]);
+            uint8_t     keys[2 * MESHCORE_PUB_KEY_SIZE];
+            SHA256_HASH secret;
+            memcpy(keys, self_public_key, MESHCORE_PUB_KEY_SIZE);
+            memcpy(&keys[MESHCORE_PUB_KEY_SIZE], public_key, MESHCORE_PUB_KEY_SIZE);
+            Sha256Calculate(keys, sizeof(keys), &secret);
+            meshcore_session_t* session = meshcore_session_login(&login_sessions, public_key, secret.bytes, MESHCORE_SESSION_ADMIN, now_ms());
+
+            tx_packet.response = COMPANION_RESPONSE_CODE_SENT;
+            mc_companion_write_serial_response(&tx_packet, sizeof(companion_resp_sent_args_t), sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+
+            memset(&tx_packet, 0, sizeof(tx_packet));
+            tx_packet.response                            = COMPANION_PUSH_CODE_LOGIN_SUCCESS;
+            tx_packet.push_login_success_args.permissions = session->permissions;
+            memcpy(tx_packet.push_login_success_args.public_key_prefix, public_key, sizeof(tx_packet.push_login_success_args.public_key_prefix));
+            mc_companion_write_serial_response(&tx_packet, sizeof(companion_push_login_success_args_t), sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+            break;
+        }
+        case COMPANION_CMD_HAS_CONNECTION: {
+            meshcore_session_t* session = meshcore_session_find(&login_sessions, packet->command_has_connection_args.pub_key, MESHCORE_PUB_KEY_SIZE);
+            printf("Received has connection command, %s\r\n", (session != NULL) ? "logged in" : "not logged in");
+            if (session != NULL) {
+                tx_packet.response = COMPANION_RESPONSE_CODE_OK;
+            } else {
+                tx_packet.response                     = COMPANION_RESPONSE_CODE_ERR;
+                tx_packet.response_err_args.error_code = COMPANION_ERROR_CODE_NOT_FOUND;
+            }
+            mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+            break;
+        }
+        case COMPANION_CMD_LOGOUT:
+            printf("Received logout command\r\n");
+            meshcore_session_logout(&login_sessions, meshcore_session_find(&login_sessions, packet->command_logout_args.pub_key, MESHCORE_PUB_KEY_SIZE));
+            tx_packet.response = COMPANION_RESPONSE_CODE_OK;
+            mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+            break;
         case COMPANION_CMD_SET_FLOOD_SCOPE:
             printf("Received set flood scope command\r\n");
             tx_packet.response = COMPANION_RESPONSE_CODE_OK;
             mc_companion_write_serial_response(&tx_packet, 0, sizeof(tx_buffer), tx_buffer, &tx_length);
             transmit(tx_buffer, tx_length);
             break;
+        case COMPANION_CMD_GET_STATS: {
+            // Older clients send no stats type and get the core stats
+            uint8_t stats_type = (packet->args_length > 0) ? packet->command_get_stats_args.stats_type : COMPANION_STATS_TYPE_CORE;
+            size_t  args_length = FIELD_SIZE(companion_resp_stats_args_t, stats_type);
+            printf("Received get stats command for stats type %u\r\n", stats_type);
+
+            meshcore_stats_totals_t totals;
+            meshcore_stats_snapshot(&node_stats, &totals);
+            uint32_t errors = totals.counters[MESHCORE_STATS_RX_ERRORS] + totals.counters[MESHCORE_STATS_TX_ERRORS];
+
+            tx_packet.response                       = COMPANION_RESPONSE_CODE_STATS;
+            tx_packet.response_stats_args.stats_type = stats_type;
+            switch (stats_type) {
+                case COMPANION_STATS_TYPE_CORE:
+                    tx_packet.response_stats_args.core.battery_mv   = 4200;
+                    tx_packet.response_stats_args.core.uptime_secs  = (now_ms() - start_ms) / 1000;
+                    tx_packet.response_stats_args.core.errors       = (errors > UINT16_MAX) ? UINT16_MAX : (uint16_t)errors;
+                    tx_packet.response_stats_args.core.queue_length = radio_link.queue_count;
+                    args_length                                    += sizeof(companion_resp_stats_core_t);
+                    break;
+                case COMPANION_STATS_TYPE_RADIO:
+                    // There is no radio, the link has no noise or signal strength to report
+                    tx_packet.response_stats_args.radio.noise_floor = -120;
+                    tx_packet.response_stats_args.radio.rx_failures = totals.counters[MESHCORE_STATS_RX_ERRORS];
+                    tx_packet.response_stats_args.radio.tx_air_secs = totals.counters[MESHCORE_STATS_TX_AIRTIME_MS] / 1000;
+                    args_length                                    += sizeof(companion_resp_stats_radio_t);
+                    break;
+                case COMPANION_STATS_TYPE_PACKETS:
+                    tx_packet.response_stats_args.packets.received  = totals.counters[MESHCORE_STATS_RX_PACKETS];
+                    tx_packet.response_stats_args.packets.sent      = totals.counters[MESHCORE_STATS_TX_PACKETS];
+                    tx_packet.response_stats_args.packets.flood_tx  = totals.counters[MESHCORE_STATS_TX_FLOOD];
+                    tx_packet.response_stats_args.packets.direct_tx = totals.counters[MESHCORE_STATS_TX_DIRECT];
+                    tx_packet.response_stats_args.packets.flood_rx  = totals.counters[MESHCORE_STATS_RX_FLOOD];
+                    tx_packet.response_stats_args.packets.direct_rx = totals.counters[MESHCORE_STATS_RX_DIRECT];
+                    args_length                                    += sizeof(companion_resp_stats_packets_t);
+                    break;
+                default:
+                    tx_packet.response                     = COMPANION_RESPONSE_CODE_ERR;
+                    tx_packet.response_err_args.error_code = COMPANION_ERROR_CODE_ILLEGAL_ARG;
+                    args_length                            = 0;
+                    break;
+            }
+            mc_companion_write_serial_response(&tx_packet, args_length, sizeof(tx_buffer), tx_buffer, &tx_length);
+            transmit(tx_buffer, tx_length);
+            break;
+        }
         default:
             printf("Received unhandled command: %u\r\n", packet->command);
             tx_packet.response                     = COMPANION_RESPONSE_CODE_ERR;
@@ -186,35 +824,58 @@ void packet_callback(companion_command_packet_t* packet, mc_companion_command_pa
     }
 }
 
-int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        printf("Usage: %s port baudrate\r\n", argv[0]);
-        return 1;
-    }
-    printf("Meshcore compantion radio protocol server\r\n");
+// Commands from remote apps are handled like the ones from the serial port, their responses go back on the
+// connection they came in on
+static void socket_command(mc_companion_socket_server_t* server, int connection, companion_command_packet_t* command,
+                           mc_companion_command_parser_error_t error, void* context) {
+    current_connection = connection;
+    packet_callback(command, error);
+    current_connection = -1;
+}
 
-    char* port     = argv[1];
-    int   baudrate = atoi(argv[2]);
+static void usage(const char* name) {
+    printf("Usage: %s [-l group:port] [-L loss] [-d latency] [-j jitter] [-r rate] [-M metrics.prom] [-f types] [-p mirrors] [-a address] [-t port] "
+           "[-w port] [-N] [-S name] [port baudrate]\r\n",
+           name);
+    printf("  -l  join a virtual radio link, UDP multicast on loopback (default %s:%u)\r\n", MESHCORE_LINK_UDP_DEFAULT_GROUP,
+           MESHCORE_LINK_UDP_DEFAULT_PORT);
+    printf("  -L  outgoing frame loss in permille\r\n");
+    printf("  -d  outgoing frame latency in ms\r\n");
+    printf("  -j  outgoing frame jitter in ms\r\n");
+    printf("  -r  outgoing bit rate limit in bit/s\r\n");
+    printf("  -M  write node statistics to a Prometheus text file every %u s\r\n", METRICS_INTERVAL_MS / 1000);
+    printf("  -p  open this many pseudo terminals that also receive channel messages\r\n");
+    printf("  -f  mirror only the payload types in this hex mask as RX log pushes (default FFFF)\r\n");
+    printf("  -a  address to accept remote apps on (default 127.0.0.1)\r\n");
+    printf("  -t  accept remote apps on this TCP port\r\n");
+    printf("  -w  accept remote apps on this WebSocket port\r\n");
+    printf("  -N  keep Nagle's algorithm on for remote apps\r\n");
+    printf("  -S  publish heard frames and channel messages to local apps in this shared memory segment, e.g. /meshcore\r\n");
+    printf("  The serial port may be left out when remote or local apps are served\r\n");
+}
 
-    printf("Listening on port %s @ %d baud\r\n", port, baudrate);
+// Open a serial port as a raw line, returns the descriptor or -1
+static int open_serial(const char* port, int* baudrate) {
+    printf("Listening on port %s @ %d baud\r\n", port, *baudrate);
 
-    serial_port = open(port, O_RDWR);
+    int fd = open(port, O_RDWR);
 
     // Check for errors
-    if (serial_port < 0) {
+    if (fd < 0) {
         printf("Failed to open serial port (%i): %s\n", errno, strerror(errno));
-        return 1;
+        return -1;
     }
 
     printf("Opened serial port\r\n");
 
-    tcflush(serial_port, TCIOFLUSH);  // Flush any existing data
+    tcflush(fd, TCIOFLUSH);  // Flush any existing data
 
     struct termios tty;
 
-    if (tcgetattr(serial_port, &tty) != 0) {
+    if (tcgetattr(fd, &tty) != 0) {
         printf("Failed to read attributes (%i): %s\n", errno, strerror(errno));
-        return 1;
+        close(fd);
+        return -1;
     }
 
     // 8 bits per byte, one stop bit, no parity, allow reading, disable modem-specific signals
@@ -228,7 +889,7 @@ int main(int argc, char* argv[]) {
     tty.c_cc[VMIN]  = 1;
 
     // Set baudrate
-    switch (baudrate) {
+    switch (*baudrate) {
         case 4800:
             cfsetospeed(&tty, B4800);
             break;
@@ -245,20 +906,235 @@ int main(int argc, char* argv[]) {
             cfsetospeed(&tty, B115200);
             break;
         default:
-            fprintf(stderr, "warning: baud rate %u is not supported, using 115200.\n", baudrate);
+            fprintf(stderr, "warning: baud rate %u is not supported, using 115200.\n", *baudrate);
             cfsetospeed(&tty, B115200);
+            *baudrate = 115200;
             break;
     }
     cfsetispeed(&tty, cfgetospeed(&tty));
 
     cfmakeraw(&tty);
 
-    if (tcsetattr(serial_port, TCSANOW, &tty) != 0) {
+    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
         printf("Failed to write attributes (%i): %s\n", errno, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    char                       link_group[64] = MESHCORE_LINK_UDP_DEFAULT_GROUP;
+    uint16_t                   link_port      = MESHCORE_LINK_UDP_DEFAULT_PORT;
+    bool                       use_link       = false;
+    meshcore_link_impairment_t impairment     = {0};
+    uint16_t                   rx_log_types   = MC_COMPANION_RX_LOG_ALL_TYPES;
+    int                        mirrors        = 0;
+    const char*                listen_address = "127.0.0.1";
+    uint16_t                   tcp_port       = 0;
+    uint16_t                   websocket_port = 0;
+    bool                       nodelay        = true;
+    const char*                shm_name       = NULL;
+    int                        option;
+
+    while ((option = getopt(argc, argv, "l:L:d:j:r:M:f:p:a:t:w:NS:")) != -1) {
+        switch (option) {
+            case 'l':
+                use_link = true;
+                if (meshcore_link_udp_parse(optarg, link_group, sizeof(link_group), &link_port) < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'L':
+                impairment.loss_permille = (uint16_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                impairment.latency_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'j':
+                impairment.jitter_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                impairment.rate_bps = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'M':
+                metrics_path = optarg;
+                break;
+            case 'f':
+                rx_log_types = (uint16_t)strtoul(optarg, NULL, 16);
+                break;
+            case 'p':
+                mirrors = atoi(optarg);
+                break;
+            case 'a':
+                listen_address = optarg;
+                break;
+            case 't':
+                tcp_port = (uint16_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                websocket_port = (uint16_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'N':
+                nodelay = false;
+                break;
+            case 'S':
+                shm_name = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    bool listening = tcp_port != 0 || websocket_port != 0 || shm_name != NULL;
+    if (optind != argc - 2 && !(optind == argc && listening)) {
+        usage(argv[0]);
+        return 1;
+    }
+    printf("Meshcore compantion radio protocol server\r\n");
+
+    int baudrate = 115200;
+    if (optind < argc) {
+        baudrate    = atoi(argv[optind + 1]);
+        serial_port = open_serial(argv[optind], &baudrate);
+        if (serial_port < 0) {
+            return 1;
+        }
+    }
+
+    mc_companion_socket_init(&sockets, socket_command, NULL);
+    mc_companion_socket_set_nodelay(&sockets, nodelay);
+    if (tcp_port != 0 && mc_companion_socket_listen(&sockets, MC_COMPANION_SOCKET_TCP, listen_address, tcp_port) < 0) {
+        printf("Failed to listen on TCP %s:%u (%i): %s\r\n", listen_address, tcp_port, errno, strerror(errno));
         return 1;
     }
+    if (websocket_port != 0 && mc_companion_socket_listen(&sockets, MC_COMPANION_SOCKET_WEBSOCKET, listen_address, websocket_port) < 0) {
+        printf("Failed to listen on WebSocket %s:%u (%i): %s\r\n", listen_address, websocket_port, errno, strerror(errno));
+        return 1;
+    }
+    if (tcp_port != 0) {
+        printf("Accepting apps on tcp://%s:%u\r\n", listen_address, tcp_port);
+    }
+    if (websocket_port != 0) {
+        printf("Accepting apps on ws://%s:%u\r\n", listen_address, websocket_port);
+    }
+
+    if (shm_name != NULL) {
+        if (mc_companion_shm_create(&shm_ring, shm_name, 0) < 0) {
+            printf("Failed to create shared memory segment %s (%i): %s\r\n", shm_name, errno, strerror(errno));
+            return 1;
+        }
+        printf("Publishing to local apps in shared memory segment %s\r\n", shm_name);
+    }
+
+    meshcore_timer_wheel_init(&timer_wheel, TIMER_TICK_MS, now_ms());
+    meshcore_timer_init(&advert_timer, advert_callback, NULL);
+    meshcore_ack_table_init(&ack_table, &timer_wheel, ack_callback, NULL);
+    meshcore_session_table_init(&login_sessions, &timer_wheel, MESHCORE_SESSION_DEFAULT_TIMEOUT_MS, session_callback, NULL);
+    meshcore_stats_init(&node_stats);
+    node_stats_shard = meshcore_stats_attach(&node_stats);
+    start_ms         = now_ms();
+
+    // A serial byte takes 10 bits on the wire, the log gets its share of what is left over from responses
+    mc_companion_rx_log_config_t rx_log_config = {
+        .type_mask    = rx_log_types,
+        .route_mask   = MC_COMPANION_RX_LOG_ALL_ROUTES,
+        .batch        = 8,
+        .max_delay_ms = 50,
+        .rate_bps     = (uint32_t)baudrate / 10 * RX_LOG_SHARE / 100,
+    };
+    mc_companion_rx_log_init(&rx_log, &rx_log_config, now_ms());
+
+    mc_companion_signer_init(&signer, 0, sign_prehashed, NULL);
+    mc_companion_contact_store_init(&contact_store);
+    for (size_t i = 0; i < sizeof(seed_contacts) / sizeof(companion_contact_t); i++) {
+        mc_companion_contact_store_stage(&contact_store, &seed_contacts[i]);
+    }
+    mc_companion_contact_store_commit(&contact_store);
+    mc_companion_fanout_init(&fanout);
+    if (serial_port >= 0) {
+        mc_companion_fanout_attach(&fanout, fanout_write, (void*)(intptr_t)serial_port, 0);
+    }
+    for (int mirror = 0; mirror < mirrors; mirror++) {
+        if (open_mirror() < 0) {
+            return 1;
+        }
+    }
+    if (metrics_path != NULL) {
+        meshcore_timer_init(&metrics_timer, metrics_callback, NULL);
+        meshcore_timer_start_periodic(&timer_wheel, &metrics_timer, now_ms() + METRICS_INTERVAL_MS, METRICS_INTERVAL_MS);
+    }
+
+    if (use_link) {
+        if (meshcore_link_udp_open(&radio_link, &radio_link_udp, link_group, link_port, (uint32_t)getpid()) < 0) {
+            printf("Failed to open link %s:%u (%i): %s\r\n", link_group, link_port, errno, strerror(errno));
+            return 1;
+        }
+        meshcore_link_set_impairment(&radio_link, &impairment);
+        meshcore_link_set_stats(&radio_link, node_stats_shard);
+        radio_link_open = true;
+        printf("Joined link %s:%u\r\n", link_group, link_port);
+    }
 
     while (1) {
+        // Wake up every tick to run the timers, or sooner when a delayed frame is due on the link
+        uint32_t link_wait = UINT32_MAX;
+        if (radio_link_open) {
+            meshcore_link_poll(&radio_link, now_ms(), &link_wait);
+        }
+
+        // The serial port and the link come first, then the listeners and connections of the remote apps
+        struct pollfd descriptors[2 + MC_COMPANION_SOCKET_MAX_POLLFDS] = {
+            {.fd = serial_port, .events = POLLIN},
+            {.fd = radio_link_open ? radio_link.fd : -1, .events = POLLIN},
+        };
+        int socket_count = mc_companion_socket_pollfds(&sockets, &descriptors[2], MC_COMPANION_SOCKET_MAX_POLLFDS);
+        int ready        = poll(descriptors, (nfds_t)(2 + socket_count), (link_wait < TIMER_TICK_MS) ? (int)link_wait : TIMER_TICK_MS);
+        meshcore_timer_wheel_advance(&timer_wheel, now_ms());
+
+        // Frames heard since the last pass go out together once a batch is due
+        uint8_t rx_log_buffer[2 * MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE];
+        size_t  rx_log_length = 0;
+        if (mc_companion_rx_log_flush(&rx_log, now_ms(), false, sizeof(rx_log_buffer), rx_log_buffer, &rx_log_length) > 0) {
+            transmit(rx_log_buffer, rx_log_length);
+        }
+        mc_companion_fanout_flush_all(&fanout);
+
+        if (ready == 0 || (ready < 0 && errno == EINTR)) {
+            continue;
+        }
+
+        if (descriptors[1].revents & POLLIN) {
+            uint8_t frame[MESHCORE_MAX_TRANS_UNIT];
+            uint8_t frame_size = 0;
+            while (meshcore_link_receive(&radio_link, frame, &frame_size) > 0) {
+                // There is no radio, the link has no noise or signal strength to report
+                mc_companion_rx_log_push(&rx_log, frame, frame_size, 0, 0, now_ms());
+                if (shm_ring.header != NULL) {
+                    shm_publish_rx(frame, frame_size);
+                }
+                meshcore_message_t message;
+                if (meshcore_deserialize(frame, frame_size, &message) < 0) {
+                    radio_link.stats.malformed++;
+                    meshcore_stats_add(node_stats_shard, MESHCORE_STATS_RX_ERRORS, 1);
+                    continue;
+                }
+                link_receive(&message);
+            }
+            // Local apps are woken once for everything heard in this pass
+            mc_companion_shm_notify(&shm_ring);
+        }
+
+        // Everything the remote apps are answered in this pass leaves in one write per connection
+        mc_companion_socket_process(&sockets, &descriptors[2], socket_count);
+        mc_companion_socket_flush(&sockets);
+
+        if ((descriptors[0].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+            continue;
+        }
+
         uint8_t read_buffer[MESHCORE_COMPANION_MAX_FRAME_SIZE] = {0};
         int     num_read                                       = read(serial_port, &read_buffer, sizeof(read_buffer));
         if (num_read < 1) {
@@ -268,4 +1144,30 @@ int main(int argc, char* argv[]) {
 
         mc_companion_read_serial_command(read_buffer, num_read, packet_callback);
     }
+
+    printf("RX log: %" PRIu32 " pushed in %" PRIu32 " writes, %" PRIu32 " filtered, %" PRIu32 " dropped, %" PRIu32 " truncated\r\n",
+           rx_log.counters.pushed, rx_log.counters.flushes, rx_log.counters.filtered, rx_log.counters.dropped, rx_log.counters.truncated);
+    for (int id = 0; id < MC_COMPANION_FANOUT_MAX_CLIENTS; id++) {
+        if (fanout.clients[id].attached) {
+            printf("Client %i: %" PRIu32 " delivered, %" PRIu32 " dropped\r\n", id, fanout.clients[id].delivered, fanout.clients[id].dropped);
+        }
+    }
+    printf("Remote apps: %" PRIu32 " accepted, %" PRIu32 " refused, %" PRIu32 " overflows, %" PRIu32 " errors, %" PRIu64 " bytes in %" PRIu64
+           " writes\r\n",
+           sockets.counters.accepted, sockets.counters.refused, sockets.counters.overflows, sockets.counters.errors, sockets.counters.sent,
+           sockets.counters.writes);
+    printf("Sessions: %" PRIu32 " active, %" PRIu32 " logins, %" PRIu32 " expired, %" PRIu32 " evicted\r\n", login_sessions.active,
+           login_sessions.stats.logins, login_sessions.stats.expired, login_sessions.stats.evicted);
+    mc_companion_socket_shutdown(&sockets);
+    if (shm_ring.header != NULL) {
+        printf("Local apps: %" PRIu64 " frames published, %" PRIu64 " overwritten\r\n", shm_ring.published, shm_ring.evicted);
+        mc_companion_shm_close(&shm_ring);
+    }
+
+#if MESHCORE_LATENCY_ENABLE
+    char latency_table[1024];
+    if (meshcore_latency_format(latency_table, sizeof(latency_table)) > 0) {
+        printf("Latency in ns:\r\n%s", latency_table);
+    }
+#endif
 }
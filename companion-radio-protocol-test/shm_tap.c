@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+// Reads what a companion server started with -S publishes in shared memory, as a local app would. Prints
+// every frame with -v, otherwise the frames per second read, by code, and the frames lost to overruns. A
+// reader that is slower than the server loses frames but never slows the server down.
+
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_companion.h"
+#include "mc_companion_shm.h"
+
+// Definitions
+
+#define TAP_REPORT_MS 1000
+
+static volatile sig_atomic_t tap_stop = 0;
+
+// Functions
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void tap_signal(int signal) {
+    tap_stop = 1;
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-v] [-n frames] name\r\n", name);
+    printf("  -v  print every frame\r\n");
+    printf("  -n  exit after reading this many frames\r\n");
+    printf("  name is the shared memory segment the server publishes to, e.g. /meshcore\r\n");
+}
+
+static void print_frame(const uint8_t* frame, size_t length) {
+    printf("code %02X, %zu bytes:", frame[3], length - 4);
+    for (size_t i = 4; i < length && i < 36; i++) {
+        printf(" %02X", frame[i]);
+    }
+    printf("%s\r\n", (length > 36) ? " ..." : "");
+}
+
+int main(int argc, char* argv[]) {
+    bool     verbose = false;
+    uint64_t limit   = 0;
+    int      option;
+
+    while ((option = getopt(argc, argv, "vn:")) != -1) {
+        switch (option) {
+            case 'v':
+                verbose = true;
+                break;
+            case 'n':
+                limit = strtoull(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    mc_companion_shm_reader_t reader;
+    if (mc_companion_shm_reader_open(&reader, argv[optind]) < 0) {
+        printf("Failed to open shared memory segment %s (%i): %s\r\n", argv[optind], errno, strerror(errno));
+        return 1;
+    }
+    printf("Reading %s, a ring of %" PRIu32 " bytes\r\n", argv[optind], reader.capacity);
+    signal(SIGINT, tap_signal);
+    signal(SIGTERM, tap_signal);
+
+    uint64_t codes[256]    = {0};
+    uint64_t report_ms     = monotonic_ms() + TAP_REPORT_MS;
+    uint64_t reported      = 0;
+    uint64_t reported_lost = 0;
+    uint64_t invalid       = 0;
+    while (!tap_stop && (limit == 0 || reader.received < limit)) {
+        const uint8_t* frame;
+        size_t         length;
+        while ((limit == 0 || reader.received < limit) && mc_companion_shm_peek(&reader, &frame, &length) > 0) {
+            bool    valid = length >= 4 && frame[0] == '>';
+            uint8_t code  = valid ? frame[3] : 0;
+            if (verbose && valid) {
+                // Printed before the check, a line may show a frame that turns out to be overwritten
+                print_frame(frame, length);
+            }
+            if (mc_companion_shm_consume(&reader) < 0) {
+                continue;
+            }
+            if (!valid) {
+                invalid++;
+                continue;
+            }
+            codes[code]++;
+        }
+
+        uint64_t now = monotonic_ms();
+        if (now >= report_ms) {
+            if (!verbose && (reader.received != reported || reader.lost != reported_lost)) {
+                printf("%" PRIu64 " frames/s, %" PRIu64 " lost\r\n", reader.received - reported, reader.lost - reported_lost);
+            }
+            reported      = reader.received;
+            reported_lost = reader.lost;
+            report_ms     = now + TAP_REPORT_MS;
+        }
+        mc_companion_shm_wait(&reader, (int)(report_ms - now));
+    }
+
+    printf("%" PRIu64 " frames read, %" PRIu64 " lost, %" PRIu64 " invalid\r\n", reader.received, reader.lost, invalid);
+    for (int code = 0; code < 256; code++) {
+        if (codes[code] > 0) {
+            printf("  code %02X: %" PRIu64 "\r\n", code, codes[code]);
+        }
+    }
+    mc_companion_shm_reader_close(&reader);
+    return 0;
+}
@@ -8,10 +8,19 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#define MESHCORE_COMPANION_MAX_FRAME_SIZE   172
+#define MESHCORE_COMPANION_MAX_FRAME_SIZE   172  // Every link carries frames of this size, larger ones are negotiated with CMD_DEVICE_QUERY
 #define MESHCORE_COMPANION_MAX_PAYLOAD_SIZE (MESHCORE_COMPANION_MAX_FRAME_SIZE - sizeof(uint8_t) - sizeof(uint16_t))  // Frame size minus start byte and length
 #define MESHCORE_COMPANION_PUBLIC_KEY_SIZE  32
 
+// Largest frame this side accepts once negotiated, frames above MESHCORE_COMPANION_MAX_FRAME_SIZE carry a
+// batch of commands or responses, see mc_companion_batch.h
+#ifndef MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE
+#define MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE 1024
+#endif
+
+_Static_assert(MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE >= MESHCORE_COMPANION_MAX_FRAME_SIZE && MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE <= UINT16_MAX,
+               "MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE out of range");
+
 typedef enum {
     COMPANION_CMD_APP_START               = 1,
     COMPANION_CMD_SEND_TXT_MSG            = 2,
@@ -63,6 +72,9 @@ typedef enum {
     COMPANION_CMD_SET_FLOOD_SCOPE         = 54,  // v8+
     COMPANION_CMD_SEND_CONTROL_DATA       = 55,  // v8+
     COMPANION_CMD_GET_STATS               = 56,  // v8+, second byte is stats type
+    COMPANION_CMD_IMPORT_BUNDLE           = 57,  // Contact bundle chunk, see mc_companion_bundle.h
+    COMPANION_CMD_EXPORT_BUNDLE           = 58,  // with optional 'since', like CMD_GET_CONTACTS
+    COMPANION_CMD_BATCH                   = 59,  // Several commands in one negotiated frame, see mc_companion_batch.h
 } companion_command_t;
 
 // For COMPANION_CMD_GET_STATS
@@ -98,6 +110,9 @@ typedef enum {
     COMPANION_RESPONSE_CODE_ADVERT_PATH         = 22,
     COMPANION_RESPONSE_CODE_TUNING_PARAMS       = 23,
     COMPANION_RESPONSE_CODE_STATS               = 24,  // v8+, second byte is stats type
+    COMPANION_RESPONSE_CODE_BUNDLE_ACK          = 25,  // a reply to CMD_IMPORT_BUNDLE
+    COMPANION_RESPONSE_CODE_BUNDLE_DATA         = 26,  // multiple of these (after CMD_EXPORT_BUNDLE), followed by OK
+    COMPANION_RESPONSE_CODE_BATCH               = 27,  // Several responses and pushes in one negotiated frame
     COMPANION_PUSH_CODE_ADVERT                  = 0x80,
     COMPANION_PUSH_CODE_PATH_UPDATED            = 0x81,
     COMPANION_PUSH_CODE_SEND_CONFIRMED          = 0x82,
@@ -224,7 +239,8 @@ typedef struct {
 } __attribute__((packed)) companion_cmd_set_tuning_params_args_t;
 
 typedef struct {
-    uint8_t app_target_version;
+    uint8_t  app_target_version;
+    uint16_t max_frame_size;  // Optional, largest frame the app accepts
 } __attribute__((packed)) companion_cmd_device_query_args_t;
 
 typedef struct {
@@ -325,6 +341,19 @@ typedef struct {
     uint8_t data[MESHCORE_COMPANION_MAX_PAYLOAD_SIZE];
 } __attribute__((packed)) companion_cmd_send_control_data_args_t;
 
+typedef struct {
+    uint8_t stats_type;  // companion_stats_t
+} __attribute__((packed)) companion_cmd_get_stats_args_t;
+
+typedef struct {
+    uint16_t sequence;  // Chunk number, 0 starts a new bundle
+    uint8_t  data[MESHCORE_COMPANION_MAX_PAYLOAD_SIZE - sizeof(uint8_t) - sizeof(uint16_t)];
+} __attribute__((packed)) companion_cmd_import_bundle_args_t;
+
+typedef struct {
+    uint32_t since;
+} __attribute__((packed)) companion_cmd_export_bundle_args_t;
+
 // Response argument structures
 
 typedef struct {
@@ -399,13 +428,14 @@ typedef struct {
 } __attribute__((packed)) companion_resp_batt_and_storage_args_t;
 
 typedef struct {
-    uint8_t firmware_version_code;
-    uint8_t max_contacts;  // Divide by 2
-    uint8_t max_group_channels;
-    uint8_t ble_pin[4];
-    char    firmware_build_date[12];
-    char    board_manufacturer_name[40];
-    char    firmware_version[20];
+    uint8_t  firmware_version_code;
+    uint8_t  max_contacts;  // Divide by 2
+    uint8_t  max_group_channels;
+    uint8_t  ble_pin[4];
+    char     firmware_build_date[12];
+    char     board_manufacturer_name[40];
+    char     firmware_version[20];
+    uint16_t max_frame_size;  // Optional, frame size both sides use from now on
 } __attribute__((packed)) companion_resp_device_info_args_t;
 
 typedef struct {
@@ -468,6 +498,25 @@ typedef struct {
     };
 } __attribute__((packed)) companion_resp_stats_args_t;
 
+// For COMPANION_RESPONSE_CODE_BUNDLE_ACK
+typedef enum {
+    COMPANION_BUNDLE_STATUS_IN_PROGRESS = 0,  // Chunk taken, send the next one
+    COMPANION_BUNDLE_STATUS_APPLIED     = 1,  // Bundle complete and applied to the contacts
+    COMPANION_BUNDLE_STATUS_RESEND      = 2,  // Chunk out of order, resend from the sequence in the reply
+    COMPANION_BUNDLE_STATUS_REJECTED    = 3,  // Bundle malformed or too large, none of it was applied
+} companion_bundle_status_t;
+
+typedef struct {
+    uint16_t sequence;  // Next chunk expected
+    uint8_t  status;    // companion_bundle_status_t
+    uint32_t contacts;  // Contacts taken from the bundle so far
+} __attribute__((packed)) companion_resp_bundle_ack_args_t;
+
+typedef struct {
+    uint16_t sequence;
+    uint8_t  data[MESHCORE_COMPANION_MAX_PAYLOAD_SIZE - sizeof(uint8_t) - sizeof(uint16_t)];
+} __attribute__((packed)) companion_resp_bundle_data_args_t;
+
 // Push message arguments
 
 typedef struct {
@@ -514,13 +563,14 @@ typedef struct {
     uint8_t  flags;
     uint32_t tag;
     uint32_t authentication_code;
-    uint8_t  data[MESHCORE_COMPANION_MAX_PAYLOAD_SIZE - sizeof(uint8_t) * 2 - sizeof(uint32_t) * 2];  // tbd
+    uint8_t  data[MESHCORE_COMPANION_MAX_PAYLOAD_SIZE - sizeof(uint8_t) * 2 - sizeof(uint32_t) * 2];  // Hop hashes, hop SNRs, final SNR
 } __attribute__((packed)) companion_push_trace_data_args_t;
 
 // Packet structure
 
 typedef struct {
     companion_command_t command;
+    uint16_t            args_length;
     union {
         uint8_t                                      args[0];
         companion_cmd_app_start_args_t               command_app_start_args;
@@ -562,6 +612,9 @@ typedef struct {
         companion_cmd_send_path_discovery_req_args_t command_send_path_discovery_req_args;
         companion_cmd_flood_scope_args_t             command_flood_scope_args;
         companion_cmd_send_control_data_args_t       command_send_control_data_args;
+        companion_cmd_get_stats_args_t               command_get_stats_args;
+        companion_cmd_import_bundle_args_t           command_import_bundle_args;
+        companion_cmd_export_bundle_args_t           command_export_bundle_args;
     };
 } companion_command_packet_t;
 
@@ -588,6 +641,8 @@ typedef struct {
         companion_resp_signature_args_t        response_signature_args;
         companion_resp_custom_vars_args_t      response_custom_vars_args;
         companion_resp_stats_args_t            response_stats_args;
+        companion_resp_bundle_ack_args_t       response_bundle_ack_args;
+        companion_resp_bundle_data_args_t      response_bundle_data_args;
         companion_push_advertisement_args_t    push_advertisement_args;
         companion_push_path_update_args_t      push_path_update_args;
         companion_push_ack_args_t              push_ack_args;
@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "mc_companion_batch.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "mc_companion.h"
+
+// Start byte, length and the BATCH code in front of the records of a batch frame
+#define BATCH_FRAME_HEADER 4
+
+static void batch_init(mc_companion_batch_t* batch, uint8_t start, uint8_t code, uint16_t frame_size, size_t output_buffer_size, uint8_t* out_framed_data) {
+    memset(batch, 0, sizeof(mc_companion_batch_t));
+    batch->start      = start;
+    batch->code       = code;
+    batch->frame_size = (frame_size < MESHCORE_COMPANION_MAX_FRAME_SIZE) ? MESHCORE_COMPANION_MAX_FRAME_SIZE : frame_size;
+    batch->size       = output_buffer_size;
+    batch->out        = out_framed_data;
+}
+
+static void batch_write_length(uint8_t* out, size_t length) {
+    out[0] = (length >> 0) & 0xFF;
+    out[1] = (length >> 8) & 0xFF;
+}
+
+void mc_companion_batch_init_responses(mc_companion_batch_t* batch, uint16_t frame_size, size_t output_buffer_size, uint8_t* out_framed_data) {
+    batch_init(batch, '>', COMPANION_RESPONSE_CODE_BATCH, frame_size, output_buffer_size, out_framed_data);
+}
+
+void mc_companion_batch_init_commands(mc_companion_batch_t* batch, uint16_t frame_size, size_t output_buffer_size, uint8_t* out_framed_data) {
+    batch_init(batch, '<', COMPANION_CMD_BATCH, frame_size, output_buffer_size, out_framed_data);
+}
+
+int mc_companion_batch_add(mc_companion_batch_t* batch, uint8_t code, const uint8_t* args, uint16_t args_length) {
+    size_t record = MC_COMPANION_BATCH_RECORD_OVERHEAD + 1 + (size_t)args_length;
+    if (1 + record > MESHCORE_COMPANION_MAX_FRAME_SIZE) {
+        return -1;
+    }
+
+    // A second record turns the open plain frame into a batch frame, its record moves behind the batch header
+    size_t grown = (batch->records == 1) ? BATCH_FRAME_HEADER - 1 : 0;
+    if (batch->records == 0 || batch->length - batch->frame + grown + record > batch->frame_size) {
+        if (1 + record > batch->size - batch->length) {
+            return -1;
+        }
+        batch->frame   = batch->length;
+        batch->records = 0;
+        grown          = 0;
+        batch->frames++;
+    } else if (grown + record > batch->size - batch->length) {
+        return -1;
+    }
+
+    uint8_t* frame = &batch->out[batch->frame];
+    if (grown > 0) {
+        memmove(&frame[BATCH_FRAME_HEADER], &frame[1], batch->length - batch->frame - 1);
+        frame[3]       = batch->code;
+        batch->length += grown;
+    }
+    uint8_t* out = &batch->out[batch->length];
+    if (batch->records == 0) {
+        *out++ = batch->start;
+    }
+    batch_write_length(out, 1 + (size_t)args_length);
+    out[MC_COMPANION_BATCH_RECORD_OVERHEAD] = code;
+    memcpy(&out[MC_COMPANION_BATCH_RECORD_OVERHEAD + 1], args, args_length);
+    batch->length += (batch->records == 0) ? 1 + record : record;
+    batch->records++;
+
+    // The frame length covers everything after the start byte and its own two bytes
+    if (batch->records > 1) {
+        frame[0] = batch->start;
+        batch_write_length(&frame[1], batch->length - batch->frame - 3);
+    }
+    return 0;
+}
+
+size_t mc_companion_batch_length(const mc_companion_batch_t* batch) {
+    return batch->length;
+}
+
+int mc_companion_batch_split(const uint8_t* data, size_t length, mc_companion_batch_record_callback callback, void* context) {
+    int    records  = 0;
+    size_t position = 0;
+    while (position < length) {
+        if (length - position < MC_COMPANION_BATCH_RECORD_OVERHEAD) {
+            return -1;
+        }
+        size_t record = data[position] | (data[position + 1] << 8);
+        position     += MC_COMPANION_BATCH_RECORD_OVERHEAD;
+        if (record < 1 || record > MESHCORE_COMPANION_MAX_PAYLOAD_SIZE || record > length - position) {
+            return -1;
+        }
+        callback(&data[position], (uint16_t)record, context);
+        position += record;
+        records++;
+    }
+    return records;
+}
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mc_companion.h"
+
+// Frames larger than MESHCORE_COMPANION_MAX_FRAME_SIZE are negotiated with DEVICE_QUERY, see mc_companion.h.
+// A large frame carries a batch: the BATCH command or response code followed by records that are framed
+// like a frame without its start byte, a little endian length and then the code and its arguments. A record
+// is never longer than a frame of MESHCORE_COMPANION_MAX_FRAME_SIZE, so every command and response keeps
+// its layout and only the number of them per frame grows.
+//
+// The writer packs records into frames of the negotiated size. A frame that ends up holding one record is
+// written as a plain frame, so with the base frame size the output is exactly what a peer that does not
+// know about batches expects.
+
+// Definitions
+
+// Length field in front of every record
+#define MC_COMPANION_BATCH_RECORD_OVERHEAD 2
+
+typedef struct {
+    uint8_t  start;       // '<' for commands, '>' for responses
+    uint8_t  code;        // COMPANION_CMD_BATCH or COMPANION_RESPONSE_CODE_BATCH
+    uint16_t frame_size;  // Largest frame to write
+    uint16_t records;     // Records in the open frame
+    uint32_t frames;      // Frames started
+    size_t   frame;       // Offset of the open frame
+    size_t   length;      // Bytes written so far, the open frame included
+    size_t   size;
+    uint8_t* out;
+} mc_companion_batch_t;
+
+/// Called for every record of a batch, the record starts at its code and record_length includes the code
+typedef void (*mc_companion_batch_record_callback)(const uint8_t* record, uint16_t record_length, void* context);
+
+// Functions
+
+/// Start packing response and push frames into a buffer
+void mc_companion_batch_init_responses(mc_companion_batch_t* batch, uint16_t frame_size, size_t output_buffer_size, uint8_t* out_framed_data);
+
+/// Start packing command frames into a buffer
+void mc_companion_batch_init_commands(mc_companion_batch_t* batch, uint16_t frame_size, size_t output_buffer_size, uint8_t* out_framed_data);
+
+/// Add a record to the open frame, or to a new frame when it does not fit. Returns -1 when the record is
+/// longer than a base frame or when the buffer is full, the buffer then holds the records added before.
+int mc_companion_batch_add(mc_companion_batch_t* batch, uint8_t code, const uint8_t* args, uint16_t args_length);
+
+/// Number of framed bytes written, every frame in the buffer is complete
+size_t mc_companion_batch_length(const mc_companion_batch_t* batch);
+
+/// Walk the records in the arguments of a BATCH frame. Returns the number of records or -1 when a record is
+/// empty, longer than a base frame or cut off, the records before it have been passed to the callback.
+int mc_companion_batch_split(const uint8_t* data, size_t length, mc_companion_batch_record_callback callback, void* context);
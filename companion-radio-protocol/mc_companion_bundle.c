@@ -0,0 +1,450 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "mc_companion_bundle.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "crypto/sha256.h"
+
+// Contact record flags
+#define BUNDLE_TYPE     0x01  // Type differs from the previous contact, the type follows
+#define BUNDLE_FLAGS    0x02  // Flags differ from the previous contact, the flags follow
+#define BUNDLE_PATH_REF 0x04  // Path is a dictionary index, otherwise its length and the path follow
+#define BUNDLE_NAME_REF 0x08  // Name is a dictionary index, otherwise the shared prefix length, suffix length and suffix follow
+#define BUNDLE_POSITION 0x10  // Position differs from the previous contact, latitude and longitude deltas follow
+#define BUNDLE_MODIFIED 0x20  // Last modified differs from the last advert, the delta follows
+
+#define BUNDLE_MAGIC "MCB"
+
+static size_t bundle_put_varint(uint8_t* out, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++]   = (uint8_t)(value | 0x80);
+        value         >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+static bool bundle_get_varint(const uint8_t* record, size_t length, size_t* position, uint32_t* out_value) {
+    uint32_t value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (*position >= length) {
+            return false;
+        }
+        uint8_t byte  = record[(*position)++];
+        value        |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *out_value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t bundle_zigzag(uint32_t delta) {
+    return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+}
+
+static uint32_t bundle_unzigzag(uint32_t value) {
+    return (value >> 1) ^ (uint32_t)-(int32_t)(value & 1);
+}
+
+static size_t bundle_name_length(const char name[32]) {
+    const char* end = memchr(name, '\0', 32);
+    return (end != NULL) ? (size_t)(end - name) : 32;
+}
+
+// Clear the bytes after the name and the path, so that both ends compare and remember the same bytes
+static bool bundle_normalize(const companion_contact_t* contact, companion_contact_t* out_contact) {
+    if (contact->out_path_len < -1 || contact->out_path_len > (int8_t)sizeof(contact->out_path)) {
+        return false;
+    }
+    *out_contact = *contact;
+    size_t name_length = bundle_name_length(contact->name);
+    memset(&out_contact->name[name_length], 0, sizeof(out_contact->name) - name_length);
+    size_t path_length = (contact->out_path_len > 0) ? (size_t)contact->out_path_len : 0;
+    memset(&out_contact->out_path[path_length], 0, sizeof(out_contact->out_path) - path_length);
+    return true;
+}
+
+static int bundle_find_name(const mc_companion_bundle_dictionary_t* dictionary, const char name[32]) {
+    for (uint16_t index = 0; index < dictionary->name_count; index++) {
+        if (memcmp(dictionary->names[index], name, 32) == 0) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+static int bundle_find_path(const mc_companion_bundle_dictionary_t* dictionary, const companion_contact_t* contact) {
+    if (contact->out_path_len <= 0) {
+        return -1;
+    }
+    for (uint16_t index = 0; index < dictionary->path_count; index++) {
+        if (dictionary->path_lengths[index] == contact->out_path_len &&
+            memcmp(dictionary->paths[index], contact->out_path, (size_t)contact->out_path_len) == 0) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+// Bring the dictionaries up to date after a contact, the encoder and the decoder do this in the same way
+static void bundle_remember(mc_companion_bundle_dictionary_t* dictionary, const companion_contact_t* contact, bool name_literal, bool path_literal) {
+    if (name_literal) {
+        memcpy(dictionary->names[dictionary->name_next], contact->name, 32);
+        dictionary->name_next = (uint16_t)((dictionary->name_next + 1) % MC_COMPANION_BUNDLE_DICTIONARY_SIZE);
+        if (dictionary->name_count < MC_COMPANION_BUNDLE_DICTIONARY_SIZE) {
+            dictionary->name_count++;
+        }
+    }
+    if (path_literal && contact->out_path_len > 0) {
+        dictionary->path_lengths[dictionary->path_next] = contact->out_path_len;
+        memcpy(dictionary->paths[dictionary->path_next], contact->out_path, sizeof(contact->out_path));
+        dictionary->path_next = (uint16_t)((dictionary->path_next + 1) % MC_COMPANION_BUNDLE_DICTIONARY_SIZE);
+        if (dictionary->path_count < MC_COMPANION_BUNDLE_DICTIONARY_SIZE) {
+            dictionary->path_count++;
+        }
+    }
+    dictionary->previous = *contact;
+}
+
+// Prefix a record with its length and copy it out
+static int bundle_put_record(const uint8_t* record, size_t length, uint8_t* out, size_t size) {
+    uint8_t prefix[5];
+    size_t  prefix_length = bundle_put_varint(prefix, (uint32_t)length);
+    if (prefix_length + length > size) {
+        return -1;
+    }
+    memcpy(out, prefix, prefix_length);
+    memcpy(&out[prefix_length], record, length);
+    return (int)(prefix_length + length);
+}
+
+void mc_companion_bundle_encoder_init(mc_companion_bundle_encoder_t* encoder) {
+    memset(encoder, 0, sizeof(mc_companion_bundle_encoder_t));
+    Sha256Initialise(&encoder->hash);
+}
+
+int mc_companion_bundle_encode_header(mc_companion_bundle_encoder_t* encoder, uint32_t count, uint8_t* out, size_t size) {
+    if (size < MC_COMPANION_BUNDLE_HEADER_SIZE) {
+        return -1;
+    }
+    memcpy(out, BUNDLE_MAGIC, 3);
+    out[3] = MC_COMPANION_BUNDLE_VERSION;
+    memcpy(&out[4], &count, sizeof(count));
+    Sha256Update(&encoder->hash, out, MC_COMPANION_BUNDLE_HEADER_SIZE);
+    return MC_COMPANION_BUNDLE_HEADER_SIZE;
+}
+
+int mc_companion_bundle_encode_contact(mc_companion_bundle_encoder_t* encoder, const companion_contact_t* contact, uint8_t* out, size_t size) {
+    mc_companion_bundle_dictionary_t* dictionary = &encoder->dictionary;
+    const companion_contact_t*        previous   = &dictionary->previous;
+    companion_contact_t               current;
+    if (!bundle_normalize(contact, &current)) {
+        return -1;
+    }
+
+    uint8_t record[MC_COMPANION_BUNDLE_MAX_RECORD];
+    uint8_t flags  = 0;
+    size_t  length = 2;  // Record type and flags
+    record[0]      = MC_COMPANION_BUNDLE_RECORD_CONTACT;
+    memcpy(&record[length], current.public_key, sizeof(current.public_key));
+    length += sizeof(current.public_key);
+
+    if (current.type != previous->type) {
+        flags            |= BUNDLE_TYPE;
+        record[length++]  = current.type;
+    }
+    if (current.flags != previous->flags) {
+        flags            |= BUNDLE_FLAGS;
+        record[length++]  = current.flags;
+    }
+
+    int path = bundle_find_path(dictionary, &current);
+    if (path >= 0) {
+        flags            |= BUNDLE_PATH_REF;
+        record[length++]  = (uint8_t)path;
+    } else {
+        record[length++] = (uint8_t)current.out_path_len;
+        if (current.out_path_len > 0) {
+            memcpy(&record[length], current.out_path, (size_t)current.out_path_len);
+            length += (size_t)current.out_path_len;
+        }
+    }
+
+    int name = bundle_find_name(dictionary, current.name);
+    if (name >= 0) {
+        flags            |= BUNDLE_NAME_REF;
+        record[length++]  = (uint8_t)name;
+    } else {
+        size_t name_length     = bundle_name_length(current.name);
+        size_t previous_length = bundle_name_length(previous->name);
+        size_t shared          = 0;
+        while (shared < name_length && shared < previous_length && current.name[shared] == previous->name[shared]) {
+            shared++;
+        }
+        record[length++] = (uint8_t)shared;
+        record[length++] = (uint8_t)(name_length - shared);
+        memcpy(&record[length], &current.name[shared], name_length - shared);
+        length += name_length - shared;
+    }
+
+    length += bundle_put_varint(&record[length], bundle_zigzag(current.last_advert_timestamp - previous->last_advert_timestamp));
+    if (current.gps_latitude != previous->gps_latitude || current.gps_longitude != previous->gps_longitude) {
+        flags  |= BUNDLE_POSITION;
+        length += bundle_put_varint(&record[length], bundle_zigzag((uint32_t)current.gps_latitude - (uint32_t)previous->gps_latitude));
+        length += bundle_put_varint(&record[length], bundle_zigzag((uint32_t)current.gps_longitude - (uint32_t)previous->gps_longitude));
+    }
+    if (current.last_modified != current.last_advert_timestamp) {
+        flags  |= BUNDLE_MODIFIED;
+        length += bundle_put_varint(&record[length], bundle_zigzag(current.last_modified - current.last_advert_timestamp));
+    }
+    record[1] = flags;
+
+    int written = bundle_put_record(record, length, out, size);
+    if (written < 0) {
+        return -1;
+    }
+    Sha256Update(&encoder->hash, record, (uint32_t)length);
+    bundle_remember(dictionary, &current, name < 0, path < 0);
+    encoder->count++;
+    return written;
+}
+
+int mc_companion_bundle_encode_end(mc_companion_bundle_encoder_t* encoder, uint8_t* out, size_t size) {
+    uint8_t record[1 + 5 + MC_COMPANION_BUNDLE_CHECK_SIZE];
+    size_t  length = 0;
+    record[length++] = MC_COMPANION_BUNDLE_RECORD_END;
+    length += bundle_put_varint(&record[length], encoder->count);
+
+    // The hash is finished on a copy, a failed write can be retried
+    Sha256Context hash = encoder->hash;
+    SHA256_HASH   digest;
+    Sha256Finalise(&hash, &digest);
+    memcpy(&record[length], digest.bytes, MC_COMPANION_BUNDLE_CHECK_SIZE);
+    length += MC_COMPANION_BUNDLE_CHECK_SIZE;
+    return bundle_put_record(record, length, out, size);
+}
+
+void mc_companion_bundle_decoder_init(mc_companion_bundle_decoder_t* decoder, mc_companion_bundle_contact_callback contact, void* context) {
+    memset(decoder, 0, sizeof(mc_companion_bundle_decoder_t));
+    decoder->contact = contact;
+    decoder->context = context;
+    decoder->status  = MC_COMPANION_BUNDLE_IN_PROGRESS;
+    Sha256Initialise(&decoder->hash);
+}
+
+static bool bundle_decode_header(mc_companion_bundle_decoder_t* decoder) {
+    if (memcmp(decoder->record, BUNDLE_MAGIC, 3) != 0 || decoder->record[3] != MC_COMPANION_BUNDLE_VERSION) {
+        return false;
+    }
+    memcpy(&decoder->expected, &decoder->record[4], sizeof(decoder->expected));
+    Sha256Update(&decoder->hash, decoder->record, MC_COMPANION_BUNDLE_HEADER_SIZE);
+    return true;
+}
+
+static bool bundle_decode_contact(mc_companion_bundle_decoder_t* decoder, const uint8_t* record, size_t length) {
+    mc_companion_bundle_dictionary_t* dictionary = &decoder->dictionary;
+    const companion_contact_t*        previous   = &dictionary->previous;
+    companion_contact_t               current    = {0};
+    size_t                            position   = 2;
+    uint32_t                          value;
+    if (length < position + sizeof(current.public_key)) {
+        return false;
+    }
+    uint8_t flags = record[1];
+    memcpy(current.public_key, &record[position], sizeof(current.public_key));
+    position += sizeof(current.public_key);
+
+    // Fields that follow are read against this bound, a record that ends early is rejected
+    current.type  = previous->type;
+    current.flags = previous->flags;
+    if (flags & BUNDLE_TYPE) {
+        if (position >= length) {
+            return false;
+        }
+        current.type = record[position++];
+    }
+    if (flags & BUNDLE_FLAGS) {
+        if (position >= length) {
+            return false;
+        }
+        current.flags = record[position++];
+    }
+
+    if (position >= length) {
+        return false;
+    }
+    if (flags & BUNDLE_PATH_REF) {
+        uint8_t index = record[position++];
+        if (index >= dictionary->path_count) {
+            return false;
+        }
+        current.out_path_len = dictionary->path_lengths[index];
+        memcpy(current.out_path, dictionary->paths[index], sizeof(current.out_path));
+    } else {
+        current.out_path_len = (int8_t)record[position++];
+        if (current.out_path_len < -1 || current.out_path_len > (int8_t)sizeof(current.out_path)) {
+            return false;
+        }
+        if (current.out_path_len > 0) {
+            if (length - position < (size_t)current.out_path_len) {
+                return false;
+            }
+            memcpy(current.out_path, &record[position], (size_t)current.out_path_len);
+            position += (size_t)current.out_path_len;
+        }
+    }
+
+    if (position >= length) {
+        return false;
+    }
+    if (flags & BUNDLE_NAME_REF) {
+        uint8_t index = record[position++];
+        if (index >= dictionary->name_count) {
+            return false;
+        }
+        memcpy(current.name, dictionary->names[index], sizeof(current.name));
+    } else {
+        if (length - position < 2) {
+            return false;
+        }
+        size_t shared = record[position++];
+        size_t suffix = record[position++];
+        if (shared > bundle_name_length(previous->name) || shared + suffix > sizeof(current.name) || length - position < suffix) {
+            return false;
+        }
+        memcpy(current.name, previous->name, shared);
+        memcpy(&current.name[shared], &record[position], suffix);
+        position += suffix;
+        // A name that stops early at a NUL byte would not compare the same on both ends
+        if (bundle_name_length(current.name) != shared + suffix) {
+            return false;
+        }
+    }
+
+    if (!bundle_get_varint(record, length, &position, &value)) {
+        return false;
+    }
+    current.last_advert_timestamp = previous->last_advert_timestamp + bundle_unzigzag(value);
+    current.gps_latitude          = previous->gps_latitude;
+    current.gps_longitude         = previous->gps_longitude;
+    if (flags & BUNDLE_POSITION) {
+        if (!bundle_get_varint(record, length, &position, &value)) {
+            return false;
+        }
+        current.gps_latitude = (int32_t)((uint32_t)previous->gps_latitude + bundle_unzigzag(value));
+        if (!bundle_get_varint(record, length, &position, &value)) {
+            return false;
+        }
+        current.gps_longitude = (int32_t)((uint32_t)previous->gps_longitude + bundle_unzigzag(value));
+    }
+    current.last_modified = current.last_advert_timestamp;
+    if (flags & BUNDLE_MODIFIED) {
+        if (!bundle_get_varint(record, length, &position, &value)) {
+            return false;
+        }
+        current.last_modified = current.last_advert_timestamp + bundle_unzigzag(value);
+    }
+    // Bytes after the known fields belong to later versions of the record and are skipped
+
+    if (decoder->contact != NULL && !decoder->contact(&current, decoder->context)) {
+        return false;
+    }
+    bundle_remember(dictionary, &current, (flags & BUNDLE_NAME_REF) == 0, (flags & BUNDLE_PATH_REF) == 0);
+    decoder->count++;
+    return true;
+}
+
+static mc_companion_bundle_status_t bundle_decode_end(mc_companion_bundle_decoder_t* decoder, const uint8_t* record, size_t length) {
+    size_t   position = 1;
+    uint32_t count;
+    if (!bundle_get_varint(record, length, &position, &count) || length - position < MC_COMPANION_BUNDLE_CHECK_SIZE) {
+        return MC_COMPANION_BUNDLE_ERROR;
+    }
+    if (count != decoder->count || (decoder->expected != 0 && decoder->expected != count)) {
+        return MC_COMPANION_BUNDLE_ERROR;
+    }
+    SHA256_HASH digest;
+    Sha256Finalise(&decoder->hash, &digest);
+    if (memcmp(digest.bytes, &record[position], MC_COMPANION_BUNDLE_CHECK_SIZE) != 0) {
+        return MC_COMPANION_BUNDLE_ERROR;
+    }
+    return MC_COMPANION_BUNDLE_COMPLETE;
+}
+
+// A record is complete, hand it to its decoder
+static mc_companion_bundle_status_t bundle_decode_record(mc_companion_bundle_decoder_t* decoder) {
+    const uint8_t* record = decoder->record;
+    size_t         length = decoder->record_length;
+    switch (record[0]) {
+        case MC_COMPANION_BUNDLE_RECORD_END:
+            return bundle_decode_end(decoder, record, length);
+        case MC_COMPANION_BUNDLE_RECORD_CONTACT:
+            Sha256Update(&decoder->hash, record, (uint32_t)length);
+            return bundle_decode_contact(decoder, record, length) ? MC_COMPANION_BUNDLE_IN_PROGRESS : MC_COMPANION_BUNDLE_ERROR;
+        default:
+            // Records of later versions are checked but otherwise skipped
+            Sha256Update(&decoder->hash, record, (uint32_t)length);
+            return MC_COMPANION_BUNDLE_IN_PROGRESS;
+    }
+}
+
+mc_companion_bundle_status_t mc_companion_bundle_decode(mc_companion_bundle_decoder_t* decoder, const uint8_t* data, size_t length) {
+    size_t index = 0;
+    while (index < length && decoder->status == MC_COMPANION_BUNDLE_IN_PROGRESS) {
+        if (decoder->offset < MC_COMPANION_BUNDLE_HEADER_SIZE) {
+            decoder->record[decoder->position++] = data[index++];
+            decoder->offset++;
+            if (decoder->position == MC_COMPANION_BUNDLE_HEADER_SIZE) {
+                decoder->position = 0;
+                if (!bundle_decode_header(decoder)) {
+                    decoder->status = MC_COMPANION_BUNDLE_ERROR;
+                }
+            }
+            continue;
+        }
+
+        if (!decoder->collecting) {
+            uint8_t byte            = data[index++];
+            decoder->offset++;
+            decoder->record_length |= (uint32_t)(byte & 0x7F) << decoder->length_shift;
+            decoder->length_shift  += 7;
+            if (byte & 0x80) {
+                // No record needs more than two length bytes
+                if (decoder->length_shift > 7) {
+                    decoder->status = MC_COMPANION_BUNDLE_ERROR;
+                }
+                continue;
+            }
+            if (decoder->record_length == 0 || decoder->record_length > sizeof(decoder->record)) {
+                decoder->status = MC_COMPANION_BUNDLE_ERROR;
+                continue;
+            }
+            decoder->collecting = true;
+            decoder->position   = 0;
+            continue;
+        }
+
+        // Take as much of the record as this piece holds
+        size_t wanted = decoder->record_length - decoder->position;
+        size_t take   = (length - index < wanted) ? length - index : wanted;
+        memcpy(&decoder->record[decoder->position], &data[index], take);
+        decoder->position += (uint16_t)take;
+        decoder->offset   += (uint32_t)take;
+        index             += take;
+        if (decoder->position < decoder->record_length) {
+            continue;
+        }
+
+        decoder->status        = bundle_decode_record(decoder);
+        decoder->collecting    = false;
+        decoder->record_length = 0;
+        decoder->length_shift  = 0;
+    }
+    return decoder->status;
+}
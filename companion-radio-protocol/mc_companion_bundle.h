@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto/sha256.h"
+#include "mc_companion.h"
+
+// Compact binary bundle of contacts for provisioning many contacts at once over IMPORT_BUNDLE and
+// EXPORT_BUNDLE instead of one contact per frame.
+//
+// A bundle is an 8 byte header ("MCB", version, little endian contact count) followed by records. Every
+// record is a varint length and a record type byte, so a decoder skips record types it does not know. A
+// contact record is encoded against the contact before it: unchanged type, flags, position and modification
+// time cost nothing, timestamps and coordinates are zigzag varint deltas and a name shares its prefix with
+// the previous name. Names and paths seen earlier in the bundle are referred to by their index in a small
+// dictionary that the encoder and the decoder keep in step, so a fleet behind a few repeaters sends every
+// path once. The end record holds the contact count and the first bytes of a SHA-256 over the header and
+// all records, a store only applies a bundle that ends with a matching end record.
+//
+// The decoder takes the bundle in pieces of any size as they arrive and hands out every contact once its
+// record is complete, it never holds more than one record.
+
+// Definitions
+
+#ifndef MC_COMPANION_BUNDLE_DICTIONARY_SIZE
+#define MC_COMPANION_BUNDLE_DICTIONARY_SIZE 32
+#endif
+
+_Static_assert(MC_COMPANION_BUNDLE_DICTIONARY_SIZE > 0 && MC_COMPANION_BUNDLE_DICTIONARY_SIZE <= 256,
+               "MC_COMPANION_BUNDLE_DICTIONARY_SIZE must fit a one byte index");
+
+#define MC_COMPANION_BUNDLE_VERSION     1
+#define MC_COMPANION_BUNDLE_HEADER_SIZE 8
+#define MC_COMPANION_BUNDLE_CHECK_SIZE  4    // Bytes of the SHA-256 in the end record
+#define MC_COMPANION_BUNDLE_MAX_RECORD  160  // Largest record including its length prefix
+
+// Records
+#define MC_COMPANION_BUNDLE_RECORD_END     0x00
+#define MC_COMPANION_BUNDLE_RECORD_CONTACT 0x01
+
+typedef enum {
+    MC_COMPANION_BUNDLE_IN_PROGRESS = 0,
+    MC_COMPANION_BUNDLE_COMPLETE    = 1,   // The end record was read and matched
+    MC_COMPANION_BUNDLE_ERROR       = -1,  // Malformed, corrupted or rejected by the contact callback
+} mc_companion_bundle_status_t;
+
+/// State the encoder and the decoder keep in step, the contact before and the name and path dictionaries
+typedef struct {
+    companion_contact_t previous;
+    uint16_t            name_count;  // Filled dictionary entries
+    uint16_t            name_next;   // Entry replaced by the next new name
+    uint16_t            path_count;
+    uint16_t            path_next;
+    char                names[MC_COMPANION_BUNDLE_DICTIONARY_SIZE][32];
+    int8_t              path_lengths[MC_COMPANION_BUNDLE_DICTIONARY_SIZE];
+    uint8_t             paths[MC_COMPANION_BUNDLE_DICTIONARY_SIZE][64];
+} mc_companion_bundle_dictionary_t;
+
+typedef struct {
+    mc_companion_bundle_dictionary_t dictionary;
+    uint32_t                         count;  // Contacts encoded
+    Sha256Context                    hash;
+} mc_companion_bundle_encoder_t;
+
+/// Take a decoded contact, return false to reject the bundle
+typedef bool (*mc_companion_bundle_contact_callback)(const companion_contact_t* contact, void* context);
+
+typedef struct {
+    mc_companion_bundle_dictionary_t     dictionary;
+    mc_companion_bundle_contact_callback contact;
+    void*                                context;
+    mc_companion_bundle_status_t         status;
+    uint32_t                             expected;       // Contact count from the header, 0 when not known up front
+    uint32_t                             count;          // Contacts decoded
+    uint32_t                             offset;         // Bundle bytes taken
+    bool                                 collecting;     // Reading a record, otherwise its length
+    uint32_t                             record_length;  // Length of the record, or the part of it read so far
+    uint8_t                              length_shift;   // Bits of the record length read so far
+    uint16_t                             position;       // Bytes collected of the header or the record
+    uint8_t                              record[MC_COMPANION_BUNDLE_MAX_RECORD];
+    Sha256Context                        hash;
+} mc_companion_bundle_decoder_t;
+
+// Functions
+
+/// Start a bundle
+void mc_companion_bundle_encoder_init(mc_companion_bundle_encoder_t* encoder);
+
+/// Write the header for a bundle of count contacts. Returns the number of bytes written or -1 when the
+/// buffer is too small.
+int mc_companion_bundle_encode_header(mc_companion_bundle_encoder_t* encoder, uint32_t count, uint8_t* out, size_t size);
+
+/// Write the record for the next contact. Returns the number of bytes written, or -1 when the buffer is too
+/// small, the encoder is then unchanged and the contact can be written again into a new buffer.
+int mc_companion_bundle_encode_contact(mc_companion_bundle_encoder_t* encoder, const companion_contact_t* contact, uint8_t* out, size_t size);
+
+/// Write the end record, the encoder has to be initialized again for the next bundle. Returns the number of
+/// bytes written or -1 when the buffer is too small.
+int mc_companion_bundle_encode_end(mc_companion_bundle_encoder_t* encoder, uint8_t* out, size_t size);
+
+/// Prepare a decoder for a new bundle
+void mc_companion_bundle_decoder_init(mc_companion_bundle_decoder_t* decoder, mc_companion_bundle_contact_callback contact, void* context);
+
+/// Take the next piece of a bundle. Bytes after the end record are ignored, once the decoder has failed it
+/// stays failed until it is initialized again.
+mc_companion_bundle_status_t mc_companion_bundle_decode(mc_companion_bundle_decoder_t* decoder, const uint8_t* data, size_t length);
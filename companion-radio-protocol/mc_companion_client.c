@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "mc_companion_client.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "mc_companion_batch.h"
+#include "mc_companion_command_parser.h"
+
+#define FIELD_SIZE(type, field) (sizeof(((type*)0)->field))
+
+_Static_assert(sizeof(companion_response_packet_t) - offsetof(companion_response_packet_t, args) >= MESHCORE_COMPANION_MAX_PAYLOAD_SIZE - 1,
+               "companion_response_packet_t must hold the arguments of the largest plain frame");
+
+void mc_companion_client_init(mc_companion_client_t* client, mc_companion_client_callback callback, void* context) {
+    memset(client, 0, sizeof(mc_companion_client_t));
+    client->callback   = callback;
+    client->context    = context;
+    client->frame_size = MESHCORE_COMPANION_MAX_FRAME_SIZE;
+}
+
+static void mc_companion_client_deliver(const uint8_t* record, uint16_t record_length, void* context) {
+    mc_companion_client_t* client      = context;
+    uint16_t               args_length = (uint16_t)(record_length - 1);
+    client->response.response          = (companion_response_code_t)record[0];
+    memcpy(client->response.args, &record[1], args_length);
+
+    // The device uses the frame size it reported from the frame after DEVICE_INFO on
+    if (client->response.response == COMPANION_RESPONSE_CODE_DEVICE_INFO && args_length >= sizeof(companion_resp_device_info_args_t)) {
+        uint16_t size      = client->response.response_device_info_args.max_frame_size;
+        client->frame_size = (size < MESHCORE_COMPANION_MAX_FRAME_SIZE)        ? MESHCORE_COMPANION_MAX_FRAME_SIZE
+                             : (size > MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE) ? MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE
+                                                                               : size;
+    }
+    client->callback(client, &client->response, args_length, client->context);
+}
+
+void mc_companion_client_read(mc_companion_client_t* client, const uint8_t* data, size_t data_length) {
+    while (data_length > 0) {
+        if (client->rx_position == 0) {
+            // Search for the start byte
+            if (*data == '>') {
+                client->rx_buffer[client->rx_position++] = *data;
+            } else {
+                client->rx_discarded++;
+            }
+            data++;
+            data_length--;
+            continue;
+        }
+
+        if (client->rx_position < 3) {
+            client->rx_buffer[client->rx_position++] = *data;
+            data++;
+            data_length--;
+            if (client->rx_position < 3) {
+                continue;
+            }
+        }
+
+        // The length covers the response code and arguments, computed in 32 bits so that it can not wrap
+        uint32_t expected_length = 3 + (uint32_t)(client->rx_buffer[1] | (client->rx_buffer[2] << 8));
+        if (expected_length < 4 || expected_length > client->frame_size) {
+            client->rx_discarded += client->rx_position;
+            client->rx_position   = 0;
+            continue;
+        }
+
+        size_t chunk = expected_length - client->rx_position;
+        if (chunk > data_length) {
+            chunk = data_length;
+        }
+        memcpy(&client->rx_buffer[client->rx_position], data, chunk);
+        client->rx_position += (uint16_t)chunk;
+        data                += chunk;
+        data_length         -= chunk;
+
+        if (client->rx_position == expected_length) {
+            client->rx_position = 0;
+            if (client->rx_buffer[3] != COMPANION_RESPONSE_CODE_BATCH) {
+                // Only batch frames grow with the negotiated frame size, a larger plain frame does not fit the response
+                if (expected_length > MESHCORE_COMPANION_MAX_FRAME_SIZE) {
+                    client->rx_malformed++;
+                } else {
+                    mc_companion_client_deliver(&client->rx_buffer[3], (uint16_t)(expected_length - 3), client);
+                }
+            } else if (mc_companion_batch_split(&client->rx_buffer[4], expected_length - 4, mc_companion_client_deliver, client) < 0) {
+                client->rx_malformed++;
+            }
+        }
+    }
+}
+
+int mc_companion_write_command(const companion_command_packet_t* packet, uint16_t args_length, size_t output_buffer_size, uint8_t* out_framed_data,
+                               size_t* out_framed_data_length) {
+    size_t min_length = 0;
+    size_t max_length = 0;
+    if (!mc_companion_command_limits(packet->command, &min_length, &max_length) || args_length < min_length || args_length > max_length) {
+        return -1;
+    }
+
+    size_t frame_length = 3 + 1 + (size_t)args_length;
+    if (frame_length > output_buffer_size || frame_length > MESHCORE_COMPANION_MAX_FRAME_SIZE) {
+        return -1;
+    }
+
+    uint16_t packet_length = args_length + 1;
+    out_framed_data[0]     = '<';
+    out_framed_data[1]     = (packet_length >> 0) & 0xFF;
+    out_framed_data[2]     = (packet_length >> 8) & 0xFF;
+    out_framed_data[3]     = (uint8_t)packet->command;
+    memcpy(&out_framed_data[4], packet->args, args_length);
+    *out_framed_data_length = frame_length;
+    return 0;
+}
+
+int mc_companion_write_device_query(uint8_t app_target_version, uint16_t max_frame_size, size_t output_buffer_size, uint8_t* out_framed_data,
+                                    size_t* out_framed_data_length) {
+    companion_command_packet_t         packet = {.command = COMPANION_CMD_DEVICE_QUERY};
+    companion_cmd_device_query_args_t* query  = &packet.command_device_query_args;
+    query->app_target_version                 = app_target_version;
+    query->max_frame_size                     = max_frame_size;
+    return mc_companion_write_command(&packet, (max_frame_size != 0) ? sizeof(*query) : sizeof(query->app_target_version), output_buffer_size,
+                                      out_framed_data, out_framed_data_length);
+}
+
+int mc_companion_write_get_contacts(uint32_t since, size_t output_buffer_size, uint8_t* out_framed_data, size_t* out_framed_data_length) {
+    companion_command_packet_t packet = {.command = COMPANION_CMD_GET_CONTACTS};
+    packet.command_get_contacts_args.since = since;
+    return mc_companion_write_command(&packet, (since != 0) ? sizeof(companion_cmd_get_contacts_args_t) : 0, output_buffer_size, out_framed_data,
+                                      out_framed_data_length);
+}
+
+int mc_companion_write_send_txt_msg(uint8_t txt_type, uint8_t attempt, uint32_t timestamp, const uint8_t* pub_key_prefix, const char* text,
+                                    size_t output_buffer_size, uint8_t* out_framed_data, size_t* out_framed_data_length) {
+    companion_command_packet_t         packet  = {.command = COMPANION_CMD_SEND_TXT_MSG};
+    companion_cmd_send_txt_msg_args_t* message = &packet.command_send_txt_msg_args;
+    size_t                             length  = strlen(text);
+    if (length > sizeof(message->text)) {
+        return -1;
+    }
+
+    message->txt_type      = txt_type;
+    message->attempt       = attempt;
+    message->msg_timestamp = timestamp;
+    memcpy(message->pub_key_prefix, pub_key_prefix, sizeof(message->pub_key_prefix));
+    memcpy(message->text, text, length);
+    return mc_companion_write_command(&packet, (uint16_t)(sizeof(companion_cmd_send_txt_msg_args_t) - sizeof(message->text) + length), output_buffer_size,
+                                      out_framed_data, out_framed_data_length);
+}
+
+int mc_companion_write_import_bundle(uint16_t sequence, const uint8_t* data, size_t length, size_t output_buffer_size, uint8_t* out_framed_data,
+                                     size_t* out_framed_data_length) {
+    companion_command_packet_t          packet = {.command = COMPANION_CMD_IMPORT_BUNDLE};
+    companion_cmd_import_bundle_args_t* chunk  = &packet.command_import_bundle_args;
+    if (length > sizeof(chunk->data)) {
+        return -1;
+    }
+
+    chunk->sequence = sequence;
+    memcpy(chunk->data, data, length);
+    return mc_companion_write_command(&packet, (uint16_t)(sizeof(chunk->sequence) + length), output_buffer_size, out_framed_data, out_framed_data_length);
+}
+
+int mc_companion_write_export_bundle(uint32_t since, size_t output_buffer_size, uint8_t* out_framed_data, size_t* out_framed_data_length) {
+    companion_command_packet_t packet = {.command = COMPANION_CMD_EXPORT_BUNDLE};
+    packet.command_export_bundle_args.since = since;
+    return mc_companion_write_command(&packet, (since != 0) ? sizeof(companion_cmd_export_bundle_args_t) : 0, output_buffer_size, out_framed_data,
+                                      out_framed_data_length);
+}
+
+int mc_companion_write_simple_command(companion_command_t command, size_t output_buffer_size, uint8_t* out_framed_data, size_t* out_framed_data_length) {
+    companion_command_packet_t packet = {.command = command};
+    return mc_companion_write_command(&packet, 0, output_buffer_size, out_framed_data, out_framed_data_length);
+}
+
+bool mc_companion_response_is_final(companion_response_code_t response) {
+    return response < COMPANION_PUSH_CODE_ADVERT && response != COMPANION_RESPONSE_CODE_CONTACTS_START && response != COMPANION_RESPONSE_CODE_CONTACT &&
+           response != COMPANION_RESPONSE_CODE_BUNDLE_DATA;
+}
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mc_companion.h"
+
+// Client side of the companion protocol: frames commands ('<', length, command, arguments) and reads the
+// response and push frames ('>', length, code, arguments) a companion radio sends back. Unlike the server
+// side reader, the client keeps its receive state in a context struct, so one process can drive any number
+// of links. The frame size a device reports in DEVICE_INFO is taken over by the client, batch frames are
+// split and their responses passed to the callback one by one.
+
+typedef struct mc_companion_client mc_companion_client_t;
+
+/// Called for every complete response or push frame, args_length is the length of the argument bytes
+typedef void (*mc_companion_client_callback)(mc_companion_client_t* client, const companion_response_packet_t* response, uint16_t args_length,
+                                             void* context);
+
+struct mc_companion_client {
+    mc_companion_client_callback callback;
+    void*                        context;
+    uint16_t                     rx_position;
+    uint16_t                     frame_size;    // Negotiated with DEVICE_QUERY, commands may be batched up to this size
+    uint32_t                     rx_discarded;  // Bytes skipped while looking for a start byte or in oversized frames
+    uint32_t                     rx_malformed;  // Plain frames above the base frame size, and batch frames with a malformed record (the records before it were passed on)
+    uint8_t                      rx_buffer[MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE];
+    companion_response_packet_t  response;
+};
+
+/// Reset a client, the callback receives every response and push frame
+void mc_companion_client_init(mc_companion_client_t* client, mc_companion_client_callback callback, void* context);
+
+/// Feed received bytes, calls the callback for every frame they complete
+void mc_companion_client_read(mc_companion_client_t* client, const uint8_t* data, size_t data_length);
+
+/// Frame a command with args_length argument bytes. Returns -1 when the command is unknown, the argument
+/// length is out of range for the command or the output buffer is too small.
+int mc_companion_write_command(const companion_command_packet_t* packet, uint16_t args_length, size_t output_buffer_size, uint8_t* out_framed_data,
+                               size_t* out_framed_data_length);
+
+/// Frame a DEVICE_QUERY command, a max_frame_size other than 0 asks the device for frames of up to that size
+int mc_companion_write_device_query(uint8_t app_target_version, uint16_t max_frame_size, size_t output_buffer_size, uint8_t* out_framed_data,
+                                    size_t* out_framed_data_length);
+
+/// Frame a GET_CONTACTS command, only contacts modified after since are requested when since is not 0
+int mc_companion_write_get_contacts(uint32_t since, size_t output_buffer_size, uint8_t* out_framed_data, size_t* out_framed_data_length);
+
+/// Frame a SEND_TXT_MSG command
+int mc_companion_write_send_txt_msg(uint8_t txt_type, uint8_t attempt, uint32_t timestamp, const uint8_t* pub_key_prefix, const char* text,
+                                    size_t output_buffer_size, uint8_t* out_framed_data, size_t* out_framed_data_length);
+
+/// Frame an IMPORT_BUNDLE command carrying the next chunk of a contact bundle, see mc_companion_bundle.h
+int mc_companion_write_import_bundle(uint16_t sequence, const uint8_t* data, size_t length, size_t output_buffer_size, uint8_t* out_framed_data,
+                                     size_t* out_framed_data_length);
+
+/// Frame an EXPORT_BUNDLE command, only contacts modified after since are requested when since is not 0
+int mc_companion_write_export_bundle(uint32_t since, size_t output_buffer_size, uint8_t* out_framed_data, size_t* out_framed_data_length);
+
+/// Frame a command without arguments, such as SYNC_NEXT_MESSAGE or GET_DEVICE_TIME
+int mc_companion_write_simple_command(companion_command_t command, size_t output_buffer_size, uint8_t* out_framed_data, size_t* out_framed_data_length);
+
+/// Check whether a response code ends the exchange started by a command, as opposed to a push or an
+/// intermediate frame such as CONTACTS_START, CONTACT and BUNDLE_DATA
+bool mc_companion_response_is_final(companion_response_code_t response);
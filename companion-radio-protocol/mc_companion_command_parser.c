@@ -41,7 +41,7 @@ companion_command_definition_t companion_command_definitions[] = {
     {COMPANION_CMD_REBOOT, sizeof(companion_cmd_reboot_args_t), sizeof(companion_cmd_reboot_args_t)},
     {COMPANION_CMD_GET_BATT_AND_STORAGE, 0, 0},
     {COMPANION_CMD_SET_TUNING_PARAMS, sizeof(companion_cmd_set_tuning_params_args_t), sizeof(companion_cmd_set_tuning_params_args_t)},
-    {COMPANION_CMD_DEVICE_QUERY, sizeof(companion_cmd_device_query_args_t), sizeof(companion_cmd_device_query_args_t)},
+    {COMPANION_CMD_DEVICE_QUERY, FIELD_SIZE(companion_cmd_device_query_args_t, app_target_version), sizeof(companion_cmd_device_query_args_t)},
     {COMPANION_CMD_EXPORT_PRIVATE_KEY, 0, 0},
     {COMPANION_CMD_IMPORT_PRIVATE_KEY, sizeof(companion_cmd_import_private_key_args_t), sizeof(companion_cmd_import_private_key_args_t)},
     {COMPANION_CMD_SEND_RAW_DATA, sizeof(companion_cmd_send_raw_data_args_t), sizeof(companion_cmd_send_raw_data_args_t)},
@@ -72,10 +72,12 @@ companion_command_definition_t companion_command_definitions[] = {
     {COMPANION_CMD_SEND_PATH_DISCOVERY_REQ, sizeof(companion_cmd_send_path_discovery_req_args_t), sizeof(companion_cmd_send_path_discovery_req_args_t)},
     {COMPANION_CMD_SET_FLOOD_SCOPE, FIELD_SIZE(companion_cmd_flood_scope_args_t, reserved), sizeof(companion_cmd_flood_scope_args_t)},
     {COMPANION_CMD_SEND_CONTROL_DATA, 1, sizeof(companion_cmd_send_control_data_args_t)},
-    {COMPANION_CMD_GET_STATS, 0, 0},
+    {COMPANION_CMD_GET_STATS, 0, sizeof(companion_cmd_get_stats_args_t)},  // Without a stats type the core stats are returned
+    {COMPANION_CMD_IMPORT_BUNDLE, FIELD_SIZE(companion_cmd_import_bundle_args_t, sequence) + 1, sizeof(companion_cmd_import_bundle_args_t)},
+    {COMPANION_CMD_EXPORT_BUNDLE, 0, sizeof(companion_cmd_export_bundle_args_t)},
 };
 
-mc_companion_command_parser_error_t mc_companion_parse_command(uint8_t* data, uint16_t data_length, companion_command_packet_t* out_packet) {
+mc_companion_command_parser_error_t mc_companion_parse_command(const uint8_t* data, uint16_t data_length, companion_command_packet_t* out_packet) {
     if (data_length < 1) {
         return COMPANION_COMMAND_PARSER_ERROR_INVALID_COMMAND;  // No command byte
     }
@@ -92,8 +94,20 @@ mc_companion_command_parser_error_t mc_companion_parse_command(uint8_t* data, ui
                 return COMPANION_COMMAND_PARSER_ERROR_INVALID_ARGUMENTS;  // Invalid argument length
             }
             memcpy(out_packet->args, data, data_length);
+            out_packet->args_length = data_length;
             return COMPANION_COMMAND_PARSER_ERROR_NONE;
         }
     }
     return COMPANION_COMMAND_PARSER_ERROR_INVALID_COMMAND;  // Command not found
-}
\ No newline at end of file
+}
+
+bool mc_companion_command_limits(companion_command_t command, size_t* out_min_length, size_t* out_max_length) {
+    for (size_t i = 0; i < sizeof(companion_command_definitions) / sizeof(companion_command_definition_t); i++) {
+        if (companion_command_definitions[i].command == command) {
+            *out_min_length = companion_command_definitions[i].min_argument_length;
+            *out_max_length = companion_command_definitions[i].max_argument_length;
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "mc_companion.h"
 
@@ -9,7 +10,10 @@ typedef enum {
     COMPANION_COMMAND_PARSER_ERROR_INVALID_ARGUMENTS = 2,
 } mc_companion_command_parser_error_t;
 
-mc_companion_command_parser_error_t mc_companion_parse_command(uint8_t* data, uint16_t data_length, companion_command_packet_t* out_packet);
+mc_companion_command_parser_error_t mc_companion_parse_command(const uint8_t* data, uint16_t data_length, companion_command_packet_t* out_packet);
+
+/// Look up the argument length range of a command, returns false for unknown commands
+bool mc_companion_command_limits(companion_command_t command, size_t* out_min_length, size_t* out_max_length);
 
 // Callback
 
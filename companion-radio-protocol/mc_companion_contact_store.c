@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "mc_companion_contact_store.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CONTACT_STORE_INDEX_MASK (MC_COMPANION_CONTACT_STORE_INDEX_SIZE - 1)
+
+// Public keys are uniformly distributed, the multiply only spreads keys that were made up in sequence
+static uint32_t contact_store_hash(const uint8_t public_key[32]) {
+    uint32_t value;
+    memcpy(&value, public_key, sizeof(value));
+    return (value * 2654435761u) >> 16;
+}
+
+// Index entry holding the key, or the free entry where it would go
+static uint16_t* contact_store_probe(mc_companion_contact_store_t* store, const uint8_t public_key[32]) {
+    uint32_t position = contact_store_hash(public_key) & CONTACT_STORE_INDEX_MASK;
+    while (store->index[position] != 0 && memcmp(store->contacts[store->index[position] - 1].public_key, public_key, 32) != 0) {
+        position = (position + 1) & CONTACT_STORE_INDEX_MASK;
+    }
+    return &store->index[position];
+}
+
+void mc_companion_contact_store_init(mc_companion_contact_store_t* store) {
+    memset(store, 0, sizeof(mc_companion_contact_store_t));
+}
+
+companion_contact_t* mc_companion_contact_store_find(mc_companion_contact_store_t* store, const uint8_t public_key[32]) {
+    uint16_t entry = *contact_store_probe(store, public_key);
+    return (entry != 0) ? &store->contacts[entry - 1] : NULL;
+}
+
+int mc_companion_contact_store_stage(mc_companion_contact_store_t* store, const companion_contact_t* contact) {
+    if (store->count + store->staged >= MC_COMPANION_CONTACT_STORE_CAPACITY) {
+        return -1;
+    }
+    store->contacts[store->count + store->staged] = *contact;
+    store->staged++;
+    return 0;
+}
+
+uint16_t mc_companion_contact_store_commit(mc_companion_contact_store_t* store) {
+    // Staged contacts are moved down over the slots of those that replaced a stored contact, a slot is
+    // only written after the contact in it was taken
+    uint16_t first = store->count;
+    uint16_t added = 0;
+    for (uint16_t staged = 0; staged < store->staged; staged++) {
+        const companion_contact_t* contact = &store->contacts[first + staged];
+        uint16_t*                  entry   = contact_store_probe(store, contact->public_key);
+        if (*entry != 0) {
+            store->contacts[*entry - 1] = *contact;
+            continue;
+        }
+        if (store->count != first + staged) {
+            store->contacts[store->count] = *contact;
+        }
+        store->count++;
+        *entry = store->count;
+        added++;
+    }
+    store->staged = 0;
+    return added;
+}
+
+void mc_companion_contact_store_rollback(mc_companion_contact_store_t* store) {
+    store->staged = 0;
+}
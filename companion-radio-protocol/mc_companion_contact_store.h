@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mc_companion.h"
+
+// Contacts of a companion radio, looked up by public key through an open addressing index. Changes are
+// staged in the free slots after the stored contacts and become visible together on commit, so a bundle
+// that fails half way leaves the store as it was. Committing can not fail: every staged contact already
+// has its slot. A transaction therefore needs a free slot for every contact it stages, also for those that
+// replace a stored contact.
+
+// Definitions
+
+#ifndef MC_COMPANION_CONTACT_STORE_CAPACITY
+#define MC_COMPANION_CONTACT_STORE_CAPACITY 350
+#endif
+
+#ifndef MC_COMPANION_CONTACT_STORE_INDEX_SIZE
+#define MC_COMPANION_CONTACT_STORE_INDEX_SIZE 1024
+#endif
+
+_Static_assert(MC_COMPANION_CONTACT_STORE_CAPACITY < UINT16_MAX, "MC_COMPANION_CONTACT_STORE_CAPACITY too large");
+_Static_assert((MC_COMPANION_CONTACT_STORE_INDEX_SIZE & (MC_COMPANION_CONTACT_STORE_INDEX_SIZE - 1)) == 0,
+               "MC_COMPANION_CONTACT_STORE_INDEX_SIZE must be a power of two");
+_Static_assert(MC_COMPANION_CONTACT_STORE_INDEX_SIZE >= 2 * MC_COMPANION_CONTACT_STORE_CAPACITY,
+               "MC_COMPANION_CONTACT_STORE_INDEX_SIZE must be at least twice the capacity");
+
+typedef struct {
+    uint16_t            count;                                         // Stored contacts
+    uint16_t            staged;                                        // Contacts staged after them
+    uint16_t            index[MC_COMPANION_CONTACT_STORE_INDEX_SIZE];  // Slot + 1 of a stored contact, 0 when free
+    companion_contact_t contacts[MC_COMPANION_CONTACT_STORE_CAPACITY];
+} mc_companion_contact_store_t;
+
+// Functions
+
+/// Empty a store
+void mc_companion_contact_store_init(mc_companion_contact_store_t* store);
+
+/// Find a stored contact, staged contacts are not found until they are committed
+companion_contact_t* mc_companion_contact_store_find(mc_companion_contact_store_t* store, const uint8_t public_key[32]);
+
+/// Stage a contact to add or replace on commit. Returns -1 when there is no free slot left.
+int mc_companion_contact_store_stage(mc_companion_contact_store_t* store, const companion_contact_t* contact);
+
+/// Apply all staged contacts at once, a later staged contact with the same key wins. Returns the number of
+/// contacts added, the others replaced stored contacts.
+uint16_t mc_companion_contact_store_commit(mc_companion_contact_store_t* store);
+
+/// Drop all staged contacts
+void mc_companion_contact_store_rollback(mc_companion_contact_store_t* store);
@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "mc_companion_fanout.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "mc_companion.h"
+#include "meshcore/pool.h"
+
+#define MC_COMPANION_FANOUT_MASK (MC_COMPANION_FANOUT_BACKLOG - 1)
+
+// Start byte, length and response code in front of the arguments
+#define MC_COMPANION_FANOUT_OVERHEAD 4
+
+void mc_companion_fanout_init(mc_companion_fanout_t* fanout) {
+    memset(fanout->clients, 0, sizeof(fanout->clients));
+    fanout->published = 0;
+    fanout->exhausted = 0;
+    meshcore_pool_init(&fanout->pool, fanout->storage, sizeof(fanout->storage), sizeof(mc_companion_fanout_frame_t));
+}
+
+int mc_companion_fanout_attach(mc_companion_fanout_t* fanout, mc_companion_fanout_write write, void* context, uint32_t high_water) {
+    for (int id = 0; id < MC_COMPANION_FANOUT_MAX_CLIENTS; id++) {
+        mc_companion_fanout_client_t* client = &fanout->clients[id];
+        if (client->attached) {
+            continue;
+        }
+        memset(client, 0, sizeof(mc_companion_fanout_client_t));
+        client->attached   = true;
+        client->write      = write;
+        client->context    = context;
+        client->high_water = (high_water > 0) ? high_water : MC_COMPANION_FANOUT_DEFAULT_HIGH_WATER;
+        if (client->high_water < MESHCORE_COMPANION_MAX_FRAME_SIZE) {
+            // A smaller mark would turn the client lagging on an empty backlog, with nothing to drain to recover
+            client->high_water = MESHCORE_COMPANION_MAX_FRAME_SIZE;
+        }
+        return id;
+    }
+    return -1;
+}
+
+void mc_companion_fanout_detach(mc_companion_fanout_t* fanout, int id) {
+    if (id < 0 || id >= MC_COMPANION_FANOUT_MAX_CLIENTS || !fanout->clients[id].attached) {
+        return;
+    }
+    mc_companion_fanout_client_t* client = &fanout->clients[id];
+    while (client->head != client->tail) {
+        meshcore_pool_release(&fanout->pool, NULL, client->backlog[client->head & MC_COMPANION_FANOUT_MASK]);
+        client->head++;
+    }
+    client->attached = false;
+}
+
+// Drop the backlog of a client except its oldest frame, which may be partly written and keeps the stream in
+// sync. Writing that frame is also how a lagging client shows it reads again.
+static void mc_companion_fanout_shed(mc_companion_fanout_t* fanout, mc_companion_fanout_client_t* client) {
+    uint32_t keep = client->head + ((client->head != client->tail) ? 1 : 0);
+    while (client->tail != keep) {
+        client->tail--;
+        mc_companion_fanout_frame_t* frame = client->backlog[client->tail & MC_COMPANION_FANOUT_MASK];
+        client->queued_bytes -= frame->length;
+        client->dropped++;
+        meshcore_pool_release(&fanout->pool, NULL, frame);
+    }
+}
+
+// Free shared buffers when the pool runs out: lagging clients lose their backlog first, otherwise the clients
+// with the largest backlog are marked lagging and lose it until a buffer is free
+static mc_companion_fanout_frame_t* mc_companion_fanout_reclaim(mc_companion_fanout_t* fanout) {
+    for (int id = 0; id < MC_COMPANION_FANOUT_MAX_CLIENTS; id++) {
+        if (fanout->clients[id].attached && fanout->clients[id].lagging) {
+            mc_companion_fanout_shed(fanout, &fanout->clients[id]);
+        }
+    }
+
+    mc_companion_fanout_frame_t* frame = meshcore_pool_alloc(&fanout->pool, NULL);
+    while (frame == NULL) {
+        mc_companion_fanout_client_t* largest = NULL;
+        for (int id = 0; id < MC_COMPANION_FANOUT_MAX_CLIENTS; id++) {
+            mc_companion_fanout_client_t* client = &fanout->clients[id];
+            if (client->attached && !client->lagging && client->head != client->tail &&
+                (largest == NULL || client->queued_bytes > largest->queued_bytes)) {
+                largest = client;
+            }
+        }
+        if (largest == NULL) {
+            break;
+        }
+        largest->lagging = true;
+        mc_companion_fanout_shed(fanout, largest);
+        frame = meshcore_pool_alloc(&fanout->pool, NULL);
+    }
+    return frame;
+}
+
+int mc_companion_fanout_publish(mc_companion_fanout_t* fanout, const companion_response_packet_t* packet, uint16_t args_length) {
+    if (args_length > MESHCORE_COMPANION_MAX_FRAME_SIZE - MC_COMPANION_FANOUT_OVERHEAD) {
+        return -1;
+    }
+    mc_companion_fanout_frame_t* frame = meshcore_pool_alloc(&fanout->pool, NULL);
+    if (frame == NULL) {
+        frame = mc_companion_fanout_reclaim(fanout);
+    }
+    if (frame == NULL) {
+        fanout->exhausted++;
+        return -1;
+    }
+
+    // Same framing as mc_companion_write_serial_response, the length covers the code and its arguments
+    uint16_t length = args_length + 1;
+    frame->data[0]  = '>';
+    frame->data[1]  = (length >> 0) & 0xFF;
+    frame->data[2]  = (length >> 8) & 0xFF;
+    frame->data[3]  = packet->response;
+    memcpy(&frame->data[MC_COMPANION_FANOUT_OVERHEAD], packet->args, args_length);
+    frame->length = MC_COMPANION_FANOUT_OVERHEAD + args_length;
+
+    int queued = 0;
+    for (int id = 0; id < MC_COMPANION_FANOUT_MAX_CLIENTS; id++) {
+        mc_companion_fanout_client_t* client = &fanout->clients[id];
+        if (!client->attached) {
+            continue;
+        }
+        if (!client->lagging && (client->queued_bytes + frame->length > client->high_water || client->tail - client->head >= MC_COMPANION_FANOUT_BACKLOG)) {
+            client->lagging = true;
+        }
+        if (client->lagging) {
+            client->dropped++;
+            continue;
+        }
+        meshcore_pool_retain(&fanout->pool, frame);
+        client->backlog[client->tail & MC_COMPANION_FANOUT_MASK] = frame;
+        client->tail++;
+        client->queued_bytes += frame->length;
+        queued++;
+    }
+
+    if (queued > 0) {
+        fanout->published++;
+    }
+    // Drop the reference taken by the allocation, the clients hold the rest
+    meshcore_pool_release(&fanout->pool, NULL, frame);
+    return queued;
+}
+
+int mc_companion_fanout_publish_channel_msg(mc_companion_fanout_t* fanout, uint8_t channel_idx, uint8_t path_length,
+                                            const meshcore_compact_grp_txt_t* grp_txt) {
+    companion_response_packet_t packet = {0};
+    size_t                      header = sizeof(companion_resp_channel_msg_recv_args_t) - sizeof(packet.response_channel_msg_recv_args.text);
+    size_t                      text   = grp_txt->text_length;
+    if (text > MESHCORE_COMPANION_MAX_FRAME_SIZE - MC_COMPANION_FANOUT_OVERHEAD - header) {
+        text = MESHCORE_COMPANION_MAX_FRAME_SIZE - MC_COMPANION_FANOUT_OVERHEAD - header;
+    }
+
+    packet.response                                        = COMPANION_RESPONSE_CODE_CHANNEL_MSG_RECV;
+    packet.response_channel_msg_recv_args.channel_idx      = channel_idx;
+    packet.response_channel_msg_recv_args.path_length      = path_length;
+    packet.response_channel_msg_recv_args.txt_type         = grp_txt->text_type;
+    packet.response_channel_msg_recv_args.sender_timestamp = grp_txt->timestamp;
+    memcpy(packet.response_channel_msg_recv_args.text, grp_txt->text, text);
+    return mc_companion_fanout_publish(fanout, &packet, (uint16_t)(header + text));
+}
+
+int mc_companion_fanout_flush(mc_companion_fanout_t* fanout, int id) {
+    if (id < 0 || id >= MC_COMPANION_FANOUT_MAX_CLIENTS || !fanout->clients[id].attached) {
+        return -1;
+    }
+    mc_companion_fanout_client_t* client    = &fanout->clients[id];
+    int                           completed = 0;
+    bool                          drained   = false;
+    while (client->head != client->tail) {
+        mc_companion_fanout_frame_t* frame   = client->backlog[client->head & MC_COMPANION_FANOUT_MASK];
+        int                          written = client->write(client->context, &frame->data[client->offset], frame->length - client->offset);
+        if (written < 0) {
+            return -1;
+        }
+        if (written == 0) {
+            break;
+        }
+        client->offset       += (uint16_t)written;
+        client->queued_bytes -= (uint32_t)written;
+        drained               = true;
+        if (client->offset < frame->length) {
+            // A partial write means the client is full for now
+            break;
+        }
+        meshcore_pool_release(&fanout->pool, NULL, frame);
+        client->offset = 0;
+        client->head++;
+        client->delivered++;
+        completed++;
+    }
+
+    // A lagging client takes new frames again once it has written its backlog down to half the mark
+    if (client->lagging && drained && client->queued_bytes <= client->high_water / 2) {
+        client->lagging = false;
+    }
+    return completed;
+}
+
+void mc_companion_fanout_flush_all(mc_companion_fanout_t* fanout) {
+    for (int id = 0; id < MC_COMPANION_FANOUT_MAX_CLIENTS; id++) {
+        if (fanout->clients[id].attached && mc_companion_fanout_flush(fanout, id) < 0) {
+            mc_companion_fanout_detach(fanout, id);
+        }
+    }
+}
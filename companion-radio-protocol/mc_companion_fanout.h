@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mc_companion.h"
+#include "meshcore/compact.h"
+#include "meshcore/pool.h"
+
+// Delivery of one response or push frame to many attached companion clients. The frame is built and framed
+// once into a reference counted buffer from a fixed pool, every client's backlog holds a reference to it and
+// the buffer returns to the pool when the last client has written it. A received channel message is thus
+// decrypted once and framed once however many apps are attached.
+//
+// Every client has a high-water mark in backlog bytes. A client over its mark stops receiving new frames
+// (they are dropped and counted for that client only) until it has written its backlog down to half the
+// mark, so a client that stops reading never holds up the others and gets one gap instead of scattered
+// losses. When the shared buffers run out, the backlog of lagging clients is dropped to free them, all but
+// the oldest frame. Clients are written through a callback that must not block, it returns 0 when the
+// client can not take more now. Not thread safe, publish and flush from one thread.
+
+// Definitions
+
+#ifndef MC_COMPANION_FANOUT_MAX_CLIENTS
+#define MC_COMPANION_FANOUT_MAX_CLIENTS 8
+#endif
+
+#ifndef MC_COMPANION_FANOUT_BACKLOG
+#define MC_COMPANION_FANOUT_BACKLOG 32
+#endif
+
+#ifndef MC_COMPANION_FANOUT_FRAMES
+#define MC_COMPANION_FANOUT_FRAMES 64
+#endif
+
+_Static_assert((MC_COMPANION_FANOUT_BACKLOG & (MC_COMPANION_FANOUT_BACKLOG - 1)) == 0, "MC_COMPANION_FANOUT_BACKLOG must be a power of two");
+_Static_assert(MC_COMPANION_FANOUT_FRAMES <= MESHCORE_POOL_MAX_CAPACITY, "MC_COMPANION_FANOUT_FRAMES too large");
+
+#define MC_COMPANION_FANOUT_DEFAULT_HIGH_WATER (8 * MESHCORE_COMPANION_MAX_FRAME_SIZE)
+
+typedef struct {
+    uint16_t length;
+    uint8_t  data[MESHCORE_COMPANION_MAX_FRAME_SIZE];
+} mc_companion_fanout_frame_t;
+
+/// Write to a client without blocking. Returns the number of bytes taken, 0 when the client can not take any
+/// now or -1 when the client is gone.
+typedef int (*mc_companion_fanout_write)(void* context, const uint8_t* data, size_t length);
+
+typedef struct {
+    bool                         attached;
+    bool                         lagging;  // Over the high-water mark, new frames are dropped
+    mc_companion_fanout_write    write;
+    void*                        context;
+    uint32_t                     high_water;    // Backlog bytes
+    uint32_t                     queued_bytes;  // Backlog bytes not yet written
+    uint16_t                     offset;        // Bytes of the oldest frame already written
+    uint32_t                     head;          // Oldest frame, free running
+    uint32_t                     tail;          // Next free backlog entry, free running
+    uint32_t                     delivered;     // Frames written in full
+    uint32_t                     dropped;       // Frames skipped or shed while the client was lagging
+    mc_companion_fanout_frame_t* backlog[MC_COMPANION_FANOUT_BACKLOG];
+} mc_companion_fanout_client_t;
+
+typedef struct {
+    meshcore_pool_t              pool;
+    MESHCORE_POOL_STORAGE(storage, mc_companion_fanout_frame_t, MC_COMPANION_FANOUT_FRAMES);
+    uint32_t                     published;  // Frames published to at least one client
+    uint32_t                     exhausted;  // Frames lost because no shared buffer could be freed
+    mc_companion_fanout_client_t clients[MC_COMPANION_FANOUT_MAX_CLIENTS];
+} mc_companion_fanout_t;
+
+// Functions
+
+/// Reset a fan-out with no clients attached
+void mc_companion_fanout_init(mc_companion_fanout_t* fanout);
+
+/// Attach a client with a high-water mark in backlog bytes (0 for the default), a mark below one frame is raised
+/// to one frame. Returns the client id, or -1 when all client slots are taken.
+int mc_companion_fanout_attach(mc_companion_fanout_t* fanout, mc_companion_fanout_write write, void* context, uint32_t high_water);
+
+/// Detach a client, frames still in its backlog are released
+void mc_companion_fanout_detach(mc_companion_fanout_t* fanout, int client);
+
+/// Frame a response or push with args_length argument bytes once and queue it for every client. Returns
+/// the number of clients it was queued for, or -1 when no shared buffer could be had.
+int mc_companion_fanout_publish(mc_companion_fanout_t* fanout, const companion_response_packet_t* packet, uint16_t args_length);
+
+/// Publish a decrypted group text as CHANNEL_MSG_RECV
+int mc_companion_fanout_publish_channel_msg(mc_companion_fanout_t* fanout, uint8_t channel_idx, uint8_t path_length,
+                                            const meshcore_compact_grp_txt_t* grp_txt);
+
+/// Write as much of a client's backlog as it takes. Returns the number of frames completed, or -1 when the
+/// write callback reported the client gone (the client stays attached, detach it).
+int mc_companion_fanout_flush(mc_companion_fanout_t* fanout, int client);
+
+/// Flush every attached client, clients whose write fails are detached
+void mc_companion_fanout_flush_all(mc_companion_fanout_t* fanout);
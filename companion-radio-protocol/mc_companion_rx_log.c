@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "mc_companion_rx_log.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "mc_companion.h"
+#include "mc_companion_batch.h"
+
+#define MC_COMPANION_RX_LOG_MASK (MC_COMPANION_RX_LOG_SIZE - 1)
+
+static const mc_companion_rx_log_config_t mc_companion_rx_log_default_config = {
+    .type_mask    = MC_COMPANION_RX_LOG_ALL_TYPES,
+    .route_mask   = MC_COMPANION_RX_LOG_ALL_ROUTES,
+    .batch        = 8,
+    .max_delay_ms = 50,
+    .rate_bps     = 0,
+    .burst_bytes  = 0,
+};
+
+void mc_companion_rx_log_init(mc_companion_rx_log_t* log, const mc_companion_rx_log_config_t* config, uint32_t now_ms) {
+    memset(log, 0, sizeof(mc_companion_rx_log_t));
+    log->config = (config != NULL) ? *config : mc_companion_rx_log_default_config;
+    if (log->config.batch == 0) {
+        log->config.batch = 1;
+    }
+    if (log->config.burst_bytes < MC_COMPANION_RX_LOG_OVERHEAD + MC_COMPANION_RX_LOG_MAX_DATA) {
+        // A burst must hold at least the largest push, or that push could never be sent
+        log->config.burst_bytes = MC_COMPANION_RX_LOG_OVERHEAD + MC_COMPANION_RX_LOG_MAX_DATA;
+    }
+    log->tokens     = log->config.burst_bytes;
+    log->refill_ms  = now_ms;
+    log->frame_size = MESHCORE_COMPANION_MAX_FRAME_SIZE;
+}
+
+void mc_companion_rx_log_set_filter(mc_companion_rx_log_t* log, uint16_t type_mask, uint8_t route_mask) {
+    log->config.type_mask  = type_mask;
+    log->config.route_mask = route_mask;
+}
+
+void mc_companion_rx_log_set_frame_size(mc_companion_rx_log_t* log, uint16_t frame_size) {
+    log->frame_size = frame_size;
+}
+
+int mc_companion_rx_log_push(mc_companion_rx_log_t* log, const uint8_t* data, uint8_t size, int8_t snr, int8_t rssi, uint32_t now_ms) {
+    if (size == 0) {
+        log->counters.dropped++;
+        return -1;
+    }
+
+    // The route is in bits 0-1 and the payload type in bits 2-5 of the header byte, see packet.c
+    uint8_t route = data[0] & 0x03;
+    uint8_t type  = (data[0] >> 2) & 0x0F;
+    if ((log->config.type_mask & (1u << type)) == 0 || (log->config.route_mask & (1u << route)) == 0) {
+        log->counters.filtered++;
+        return 0;
+    }
+
+    if (log->tail - log->head >= MC_COMPANION_RX_LOG_SIZE) {
+        log->counters.dropped++;
+        return -1;
+    }
+
+    mc_companion_rx_log_entry_t* entry = &log->entries[log->tail & MC_COMPANION_RX_LOG_MASK];
+    if (size > MC_COMPANION_RX_LOG_MAX_DATA) {
+        size = MC_COMPANION_RX_LOG_MAX_DATA;
+        log->counters.truncated++;
+    }
+    entry->snr         = snr;
+    entry->rssi        = rssi;
+    entry->length      = size;
+    entry->received_ms = now_ms;
+    memcpy(entry->data, data, size);
+    log->tail++;
+    log->counters.accepted++;
+    return 1;
+}
+
+uint32_t mc_companion_rx_log_pending(const mc_companion_rx_log_t* log) {
+    return log->tail - log->head;
+}
+
+static void mc_companion_rx_log_refill(mc_companion_rx_log_t* log, uint32_t now_ms) {
+    if (log->config.rate_bps == 0) {
+        log->tokens = UINT32_MAX;
+        return;
+    }
+    uint32_t elapsed = now_ms - log->refill_ms;
+    uint64_t earned  = (uint64_t)elapsed * log->config.rate_bps / 1000;
+    if (earned == 0) {
+        // Keep the remainder for the next refill instead of rounding it away
+        return;
+    }
+    log->refill_ms += (uint32_t)(earned * 1000 / log->config.rate_bps);
+    uint64_t tokens = log->tokens + earned;
+    log->tokens     = (tokens > log->config.burst_bytes) ? log->config.burst_bytes : (uint32_t)tokens;
+}
+
+int mc_companion_rx_log_flush(mc_companion_rx_log_t* log, uint32_t now_ms, bool force, size_t output_buffer_size, uint8_t* out_framed_data,
+                              size_t* out_framed_data_length) {
+    *out_framed_data_length = 0;
+    uint32_t pending        = log->tail - log->head;
+    if (pending == 0) {
+        return 0;
+    }
+    bool due = force || pending >= log->config.batch ||
+               (uint32_t)(now_ms - log->entries[log->head & MC_COMPANION_RX_LOG_MASK].received_ms) >= log->config.max_delay_ms;
+    if (!due) {
+        return 0;
+    }
+
+    mc_companion_rx_log_refill(log, now_ms);
+    mc_companion_batch_t batch;
+    uint8_t              args[2 + MC_COMPANION_RX_LOG_MAX_DATA];
+    int                  pushed = 0;
+    mc_companion_batch_init_responses(&batch, log->frame_size, output_buffer_size, out_framed_data);
+    while (log->head != log->tail) {
+        const mc_companion_rx_log_entry_t* entry = &log->entries[log->head & MC_COMPANION_RX_LOG_MASK];
+        size_t size = MC_COMPANION_RX_LOG_OVERHEAD + entry->length;
+        if (size > log->tokens) {
+            break;
+        }
+
+        args[0] = (uint8_t)entry->snr;
+        args[1] = (uint8_t)entry->rssi;
+        memcpy(&args[2], entry->data, entry->length);
+        size_t before = mc_companion_batch_length(&batch);
+        if (mc_companion_batch_add(&batch, COMPANION_PUSH_CODE_LOG_RX_DATA, args, (uint16_t)(2 + entry->length)) < 0) {
+            break;
+        }
+
+        // In a batch a push costs a byte less than on its own, or two more when it turns a plain frame into a
+        // batch frame, those two are forgiven so that the bucket never has to hold more than the largest push
+        if (log->config.rate_bps != 0) {
+            size_t cost  = mc_companion_batch_length(&batch) - before;
+            log->tokens -= (cost > log->tokens) ? log->tokens : (uint32_t)cost;
+        }
+        log->head++;
+        pushed++;
+    }
+
+    if (pushed > 0) {
+        log->counters.pushed += (uint32_t)pushed;
+        log->counters.flushes++;
+    }
+    *out_framed_data_length = mc_companion_batch_length(&batch);
+    return pushed;
+}
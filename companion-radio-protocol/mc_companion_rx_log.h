@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mc_companion.h"
+
+// Producer for LOG_RX_DATA pushes, which mirror every frame heard on the radio to the host. Frames are
+// filtered by payload type and route on their header byte before anything is copied, the ones that pass
+// wait in a bounded ring and are framed in batches: a flush writes every waiting frame back to back into
+// one buffer so the caller can hand it to the serial port in a single write. Once a larger frame size is
+// negotiated the pushes are packed into BATCH frames of that size, see mc_companion_batch.h.
+//
+// Delivery is paced by a token bucket in serial bytes per second, so the log can not take the whole link
+// from command responses. Frames wait in the ring while the bucket or the output buffer is short of room,
+// when the ring is full new frames are dropped and counted. The producer is not thread safe, push and
+// flush from the thread that owns the serial port.
+
+// Definitions
+
+#ifndef MC_COMPANION_RX_LOG_SIZE
+#define MC_COMPANION_RX_LOG_SIZE 32
+#endif
+
+_Static_assert((MC_COMPANION_RX_LOG_SIZE & (MC_COMPANION_RX_LOG_SIZE - 1)) == 0, "MC_COMPANION_RX_LOG_SIZE must be a power of two");
+
+// Framing around the logged bytes: start byte, length, push code, SNR and RSSI
+#define MC_COMPANION_RX_LOG_OVERHEAD 6
+
+// Frame bytes that fit in one push, longer frames are truncated
+#define MC_COMPANION_RX_LOG_MAX_DATA (MESHCORE_COMPANION_MAX_FRAME_SIZE - MC_COMPANION_RX_LOG_OVERHEAD)
+
+#define MC_COMPANION_RX_LOG_ALL_TYPES  0xFFFF
+#define MC_COMPANION_RX_LOG_ALL_ROUTES 0x0F
+
+typedef struct {
+    uint16_t type_mask;     // Bit n logs payload type n
+    uint8_t  route_mask;    // Bit n logs route type n
+    uint8_t  batch;         // Flush once this many frames wait
+    uint16_t max_delay_ms;  // Or once the oldest waiting frame is this old
+    uint32_t rate_bps;      // Serial bytes per second for the log, 0 for no limit
+    uint32_t burst_bytes;   // Bytes that can be sent at once after an idle period
+} mc_companion_rx_log_config_t;
+
+typedef struct {
+    uint32_t accepted;   // Frames queued
+    uint32_t filtered;   // Frames skipped by the type or route filter
+    uint32_t dropped;    // Frames dropped because the ring was full
+    uint32_t truncated;  // Frames cut to MC_COMPANION_RX_LOG_MAX_DATA bytes
+    uint32_t pushed;     // Push frames written
+    uint32_t flushes;    // Flushes that wrote at least one push frame
+} mc_companion_rx_log_counters_t;
+
+typedef struct {
+    int8_t   snr;  // Multiplied by 4
+    int8_t   rssi;
+    uint8_t  length;
+    uint32_t received_ms;
+    uint8_t  data[MC_COMPANION_RX_LOG_MAX_DATA];
+} mc_companion_rx_log_entry_t;
+
+typedef struct {
+    mc_companion_rx_log_config_t   config;
+    mc_companion_rx_log_counters_t counters;
+    uint32_t                       head;  // Next entry to flush, free running
+    uint32_t                       tail;  // Next entry to fill, free running
+    uint32_t                       tokens;
+    uint32_t                       refill_ms;
+    uint16_t                       frame_size;  // Negotiated companion frame size
+    mc_companion_rx_log_entry_t    entries[MC_COMPANION_RX_LOG_SIZE];
+} mc_companion_rx_log_t;
+
+// Functions
+
+/// Reset a log, config may be NULL to log everything in batches of 8 or after 50 ms without a rate limit
+void mc_companion_rx_log_init(mc_companion_rx_log_t* log, const mc_companion_rx_log_config_t* config, uint32_t now_ms);
+
+/// Change the payload type and route filters, frames already queued are kept
+void mc_companion_rx_log_set_filter(mc_companion_rx_log_t* log, uint16_t type_mask, uint8_t route_mask);
+
+/// Pack pushes into frames of a negotiated size from the next flush on
+void mc_companion_rx_log_set_frame_size(mc_companion_rx_log_t* log, uint16_t frame_size);
+
+/// Queue a received frame. Returns 1 when it was queued, 0 when it was filtered out and -1 when it was
+/// dropped because the ring is full or the frame is empty.
+int mc_companion_rx_log_push(mc_companion_rx_log_t* log, const uint8_t* data, uint8_t size, int8_t snr, int8_t rssi, uint32_t now_ms);
+
+/// Number of frames waiting
+uint32_t mc_companion_rx_log_pending(const mc_companion_rx_log_t* log);
+
+/// Frame waiting entries as LOG_RX_DATA pushes, back to back, when a batch is due or force is set. Stops at
+/// the first push that does not fit in the output buffer or the rate budget. Returns the number of pushes
+/// written.
+int mc_companion_rx_log_flush(mc_companion_rx_log_t* log, uint32_t now_ms, bool force, size_t output_buffer_size, uint8_t* out_framed_data,
+                              size_t* out_framed_data_length);
@@ -1,3 +1,4 @@
+#include "mc_companion_serial_interface.h"
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -5,16 +6,32 @@
 #include <stdio.h>
 #include <string.h>
 #include "mc_companion.h"
+#include "mc_companion_batch.h"
 #include "mc_companion_command_parser.h"
+#include "meshcore/latency.h"
 
 #define FIELD_SIZE(type, field) (sizeof(((type*)0)->field))
 
-static uint8_t                    rx_buffer[MESHCORE_COMPANION_MAX_FRAME_SIZE] = {0};
-static uint16_t                   rx_position                                  = 0;
-static companion_command_packet_t command_packet_buffer                        = {0};
+static companion_command_packet_t   command_packet_buffer  = {0};
+static mc_companion_framer_t        serial_framer          = {0};
+static bool                         serial_framer_ready    = false;
+static mc_companion_server_callback serial_server_callback = NULL;
 
-static void mc_companion_handle_serial_command_frame(mc_companion_server_callback callback) {
-    uint16_t length = sizeof(char) + sizeof(uint16_t) + (rx_buffer[1] | (rx_buffer[2] << 8));
+static void mc_companion_handle_command(const uint8_t* data, uint16_t length, void* context) {
+    mc_companion_framer_t* framer = (mc_companion_framer_t*)context;
+
+    MESHCORE_LATENCY_START(parse_start);
+    mc_companion_command_parser_error_t error = mc_companion_parse_command(data, length, &command_packet_buffer);
+    MESHCORE_LATENCY_END(MESHCORE_LATENCY_PARSE, parse_start);
+
+    MESHCORE_LATENCY_START(dispatch_start);
+    framer->callback(framer, &command_packet_buffer, error, framer->context);
+    MESHCORE_LATENCY_END(MESHCORE_LATENCY_DISPATCH, dispatch_start);
+}
+
+static void mc_companion_handle_command_frame(mc_companion_framer_t* framer) {
+    const uint8_t* rx_buffer = framer->rx_buffer;
+    uint32_t       length    = sizeof(char) + sizeof(uint16_t) + (rx_buffer[1] | (rx_buffer[2] << 8));
 
     // Received packet is a command
     if (length < 1) {
@@ -22,63 +39,104 @@ static void mc_companion_handle_serial_command_frame(mc_companion_server_callbac
         return;
     }
 
-    mc_companion_command_parser_error_t error = mc_companion_parse_command(&rx_buffer[3], length - 3, &command_packet_buffer);
-    callback(&command_packet_buffer, error);
+    // A batch is handled command by command, a malformed record ends it with an error for the batch
+    if (length > 3 && rx_buffer[3] == COMPANION_CMD_BATCH) {
+        if (mc_companion_batch_split(&rx_buffer[4], length - 4, mc_companion_handle_command, framer) < 0) {
+            memset(&command_packet_buffer, 0, sizeof(companion_command_packet_t));
+            command_packet_buffer.command = COMPANION_CMD_BATCH;
+            framer->callback(framer, &command_packet_buffer, COMPANION_COMMAND_PARSER_ERROR_INVALID_ARGUMENTS, framer->context);
+        }
+        return;
+    }
+
+    mc_companion_handle_command(&rx_buffer[3], (uint16_t)(length - 3), framer);
 }
 
-void mc_companion_read_serial_command(uint8_t* received_data, size_t received_data_length, mc_companion_server_callback server_callback) {
+void mc_companion_framer_init(mc_companion_framer_t* framer, mc_companion_framer_callback callback, void* context) {
+    memset(framer, 0, sizeof(mc_companion_framer_t));
+    framer->callback   = callback;
+    framer->context    = context;
+    framer->frame_size = MESHCORE_COMPANION_MAX_FRAME_SIZE;
+}
+
+void mc_companion_framer_read(mc_companion_framer_t* framer, const uint8_t* received_data, size_t received_data_length) {
+    uint8_t* rx_buffer = framer->rx_buffer;
     while (received_data_length > 0) {
-        if (rx_position == 0) {
+        if (framer->rx_position == 0) {
             // Ready to receive a frame, search for start byte
-            char start_byte = '<';
-            while (received_data_length > 0) {
-                if (*received_data == start_byte) {
-                    // Found start byte
-                    rx_buffer[rx_position] = *received_data;
-                    rx_position++;
-                    received_data = &received_data[1];
-                    received_data_length--;
-                    break;
-                } else {
-                    // printf("RX discarding byte: %02X\r\n", *received_data);
-                }
-                received_data = &received_data[1];
-                received_data_length--;
+            const uint8_t* start = memchr(received_data, '<', received_data_length);
+            if (start == NULL) {
+                return;
             }
-            continue;
-        } else if (rx_position == 1 || rx_position == 2) {
+            MESHCORE_LATENCY_MARK(framer->rx_frame_start);
+            received_data_length -= (size_t)(start - received_data) + 1;
+            received_data         = start + 1;
+            rx_buffer[0]          = '<';
+            framer->rx_position   = 1;
+        } else if (framer->rx_position == 1 || framer->rx_position == 2) {
             // Started receiving, store length bytes
-            rx_buffer[rx_position] = *received_data;
-            received_data          = &received_data[1];
-            rx_position++;
+            rx_buffer[framer->rx_position] = *received_data;
+            received_data                  = &received_data[1];
+            framer->rx_position++;
             received_data_length--;
-            continue;
         } else {
-            // Receiving data
-            uint16_t expected_length = sizeof(char) + sizeof(uint16_t) + (rx_buffer[1] | (rx_buffer[2] << 8));
-            if (expected_length > sizeof(rx_buffer)) {
+            // Receiving data, the length is computed in 32 bits so that lengths close to 0xFFFF can not wrap
+            uint32_t expected_length = sizeof(char) + sizeof(uint16_t) + (rx_buffer[1] | (rx_buffer[2] << 8));
+            if (expected_length > framer->frame_size) {
                 // Invalid packet length, reset
-                rx_position = 0;
+                framer->rx_position = 0;
                 continue;
             }
-            while (received_data_length > 0 && rx_position < expected_length) {
-                rx_buffer[rx_position] = *received_data;
-                rx_position++;
-                received_data = &received_data[1];
-                received_data_length--;
+            size_t take = expected_length - framer->rx_position;
+            if (take > received_data_length) {
+                take = received_data_length;
             }
+            memcpy(&rx_buffer[framer->rx_position], received_data, take);
+            framer->rx_position  += (uint16_t)take;
+            received_data        += take;
+            received_data_length -= take;
 
-            if (expected_length == rx_position) {
+            if (expected_length == framer->rx_position) {
                 // Received a full frame
-                mc_companion_handle_serial_command_frame(server_callback);
-                rx_position = 0;
+                MESHCORE_LATENCY_END(MESHCORE_LATENCY_FRAME, framer->rx_frame_start);
+                mc_companion_handle_command_frame(framer);
+                framer->rx_position = 0;
             }
         }
     }
 }
 
+uint16_t mc_companion_framer_set_frame_size(mc_companion_framer_t* framer, uint16_t requested) {
+    if (requested > MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE) {
+        requested = MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE;
+    }
+    framer->frame_size = (requested < MESHCORE_COMPANION_MAX_FRAME_SIZE) ? MESHCORE_COMPANION_MAX_FRAME_SIZE : requested;
+    return framer->frame_size;
+}
+
+// The serial port uses a framer of its own, passing commands on to the server callback
+
+static void mc_companion_serial_callback(mc_companion_framer_t* framer, companion_command_packet_t* command, mc_companion_command_parser_error_t error,
+                                         void* context) {
+    serial_server_callback(command, error);
+}
+
+static void mc_companion_serial_framer_ready(void) {
+    if (!serial_framer_ready) {
+        mc_companion_framer_init(&serial_framer, mc_companion_serial_callback, NULL);
+        serial_framer_ready = true;
+    }
+}
+
+void mc_companion_read_serial_command(uint8_t* received_data, size_t received_data_length, mc_companion_server_callback server_callback) {
+    mc_companion_serial_framer_ready();
+    serial_server_callback = server_callback;
+    mc_companion_framer_read(&serial_framer, received_data, received_data_length);
+}
+
 void mc_companion_write_serial_response(companion_response_packet_t* packet, uint16_t args_length, size_t output_buffer_size, uint8_t* out_framed_data,
                                         size_t* out_framed_data_length) {
+    MESHCORE_LATENCY_START(response_start);
 
     uint16_t packet_length = args_length;
     uint8_t  packet_type   = packet->response;
@@ -102,4 +160,15 @@ void mc_companion_write_serial_response(companion_response_packet_t* packet, uin
     position += packet_length;
 
     *out_framed_data_length = position - 1;
+    MESHCORE_LATENCY_END(MESHCORE_LATENCY_RESPONSE, response_start);
+}
+
+uint16_t mc_companion_set_serial_frame_size(uint16_t requested) {
+    mc_companion_serial_framer_ready();
+    return mc_companion_framer_set_frame_size(&serial_framer, requested);
+}
+
+uint16_t mc_companion_serial_frame_size(void) {
+    mc_companion_serial_framer_ready();
+    return serial_framer.frame_size;
 }
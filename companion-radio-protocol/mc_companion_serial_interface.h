@@ -9,6 +9,42 @@
 #include "mc_companion.h"
 #include "mc_companion_command_parser.h"
 
+// Receive side of the companion framing ('<', length, command, arguments). The framer does not care where
+// the bytes come from: a serial port feeds the default framer through mc_companion_read_serial_command, a
+// socket transport keeps one framer per connection, see mc_companion_socket.h.
+
+typedef struct mc_companion_framer mc_companion_framer_t;
+
+/// Called for every received command, the commands of a batch frame are passed one by one
+typedef void (*mc_companion_framer_callback)(mc_companion_framer_t* framer, companion_command_packet_t* command, mc_companion_command_parser_error_t error,
+                                             void* context);
+
+struct mc_companion_framer {
+    mc_companion_framer_callback callback;
+    void*                        context;
+    uint16_t                     rx_position;
+    uint16_t                     frame_size;      // Largest frame accepted, negotiated with DEVICE_QUERY
+    uint64_t                     rx_frame_start;  // Arrival of the start byte of the frame being received
+    uint8_t                      rx_buffer[MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE];
+};
+
+/// Reset a framer to the base frame size
+void mc_companion_framer_init(mc_companion_framer_t* framer, mc_companion_framer_callback callback, void* context);
+
+/// Feed received bytes, calls the callback for every command they complete
+void mc_companion_framer_read(mc_companion_framer_t* framer, const uint8_t* data, size_t data_length);
+
+/// Use a negotiated frame size, clamped between MESHCORE_COMPANION_MAX_FRAME_SIZE and
+/// MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE. Returns the size in use, the one to report in DEVICE_INFO.
+uint16_t mc_companion_framer_set_frame_size(mc_companion_framer_t* framer, uint16_t requested);
+
 void mc_companion_read_serial_command(uint8_t* framed_data, size_t framed_data_length, mc_companion_server_callback callback);
 void mc_companion_write_serial_response(companion_response_packet_t* packet, uint16_t args_length, size_t output_buffer_size, uint8_t* out_framed_data,
                                         size_t* out_framed_data_length);
+
+/// Use a negotiated frame size, clamped between MESHCORE_COMPANION_MAX_FRAME_SIZE and
+/// MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE. Returns the size in use, the one to report in DEVICE_INFO.
+uint16_t mc_companion_set_serial_frame_size(uint16_t requested);
+
+/// Frame size in use, responses may be packed into frames of this size with mc_companion_batch.h
+uint16_t mc_companion_serial_frame_size(void);
@@ -0,0 +1,384 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#define _GNU_SOURCE
+
+#include "mc_companion_shm.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_companion.h"
+
+#define SHM_PADDING 0xFFFFFFFFu  // Length of a padding record, the rest of the ring up to its end is unused
+
+static uint32_t shm_record_size(uint32_t length) {
+    return (MC_COMPANION_SHM_RECORD_HEADER + length + 7) & ~7u;
+}
+
+static long shm_futex(_Atomic(uint32_t)* word, int operation, uint32_t value, const struct timespec* timeout) {
+    // Shared futex operations, the word is waited on from other processes
+    return syscall(SYS_futex, (uint32_t*)word, operation, value, timeout, NULL, 0);
+}
+
+// Writing side
+
+int mc_companion_shm_create(mc_companion_shm_t* shm, const char* name, uint32_t capacity) {
+    memset(shm, 0, sizeof(mc_companion_shm_t));
+    shm->fd = -1;
+
+    if (capacity == 0) {
+        capacity = MC_COMPANION_SHM_DEFAULT_SIZE;
+    }
+    if (capacity < MC_COMPANION_SHM_MIN_SIZE || capacity > (1u << 30) || (capacity & (capacity - 1)) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (name != NULL) {
+        if (strlen(name) >= sizeof(shm->name)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        shm_unlink(name);  // A segment left behind by a server that did not exit cleanly
+        shm->fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (shm->fd >= 0) {
+            strcpy(shm->name, name);
+        }
+    } else {
+        shm->fd = memfd_create("meshcore-companion", MFD_CLOEXEC);
+    }
+    if (shm->fd < 0) {
+        return -1;
+    }
+
+    shm->size     = MC_COMPANION_SHM_HEADER_SIZE + (size_t)capacity;
+    void* segment = MAP_FAILED;
+    if (ftruncate(shm->fd, (off_t)shm->size) == 0) {
+        segment = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    }
+    if (segment == MAP_FAILED) {
+        int error = errno;
+        mc_companion_shm_close(shm);
+        errno = error;
+        return -1;
+    }
+
+    shm->header   = segment;
+    shm->ring     = (uint8_t*)segment + MC_COMPANION_SHM_HEADER_SIZE;
+    shm->capacity = capacity;
+
+    mc_companion_shm_header_t* header = shm->header;
+    header->version                   = MC_COMPANION_SHM_VERSION;
+    header->capacity                  = capacity;
+    header->max_frame                 = MC_COMPANION_SHM_MAX_FRAME;
+    atomic_store_explicit(&header->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&header->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&header->wakeups, 0, memory_order_relaxed);
+    atomic_store_explicit(&header->waiters, 0, memory_order_relaxed);
+
+    // The magic goes in last, a reader that opens the segment before this sees an invalid one
+    atomic_thread_fence(memory_order_release);
+    header->magic = MC_COMPANION_SHM_MAGIC;
+    return 0;
+}
+
+void mc_companion_shm_close(mc_companion_shm_t* shm) {
+    if (shm->header != NULL) {
+        munmap(shm->header, shm->size);
+    }
+    if (shm->fd >= 0) {
+        close(shm->fd);
+    }
+    if (shm->name[0] != '\0') {
+        shm_unlink(shm->name);
+    }
+    memset(shm, 0, sizeof(mc_companion_shm_t));
+    shm->fd = -1;
+}
+
+uint8_t* mc_companion_shm_reserve(mc_companion_shm_t* shm, size_t length) {
+    if (length == 0 || length > MC_COMPANION_SHM_MAX_FRAME) {
+        return NULL;
+    }
+
+    uint32_t mask    = shm->capacity - 1;
+    uint32_t record  = shm_record_size((uint32_t)length);
+    uint32_t offset  = shm->head & mask;
+    uint32_t padding = (offset + record > shm->capacity) ? shm->capacity - offset : 0;
+
+    // Evict the oldest records until the padding and the record fit
+    bool evicted = false;
+    while (shm->head + padding + record - shm->tail > shm->capacity) {
+        uint32_t tail_offset = shm->tail & mask;
+        uint32_t tail_length;
+        memcpy(&tail_length, &shm->ring[tail_offset], sizeof(tail_length));
+        if (tail_length == SHM_PADDING) {
+            shm->tail += shm->capacity - tail_offset;
+        } else {
+            shm->tail += shm_record_size(tail_length);
+            shm->evicted++;
+        }
+        evicted = true;
+    }
+    if (evicted) {
+        // Readers must see the new tail before any of the bytes it gave up change
+        atomic_store_explicit(&shm->header->tail, shm->tail, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+    }
+
+    if (padding > 0) {
+        uint32_t marker = SHM_PADDING;
+        memcpy(&shm->ring[offset], &marker, sizeof(marker));
+        offset = 0;
+    }
+    shm->reserved = (uint32_t)length;
+    return &shm->ring[offset + MC_COMPANION_SHM_RECORD_HEADER];
+}
+
+void mc_companion_shm_commit(mc_companion_shm_t* shm) {
+    if (shm->reserved == 0) {
+        return;
+    }
+
+    uint32_t mask   = shm->capacity - 1;
+    uint32_t record = shm_record_size(shm->reserved);
+    uint32_t offset = shm->head & mask;
+    if (offset + record > shm->capacity) {
+        shm->head += shm->capacity - offset;
+        offset     = 0;
+    }
+
+    memcpy(&shm->ring[offset], &shm->reserved, sizeof(uint32_t));
+    memcpy(&shm->ring[offset + sizeof(uint32_t)], &shm->sequence, sizeof(uint32_t));
+    shm->head     += record;
+    shm->reserved  = 0;
+    shm->sequence++;
+    shm->published++;
+    atomic_store_explicit(&shm->header->head, shm->head, memory_order_release);
+}
+
+int mc_companion_shm_publish(mc_companion_shm_t* shm, const companion_response_packet_t* packet, uint16_t args_length) {
+    // Same framing as mc_companion_write_serial_response, the length covers the code and its arguments
+    uint8_t* frame = mc_companion_shm_reserve(shm, 4 + (size_t)args_length);
+    if (frame == NULL) {
+        return -1;
+    }
+    uint16_t length = args_length + 1;
+    frame[0]        = '>';
+    frame[1]        = (length >> 0) & 0xFF;
+    frame[2]        = (length >> 8) & 0xFF;
+    frame[3]        = packet->response;
+    memcpy(&frame[4], packet->args, args_length);
+    mc_companion_shm_commit(shm);
+    return 0;
+}
+
+void mc_companion_shm_notify(mc_companion_shm_t* shm) {
+    if (shm->header == NULL || shm->head == shm->notified) {
+        return;
+    }
+    shm->notified = shm->head;
+
+    // Bumping the word first makes a reader that is about to sleep on the old value return right away
+    atomic_fetch_add(&shm->header->wakeups, 1);
+    if (atomic_load(&shm->header->waiters) > 0) {
+        shm_futex(&shm->header->wakeups, FUTEX_WAKE, INT_MAX, NULL);
+    }
+}
+
+// Reading side
+
+int mc_companion_shm_reader_attach(mc_companion_shm_reader_t* reader, int fd) {
+    memset(reader, 0, sizeof(mc_companion_shm_reader_t));
+    reader->fd = -1;
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        return -1;
+    }
+    if (status.st_size < MC_COMPANION_SHM_HEADER_SIZE + MC_COMPANION_SHM_MIN_SIZE) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Mapped writable for the waiter count, the ring itself is only read
+    size_t size    = (size_t)status.st_size;
+    void*  segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (segment == MAP_FAILED) {
+        return -1;
+    }
+
+    mc_companion_shm_header_t* header = segment;
+    uint32_t                   magic  = header->magic;
+    atomic_thread_fence(memory_order_acquire);
+    uint32_t capacity = header->capacity;
+    if (magic != MC_COMPANION_SHM_MAGIC || header->version != MC_COMPANION_SHM_VERSION || (capacity & (capacity - 1)) != 0 ||
+        MC_COMPANION_SHM_HEADER_SIZE + (size_t)capacity != size || header->max_frame > MC_COMPANION_SHM_MAX_FRAME) {
+        munmap(segment, size);
+        errno = EINVAL;
+        return -1;
+    }
+
+    reader->fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (reader->fd < 0) {
+        munmap(segment, size);
+        return -1;
+    }
+    reader->header   = header;
+    reader->ring     = (const uint8_t*)segment + MC_COMPANION_SHM_HEADER_SIZE;
+    reader->size     = size;
+    reader->capacity = capacity;
+    reader->position = atomic_load_explicit(&header->head, memory_order_acquire);
+    return 0;
+}
+
+int mc_companion_shm_reader_open(mc_companion_shm_reader_t* reader, const char* name) {
+    int fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int result = mc_companion_shm_reader_attach(reader, fd);
+    int error  = errno;
+    close(fd);
+    errno = error;
+    return result;
+}
+
+void mc_companion_shm_reader_close(mc_companion_shm_reader_t* reader) {
+    if (reader->header != NULL) {
+        munmap(reader->header, reader->size);
+    }
+    if (reader->fd >= 0) {
+        close(reader->fd);
+    }
+    memset(reader, 0, sizeof(mc_companion_shm_reader_t));
+    reader->fd = -1;
+}
+
+int mc_companion_shm_peek(mc_companion_shm_reader_t* reader, const uint8_t** out_frame, size_t* out_length) {
+    mc_companion_shm_header_t* header = reader->header;
+    uint32_t                   mask   = reader->capacity - 1;
+
+    for (;;) {
+        uint64_t head = atomic_load_explicit(&header->head, memory_order_acquire);
+        if (reader->position == head) {
+            reader->peeked = 0;
+            return 0;
+        }
+        uint64_t tail = atomic_load_explicit(&header->tail, memory_order_acquire);
+        if (reader->position < tail) {
+            // Overrun, carry on from the oldest record left, the sequence numbers tell how many were lost
+            reader->position = tail;
+            continue;
+        }
+
+        uint32_t offset = reader->position & mask;
+        uint32_t length;
+        uint32_t sequence;
+        memcpy(&length, &reader->ring[offset], sizeof(length));
+        memcpy(&sequence, &reader->ring[offset + sizeof(uint32_t)], sizeof(sequence));
+
+        // Only trust what was read when the record was not given up meanwhile
+        atomic_thread_fence(memory_order_acquire);
+        if (reader->position < atomic_load_explicit(&header->tail, memory_order_relaxed)) {
+            continue;
+        }
+
+        if (length == SHM_PADDING) {
+            reader->position += reader->capacity - offset;
+            continue;
+        }
+        if (length == 0 || length > header->max_frame || offset + shm_record_size(length) > reader->capacity) {
+            // Not a record boundary, which the server never leaves behind: start over from the newest frame
+            reader->position = head;
+            reader->synced   = false;
+            continue;
+        }
+
+        if (reader->synced) {
+            reader->lost += sequence - reader->sequence;
+        }
+        reader->synced   = true;
+        reader->sequence = sequence;
+        reader->peeked   = length;
+        *out_frame       = &reader->ring[offset + MC_COMPANION_SHM_RECORD_HEADER];
+        *out_length      = length;
+        return 1;
+    }
+}
+
+int mc_companion_shm_consume(mc_companion_shm_reader_t* reader) {
+    if (reader->peeked == 0) {
+        return 0;
+    }
+
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t tail     = atomic_load_explicit(&reader->header->tail, memory_order_relaxed);
+    uint64_t position = reader->position;
+    reader->position += shm_record_size(reader->peeked);
+    reader->sequence++;
+    reader->peeked = 0;
+
+    if (position < tail) {
+        reader->lost++;
+        return -1;
+    }
+    reader->received++;
+    return 0;
+}
+
+int mc_companion_shm_wait(mc_companion_shm_reader_t* reader, int timeout_ms) {
+    mc_companion_shm_header_t* header = reader->header;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec  += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    for (;;) {
+        // Load the futex word before looking at the head, a notify in between then makes the wait return at once
+        uint32_t wakeups = atomic_load(&header->wakeups);
+        if (atomic_load(&header->head) != reader->position) {
+            return 1;
+        }
+
+        // A wakeup may be for frames that were already read, so sleep again until the deadline
+        struct timespec timeout = {0};
+        if (timeout_ms >= 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            timeout.tv_sec  = deadline.tv_sec - now.tv_sec;
+            timeout.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+            if (timeout.tv_nsec < 0) {
+                timeout.tv_sec--;
+                timeout.tv_nsec += 1000000000;
+            }
+            if (timeout.tv_sec < 0) {
+                return 0;
+            }
+        }
+
+        atomic_fetch_add(&header->waiters, 1);
+        long result = shm_futex(&header->wakeups, FUTEX_WAIT, wakeups, (timeout_ms < 0) ? NULL : &timeout);
+        int  error  = errno;
+        atomic_fetch_sub(&header->waiters, 1);
+        if (result < 0 && error == ETIMEDOUT) {
+            return (atomic_load(&header->head) != reader->position) ? 1 : 0;
+        }
+    }
+}
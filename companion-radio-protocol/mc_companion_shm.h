@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mc_companion.h"
+
+// Shared memory transport from a companion server to local apps on the same Linux host, such as a logger,
+// a map service or a bridge. The server writes framed responses and pushes ('>', length, code, arguments)
+// into a ring in a shared memory segment, every reader maps the segment and reads the frames where they
+// lie, without a system call or a copy per frame. Readers sleep on a futex in the segment, the server wakes
+// them once per batch of frames with mc_companion_shm_notify.
+//
+// The ring has one writer and any number of readers, each with a read position of its own in its own
+// memory, so readers never hold up the server or each other. A reader that falls behind by more than the
+// ring size loses the oldest frames, which it learns from the sequence numbers and counts in lost. A frame
+// may be overwritten while a reader looks at it, so a reader checks with mc_companion_shm_consume that it
+// was intact before acting on what it read, the same way a seqlock is read.
+//
+// Records are eight byte aligned: a little header with the frame length and a sequence number, then the
+// frame. A record that would run past the end of the ring is preceded by a padding record and starts over
+// at the beginning, so every frame is contiguous.
+
+// Definitions
+
+#ifndef MC_COMPANION_SHM_DEFAULT_SIZE
+#define MC_COMPANION_SHM_DEFAULT_SIZE (1u << 20)
+#endif
+
+#define MC_COMPANION_SHM_MAGIC         0x4853434Du  // "MCSH"
+#define MC_COMPANION_SHM_VERSION       1
+#define MC_COMPANION_SHM_HEADER_SIZE   256  // Segment header in front of the ring
+#define MC_COMPANION_SHM_RECORD_HEADER 8
+#define MC_COMPANION_SHM_MAX_FRAME     MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE
+#define MC_COMPANION_SHM_MIN_SIZE      (8 * (MC_COMPANION_SHM_RECORD_HEADER + MC_COMPANION_SHM_MAX_FRAME))
+
+_Static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "shared memory ring needs lock free atomics");
+
+/// Layout of the start of the segment, shared by every process that maps it
+typedef struct {
+    uint32_t                       magic;
+    uint32_t                       version;
+    uint32_t                       capacity;  // Bytes of the ring behind the header, a power of two
+    uint32_t                       max_frame;
+    _Alignas(64) _Atomic(uint64_t) head;     // End of the newest published record, free running
+    _Atomic(uint64_t)              tail;     // Start of the oldest record not yet overwritten, free running
+    _Alignas(64) _Atomic(uint32_t) wakeups;  // Futex word, bumped by every notify
+    _Atomic(uint32_t)              waiters;  // Readers sleeping on the futex word
+} mc_companion_shm_header_t;
+
+_Static_assert(sizeof(mc_companion_shm_header_t) <= MC_COMPANION_SHM_HEADER_SIZE, "MC_COMPANION_SHM_HEADER_SIZE too small");
+
+/// Writing side, owned by the companion server
+typedef struct {
+    mc_companion_shm_header_t* header;
+    uint8_t*                   ring;
+    size_t                     size;  // Bytes mapped
+    int                        fd;
+    uint32_t                   capacity;
+    uint32_t                   sequence;  // Sequence number of the next record
+    uint32_t                   reserved;  // Length of the reserved frame, 0 when none
+    uint64_t                   head;
+    uint64_t                   tail;
+    uint64_t                   notified;   // Head at the last notify
+    uint64_t                   published;  // Frames published
+    uint64_t                   evicted;    // Frames overwritten to make room
+    char                       name[64];   // Shared memory object to unlink on close, empty for a memfd
+} mc_companion_shm_t;
+
+/// Reading side, one per local app
+typedef struct {
+    mc_companion_shm_header_t* header;
+    const uint8_t*             ring;
+    size_t                     size;
+    int                        fd;
+    uint32_t                   capacity;
+    bool                       synced;    // The sequence number of the next record is known
+    uint32_t                   sequence;  // Sequence number of the next record
+    uint32_t                   peeked;    // Length of the frame returned by the last peek, 0 when none
+    uint64_t                   position;  // Next record to read, free running
+    uint64_t                   received;  // Frames read intact
+    uint64_t                   lost;      // Frames overwritten before they were read
+} mc_companion_shm_reader_t;
+
+// Functions
+
+/// Create a segment with a ring of capacity bytes (0 for MC_COMPANION_SHM_DEFAULT_SIZE, otherwise a power of
+/// two of at least MC_COMPANION_SHM_MIN_SIZE). With a name such as "/meshcore-companion" readers open it by
+/// that name, a stale segment of the same name is replaced. Without a name the segment is an anonymous memfd
+/// and readers attach to its descriptor. Returns -1 with errno set on failure.
+int mc_companion_shm_create(mc_companion_shm_t* shm, const char* name, uint32_t capacity);
+
+/// Unmap the segment, a named one is removed
+void mc_companion_shm_close(mc_companion_shm_t* shm);
+
+/// Reserve room for a frame of length bytes, overwriting the oldest frames when the ring is full. Returns
+/// where to write the frame, or NULL when it is longer than MC_COMPANION_SHM_MAX_FRAME. Readers see the frame
+/// once it is committed.
+uint8_t* mc_companion_shm_reserve(mc_companion_shm_t* shm, size_t length);
+
+/// Publish the reserved frame
+void mc_companion_shm_commit(mc_companion_shm_t* shm);
+
+/// Frame a response or push with args_length argument bytes straight into the ring and publish it
+int mc_companion_shm_publish(mc_companion_shm_t* shm, const companion_response_packet_t* packet, uint16_t args_length);
+
+/// Wake the readers waiting for frames, when any were published since the last notify
+void mc_companion_shm_notify(mc_companion_shm_t* shm);
+
+/// Open a named segment for reading, from the frames published after this call on. Returns -1 with errno
+/// set on failure.
+int mc_companion_shm_reader_open(mc_companion_shm_reader_t* reader, const char* name);
+
+/// Read from a segment by its descriptor, for instance a memfd passed over a Unix socket. The reader keeps
+/// its own descriptor, the one passed in may be closed.
+int mc_companion_shm_reader_attach(mc_companion_shm_reader_t* reader, int fd);
+
+/// Unmap a segment
+void mc_companion_shm_reader_close(mc_companion_shm_reader_t* reader);
+
+/// Look at the next frame without copying it. Returns 1 with the frame, 0 when there is none.
+int mc_companion_shm_peek(mc_companion_shm_reader_t* reader, const uint8_t** out_frame, size_t* out_length);
+
+/// Move past the frame returned by the last peek. Returns 0 when the frame was intact while it was looked
+/// at, -1 when the server overwrote it meanwhile and whatever was read from it must be dropped.
+int mc_companion_shm_consume(mc_companion_shm_reader_t* reader);
+
+/// Wait up to timeout_ms (-1 for no limit) for a frame to read. Returns 1 when there is one, 0 otherwise.
+int mc_companion_shm_wait(mc_companion_shm_reader_t* reader, int timeout_ms);
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "mc_companion_signer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "crypto/sha512.h"
+
+void mc_companion_signer_init(mc_companion_signer_t* signer, uint32_t maximum_length, mc_companion_sign_prehashed sign, void* context) {
+    memset(signer, 0, sizeof(mc_companion_signer_t));
+    signer->sign           = sign;
+    signer->context        = context;
+    signer->maximum_length = (maximum_length > 0) ? maximum_length : MC_COMPANION_SIGN_MAX_LENGTH;
+}
+
+uint32_t mc_companion_signer_start(mc_companion_signer_t* signer) {
+    Sha512Initialise(&signer->hash);
+    signer->length = 0;
+    signer->active = true;
+    return signer->maximum_length;
+}
+
+mc_companion_signer_status_t mc_companion_signer_data(mc_companion_signer_t* signer, const uint8_t* data, size_t length) {
+    if (!signer->active) {
+        return MC_COMPANION_SIGNER_NOT_STARTED;
+    }
+    if (length > signer->maximum_length - signer->length) {
+        signer->active = false;
+        return MC_COMPANION_SIGNER_TOO_LONG;
+    }
+    Sha512Update(&signer->hash, data, (uint32_t)length);
+    signer->length += (uint32_t)length;
+    return MC_COMPANION_SIGNER_OK;
+}
+
+int mc_companion_signer_finish(mc_companion_signer_t* signer, uint8_t out_signature[MC_COMPANION_SIGNATURE_SIZE]) {
+    if (!signer->active) {
+        return -1;
+    }
+    signer->active = false;
+
+    SHA512_HASH digest;
+    Sha512Finalise(&signer->hash, &digest);
+    int result = (signer->sign != NULL) ? signer->sign(digest.bytes, out_signature, signer->context) : -1;
+    memset(&digest, 0, sizeof(digest));
+    return result;
+}
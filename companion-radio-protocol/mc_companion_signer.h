@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto/sha512.h"
+
+// Streaming signer behind SIGN_START, SIGN_DATA and SIGN_FINISH. Instead of collecting the document up to
+// the advertised maximum length and signing it when it is complete, every SIGN_DATA chunk is absorbed into
+// a SHA-512 state as it arrives, so memory use does not depend on the document size and SIGN_FINISH only
+// has to finish the hash and sign 64 bytes.
+//
+// Signing a SHA-512 prehash is Ed25519ph (RFC 8032), the host verifies the signature as such rather than as
+// plain Ed25519 over the document. The private key operation is left to a callback, which signs the digest
+// with the node's identity key wherever that key lives (a secure element or a crypto library).
+
+// Definitions
+
+#ifndef MC_COMPANION_SIGN_MAX_LENGTH
+#define MC_COMPANION_SIGN_MAX_LENGTH (8 * 1024)
+#endif
+
+#define MC_COMPANION_SIGNATURE_SIZE 64
+
+typedef enum {
+    MC_COMPANION_SIGNER_OK          = 0,
+    MC_COMPANION_SIGNER_NOT_STARTED = -1,  // No SIGN_START since the last SIGN_FINISH or rejected chunk
+    MC_COMPANION_SIGNER_TOO_LONG    = -2,  // The chunk would take the document past the maximum length
+} mc_companion_signer_status_t;
+
+/// Sign a SHA-512 prehash, returns 0 on success or -1 on failure
+typedef int (*mc_companion_sign_prehashed)(const uint8_t digest[SHA512_HASH_SIZE], uint8_t out_signature[MC_COMPANION_SIGNATURE_SIZE],
+                                           void* context);
+
+typedef struct {
+    mc_companion_sign_prehashed sign;
+    void*                       context;
+    uint32_t                    maximum_length;
+    uint32_t                    length;  // Bytes absorbed since SIGN_START
+    bool                        active;  // Between SIGN_START and SIGN_FINISH
+    Sha512Context               hash;
+} mc_companion_signer_t;
+
+// Functions
+
+/// Prepare a signer for documents of up to maximum_length bytes (0 for MC_COMPANION_SIGN_MAX_LENGTH)
+void mc_companion_signer_init(mc_companion_signer_t* signer, uint32_t maximum_length, mc_companion_sign_prehashed sign, void* context);
+
+/// Start a new document, abandoning one in progress. Returns the maximum length for the SIGN_START response.
+uint32_t mc_companion_signer_start(mc_companion_signer_t* signer);
+
+/// Absorb the next chunk of the document. Returns MC_COMPANION_SIGNER_NOT_STARTED when no document was
+/// started, or MC_COMPANION_SIGNER_TOO_LONG when the chunk would take it past the maximum length, the document
+/// is then abandoned.
+mc_companion_signer_status_t mc_companion_signer_data(mc_companion_signer_t* signer, const uint8_t* data, size_t length);
+
+/// Finish the document and sign it. Returns -1 when no document was started or signing failed.
+int mc_companion_signer_finish(mc_companion_signer_t* signer, uint8_t out_signature[MC_COMPANION_SIGNATURE_SIZE]);
@@ -0,0 +1,445 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "mc_companion_socket.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_companion.h"
+#include "mc_companion_command_parser.h"
+#include "mc_companion_serial_interface.h"
+#include "mc_companion_websocket.h"
+
+#define SOCKET_LISTEN_BACKLOG 128
+#define SOCKET_READ_SIZE      4096
+
+#define SOCKET_STATUS_NORMAL 1000
+
+static uint32_t socket_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static int socket_index(const mc_companion_socket_connection_t* connection) {
+    return (int)(connection - connection->server->connections);
+}
+
+static uint32_t socket_queued(const mc_companion_socket_connection_t* connection) {
+    return connection->tx_tail - connection->tx_head;
+}
+
+// Copy into the ring, the caller made sure there is room
+static void socket_queue(mc_companion_socket_connection_t* connection, const uint8_t* data, size_t length) {
+    uint32_t offset = connection->tx_tail & (MC_COMPANION_SOCKET_TX_SIZE - 1);
+    size_t   first  = MC_COMPANION_SOCKET_TX_SIZE - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&connection->tx[offset], data, first);
+    memcpy(connection->tx, &data[first], length - first);
+    connection->tx_tail += (uint32_t)length;
+}
+
+// Write as much of the ring as the socket takes, both parts of a wrapped ring in one call. Returns -1 when
+// the connection failed.
+static int socket_write(mc_companion_socket_connection_t* connection) {
+    mc_companion_socket_counters_t* counters = &connection->server->counters;
+    while (socket_queued(connection) > 0) {
+        uint32_t     queued = socket_queued(connection);
+        uint32_t     offset = connection->tx_head & (MC_COMPANION_SOCKET_TX_SIZE - 1);
+        uint32_t     first  = MC_COMPANION_SOCKET_TX_SIZE - offset;
+        struct iovec parts[2];
+        if (first > queued) {
+            first = queued;
+        }
+        parts[0] = (struct iovec){.iov_base = &connection->tx[offset], .iov_len = first};
+        parts[1] = (struct iovec){.iov_base = connection->tx, .iov_len = queued - first};
+
+        // sendmsg rather than writev, a peer that went away must not raise SIGPIPE
+        struct msghdr message = {.msg_iov = parts, .msg_iovlen = (queued > first) ? 2 : 1};
+        ssize_t       sent    = sendmsg(connection->fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        connection->tx_head += (uint32_t)sent;
+        counters->sent      += (uint64_t)sent;
+        counters->writes++;
+    }
+    return 0;
+}
+
+static void socket_release(mc_companion_socket_connection_t* connection) {
+    close(connection->fd);
+    connection->fd    = -1;
+    connection->state = MC_COMPANION_SOCKET_FREE;
+    connection->server->counters.closed++;
+}
+
+// Stop taking input, the connection is released once what is queued has been written or linger_ms has passed
+static void socket_linger(mc_companion_socket_connection_t* connection) {
+    connection->state           = MC_COMPANION_SOCKET_CLOSING;
+    connection->linger_until_ms = socket_now_ms() + (uint32_t)connection->server->linger_ms;
+}
+
+// The connection failed, there is nobody left to write what is queued to
+static void socket_abort(mc_companion_socket_connection_t* connection) {
+    connection->tx_head = connection->tx_tail;
+    socket_linger(connection);
+}
+
+// Queue a WebSocket frame from the server, the caller made sure there is room
+static void socket_queue_frame(mc_companion_socket_connection_t* connection, uint8_t opcode, const uint8_t* data, size_t length) {
+    uint8_t header[MC_COMPANION_WEBSOCKET_MAX_HEADER];
+    socket_queue(connection, header, mc_companion_websocket_header(opcode, length, NULL, header));
+    socket_queue(connection, data, length);
+}
+
+// Stop taking input and close once the ring has been flushed, a WebSocket peer is told the status first
+static void socket_closing(mc_companion_socket_connection_t* connection, uint16_t status) {
+    if (connection->state == MC_COMPANION_SOCKET_CLOSING || connection->state == MC_COMPANION_SOCKET_FREE) {
+        return;
+    }
+    uint8_t payload[2] = {(status >> 8) & 0xFF, (status >> 0) & 0xFF};
+    if (connection->transport == MC_COMPANION_SOCKET_WEBSOCKET && connection->state == MC_COMPANION_SOCKET_OPEN && status != 0 &&
+        MC_COMPANION_SOCKET_TX_SIZE - socket_queued(connection) >= 2 + sizeof(payload)) {
+        socket_queue_frame(connection, MC_COMPANION_WEBSOCKET_OPCODE_CLOSE, payload, sizeof(payload));
+    }
+    socket_linger(connection);
+}
+
+static void socket_framer_callback(mc_companion_framer_t* framer, companion_command_packet_t* command, mc_companion_command_parser_error_t error,
+                                   void* context) {
+    mc_companion_socket_connection_t* connection = (mc_companion_socket_connection_t*)context;
+    mc_companion_socket_server_t*     server     = connection->server;
+
+    // Commands behind one that closed the connection are not answered
+    if (connection->state == MC_COMPANION_SOCKET_OPEN) {
+        server->callback(server, socket_index(connection), command, error, server->context);
+    }
+}
+
+static void socket_websocket_callback(uint8_t opcode, const uint8_t* data, size_t length, void* context) {
+    mc_companion_socket_connection_t* connection = (mc_companion_socket_connection_t*)context;
+    if (connection->state != MC_COMPANION_SOCKET_OPEN) {
+        return;
+    }
+
+    switch (opcode) {
+        case MC_COMPANION_WEBSOCKET_OPCODE_TEXT:
+        case MC_COMPANION_WEBSOCKET_OPCODE_BINARY:
+            mc_companion_framer_read(&connection->framer, data, length);
+            break;
+        case MC_COMPANION_WEBSOCKET_OPCODE_PING:
+            if (MC_COMPANION_SOCKET_TX_SIZE - socket_queued(connection) >= MC_COMPANION_WEBSOCKET_MAX_HEADER + length) {
+                socket_queue_frame(connection, MC_COMPANION_WEBSOCKET_OPCODE_PONG, data, length);
+            }
+            break;
+        case MC_COMPANION_WEBSOCKET_OPCODE_CLOSE:
+            // Echo the status of the peer, or close normally when it did not give one
+            socket_closing(connection, (length >= 2) ? (uint16_t)((data[0] << 8) | data[1]) : SOCKET_STATUS_NORMAL);
+            break;
+        default:
+            break;
+    }
+}
+
+static void socket_receive_websocket(mc_companion_socket_connection_t* connection, uint8_t* data, size_t length) {
+    if (mc_companion_websocket_decode(&connection->websocket, data, length) < 0) {
+        connection->server->counters.errors++;
+        socket_closing(connection, MC_COMPANION_WEBSOCKET_STATUS_ERROR);
+    }
+}
+
+// Collect the opening handshake of a WebSocket connection, frames may follow it in the same read
+static void socket_receive_handshake(mc_companion_socket_connection_t* connection, uint8_t* data, size_t length) {
+    size_t room = MC_COMPANION_SOCKET_REQUEST_SIZE - connection->request_length;
+    size_t take = (length < room) ? length : room;
+    memcpy(&connection->request[connection->request_length], data, take);
+    connection->request_length += (uint16_t)take;
+
+    char   response[256];
+    size_t request_length = 0;
+    int    response_length =
+        mc_companion_websocket_handshake((const char*)connection->request, connection->request_length, sizeof(response), response, &request_length);
+    if (response_length == 0 && connection->request_length < MC_COMPANION_SOCKET_REQUEST_SIZE) {
+        return;
+    }
+    if (response_length <= 0) {
+        response_length = mc_companion_websocket_reject(sizeof(response), response);
+        socket_queue(connection, (const uint8_t*)response, (size_t)response_length);
+        connection->server->counters.errors++;
+        socket_linger(connection);
+        return;
+    }
+
+    socket_queue(connection, (const uint8_t*)response, (size_t)response_length);
+    connection->state = MC_COMPANION_SOCKET_OPEN;
+    if (request_length < connection->request_length) {
+        socket_receive_websocket(connection, &connection->request[request_length], connection->request_length - request_length);
+    }
+    if (take < length && connection->state == MC_COMPANION_SOCKET_OPEN) {
+        socket_receive_websocket(connection, &data[take], length - take);
+    }
+}
+
+static void socket_receive(mc_companion_socket_connection_t* connection) {
+    uint8_t buffer[SOCKET_READ_SIZE];
+    ssize_t received = recv(connection->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (received < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return;
+    }
+    if (received == 0) {
+        // The peer shut down its side, it may still read the responses to what it sent before
+        socket_linger(connection);
+        return;
+    }
+    if (received < 0) {
+        socket_abort(connection);
+        return;
+    }
+    connection->server->counters.received += (uint64_t)received;
+
+    switch (connection->state) {
+        case MC_COMPANION_SOCKET_HANDSHAKE:
+            socket_receive_handshake(connection, buffer, (size_t)received);
+            break;
+        case MC_COMPANION_SOCKET_OPEN:
+            if (connection->transport == MC_COMPANION_SOCKET_WEBSOCKET) {
+                socket_receive_websocket(connection, buffer, (size_t)received);
+            } else {
+                mc_companion_framer_read(&connection->framer, buffer, (size_t)received);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void socket_set_nodelay(int fd, bool nodelay) {
+    int enable = nodelay ? 1 : 0;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+// Take every connection waiting on a listener
+static void socket_accept(mc_companion_socket_server_t* server, int listener) {
+    for (;;) {
+        int fd = accept(server->listeners[listener], NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;
+        }
+
+        mc_companion_socket_connection_t* connection = NULL;
+        for (int index = 0; index < MC_COMPANION_SOCKET_MAX_CONNECTIONS; index++) {
+            if (server->connections[index].state == MC_COMPANION_SOCKET_FREE) {
+                connection = &server->connections[index];
+                break;
+            }
+        }
+        if (connection == NULL || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0 || fcntl(fd, F_SETFD, FD_CLOEXEC) != 0) {
+            close(fd);
+            server->counters.refused++;
+            continue;
+        }
+        socket_set_nodelay(fd, server->nodelay);
+
+        connection->fd             = fd;
+        connection->transport      = server->listener_transports[listener];
+        connection->state          = (connection->transport == MC_COMPANION_SOCKET_WEBSOCKET) ? MC_COMPANION_SOCKET_HANDSHAKE : MC_COMPANION_SOCKET_OPEN;
+        connection->request_length = 0;
+        connection->tx_head        = 0;
+        connection->tx_tail        = 0;
+        mc_companion_framer_init(&connection->framer, socket_framer_callback, connection);
+        mc_companion_websocket_decoder_init(&connection->websocket, true, socket_websocket_callback, connection);
+        server->counters.accepted++;
+    }
+}
+
+void mc_companion_socket_init(mc_companion_socket_server_t* server, mc_companion_socket_callback callback, void* context) {
+    memset(server, 0, sizeof(mc_companion_socket_server_t));
+    server->callback        = callback;
+    server->context         = context;
+    server->nodelay         = true;
+    server->linger_ms       = MC_COMPANION_SOCKET_LINGER_MS;
+    for (int index = 0; index < MC_COMPANION_SOCKET_MAX_CONNECTIONS; index++) {
+        server->connections[index].server = server;
+        server->connections[index].fd     = -1;
+    }
+}
+
+int mc_companion_socket_listen(mc_companion_socket_server_t* server, mc_companion_socket_transport_t transport, const char* address, uint16_t port) {
+    struct sockaddr_in bind_address = {
+        .sin_family = AF_INET,
+        .sin_port   = htons(port),
+    };
+    if (server->listener_count == MC_COMPANION_SOCKET_MAX_LISTENERS || inet_pton(AF_INET, address, &bind_address.sin_addr) != 1) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (bind(fd, (const struct sockaddr*)&bind_address, sizeof(bind_address)) != 0 || listen(fd, SOCKET_LISTEN_BACKLOG) != 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+
+    server->listeners[server->listener_count]           = fd;
+    server->listener_transports[server->listener_count] = (uint8_t)transport;
+    server->listener_count++;
+    return 0;
+}
+
+void mc_companion_socket_set_nodelay(mc_companion_socket_server_t* server, bool nodelay) {
+    server->nodelay = nodelay;
+    for (int index = 0; index < MC_COMPANION_SOCKET_MAX_CONNECTIONS; index++) {
+        if (server->connections[index].state != MC_COMPANION_SOCKET_FREE) {
+            socket_set_nodelay(server->connections[index].fd, nodelay);
+        }
+    }
+}
+
+int mc_companion_socket_pollfds(mc_companion_socket_server_t* server, struct pollfd* out_descriptors, int max) {
+    int count = 0;
+    for (int listener = 0; listener < server->listener_count && count < max; listener++) {
+        out_descriptors[count]  = (struct pollfd){.fd = server->listeners[listener], .events = POLLIN};
+        server->polled[count++] = (int16_t)(-1 - listener);
+    }
+    for (int index = 0; index < MC_COMPANION_SOCKET_MAX_CONNECTIONS && count < max; index++) {
+        mc_companion_socket_connection_t* connection = &server->connections[index];
+        if (connection->state == MC_COMPANION_SOCKET_FREE) {
+            continue;
+        }
+        // Only wait for room to write when a flush could not write everything, a closing connection is not read
+        short events            = ((connection->state != MC_COMPANION_SOCKET_CLOSING) ? POLLIN : 0) | ((socket_queued(connection) > 0) ? POLLOUT : 0);
+        out_descriptors[count]  = (struct pollfd){.fd = connection->fd, .events = events};
+        server->polled[count++] = (int16_t)index;
+    }
+    server->polled_count = (uint16_t)count;
+    return count;
+}
+
+void mc_companion_socket_process(mc_companion_socket_server_t* server, const struct pollfd* descriptors, int count) {
+    if (count > server->polled_count) {
+        count = server->polled_count;
+    }
+    for (int position = 0; position < count; position++) {
+        if (descriptors[position].revents == 0) {
+            continue;
+        }
+        int polled = server->polled[position];
+        if (polled < 0) {
+            socket_accept(server, -1 - polled);
+            continue;
+        }
+        mc_companion_socket_connection_t* connection = &server->connections[polled];
+        if (connection->fd != descriptors[position].fd || connection->state == MC_COMPANION_SOCKET_FREE || connection->state == MC_COMPANION_SOCKET_CLOSING) {
+            continue;
+        }
+        if (descriptors[position].revents & (POLLIN | POLLHUP | POLLERR)) {
+            socket_receive(connection);
+        }
+    }
+}
+
+int mc_companion_socket_send(mc_companion_socket_server_t* server, int connection_index, const uint8_t* data, size_t length) {
+    if (connection_index < 0 || connection_index >= MC_COMPANION_SOCKET_MAX_CONNECTIONS) {
+        return -1;
+    }
+    mc_companion_socket_connection_t* connection = &server->connections[connection_index];
+    size_t                            needed     = length + ((connection->transport == MC_COMPANION_SOCKET_WEBSOCKET) ? MC_COMPANION_WEBSOCKET_MAX_HEADER : 0);
+    if (connection->state != MC_COMPANION_SOCKET_OPEN || needed > MC_COMPANION_SOCKET_TX_SIZE) {
+        return -1;
+    }
+
+    // Make room by writing out what the socket takes now. A peer that is a full ring behind is not keeping up,
+    // it gets what is queued while the connection lingers and is then closed.
+    if (MC_COMPANION_SOCKET_TX_SIZE - socket_queued(connection) < needed) {
+        if (socket_write(connection) < 0) {
+            socket_abort(connection);
+            return -1;
+        }
+        if (MC_COMPANION_SOCKET_TX_SIZE - socket_queued(connection) < needed) {
+            server->counters.overflows++;
+            socket_linger(connection);
+            return -1;
+        }
+    }
+
+    if (connection->transport == MC_COMPANION_SOCKET_WEBSOCKET) {
+        socket_queue_frame(connection, MC_COMPANION_WEBSOCKET_OPCODE_BINARY, data, length);
+    } else {
+        socket_queue(connection, data, length);
+    }
+    return 0;
+}
+
+static void socket_flush(mc_companion_socket_server_t* server, bool final) {
+    uint32_t now_ms = socket_now_ms();
+    for (int index = 0; index < MC_COMPANION_SOCKET_MAX_CONNECTIONS; index++) {
+        mc_companion_socket_connection_t* connection = &server->connections[index];
+        if (connection->state == MC_COMPANION_SOCKET_FREE) {
+            continue;
+        }
+        if (socket_queued(connection) > 0 && socket_write(connection) < 0) {
+            socket_abort(connection);
+        }
+        // A peer that does not read what is left in time loses it
+        if (connection->state == MC_COMPANION_SOCKET_CLOSING &&
+            (final || socket_queued(connection) == 0 || (int32_t)(now_ms - connection->linger_until_ms) >= 0)) {
+            socket_release(connection);
+        }
+    }
+}
+
+void mc_companion_socket_flush(mc_companion_socket_server_t* server) {
+    socket_flush(server, false);
+}
+
+void mc_companion_socket_close(mc_companion_socket_server_t* server, int connection) {
+    if (connection >= 0 && connection < MC_COMPANION_SOCKET_MAX_CONNECTIONS) {
+        socket_closing(&server->connections[connection], SOCKET_STATUS_NORMAL);
+    }
+}
+
+void mc_companion_socket_shutdown(mc_companion_socket_server_t* server) {
+    for (int index = 0; index < MC_COMPANION_SOCKET_MAX_CONNECTIONS; index++) {
+        mc_companion_socket_close(server, index);
+    }
+    socket_flush(server, true);
+    for (int listener = 0; listener < server->listener_count; listener++) {
+        close(server->listeners[listener]);
+    }
+    server->listener_count = 0;
+}
+
+int mc_companion_socket_connections(const mc_companion_socket_server_t* server) {
+    int count = 0;
+    for (int index = 0; index < MC_COMPANION_SOCKET_MAX_CONNECTIONS; index++) {
+        count += (server->connections[index].state != MC_COMPANION_SOCKET_FREE) ? 1 : 0;
+    }
+    return count;
+}
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <poll.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mc_companion.h"
+#include "mc_companion_command_parser.h"
+#include "mc_companion_serial_interface.h"
+#include "mc_companion_websocket.h"
+
+// Companion protocol over TCP and WebSocket for POSIX hosts, so one gateway can serve many remote apps. A
+// TCP connection carries the same byte stream as a serial port, a WebSocket connection carries it in binary
+// messages, and both feed a framer of their own (see mc_companion_serial_interface.h) so every connection
+// negotiates its own frame size.
+//
+// Sockets never block. Responses are queued in a ring per connection and written out by
+// mc_companion_socket_flush with one gathering write per connection, so everything answered in a pass of
+// the event loop leaves in as few segments as possible. That is also why Nagle's algorithm is off by
+// default: the queue already coalesces, and the delay would only stretch the round trip of every command.
+// Sending never waits either: the ring holds a full contact sync, and a connection that has not read enough
+// to make room for the next response is closed, so one stalled peer never holds up the others. A closing
+// connection, including one whose peer shut down its side, is given up to linger_ms to read what is queued.
+//
+// The caller owns the event loop: it polls the descriptors from mc_companion_socket_pollfds and passes them
+// back to mc_companion_socket_process. Not thread safe, drive a server from one thread.
+
+// Definitions
+
+#ifndef MC_COMPANION_SOCKET_MAX_CONNECTIONS
+#define MC_COMPANION_SOCKET_MAX_CONNECTIONS 256
+#endif
+
+#ifndef MC_COMPANION_SOCKET_TX_SIZE
+#define MC_COMPANION_SOCKET_TX_SIZE 65536
+#endif
+
+#ifndef MC_COMPANION_SOCKET_REQUEST_SIZE
+#define MC_COMPANION_SOCKET_REQUEST_SIZE 2048
+#endif
+
+#ifndef MC_COMPANION_SOCKET_LINGER_MS
+#define MC_COMPANION_SOCKET_LINGER_MS 1000
+#endif
+
+#define MC_COMPANION_SOCKET_MAX_LISTENERS 4
+#define MC_COMPANION_SOCKET_MAX_POLLFDS   (MC_COMPANION_SOCKET_MAX_LISTENERS + MC_COMPANION_SOCKET_MAX_CONNECTIONS)
+
+_Static_assert((MC_COMPANION_SOCKET_TX_SIZE & (MC_COMPANION_SOCKET_TX_SIZE - 1)) == 0, "MC_COMPANION_SOCKET_TX_SIZE must be a power of two");
+_Static_assert(MC_COMPANION_SOCKET_TX_SIZE >= 2 * MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE + MC_COMPANION_WEBSOCKET_MAX_HEADER,
+               "MC_COMPANION_SOCKET_TX_SIZE too small");
+_Static_assert(MC_COMPANION_SOCKET_MAX_CONNECTIONS <= INT16_MAX, "MC_COMPANION_SOCKET_MAX_CONNECTIONS too large");
+
+typedef enum {
+    MC_COMPANION_SOCKET_TCP       = 0,
+    MC_COMPANION_SOCKET_WEBSOCKET = 1,
+} mc_companion_socket_transport_t;
+
+typedef enum {
+    MC_COMPANION_SOCKET_FREE      = 0,
+    MC_COMPANION_SOCKET_HANDSHAKE = 1,  // WebSocket connection waiting for its opening handshake
+    MC_COMPANION_SOCKET_OPEN      = 2,
+    MC_COMPANION_SOCKET_CLOSING   = 3,  // Closed once what is queued has been written, input is ignored
+} mc_companion_socket_state_t;
+
+typedef struct mc_companion_socket_server mc_companion_socket_server_t;
+
+/// Called for every command received on a connection, answer it with mc_companion_socket_send
+typedef void (*mc_companion_socket_callback)(mc_companion_socket_server_t* server, int connection, companion_command_packet_t* command,
+                                             mc_companion_command_parser_error_t error, void* context);
+
+typedef struct {
+    mc_companion_socket_server_t*    server;
+    int                              fd;
+    uint8_t                          transport;
+    uint8_t                          state;
+    uint16_t                         request_length;   // Handshake bytes received
+    uint32_t                         tx_head;          // Next byte to write, free running
+    uint32_t                         tx_tail;          // Next byte to fill, free running
+    uint32_t                         linger_until_ms;  // A closing connection is released by then, drained or not
+    mc_companion_framer_t            framer;
+    mc_companion_websocket_decoder_t websocket;
+    uint8_t                          request[MC_COMPANION_SOCKET_REQUEST_SIZE];
+    uint8_t                          tx[MC_COMPANION_SOCKET_TX_SIZE];
+} mc_companion_socket_connection_t;
+
+typedef struct {
+    uint32_t accepted;   // Connections accepted
+    uint32_t refused;    // Connections closed right away because every slot was taken
+    uint32_t closed;     // Connections closed, for any reason
+    uint32_t overflows;  // Connections closed because they did not read their responses
+    uint32_t errors;     // Connections closed after a failed handshake or a WebSocket protocol error
+    uint64_t received;   // Bytes read
+    uint64_t sent;       // Bytes written
+    uint64_t writes;     // Gathering writes
+} mc_companion_socket_counters_t;
+
+struct mc_companion_socket_server {
+    mc_companion_socket_callback     callback;
+    void*                            context;
+    bool                             nodelay;          // TCP_NODELAY on accepted connections
+    int                              linger_ms;        // Longest time a closing connection is kept to drain
+    uint8_t                          listener_count;
+    int                              listeners[MC_COMPANION_SOCKET_MAX_LISTENERS];
+    uint8_t                          listener_transports[MC_COMPANION_SOCKET_MAX_LISTENERS];
+    uint16_t                         polled_count;
+    int16_t                          polled[MC_COMPANION_SOCKET_MAX_POLLFDS];  // Connection of every polled descriptor, -1 - n for listener n
+    mc_companion_socket_counters_t   counters;
+    mc_companion_socket_connection_t connections[MC_COMPANION_SOCKET_MAX_CONNECTIONS];
+};
+
+// Functions
+
+/// Reset a server without listeners or connections, the callback receives the commands of every connection
+void mc_companion_socket_init(mc_companion_socket_server_t* server, mc_companion_socket_callback callback, void* context);
+
+/// Listen for connections of a transport on an IPv4 address and port, returns -1 with errno set on failure
+int mc_companion_socket_listen(mc_companion_socket_server_t* server, mc_companion_socket_transport_t transport, const char* address, uint16_t port);
+
+/// Turn Nagle's algorithm off (the default) or on, for open connections and the ones accepted later
+void mc_companion_socket_set_nodelay(mc_companion_socket_server_t* server, bool nodelay);
+
+/// Fill in the descriptors to poll, at most max of them. Returns the number filled in, pass them to
+/// mc_companion_socket_process once poll returns.
+int mc_companion_socket_pollfds(mc_companion_socket_server_t* server, struct pollfd* out_descriptors, int max);
+
+/// Accept new connections and read from the ready ones, calling the callback for every received command
+void mc_companion_socket_process(mc_companion_socket_server_t* server, const struct pollfd* descriptors, int count);
+
+/// Queue framed response data on a connection, WebSocket connections get it as one binary message. Never
+/// waits: when the ring has no room even after writing what the socket takes, the connection is closed.
+/// Returns -1 when the connection is closed or closing, or when the data was not queued.
+int mc_companion_socket_send(mc_companion_socket_server_t* server, int connection, const uint8_t* data, size_t length);
+
+/// Write out what is queued on every connection and release the closing connections that are drained or
+/// out of time
+void mc_companion_socket_flush(mc_companion_socket_server_t* server);
+
+/// Close a connection once what is queued on it has been flushed
+void mc_companion_socket_close(mc_companion_socket_server_t* server, int connection);
+
+/// Close every connection and listener
+void mc_companion_socket_shutdown(mc_companion_socket_server_t* server);
+
+/// Number of open connections
+int mc_companion_socket_connections(const mc_companion_socket_server_t* server);
@@ -0,0 +1,336 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "mc_companion_websocket.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "sha1.h"
+
+// Appended to the client's key before hashing, fixed by RFC 6455
+static const char websocket_guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static const char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static char websocket_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// Compare a header field against a lower case string, ignoring case
+static bool websocket_equals(const char* field, size_t field_length, const char* lower) {
+    size_t length = strlen(lower);
+    if (field_length != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (websocket_lower(field[i]) != lower[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check whether a comma separated header value lists a token, ignoring case
+static bool websocket_lists(const char* value, size_t value_length, const char* lower) {
+    size_t position = 0;
+    while (position < value_length) {
+        size_t start = position;
+        while (position < value_length && value[position] != ',') {
+            position++;
+        }
+        size_t end = position;
+        while (start < end && (value[start] == ' ' || value[start] == '\t')) {
+            start++;
+        }
+        while (end > start && (value[end - 1] == ' ' || value[end - 1] == '\t')) {
+            end--;
+        }
+        if (websocket_equals(&value[start], end - start, lower)) {
+            return true;
+        }
+        position++;
+    }
+    return false;
+}
+
+void mc_companion_websocket_accept(const char* key, size_t key_length, char out_accept[MC_COMPANION_WEBSOCKET_ACCEPT_SIZE]) {
+    Sha1Context context;
+    SHA1_HASH   digest;
+    Sha1Initialise(&context);
+    Sha1Update(&context, key, (uint32_t)key_length);
+    Sha1Update(&context, websocket_guid, sizeof(websocket_guid) - 1);
+    Sha1Finalise(&context, &digest);
+
+    // 20 bytes are six full groups of three and one group of two, padded with one '='
+    size_t position = 0;
+    for (size_t i = 0; i < SHA1_HASH_SIZE; i += 3) {
+        uint32_t group = (uint32_t)digest.bytes[i] << 16;
+        if (i + 1 < SHA1_HASH_SIZE) {
+            group |= (uint32_t)digest.bytes[i + 1] << 8;
+        }
+        if (i + 2 < SHA1_HASH_SIZE) {
+            group |= digest.bytes[i + 2];
+        }
+        out_accept[position++] = base64_alphabet[(group >> 18) & 0x3F];
+        out_accept[position++] = base64_alphabet[(group >> 12) & 0x3F];
+        out_accept[position++] = (i + 1 < SHA1_HASH_SIZE) ? base64_alphabet[(group >> 6) & 0x3F] : '=';
+        out_accept[position++] = (i + 2 < SHA1_HASH_SIZE) ? base64_alphabet[group & 0x3F] : '=';
+    }
+    out_accept[position] = '\0';
+}
+
+int mc_companion_websocket_handshake(const char* request, size_t request_length, size_t output_buffer_size, char* out_response,
+                                     size_t* out_request_length) {
+    // The request ends at the first blank line
+    size_t end = 0;
+    while (end + 4 <= request_length && memcmp(&request[end], "\r\n\r\n", 4) != 0) {
+        end++;
+    }
+    if (end + 4 > request_length) {
+        return 0;
+    }
+    *out_request_length = end + 4;
+
+    if (end < 4 || memcmp(request, "GET ", 4) != 0) {
+        return -1;
+    }
+
+    const char* key        = NULL;
+    size_t      key_length = 0;
+    bool        upgrade    = false;
+    bool        version    = false;
+
+    // Skip the request line, then look at one header field per line
+    size_t line = 0;
+    while (line < end && request[line] != '\n') {
+        line++;
+    }
+    line++;
+    while (line < end) {
+        size_t line_end = line;
+        while (line_end < end && request[line_end] != '\r') {
+            line_end++;
+        }
+        size_t colon = line;
+        while (colon < line_end && request[colon] != ':') {
+            colon++;
+        }
+        if (colon < line_end) {
+            size_t value     = colon + 1;
+            size_t value_end = line_end;
+            while (value < value_end && (request[value] == ' ' || request[value] == '\t')) {
+                value++;
+            }
+            while (value_end > value && (request[value_end - 1] == ' ' || request[value_end - 1] == '\t')) {
+                value_end--;
+            }
+            const char* name        = &request[line];
+            size_t      name_length = colon - line;
+            if (websocket_equals(name, name_length, "upgrade")) {
+                upgrade = websocket_lists(&request[value], value_end - value, "websocket");
+            } else if (websocket_equals(name, name_length, "sec-websocket-version")) {
+                version = websocket_equals(&request[value], value_end - value, "13");
+            } else if (websocket_equals(name, name_length, "sec-websocket-key")) {
+                key        = &request[value];
+                key_length = value_end - value;
+            }
+        }
+        line = line_end + 2;
+    }
+
+    if (!upgrade || !version || key == NULL || key_length == 0) {
+        return -1;
+    }
+
+    char accept[MC_COMPANION_WEBSOCKET_ACCEPT_SIZE];
+    mc_companion_websocket_accept(key, key_length, accept);
+    int length = snprintf(out_response, output_buffer_size,
+                          "HTTP/1.1 101 Switching Protocols\r\n"
+                          "Upgrade: websocket\r\n"
+                          "Connection: Upgrade\r\n"
+                          "Sec-WebSocket-Accept: %s\r\n"
+                          "\r\n",
+                          accept);
+    return (length > 0 && (size_t)length < output_buffer_size) ? length : -1;
+}
+
+int mc_companion_websocket_reject(size_t output_buffer_size, char* out_response) {
+    int length = snprintf(out_response, output_buffer_size,
+                          "HTTP/1.1 400 Bad Request\r\n"
+                          "Connection: close\r\n"
+                          "Sec-WebSocket-Version: 13\r\n"
+                          "Content-Length: 0\r\n"
+                          "\r\n");
+    return (length > 0 && (size_t)length < output_buffer_size) ? length : -1;
+}
+
+size_t mc_companion_websocket_header(uint8_t opcode, uint64_t length, const uint8_t* mask, uint8_t out_header[MC_COMPANION_WEBSOCKET_MAX_HEADER]) {
+    uint8_t masked   = (mask != NULL) ? 0x80 : 0x00;
+    size_t  position = 0;
+
+    out_header[position++] = 0x80 | (opcode & 0x0F);
+    if (length < 126) {
+        out_header[position++] = masked | (uint8_t)length;
+    } else if (length <= 0xFFFF) {
+        out_header[position++] = masked | 126;
+        out_header[position++] = (length >> 8) & 0xFF;
+        out_header[position++] = (length >> 0) & 0xFF;
+    } else {
+        out_header[position++] = masked | 127;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            out_header[position++] = (length >> shift) & 0xFF;
+        }
+    }
+    if (mask != NULL) {
+        memcpy(&out_header[position], mask, 4);
+        position += 4;
+    }
+    return position;
+}
+
+void mc_companion_websocket_mask(uint8_t* data, size_t length, const uint8_t mask[4], size_t offset) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] ^= mask[(offset + i) & 3];
+    }
+}
+
+void mc_companion_websocket_decoder_init(mc_companion_websocket_decoder_t* decoder, bool require_mask, mc_companion_websocket_callback callback,
+                                         void* context) {
+    memset(decoder, 0, sizeof(mc_companion_websocket_decoder_t));
+    decoder->callback     = callback;
+    decoder->context      = context;
+    decoder->require_mask = require_mask;
+}
+
+// Bytes of the header after its first two, known once those are in
+static uint8_t websocket_header_needed(const mc_companion_websocket_decoder_t* decoder) {
+    uint8_t length = decoder->header[1] & 0x7F;
+    uint8_t needed = 2;
+    needed        += (length == 126) ? 2 : (length == 127) ? 8 : 0;
+    needed        += (decoder->header[1] & 0x80) ? 4 : 0;
+    return needed;
+}
+
+// Check a complete header and set up for its payload, returns -1 when the frame breaks the protocol
+static int websocket_start_frame(mc_companion_websocket_decoder_t* decoder) {
+    const uint8_t* header  = decoder->header;
+    bool           fin     = (header[0] & 0x80) != 0;
+    bool           masked  = (header[1] & 0x80) != 0;
+    uint8_t        opcode  = header[0] & 0x0F;
+    uint8_t        length  = header[1] & 0x7F;
+    size_t         offset  = 2;
+    uint64_t       payload = length;
+
+    if ((header[0] & 0x70) != 0 || masked != decoder->require_mask) {
+        return -1;  // Extension bits without a negotiated extension, or masking the wrong way round
+    }
+    if (length == 126) {
+        payload  = ((uint64_t)header[2] << 8) | header[3];
+        offset  += 2;
+    } else if (length == 127) {
+        payload = 0;
+        for (int i = 0; i < 8; i++) {
+            payload = (payload << 8) | header[2 + i];
+        }
+        if (payload >> 63) {
+            return -1;
+        }
+        offset += 8;
+    }
+    if (masked) {
+        memcpy(decoder->mask, &header[offset], 4);
+    }
+
+    switch (opcode) {
+        case MC_COMPANION_WEBSOCKET_OPCODE_CLOSE:
+        case MC_COMPANION_WEBSOCKET_OPCODE_PING:
+        case MC_COMPANION_WEBSOCKET_OPCODE_PONG:
+            // Control frames may come between the frames of a message but are never fragmented themselves
+            if (!fin || payload > MC_COMPANION_WEBSOCKET_MAX_CONTROL) {
+                return -1;
+            }
+            decoder->control_length = 0;
+            break;
+        case MC_COMPANION_WEBSOCKET_OPCODE_CONTINUATION:
+            if (!decoder->fragmented) {
+                return -1;
+            }
+            decoder->fragmented = !fin;
+            break;
+        case MC_COMPANION_WEBSOCKET_OPCODE_TEXT:
+        case MC_COMPANION_WEBSOCKET_OPCODE_BINARY:
+            if (decoder->fragmented) {
+                return -1;
+            }
+            decoder->message    = opcode;
+            decoder->fragmented = !fin;
+            break;
+        default:
+            return -1;
+    }
+
+    decoder->opcode        = opcode;
+    decoder->remaining     = payload;
+    decoder->mask_offset   = 0;
+    decoder->header_length = 0;
+    decoder->payload       = true;
+    return 0;
+}
+
+static void websocket_end_frame(mc_companion_websocket_decoder_t* decoder) {
+    decoder->payload = false;
+    if (decoder->opcode >= MC_COMPANION_WEBSOCKET_OPCODE_CLOSE) {
+        decoder->callback(decoder->opcode, decoder->control, decoder->control_length, decoder->context);
+    }
+}
+
+int mc_companion_websocket_decode(mc_companion_websocket_decoder_t* decoder, uint8_t* data, size_t length) {
+    if (decoder->failed) {
+        return -1;
+    }
+    while (length > 0) {
+        if (!decoder->payload) {
+            // Collect the first two bytes, then the rest of the header they announce
+            uint8_t needed = (decoder->header_length < 2) ? 2 : websocket_header_needed(decoder);
+            while (length > 0 && decoder->header_length < needed) {
+                decoder->header[decoder->header_length++] = *data++;
+                length--;
+                if (decoder->header_length == 2) {
+                    needed = websocket_header_needed(decoder);
+                }
+            }
+            if (decoder->header_length < needed) {
+                return 0;
+            }
+            if (websocket_start_frame(decoder) < 0) {
+                decoder->failed = true;
+                return -1;
+            }
+            if (decoder->remaining == 0) {
+                websocket_end_frame(decoder);
+            }
+            continue;
+        }
+
+        size_t take = (decoder->remaining < length) ? (size_t)decoder->remaining : length;
+        if (decoder->require_mask) {
+            mc_companion_websocket_mask(data, take, decoder->mask, decoder->mask_offset);
+            decoder->mask_offset = (uint8_t)((decoder->mask_offset + take) & 3);
+        }
+        if (decoder->opcode >= MC_COMPANION_WEBSOCKET_OPCODE_CLOSE) {
+            memcpy(&decoder->control[decoder->control_length], data, take);
+            decoder->control_length += (uint8_t)take;
+        } else {
+            decoder->callback(decoder->message, data, take, decoder->context);
+        }
+        data               += take;
+        length             -= take;
+        decoder->remaining -= take;
+        if (decoder->remaining == 0) {
+            websocket_end_frame(decoder);
+        }
+    }
+    return 0;
+}
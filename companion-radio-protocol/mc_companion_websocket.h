@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// WebSocket (RFC 6455) framing for carrying the companion protocol to browser apps. The companion frames
+// travel unchanged in binary messages, a message may hold any number of them or a part of one, so the
+// receiving side feeds the payloads to its framer like bytes from a serial port. Only the parts a companion
+// transport needs are here: the opening handshake, frame headers and an incremental decoder that unmasks
+// payloads in place. Nothing here touches a socket, see mc_companion_socket.h for the transport.
+
+// Definitions
+
+#define MC_COMPANION_WEBSOCKET_MAX_HEADER   14  // Two bytes, a 64 bit length and a masking key
+#define MC_COMPANION_WEBSOCKET_MAX_CONTROL  125
+#define MC_COMPANION_WEBSOCKET_ACCEPT_SIZE  29  // Base64 of a SHA-1 digest and a terminator
+#define MC_COMPANION_WEBSOCKET_STATUS_ERROR 1002
+
+typedef enum {
+    MC_COMPANION_WEBSOCKET_OPCODE_CONTINUATION = 0x0,
+    MC_COMPANION_WEBSOCKET_OPCODE_TEXT         = 0x1,
+    MC_COMPANION_WEBSOCKET_OPCODE_BINARY       = 0x2,
+    MC_COMPANION_WEBSOCKET_OPCODE_CLOSE        = 0x8,
+    MC_COMPANION_WEBSOCKET_OPCODE_PING         = 0x9,
+    MC_COMPANION_WEBSOCKET_OPCODE_PONG         = 0xA,
+} mc_companion_websocket_opcode_t;
+
+/// Called with message payload as it arrives, with the opcode of the message it belongs to, and with every
+/// complete control frame
+typedef void (*mc_companion_websocket_callback)(uint8_t opcode, const uint8_t* data, size_t length, void* context);
+
+typedef struct {
+    mc_companion_websocket_callback callback;
+    void*                           context;
+    bool                            require_mask;  // Set on the server side, clients must mask their frames
+    bool                            fragmented;    // A message continues in continuation frames
+    bool                            payload;       // The header is complete, payload bytes follow
+    bool                            failed;
+    uint8_t                         message;  // Opcode of the message being received
+    uint8_t                         opcode;   // Opcode of the frame being received
+    uint8_t                         header[MC_COMPANION_WEBSOCKET_MAX_HEADER];
+    uint8_t                         header_length;
+    uint8_t                         mask[4];
+    uint8_t                         mask_offset;
+    uint64_t                        remaining;  // Payload bytes of the frame still to come
+    uint8_t                         control_length;
+    uint8_t                         control[MC_COMPANION_WEBSOCKET_MAX_CONTROL];
+} mc_companion_websocket_decoder_t;
+
+// Functions
+
+/// Compute the Sec-WebSocket-Accept value for a Sec-WebSocket-Key, as a terminated string
+void mc_companion_websocket_accept(const char* key, size_t key_length, char out_accept[MC_COMPANION_WEBSOCKET_ACCEPT_SIZE]);
+
+/// Answer an opening handshake. Returns the length of the 101 response written, 0 when the request is not
+/// complete yet or -1 when it is not a WebSocket upgrade, answer that with mc_companion_websocket_reject.
+/// The length of the request up to and including its blank line is stored, frames may follow it.
+int mc_companion_websocket_handshake(const char* request, size_t request_length, size_t output_buffer_size, char* out_response,
+                                     size_t* out_request_length);
+
+/// Write the 400 response for a request that is not a WebSocket upgrade, returns its length
+int mc_companion_websocket_reject(size_t output_buffer_size, char* out_response);
+
+/// Write a frame header for a whole message of length bytes. A client passes a masking key and masks the
+/// payload with mc_companion_websocket_mask, a server passes NULL. Returns the length of the header.
+size_t mc_companion_websocket_header(uint8_t opcode, uint64_t length, const uint8_t* mask, uint8_t out_header[MC_COMPANION_WEBSOCKET_MAX_HEADER]);
+
+/// Mask or unmask payload bytes in place, offset is the position of the first byte in the payload
+void mc_companion_websocket_mask(uint8_t* data, size_t length, const uint8_t mask[4], size_t offset);
+
+/// Reset a decoder
+void mc_companion_websocket_decoder_init(mc_companion_websocket_decoder_t* decoder, bool require_mask, mc_companion_websocket_callback callback,
+                                         void* context);
+
+/// Feed received bytes, they are unmasked in place. Returns -1 on a protocol error, after which the
+/// connection has to be closed with status MC_COMPANION_WEBSOCKET_STATUS_ERROR.
+int mc_companion_websocket_decode(mc_companion_websocket_decoder_t* decoder, uint8_t* data, size_t length);
@@ -0,0 +1,1363 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "aes.h"
+#include "hmac_sha256.h"
+#include "mc_companion.h"
+#include "mc_companion_batch.h"
+#include "mc_companion_bundle.h"
+#include "mc_companion_client.h"
+#include "mc_companion_command_parser.h"
+#include "mc_companion_contact_store.h"
+#include "mc_companion_fanout.h"
+#include "mc_companion_serial_interface.h"
+#include "mc_companion_shm.h"
+#include "mc_companion_signer.h"
+#include "meshcore/ack_table.h"
+#include "meshcore/capture.h"
+#include "meshcore/compact.h"
+#include "meshcore/dedup.h"
+#include "meshcore/multipart_reassembly.h"
+#include "meshcore/packet.h"
+#include "meshcore/pool.h"
+#include "meshcore/session.h"
+#include "meshcore/stream_decoder.h"
+#include "meshcore/timer_wheel.h"
+#include "meshcore/tx_scheduler.h"
+#include "meshcore/trace_monitor.h"
+#include "meshcore/payload/ack.h"
+#include "meshcore/payload/advert.h"
+#include "meshcore/payload/grp_txt.h"
+#include "meshcore/payload/multipart.h"
+#include "meshcore/payload/request.h"
+#include "meshcore/payload/trace.h"
+
+#ifndef MESHCORE_BENCH_VERSION
+#define MESHCORE_BENCH_VERSION "unknown"
+#endif
+
+#define BENCH_MAX_FRAMES  4096
+#define BENCH_RUNS        5
+#define BENCH_MIN_TIME_NS 50000000ull  // Each run lasts at least 50 ms
+
+// Keep the compiler from optimizing away results of benchmarked calls
+#define BENCH_CLOBBER(pointer) __asm__ volatile("" : : "g"(pointer) : "memory")
+
+typedef struct {
+    uint8_t data[MESHCORE_MAX_TRANS_UNIT];
+    uint8_t size;
+} bench_frame_t;
+
+typedef struct {
+    const char* name;
+    uint64_t    iterations;
+    double      ns_per_op;
+    double      ops_per_sec;
+    double      bytes_per_op;
+} bench_result_t;
+
+typedef uint64_t (*bench_function_t)(uint64_t iterations);  // Returns the number of bytes processed
+
+static bench_frame_t  frames[BENCH_MAX_FRAMES];
+static size_t         frame_count = 0;
+static bench_result_t results[64];
+static size_t         result_count = 0;
+
+// Sample traffic, the same frames are decoded by main.c
+
+static const uint8_t sample_advert[] = {
+    0x11, 0x00, 0x7e, 0x76, 0x62, 0x67, 0x6f, 0x7f, 0x08, 0x50, 0xa8, 0xa3, 0x55, 0xba, 0xaf, 0xbf, 0xc1, 0xeb, 0x7b, 0x41, 0x74, 0xc3, 0x40,
+    0x44, 0x2d, 0x7d, 0x71, 0x61, 0xc9, 0x47, 0x4a, 0x2c, 0x94, 0x00, 0x6c, 0xe7, 0xcf, 0x68, 0x2e, 0x58, 0x40, 0x8d, 0xd8, 0xfc, 0xc5, 0x19,
+    0x06, 0xec, 0xa9, 0x8e, 0xbf, 0x94, 0xa0, 0x37, 0x88, 0x6b, 0xda, 0xde, 0x7e, 0xcd, 0x09, 0xfd, 0x92, 0xb8, 0x39, 0x49, 0x1d, 0xf3, 0x80,
+    0x9c, 0x94, 0x54, 0xf5, 0x28, 0x6d, 0x1d, 0x33, 0x70, 0xac, 0x31, 0xa3, 0x45, 0x93, 0xd5, 0x69, 0xe9, 0xa0, 0x42, 0xa3, 0xb4, 0x1f, 0xd3,
+    0x31, 0xdf, 0xfb, 0x7e, 0x18, 0x59, 0x9c, 0xe1, 0xe6, 0x09, 0x92, 0xa0, 0x76, 0xd5, 0x02, 0x38, 0xc5, 0xb8, 0xf8, 0x57, 0x57, 0x37, 0x53,
+    0x54, 0x52, 0x2f, 0x50, 0x75, 0x67, 0x65, 0x74, 0x4d, 0x65, 0x73, 0x68, 0x20, 0x43, 0x6f, 0x75, 0x67, 0x61, 0x72};
+
+static const uint8_t sample_grp_txt[] = {0x15, 0x00, 0x11, 0x61, 0x72, 0xfb, 0x24, 0x6c, 0x57, 0x9e, 0x01, 0x0a, 0x18, 0x18, 0x6f, 0xfb, 0x79, 0x3a, 0x18,
+                                         0x81, 0xec, 0x7c, 0x2d, 0x64, 0xda, 0x78, 0xbb, 0xaf, 0x0c, 0x05, 0x71, 0xae, 0x29, 0xa1, 0x2d, 0xf5, 0xc4};
+
+static const uint8_t channel_key[16] = {0x8b, 0x33, 0x87, 0xe9, 0xc5, 0xcd, 0xea, 0x6a, 0xc9, 0xe5, 0xed, 0xba, 0xa1, 0x15, 0xcd, 0x72};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void add_frame(const uint8_t* data, uint8_t size) {
+    if (frame_count < BENCH_MAX_FRAMES) {
+        memcpy(frames[frame_count].data, data, size);
+        frames[frame_count].size = size;
+        frame_count++;
+    }
+}
+
+static void add_message(meshcore_message_t* message) {
+    uint8_t buffer[MESHCORE_MAX_TRANS_UNIT];
+    uint8_t size = 0;
+    if (meshcore_serialize(message, buffer, &size) >= 0) {
+        add_frame(buffer, size);
+    }
+}
+
+// Representative mix of traffic seen on a busy mesh: mostly group text and adverts, with direct
+// requests, acknowledgements and flood packets that have collected a path
+static void build_packet_mix(void) {
+    uint32_t seed = 0x1234567;
+    for (int i = 0; i < 64; i++) {
+        seed = seed * 1103515245 + 12345;
+
+        meshcore_message_t message = {0};
+        message.version            = 0;
+        message.path_length        = (seed >> 8) % 8;
+        for (uint8_t j = 0; j < message.path_length; j++) {
+            message.path[j] = (uint8_t)(seed >> j);
+        }
+
+        switch (i % 8) {
+            case 0:
+            case 1:
+            case 2: {
+                meshcore_message_t grp_txt;
+                meshcore_deserialize((uint8_t*)sample_grp_txt, sizeof(sample_grp_txt), &grp_txt);
+                grp_txt.path_length = message.path_length;
+                memcpy(grp_txt.path, message.path, message.path_length);
+                add_message(&grp_txt);
+                break;
+            }
+            case 3:
+            case 4:
+                add_frame(sample_advert, sizeof(sample_advert));
+                break;
+            case 5: {
+                meshcore_request_t request = {.destination_hash = 0x12, .source_hash = 0x34, .ciphher_mac = {0xAB, 0xCD}, .ciphertext_length = 48};
+                memset(request.ciphertext, 0x5A, request.ciphertext_length);
+                message.type  = MESHCORE_PAYLOAD_TYPE_REQ;
+                message.route = MESHCORE_ROUTE_TYPE_DIRECT;
+                meshcore_request_serialize(&request, message.payload, &message.payload_length);
+                add_message(&message);
+                break;
+            }
+            case 6: {
+                meshcore_ack_t ack = {.crc = seed};
+                message.type       = MESHCORE_PAYLOAD_TYPE_ACK;
+                message.route      = MESHCORE_ROUTE_TYPE_DIRECT;
+                meshcore_ack_serialize(&ack, message.payload, &message.payload_length);
+                add_message(&message);
+                break;
+            }
+            default: {
+                message.type               = MESHCORE_PAYLOAD_TYPE_TXT_MSG;
+                message.route              = MESHCORE_ROUTE_TYPE_TRANSPORT_FLOOD;
+                message.transport_codes[0] = (uint16_t)seed;
+                message.payload_length     = 64;
+                memset(message.payload, 0xA5, message.payload_length);
+                add_message(&message);
+                break;
+            }
+        }
+    }
+}
+
+static int load_capture(const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open capture (%i): %s\n", errno, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return -1;
+    }
+
+    const uint8_t* capture = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (capture == MAP_FAILED) {
+        return -1;
+    }
+
+    meshcore_capture_reader_t reader;
+    meshcore_capture_frame_t  frame;
+    if (meshcore_capture_reader_init(&reader, capture, st.st_size) < 0) {
+        munmap((void*)capture, st.st_size);
+        return -1;
+    }
+    while (meshcore_capture_next(&reader, &frame) > 0) {
+        add_frame(frame.data, frame.size);
+    }
+
+    munmap((void*)capture, st.st_size);
+    return 0;
+}
+
+static void run(const char* name, bench_function_t function) {
+    // Warm up caches and find an iteration count that runs long enough to time
+    uint64_t iterations = 1000;
+    uint64_t elapsed    = 0;
+    while (true) {
+        uint64_t start = monotonic_ns();
+        function(iterations);
+        elapsed = monotonic_ns() - start;
+        if (elapsed >= BENCH_MIN_TIME_NS) {
+            break;
+        }
+        iterations *= (elapsed < BENCH_MIN_TIME_NS / 16) ? 8 : 2;
+    }
+
+    // Report the fastest run, which is the one least disturbed by the rest of the system
+    double   best_ns = 0;
+    uint64_t bytes   = 0;
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        uint64_t start     = monotonic_ns();
+        bytes              = function(iterations);
+        double   ns_per_op = (double)(monotonic_ns() - start) / iterations;
+        if (i == 0 || ns_per_op < best_ns) {
+            best_ns = ns_per_op;
+        }
+    }
+
+    bench_result_t* result = &results[result_count++];
+    result->name           = name;
+    result->iterations     = iterations;
+    result->ns_per_op      = best_ns;
+    result->ops_per_sec    = 1e9 / best_ns;
+    result->bytes_per_op   = (double)bytes / iterations;
+
+    fprintf(stderr, "%-36s %10.1f ns/op %14.0f ops/s %8.1f B/op\n", name, result->ns_per_op, result->ops_per_sec, result->bytes_per_op);
+}
+
+// Packet codec
+
+static uint64_t bench_deserialize(uint64_t iterations) {
+    meshcore_message_t message;
+    uint64_t           bytes = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_frame_t* frame  = &frames[i % frame_count];
+        bytes                += frame->size;
+        meshcore_deserialize(frame->data, frame->size, &message);
+        BENCH_CLOBBER(&message);
+    }
+    return bytes;
+}
+
+// The packet mix fed to the incremental decoder in reads of 16 bytes, as from a radio FIFO
+static uint64_t bench_stream_decode(uint64_t iterations) {
+    static meshcore_stream_decoder_t decoder;
+    uint64_t                         bytes = 0;
+    meshcore_stream_init(&decoder, NULL, NULL, 0);
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_frame_t* frame = &frames[i % frame_count];
+        meshcore_stream_begin(&decoder, frame->size);
+        for (size_t position = 0; position < frame->size; position += 16) {
+            size_t length = (frame->size - position < 16) ? frame->size - position : 16;
+            meshcore_stream_feed(&decoder, &frame->data[position], length, NULL);
+        }
+        BENCH_CLOBBER(&decoder.message);
+        bytes += frame->size;
+    }
+    return bytes;
+}
+
+static meshcore_message_t decoded[BENCH_MAX_FRAMES];
+
+static uint64_t bench_serialize(uint64_t iterations) {
+    uint8_t  buffer[MESHCORE_MAX_TRANS_UNIT];
+    uint8_t  size  = 0;
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_serialize(&decoded[i % frame_count], buffer, &size);
+        BENCH_CLOBBER(buffer);
+        bytes += size;
+    }
+    return bytes;
+}
+
+// Payload codecs
+
+static uint8_t advert_payload[MESHCORE_MAX_PAYLOAD_SIZE];
+static uint8_t advert_payload_size;
+static uint8_t grp_txt_payload[MESHCORE_MAX_PAYLOAD_SIZE];
+static uint8_t grp_txt_payload_size;
+static uint8_t request_payload[MESHCORE_MAX_PAYLOAD_SIZE];
+static uint8_t request_payload_size;
+static uint8_t ack_payload[MESHCORE_MAX_PAYLOAD_SIZE];
+static uint8_t ack_payload_size;
+static uint8_t trace_payload[MESHCORE_MAX_PAYLOAD_SIZE];
+static uint8_t trace_payload_size;
+
+static uint64_t bench_advert_deserialize(uint64_t iterations) {
+    meshcore_advert_t advert;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_advert_deserialize(advert_payload, advert_payload_size, &advert);
+        BENCH_CLOBBER(&advert);
+    }
+    return iterations * advert_payload_size;
+}
+
+static uint64_t bench_advert_serialize(uint64_t iterations) {
+    meshcore_advert_t advert;
+    uint8_t           buffer[MESHCORE_MAX_PAYLOAD_SIZE];
+    uint8_t           size = 0;
+    meshcore_advert_deserialize(advert_payload, advert_payload_size, &advert);
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_advert_serialize(&advert, buffer, &size);
+        BENCH_CLOBBER(buffer);
+    }
+    return iterations * size;
+}
+
+static uint64_t bench_grp_txt_deserialize(uint64_t iterations) {
+    static meshcore_grp_txt_t grp_txt;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_grp_txt_deserialize(grp_txt_payload, grp_txt_payload_size, &grp_txt);
+        BENCH_CLOBBER(&grp_txt);
+    }
+    return iterations * grp_txt_payload_size;
+}
+
+static uint64_t bench_grp_txt_serialize(uint64_t iterations) {
+    static meshcore_grp_txt_t grp_txt;
+    uint8_t                   buffer[MESHCORE_MAX_PAYLOAD_SIZE];
+    uint8_t                   size = 0;
+    meshcore_grp_txt_deserialize(grp_txt_payload, grp_txt_payload_size, &grp_txt);
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_grp_txt_serialize(&grp_txt, buffer, &size);
+        BENCH_CLOBBER(buffer);
+    }
+    return iterations * size;
+}
+
+static uint64_t bench_request_deserialize(uint64_t iterations) {
+    meshcore_request_t request;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_request_deserialize(request_payload, request_payload_size, &request);
+        BENCH_CLOBBER(&request);
+    }
+    return iterations * request_payload_size;
+}
+
+static uint64_t bench_request_serialize(uint64_t iterations) {
+    meshcore_request_t request;
+    uint8_t            buffer[MESHCORE_MAX_PAYLOAD_SIZE];
+    uint8_t            size = 0;
+    meshcore_request_deserialize(request_payload, request_payload_size, &request);
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_request_serialize(&request, buffer, &size);
+        BENCH_CLOBBER(buffer);
+    }
+    return iterations * size;
+}
+
+static uint64_t bench_ack_deserialize(uint64_t iterations) {
+    meshcore_ack_t ack;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_ack_deserialize(ack_payload, ack_payload_size, &ack);
+        BENCH_CLOBBER(&ack);
+    }
+    return iterations * ack_payload_size;
+}
+
+static uint64_t bench_ack_serialize(uint64_t iterations) {
+    meshcore_ack_t ack = {.crc = 0x12345678};
+    uint8_t        buffer[MESHCORE_MAX_PAYLOAD_SIZE];
+    uint8_t        size = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_ack_serialize(&ack, buffer, &size);
+        BENCH_CLOBBER(buffer);
+    }
+    return iterations * size;
+}
+
+static uint64_t bench_trace_deserialize(uint64_t iterations) {
+    meshcore_trace_t trace;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_trace_deserialize(trace_payload, trace_payload_size, &trace);
+        BENCH_CLOBBER(&trace);
+    }
+    return iterations * trace_payload_size;
+}
+
+static uint64_t bench_trace_serialize(uint64_t iterations) {
+    meshcore_trace_t trace;
+    uint8_t          buffer[MESHCORE_MAX_PAYLOAD_SIZE];
+    uint8_t          size = 0;
+    meshcore_trace_deserialize(trace_payload, trace_payload_size, &trace);
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_trace_serialize(&trace, buffer, &size);
+        BENCH_CLOBBER(buffer);
+    }
+    return iterations * size;
+}
+
+// Multipart reassembly, fragments of many concurrent messages interleaved and in reverse order
+
+#define BENCH_MULTIPART_MESSAGES  1024
+#define BENCH_MULTIPART_FRAGMENTS 4
+
+static meshcore_multipart_reassembly_t multipart_reassembly;
+static meshcore_multipart_t            multipart_fragments[BENCH_MULTIPART_FRAGMENTS];
+
+static uint64_t bench_multipart_reassembly(uint64_t iterations) {
+    static uint8_t               message[MESHCORE_MULTIPART_MAX_MESSAGE_SIZE];
+    meshcore_multipart_message_t info;
+    uint64_t                     bytes = 0;
+    uint32_t                     round = 0;
+    meshcore_multipart_reassembly_init(&multipart_reassembly, 60000);
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint32_t              step     = (uint32_t)(i % (BENCH_MULTIPART_MESSAGES * BENCH_MULTIPART_FRAGMENTS));
+        meshcore_multipart_t* fragment = &multipart_fragments[BENCH_MULTIPART_FRAGMENTS - 1 - step / BENCH_MULTIPART_MESSAGES];
+        uint32_t              id       = round * BENCH_MULTIPART_MESSAGES + step % BENCH_MULTIPART_MESSAGES;
+        fragment->source_hash          = (uint8_t)id;
+        fragment->message_id           = (uint16_t)(id >> 8);
+        meshcore_multipart_reassembly_push(&multipart_reassembly, fragment, round, message, sizeof(message), &info);
+        bytes += fragment->data_length;
+        if (step == BENCH_MULTIPART_MESSAGES * BENCH_MULTIPART_FRAGMENTS - 1) {
+            round++;
+        }
+    }
+    BENCH_CLOBBER(message);
+    return bytes;
+}
+
+// Trace collection, eight hop round trips spread over a few thousand links
+
+#define BENCH_TRACE_ROUTES 512
+
+static meshcore_trace_collector_t trace_collector;
+static meshcore_message_t         trace_messages[BENCH_TRACE_ROUTES];
+
+static uint64_t bench_trace_collect(uint64_t iterations) {
+    meshcore_trace_collector_init(&trace_collector);
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_trace_collect(&trace_collector, 0, &trace_messages[i % BENCH_TRACE_ROUTES], 20, (uint32_t)i);
+    }
+    BENCH_CLOBBER(&trace_collector);
+    return iterations * 9;
+}
+
+static uint64_t bench_trace_forward(uint64_t iterations) {
+    meshcore_message_t message = trace_messages[0];
+    for (uint64_t i = 0; i < iterations; i++) {
+        message.path_length = (uint8_t)(i & 7);
+        meshcore_trace_forward(&message, &message.payload[MESHCORE_TRACE_HEADER_SIZE + message.path_length], 12);
+        BENCH_CLOBBER(&message);
+    }
+    return iterations;
+}
+
+// ACK tracking, a few thousand messages in flight, acknowledged in a different order than they were sent
+
+#define BENCH_ACK_IN_FLIGHT 2048
+
+static meshcore_timer_wheel_t timer_wheel;
+static meshcore_ack_table_t   ack_table;
+
+static void bench_ack_callback(meshcore_ack_table_t* table, meshcore_ack_pending_t* pending, meshcore_ack_event_t event, void* context) {
+    (void)table;
+    (void)pending;
+    (void)event;
+    (void)context;
+}
+
+static uint64_t bench_ack_track_confirm(uint64_t iterations) {
+    meshcore_timer_wheel_init(&timer_wheel, 10, 0);
+    meshcore_ack_table_init(&ack_table, &timer_wheel, bench_ack_callback, NULL);
+    uint32_t now_ms = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint32_t crc = (uint32_t)i * 0x9E3779B1u;
+        meshcore_ack_track(&ack_table, crc, (uint8_t)i, 3, now_ms, NULL, NULL);
+        if (i >= BENCH_ACK_IN_FLIGHT) {
+            meshcore_ack_received(&ack_table, (uint32_t)(i - BENCH_ACK_IN_FLIGHT + (i & 15)) * 0x9E3779B1u, now_ms);
+        }
+        if ((i & 63) == 0) {
+            meshcore_timer_wheel_advance(&timer_wheel, ++now_ms);
+        }
+    }
+    return iterations;
+}
+
+// Timer wheel, timers spread over a minute that are mostly cancelled before they expire, like retries
+
+#define BENCH_TIMERS 4096
+
+static meshcore_timer_t bench_timers[BENCH_TIMERS];
+static uint64_t         bench_timers_fired;
+
+static void bench_timer_callback(meshcore_timer_t* timer, void* context) {
+    (void)timer;
+    (void)context;
+    bench_timers_fired++;
+}
+
+static uint64_t bench_timer_start_cancel(uint64_t iterations) {
+    meshcore_timer_wheel_init(&timer_wheel, 10, 0);
+    for (uint32_t i = 0; i < BENCH_TIMERS; i++) {
+        meshcore_timer_init(&bench_timers[i], bench_timer_callback, NULL);
+    }
+    uint32_t now_ms = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_timer_t* timer = &bench_timers[i & (BENCH_TIMERS - 1)];
+        if ((i & 7) == 0) {
+            meshcore_timer_start(&timer_wheel, timer, now_ms + (uint32_t)((i * 2654435761u) % 60000));
+        } else {
+            meshcore_timer_cancel(&timer_wheel, timer);
+            meshcore_timer_start(&timer_wheel, timer, now_ms + 100 + (uint32_t)(i % 5000));
+        }
+        if ((i & 15) == 0) {
+            now_ms += 1;
+            meshcore_timer_wheel_advance(&timer_wheel, now_ms);
+        }
+    }
+    BENCH_CLOBBER(&bench_timers_fired);
+    return iterations;
+}
+
+// Timers rearmed from their callback while the wheel catches up on many ticks at once, every expiry is
+// checked against the time of the wheel so that a timer that fires early or late stops the run
+#define BENCH_TIMER_PERIOD_MS   1000
+#define BENCH_TIMER_REARM_MS    250
+#define BENCH_TIMER_CATCH_UP_MS 10000
+
+static meshcore_timer_t bench_timer_periodic;
+static meshcore_timer_t bench_timer_rearmed;
+static uint32_t         bench_timer_expected[2];
+
+static void bench_timer_check(meshcore_timer_t* timer, uint32_t* expected_ms, uint32_t spacing_ms) {
+    if (timer_wheel.time_ms != *expected_ms) {
+        fprintf(stderr, "Timer fired at %" PRIu32 " ms, expected %" PRIu32 " ms\n", timer_wheel.time_ms, *expected_ms);
+        exit(1);
+    }
+    *expected_ms += spacing_ms;
+    bench_timers_fired++;
+}
+
+static void bench_timer_periodic_callback(meshcore_timer_t* timer, void* context) {
+    bench_timer_check(timer, &bench_timer_expected[0], BENCH_TIMER_PERIOD_MS);
+}
+
+static void bench_timer_rearm_callback(meshcore_timer_t* timer, void* context) {
+    bench_timer_check(timer, &bench_timer_expected[1], BENCH_TIMER_REARM_MS);
+    meshcore_timer_start(&timer_wheel, timer, timer_wheel.time_ms + BENCH_TIMER_REARM_MS);
+}
+
+static uint64_t bench_timer_rearm(uint64_t iterations) {
+    meshcore_timer_wheel_init(&timer_wheel, 10, 0);
+    meshcore_timer_init(&bench_timer_periodic, bench_timer_periodic_callback, NULL);
+    meshcore_timer_init(&bench_timer_rearmed, bench_timer_rearm_callback, NULL);
+    bench_timer_expected[0] = 10;
+    bench_timer_expected[1] = 20;
+    meshcore_timer_start_periodic(&timer_wheel, &bench_timer_periodic, bench_timer_expected[0], BENCH_TIMER_PERIOD_MS);
+    meshcore_timer_start(&timer_wheel, &bench_timer_rearmed, bench_timer_expected[1]);
+
+    bench_timers_fired = 0;
+    uint32_t now_ms    = 0;
+    while (bench_timers_fired < iterations) {
+        now_ms += BENCH_TIMER_CATCH_UP_MS;
+        meshcore_timer_wheel_advance(&timer_wheel, now_ms);
+    }
+    return bench_timers_fired;
+}
+
+// Dedup, a flood where every packet is heard three times
+
+static meshcore_dedup_t dedup;
+
+static uint64_t bench_dedup(uint64_t iterations) {
+    meshcore_timer_wheel_init(&timer_wheel, 10, 0);
+    meshcore_dedup_init(&dedup, &timer_wheel, 30000);
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint32_t packet = (uint32_t)(i / 3) + (uint32_t)(i % 3) * 7;
+        meshcore_dedup_seen(&dedup, packet * 0x9E3779B1u, (uint32_t)i);
+        if ((i & 63) == 0) {
+            meshcore_timer_wheel_advance(&timer_wheel, (uint32_t)i);
+        }
+    }
+    BENCH_CLOBBER(&dedup);
+    return iterations;
+}
+
+// Sessions of a room server with every slot taken: requests found by key prefix and touched, and logins of
+// new clients that evict the least recently active one
+
+#define BENCH_SESSIONS MESHCORE_SESSION_MAX_SESSIONS
+
+static meshcore_session_table_t session_table;
+
+static void bench_session_key(uint32_t client, uint8_t out_public_key[MESHCORE_PUB_KEY_SIZE]) {
+    uint32_t state = client * 0x9E3779B1u + 1;
+    for (size_t i = 0; i < MESHCORE_PUB_KEY_SIZE; i += sizeof(state)) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        memcpy(&out_public_key[i], &state, sizeof(state));
+    }
+}
+
+static void bench_session_fill(void) {
+    uint8_t public_key[MESHCORE_PUB_KEY_SIZE];
+    uint8_t secret[MESHCORE_SESSION_SECRET_SIZE] = {0};
+    meshcore_timer_wheel_init(&timer_wheel, 10, 0);
+    meshcore_session_table_init(&session_table, &timer_wheel, MESHCORE_SESSION_DEFAULT_TIMEOUT_MS, NULL, NULL);
+    for (uint32_t client = 0; client < BENCH_SESSIONS; client++) {
+        bench_session_key(client, public_key);
+        meshcore_session_login(&session_table, public_key, secret, MESHCORE_SESSION_READ_WRITE, 0);
+    }
+}
+
+static uint64_t bench_session_find_touch(uint64_t iterations) {
+    static uint8_t prefixes[BENCH_SESSIONS][6];
+    uint8_t        public_key[MESHCORE_PUB_KEY_SIZE];
+    bench_session_fill();
+    for (uint32_t client = 0; client < BENCH_SESSIONS; client++) {
+        bench_session_key(client, public_key);
+        memcpy(prefixes[client], public_key, sizeof(prefixes[client]));
+    }
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint32_t            client  = (uint32_t)(i * 2654435761u) & (BENCH_SESSIONS - 1);
+        meshcore_session_t* session = meshcore_session_find(&session_table, prefixes[client], sizeof(prefixes[client]));
+        meshcore_session_touch(&session_table, session, (uint32_t)(i >> 6));
+        BENCH_CLOBBER(session->secret);
+        if ((i & 63) == 0) {
+            meshcore_timer_wheel_advance(&timer_wheel, (uint32_t)(i >> 6));
+        }
+    }
+    return iterations;
+}
+
+static uint64_t bench_session_login_evict(uint64_t iterations) {
+    uint8_t public_key[MESHCORE_PUB_KEY_SIZE];
+    uint8_t secret[MESHCORE_SESSION_SECRET_SIZE] = {0};
+    bench_session_fill();
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_session_key(BENCH_SESSIONS + (uint32_t)i, public_key);
+        meshcore_session_t* session = meshcore_session_login(&session_table, public_key, secret, MESHCORE_SESSION_GUEST, (uint32_t)(i >> 6));
+        BENCH_CLOBBER(session);
+    }
+    return iterations;
+}
+
+// TX scheduling, a saturated queue with all four classes and a duty-cycle budget
+
+static meshcore_tx_scheduler_t tx_scheduler;
+static const meshcore_radio_params_t tx_params = {.frequency = 869618, .bandwidth = 62500, .spreading_factor = 8, .coding_rate = 8,
+                                                  .preamble_length = MESHCORE_TX_DEFAULT_PREAMBLE_LENGTH};
+
+static uint64_t bench_lora_airtime(uint64_t iterations) {
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        total += meshcore_lora_airtime_us(&tx_params, (uint8_t)(i & 0xFF));
+    }
+    BENCH_CLOBBER(&total);
+    return iterations;
+}
+
+static uint64_t bench_tx_schedule(uint64_t iterations) {
+    uint8_t  frame[MESHCORE_MAX_TRANS_UNIT];
+    uint8_t  size;
+    uint32_t wait_ms;
+    uint32_t now_ms = 0;
+    meshcore_tx_scheduler_init(&tx_scheduler, &tx_params, 10, 3600000, now_ms, 1);
+    memset(frame, 0x55, sizeof(frame));
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_tx_enqueue(&tx_scheduler, frame, (uint8_t)(20 + (i & 127)), (meshcore_tx_class_t)(i & 3), now_ms);
+        if (meshcore_tx_next(&tx_scheduler, now_ms, frame, &size, &wait_ms) == 0) {
+            now_ms += (wait_ms != UINT32_MAX && wait_ms < 1000) ? wait_ms : 1000;
+        }
+    }
+    BENCH_CLOBBER(frame);
+    return iterations;
+}
+
+// Object pools, a received frame decoded into a pooled message that is shared by three consumers, compared
+// with a malloc per frame
+
+#define BENCH_POOL_MESSAGES 256
+
+static MESHCORE_POOL_STORAGE(message_pool_storage, meshcore_message_t, BENCH_POOL_MESSAGES);
+static meshcore_message_pool_t message_pool;
+static meshcore_pool_cache_t   message_pool_cache;
+
+static uint64_t bench_pool_fanout(meshcore_pool_cache_t* cache, uint64_t iterations) {
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_frame_t*      frame   = &frames[i % frame_count];
+        meshcore_message_t* message = meshcore_message_pool_alloc(&message_pool, cache);
+        meshcore_deserialize(frame->data, frame->size, message);
+        meshcore_message_pool_retain(&message_pool, message);
+        meshcore_message_pool_retain(&message_pool, message);
+        BENCH_CLOBBER(message);
+        for (int consumer = 0; consumer < 3; consumer++) {
+            meshcore_message_pool_release(&message_pool, cache, message);
+        }
+        bytes += frame->size;
+    }
+    return bytes;
+}
+
+static uint64_t bench_pool_fanout_cached(uint64_t iterations) {
+    meshcore_pool_cache_init(&message_pool_cache, &message_pool.base);
+    uint64_t bytes = bench_pool_fanout(&message_pool_cache, iterations);
+    meshcore_pool_cache_flush(&message_pool_cache);
+    return bytes;
+}
+
+static uint64_t bench_pool_fanout_shared(uint64_t iterations) {
+    return bench_pool_fanout(NULL, iterations);
+}
+
+static uint64_t bench_malloc_copy_3(uint64_t iterations) {
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_frame_t*      frame   = &frames[i % frame_count];
+        meshcore_message_t* message = calloc(1, sizeof(meshcore_message_t));
+        meshcore_deserialize(frame->data, frame->size, message);
+        meshcore_message_t* copies[2];
+        for (int consumer = 0; consumer < 2; consumer++) {
+            copies[consumer] = malloc(sizeof(meshcore_message_t));
+            memcpy(copies[consumer], message, sizeof(meshcore_message_t));
+            BENCH_CLOBBER(copies[consumer]);
+        }
+        BENCH_CLOBBER(message);
+        free(copies[0]);
+        free(copies[1]);
+        free(message);
+        bytes += frame->size;
+    }
+    return bytes;
+}
+
+// Compact messages, the packet mix stored back to back in a history buffer, and a group text message
+// decoded and decrypted in place compared with the copy into meshcore_grp_txt_t
+
+static uint8_t compact_history[BENCH_MAX_FRAMES * MESHCORE_COMPACT_MAX_SIZE];
+
+static uint64_t bench_compact_from_wire(uint64_t iterations) {
+    uint64_t bytes    = 0;
+    size_t   position = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_frame_t* frame = &frames[i % frame_count];
+        if (position + MESHCORE_COMPACT_MAX_SIZE > sizeof(compact_history)) {
+            position = 0;
+        }
+        int size = meshcore_compact_from_wire(frame->data, frame->size, (meshcore_compact_message_t*)&compact_history[position],
+                                              sizeof(compact_history) - position);
+        if (size > 0) {
+            position += (size_t)size;
+        }
+        bytes += frame->size;
+    }
+    BENCH_CLOBBER(compact_history);
+    return bytes;
+}
+
+static uint64_t bench_compact_grp_txt_decrypt(uint64_t iterations) {
+    uint8_t                     buffer[MESHCORE_COMPACT_MAX_SIZE];
+    meshcore_compact_message_t* message = (meshcore_compact_message_t*)buffer;
+    meshcore_compact_grp_txt_t  grp_txt;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_compact_from_wire(sample_grp_txt, sizeof(sample_grp_txt), message, sizeof(buffer));
+        meshcore_compact_decrypt(message, channel_key, sizeof(channel_key));
+        meshcore_compact_grp_txt(message, &grp_txt);
+        BENCH_CLOBBER(&grp_txt);
+    }
+    return iterations * sizeof(sample_grp_txt);
+}
+
+static uint64_t bench_grp_txt_decrypt_copy(uint64_t iterations) {
+    meshcore_message_t message;
+    meshcore_grp_txt_t grp_txt;
+    uint8_t            mac[MESHCORE_CIPHER_MAC_SIZE];
+    struct AES_ctx     ctx;
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_deserialize((uint8_t*)sample_grp_txt, sizeof(sample_grp_txt), &message);
+        meshcore_grp_txt_deserialize(message.payload, message.payload_length, &grp_txt);
+        hmac_sha256(channel_key, sizeof(channel_key), grp_txt.data, grp_txt.data_length, mac, sizeof(mac));
+        if (memcmp(mac, grp_txt.mac, sizeof(mac)) == 0) {
+            grp_txt.decrypted.data_length = grp_txt.data_length;
+            memcpy(grp_txt.decrypted.data, grp_txt.data, grp_txt.data_length);
+            AES_init_ctx(&ctx, channel_key);
+            for (uint8_t block = 0; block < grp_txt.decrypted.data_length / AES_BLOCKLEN; block++) {
+                AES_ECB_decrypt(&ctx, &grp_txt.decrypted.data[block * AES_BLOCKLEN]);
+            }
+        }
+        BENCH_CLOBBER(&grp_txt);
+    }
+    return iterations * sizeof(sample_grp_txt);
+}
+
+// Crypto
+
+static uint8_t crypto_buffer[MESHCORE_MAX_PAYLOAD_SIZE];
+
+static uint64_t bench_hmac_sha256_32(uint64_t iterations) {
+    uint8_t mac[MESHCORE_CIPHER_MAC_SIZE];
+    for (uint64_t i = 0; i < iterations; i++) {
+        hmac_sha256(channel_key, sizeof(channel_key), crypto_buffer, 32, mac, sizeof(mac));
+        BENCH_CLOBBER(mac);
+    }
+    return iterations * 32;
+}
+
+static uint64_t bench_hmac_sha256_176(uint64_t iterations) {
+    uint8_t mac[MESHCORE_CIPHER_MAC_SIZE];
+    for (uint64_t i = 0; i < iterations; i++) {
+        hmac_sha256(channel_key, sizeof(channel_key), crypto_buffer, 176, mac, sizeof(mac));
+        BENCH_CLOBBER(mac);
+    }
+    return iterations * 176;
+}
+
+static uint64_t bench_aes_init(uint64_t iterations) {
+    struct AES_ctx ctx;
+    for (uint64_t i = 0; i < iterations; i++) {
+        AES_init_ctx(&ctx, channel_key);
+        BENCH_CLOBBER(&ctx);
+    }
+    return 0;
+}
+
+static uint64_t bench_aes_ecb_decrypt_176(uint64_t iterations) {
+    struct AES_ctx ctx;
+    AES_init_ctx(&ctx, channel_key);
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (size_t block = 0; block < 176; block += AES_BLOCKLEN) {
+            AES_ECB_decrypt(&ctx, &crypto_buffer[block]);
+        }
+        BENCH_CLOBBER(crypto_buffer);
+    }
+    return iterations * 176;
+}
+
+static uint64_t bench_aes_ecb_encrypt_176(uint64_t iterations) {
+    struct AES_ctx ctx;
+    AES_init_ctx(&ctx, channel_key);
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (size_t block = 0; block < 176; block += AES_BLOCKLEN) {
+            AES_ECB_encrypt(&ctx, &crypto_buffer[block]);
+        }
+        BENCH_CLOBBER(crypto_buffer);
+    }
+    return iterations * 176;
+}
+
+static uint64_t bench_aes_ctr_176(uint64_t iterations) {
+    struct AES_ctx ctx;
+    uint8_t        iv[AES_BLOCKLEN] = {0};
+    AES_init_ctx_iv(&ctx, channel_key, iv);
+    for (uint64_t i = 0; i < iterations; i++) {
+        AES_CTR_xcrypt_buffer(&ctx, crypto_buffer, 176);
+        BENCH_CLOBBER(crypto_buffer);
+    }
+    return iterations * 176;
+}
+
+static int bench_sign_prehashed(const uint8_t digest[SHA512_HASH_SIZE], uint8_t out_signature[MC_COMPANION_SIGNATURE_SIZE], void* context) {
+    memcpy(out_signature, digest, MC_COMPANION_SIGNATURE_SIZE);
+    return 0;
+}
+
+// An 8 KiB document signed through SIGN_DATA chunks of the largest size the protocol carries
+static uint64_t bench_sign_stream_8k(uint64_t iterations) {
+    static uint8_t        document[8 * 1024];
+    mc_companion_signer_t signer;
+    uint8_t               signature[MC_COMPANION_SIGNATURE_SIZE];
+    size_t                chunk = sizeof(companion_cmd_sign_data_args_t);
+    mc_companion_signer_init(&signer, sizeof(document), bench_sign_prehashed, NULL);
+    for (uint64_t i = 0; i < iterations; i++) {
+        mc_companion_signer_start(&signer);
+        for (size_t position = 0; position < sizeof(document); position += chunk) {
+            size_t length = (sizeof(document) - position < chunk) ? sizeof(document) - position : chunk;
+            mc_companion_signer_data(&signer, &document[position], length);
+        }
+        mc_companion_signer_finish(&signer, signature);
+        BENCH_CLOBBER(signature);
+    }
+    return iterations * sizeof(document);
+}
+
+// Companion protocol
+
+typedef struct {
+    uint8_t  data[MESHCORE_COMPANION_MAX_FRAME_SIZE];
+    uint16_t size;
+} bench_command_t;
+
+static bench_command_t commands[4];
+static uint8_t         command_stream[4096];
+static size_t          command_stream_size = 0;
+static uint64_t        commands_received   = 0;
+
+static void build_command_mix(void) {
+    // APP_START
+    commands[0].data[0] = COMPANION_CMD_APP_START;
+    memcpy(&commands[0].data[8], "meshcore-bench", 14);
+    commands[0].size = 1 + 7 + 14;
+
+    // SEND_TXT_MSG
+    companion_cmd_send_txt_msg_args_t* txt_msg = (companion_cmd_send_txt_msg_args_t*)&commands[1].data[1];
+    commands[1].data[0]                        = COMPANION_CMD_SEND_TXT_MSG;
+    txt_msg->msg_timestamp                     = 1767225600;
+    memcpy(txt_msg->text, "Hello from the benchmark, how is the mesh today?", 48);
+    commands[1].size = 1 + sizeof(companion_cmd_send_txt_msg_args_t) - sizeof(txt_msg->text) + 48;
+
+    // GET_CONTACTS since
+    commands[2].data[0] = COMPANION_CMD_GET_CONTACTS;
+    commands[2].size    = 1 + sizeof(companion_cmd_get_contacts_args_t);
+
+    // SYNC_NEXT_MESSAGE
+    commands[3].data[0] = COMPANION_CMD_SYNC_NEXT_MESSAGE;
+    commands[3].size    = 1;
+
+    // Framed byte stream as it arrives from the serial port
+    while (command_stream_size + MESHCORE_COMPANION_MAX_FRAME_SIZE < sizeof(command_stream)) {
+        for (size_t i = 0; i < 4; i++) {
+            command_stream[command_stream_size++] = '<';
+            command_stream[command_stream_size++] = commands[i].size & 0xFF;
+            command_stream[command_stream_size++] = commands[i].size >> 8;
+            memcpy(&command_stream[command_stream_size], commands[i].data, commands[i].size);
+            command_stream_size += commands[i].size;
+        }
+    }
+}
+
+static uint64_t bench_companion_parse_command(uint64_t iterations) {
+    static companion_command_packet_t packet;
+    uint64_t                          bytes = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_command_t* command  = &commands[i & 3];
+        bytes                    += command->size;
+        mc_companion_parse_command(command->data, command->size, &packet);
+        BENCH_CLOBBER(&packet);
+    }
+    return bytes;
+}
+
+static void bench_companion_callback(companion_command_packet_t* command, mc_companion_command_parser_error_t error) {
+    commands_received++;
+}
+
+static uint64_t bench_companion_read_serial_command(uint64_t iterations) {
+    // One operation is one 64 byte read from the serial port
+    size_t position = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (position + 64 > command_stream_size) {
+            position = 0;
+        }
+        mc_companion_read_serial_command(&command_stream[position], 64, bench_companion_callback);
+        position += 64;
+    }
+    return iterations * 64;
+}
+
+// Channel message fan-out, one decrypted group text delivered to eight clients: framed once into a shared
+// buffer, compared with building and framing the response for every client
+#define BENCH_FANOUT_CLIENTS 8
+
+static mc_companion_fanout_t bench_fanout;
+
+static int bench_fanout_write(void* context, const uint8_t* data, size_t length) {
+    BENCH_CLOBBER(data);
+    return (int)length;
+}
+
+static uint64_t bench_channel_fanout(uint64_t iterations) {
+    uint8_t                     buffer[MESHCORE_COMPACT_MAX_SIZE];
+    meshcore_compact_message_t* message = (meshcore_compact_message_t*)buffer;
+    meshcore_compact_grp_txt_t  grp_txt;
+    mc_companion_fanout_init(&bench_fanout);
+    for (int client = 0; client < BENCH_FANOUT_CLIENTS; client++) {
+        mc_companion_fanout_attach(&bench_fanout, bench_fanout_write, NULL, 0);
+    }
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_compact_from_wire(sample_grp_txt, sizeof(sample_grp_txt), message, sizeof(buffer));
+        meshcore_compact_decrypt(message, channel_key, sizeof(channel_key));
+        meshcore_compact_grp_txt(message, &grp_txt);
+        mc_companion_fanout_publish_channel_msg(&bench_fanout, 0, message->path_length, &grp_txt);
+        mc_companion_fanout_flush_all(&bench_fanout);
+    }
+    return iterations * sizeof(sample_grp_txt);
+}
+
+static uint64_t bench_channel_frame_per_client(uint64_t iterations) {
+    uint8_t                     buffer[MESHCORE_COMPACT_MAX_SIZE];
+    meshcore_compact_message_t* message = (meshcore_compact_message_t*)buffer;
+    meshcore_compact_grp_txt_t  grp_txt;
+    companion_response_packet_t packet;
+    uint8_t                     framed[MESHCORE_COMPANION_MAX_FRAME_SIZE + 1];
+    size_t                      framed_length = 0;
+    size_t header = sizeof(companion_resp_channel_msg_recv_args_t) - sizeof(packet.response_channel_msg_recv_args.text);
+    for (uint64_t i = 0; i < iterations; i++) {
+        meshcore_compact_from_wire(sample_grp_txt, sizeof(sample_grp_txt), message, sizeof(buffer));
+        meshcore_compact_decrypt(message, channel_key, sizeof(channel_key));
+        meshcore_compact_grp_txt(message, &grp_txt);
+        for (int client = 0; client < BENCH_FANOUT_CLIENTS; client++) {
+            memset(&packet, 0, sizeof(packet));
+            packet.response                                        = COMPANION_RESPONSE_CODE_CHANNEL_MSG_RECV;
+            packet.response_channel_msg_recv_args.path_length      = message->path_length;
+            packet.response_channel_msg_recv_args.txt_type         = grp_txt.text_type;
+            packet.response_channel_msg_recv_args.sender_timestamp = grp_txt.timestamp;
+            memcpy(packet.response_channel_msg_recv_args.text, grp_txt.text, grp_txt.text_length);
+            mc_companion_write_serial_response(&packet, (uint16_t)(header + grp_txt.text_length), sizeof(framed), framed, &framed_length);
+            bench_fanout_write(NULL, framed, framed_length);
+        }
+    }
+    return iterations * sizeof(sample_grp_txt);
+}
+
+// Contact bundles
+
+#define BENCH_BUNDLE_CONTACTS 256
+
+static companion_contact_t bundle_contacts[BENCH_BUNDLE_CONTACTS];
+static uint8_t             bundle[MC_COMPANION_BUNDLE_HEADER_SIZE + (BENCH_BUNDLE_CONTACTS + 1) * MC_COMPANION_BUNDLE_MAX_RECORD];
+static size_t              bundle_size = 0;
+
+static mc_companion_bundle_encoder_t bundle_encoder;
+static mc_companion_bundle_decoder_t bundle_decoder;
+static mc_companion_contact_store_t  bundle_store;
+
+static size_t encode_bundle(void) {
+    size_t size = 0;
+    mc_companion_bundle_encoder_init(&bundle_encoder);
+    size += (size_t)mc_companion_bundle_encode_header(&bundle_encoder, BENCH_BUNDLE_CONTACTS, bundle, sizeof(bundle));
+    for (size_t i = 0; i < BENCH_BUNDLE_CONTACTS; i++) {
+        size += (size_t)mc_companion_bundle_encode_contact(&bundle_encoder, &bundle_contacts[i], &bundle[size], sizeof(bundle) - size);
+    }
+    size += (size_t)mc_companion_bundle_encode_end(&bundle_encoder, &bundle[size], sizeof(bundle) - size);
+    return size;
+}
+
+// A fleet behind a few repeaters, named in sequence, as a provisioning tool sends it
+static void build_contact_bundle(void) {
+    for (size_t i = 0; i < BENCH_BUNDLE_CONTACTS; i++) {
+        companion_contact_t* contact   = &bundle_contacts[i];
+        contact->type                  = (i % 16 == 0) ? COMPANION_ADV_TYPE_REPEATER : COMPANION_ADV_TYPE_CHAT;
+        contact->out_path_len          = (int8_t)(1 + i % 3);
+        contact->last_advert_timestamp = 1767225600 + (uint32_t)i * 37;
+        contact->last_modified         = contact->last_advert_timestamp;
+        contact->gps_latitude          = 52370216 + (int32_t)(i % 16) * 150;
+        contact->gps_longitude         = 4895168 + (int32_t)(i / 16) * 220;
+        for (size_t byte = 0; byte < sizeof(contact->public_key); byte++) {
+            contact->public_key[byte] = (uint8_t)(i * 131 + byte * 29 + (i >> 3));
+        }
+        for (int8_t hop = 0; hop < contact->out_path_len; hop++) {
+            contact->out_path[hop] = (uint8_t)(0x10 * (hop + 1) + i % 4);
+        }
+        snprintf(contact->name, sizeof(contact->name), "fleet-%05zu", i);
+    }
+    bundle_size = encode_bundle();
+    mc_companion_contact_store_init(&bundle_store);
+}
+
+static uint64_t bench_contact_bundle_encode(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        encode_bundle();
+        BENCH_CLOBBER(bundle);
+    }
+    return iterations * BENCH_BUNDLE_CONTACTS * sizeof(companion_contact_t);
+}
+
+static bool bench_stage_contact(const companion_contact_t* contact, void* context) {
+    return mc_companion_contact_store_stage(&bundle_store, contact) >= 0;
+}
+
+// Decode a bundle in IMPORT_BUNDLE chunks and apply it to the store, after the first pass every contact replaces itself
+static uint64_t bench_contact_bundle_import(uint64_t iterations) {
+    size_t chunk = sizeof(companion_cmd_import_bundle_args_t) - sizeof(uint16_t);
+    for (uint64_t i = 0; i < iterations; i++) {
+        mc_companion_bundle_decoder_init(&bundle_decoder, bench_stage_contact, NULL);
+        for (size_t position = 0; position < bundle_size; position += chunk) {
+            mc_companion_bundle_decode(&bundle_decoder, &bundle[position], (bundle_size - position < chunk) ? bundle_size - position : chunk);
+        }
+        mc_companion_contact_store_commit(&bundle_store);
+        BENCH_CLOBBER(&bundle_store);
+    }
+    return iterations * bundle_size;
+}
+
+// GET_CONTACTS answered in frames of the base size and in negotiated 1024 byte frames, written with the batch
+// writer and read back through a client that splits the batch frames again
+static mc_companion_client_t sync_client;
+static uint32_t              sync_received;
+
+static void bench_sync_response(mc_companion_client_t* client, const companion_response_packet_t* response, uint16_t args_length, void* context) {
+    sync_received++;
+}
+
+static uint64_t bench_contact_sync(uint64_t iterations, uint16_t frame_size) {
+    static uint8_t       frames[BENCH_BUNDLE_CONTACTS * (sizeof(companion_contact_t) + 8)];
+    mc_companion_batch_t batch;
+    mc_companion_client_init(&sync_client, bench_sync_response, NULL);
+    sync_client.frame_size = frame_size;
+    for (uint64_t i = 0; i < iterations; i++) {
+        mc_companion_batch_init_responses(&batch, frame_size, sizeof(frames), frames);
+        for (size_t contact = 0; contact < BENCH_BUNDLE_CONTACTS; contact++) {
+            mc_companion_batch_add(&batch, COMPANION_RESPONSE_CODE_CONTACT, (const uint8_t*)&bundle_contacts[contact], sizeof(companion_contact_t));
+        }
+        mc_companion_client_read(&sync_client, frames, mc_companion_batch_length(&batch));
+    }
+    return iterations * BENCH_BUNDLE_CONTACTS * sizeof(companion_contact_t);
+}
+
+static uint64_t bench_contact_sync_frames(uint64_t iterations) {
+    return bench_contact_sync(iterations, MESHCORE_COMPANION_MAX_FRAME_SIZE);
+}
+
+static uint64_t bench_contact_sync_batch(uint64_t iterations) {
+    return bench_contact_sync(iterations, 1024);
+}
+
+// Shared memory ring: heard frames published as RX log pushes the way the server does, a reader attached
+// to the same memfd takes them in batches of one wakeup each, reading every frame where it lies
+#define BENCH_SHM_BATCH 64
+
+static mc_companion_shm_t        bench_shm;
+static mc_companion_shm_reader_t bench_shm_reader;
+
+static uint64_t bench_shm_drain(void) {
+    const uint8_t* frame;
+    size_t         length;
+    uint64_t       bytes = 0;
+    while (mc_companion_shm_peek(&bench_shm_reader, &frame, &length) > 0) {
+        BENCH_CLOBBER(frame);
+        if (mc_companion_shm_consume(&bench_shm_reader) == 0) {
+            bytes += length;
+        }
+    }
+    return bytes;
+}
+
+static uint64_t bench_shm_log_rx(uint64_t iterations) {
+    if (bench_shm.header == NULL &&
+        (mc_companion_shm_create(&bench_shm, NULL, 0) < 0 || mc_companion_shm_reader_attach(&bench_shm_reader, bench_shm.fd) < 0)) {
+        fprintf(stderr, "Failed to create a shared memory ring: %s\n", strerror(errno));
+        exit(1);
+    }
+    bench_shm_drain();
+
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint8_t* data = mc_companion_shm_reserve(&bench_shm, 6 + sizeof(sample_grp_txt));
+        data[0]       = '>';
+        data[1]       = (3 + sizeof(sample_grp_txt)) & 0xFF;
+        data[2]       = (3 + sizeof(sample_grp_txt)) >> 8;
+        data[3]       = COMPANION_PUSH_CODE_LOG_RX_DATA;
+        data[4]       = 0;
+        data[5]       = 0;
+        memcpy(&data[6], sample_grp_txt, sizeof(sample_grp_txt));
+        mc_companion_shm_commit(&bench_shm);
+        if ((i + 1) % BENCH_SHM_BATCH == 0) {
+            mc_companion_shm_notify(&bench_shm);
+            bytes += bench_shm_drain();
+        }
+    }
+    return bytes + bench_shm_drain();
+}
+
+static void write_json(FILE* out, int cpu) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"suite\": \"meshcore_bench\",\n");
+    fprintf(out, "  \"version\": \"%s\",\n", MESHCORE_BENCH_VERSION);
+    fprintf(out, "  \"timestamp\": %lld,\n", (long long)time(NULL));
+    fprintf(out, "  \"cpu\": %d,\n", cpu);
+    fprintf(out, "  \"frames\": %zu,\n", frame_count);
+    fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < result_count; i++) {
+        fprintf(out, "    {\"name\": \"%s\", \"iterations\": %" PRIu64 ", \"ns_per_op\": %.3f, \"ops_per_sec\": %.1f, \"bytes_per_op\": %.1f}%s\n",
+                results[i].name, results[i].iterations, results[i].ns_per_op, results[i].ops_per_sec, results[i].bytes_per_op,
+                (i + 1 < result_count) ? "," : "");
+    }
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-c cpu] [-f capture.pcapng] [-o results.json] [-b filter]\n", name);
+    printf("  -c  pin the benchmark to this CPU (default: the CPU it starts on)\n");
+    printf("  -f  use the frames of a capture as packet mix instead of the built-in one\n");
+    printf("  -o  write JSON results to a file instead of stdout\n");
+    printf("  -b  only run benchmarks whose name contains filter\n");
+}
+
+int main(int argc, char* argv[]) {
+    int         cpu     = sched_getcpu();
+    const char* capture = NULL;
+    const char* output  = NULL;
+    const char* filter  = NULL;
+    int         option;
+
+    while ((option = getopt(argc, argv, "c:f:o:b:")) != -1) {
+        switch (option) {
+            case 'c':
+                cpu = atoi(optarg);
+                break;
+            case 'f':
+                capture = optarg;
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'b':
+                filter = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            fprintf(stderr, "Failed to pin to CPU %d (%i): %s\n", cpu, errno, strerror(errno));
+            cpu = -1;
+        }
+    }
+
+    if (capture != NULL) {
+        if (load_capture(capture) < 0 || frame_count == 0) {
+            fprintf(stderr, "No frames loaded from %s\n", capture);
+            return 1;
+        }
+    } else {
+        build_packet_mix();
+    }
+
+    for (size_t i = 0; i < frame_count; i++) {
+        meshcore_deserialize(frames[i].data, frames[i].size, &decoded[i]);
+    }
+
+    meshcore_message_t message;
+    meshcore_deserialize((uint8_t*)sample_advert, sizeof(sample_advert), &message);
+    memcpy(advert_payload, message.payload, message.payload_length);
+    advert_payload_size = message.payload_length;
+    meshcore_deserialize((uint8_t*)sample_grp_txt, sizeof(sample_grp_txt), &message);
+    memcpy(grp_txt_payload, message.payload, message.payload_length);
+    grp_txt_payload_size = message.payload_length;
+    meshcore_request_t request = {.destination_hash = 0x12, .source_hash = 0x34, .ciphertext_length = 48};
+    meshcore_request_serialize(&request, request_payload, &request_payload_size);
+    meshcore_ack_t ack = {.crc = 0xDEADBEEF};
+    meshcore_ack_serialize(&ack, ack_payload, &ack_payload_size);
+    meshcore_trace_t trace = {.tag = 0x11223344, .auth_code = 0x55667788, .path_length = 8, .path = {1, 2, 3, 4, 5, 6, 7, 8}};
+    meshcore_trace_serialize(&trace, trace_payload, &trace_payload_size);
+
+    static uint8_t multipart_message[BENCH_MULTIPART_FRAGMENTS * MESHCORE_MULTIPART_FRAGMENT_SIZE - 20];
+    for (uint8_t i = 0; i < BENCH_MULTIPART_FRAGMENTS; i++) {
+        meshcore_multipart_fragment(0, 0, MESHCORE_PAYLOAD_TYPE_TXT_MSG, multipart_message, sizeof(multipart_message), i, &multipart_fragments[i]);
+    }
+
+    for (uint32_t route = 0; route < BENCH_TRACE_ROUTES; route++) {
+        meshcore_message_t* message = &trace_messages[route];
+        message->type               = MESHCORE_PAYLOAD_TYPE_TRACE;
+        message->route              = MESHCORE_ROUTE_TYPE_DIRECT;
+        message->payload_length     = MESHCORE_TRACE_HEADER_SIZE + 8;
+        message->path_length        = 8;
+        for (uint8_t hop = 0; hop < 8; hop++) {
+            message->payload[MESHCORE_TRACE_HEADER_SIZE + hop] = (uint8_t)(route * 7 + hop * 31 + 1);
+            message->path[hop]                                  = (uint8_t)(route + hop * 5);
+        }
+    }
+
+    meshcore_message_pool_init(&message_pool, message_pool_storage, sizeof(message_pool_storage));
+
+    size_t compact_size = 0;
+    for (size_t i = 0; i < frame_count; i++) {
+        int size = meshcore_compact_from_wire(frames[i].data, frames[i].size, (meshcore_compact_message_t*)compact_history, sizeof(compact_history));
+        compact_size += (size > 0) ? (size_t)size : 0;
+    }
+    fprintf(stderr, "Packet mix of %zu frames: %zu B as meshcore_message_t, %zu B compact\n", frame_count, frame_count * sizeof(meshcore_message_t),
+            compact_size);
+
+    build_command_mix();
+    build_contact_bundle();
+
+    static const struct {
+        const char*      name;
+        bench_function_t function;
+    } benchmarks[] = {
+        {"packet_deserialize_mix", bench_deserialize},
+        {"packet_serialize_mix", bench_serialize},
+        {"packet_stream_decode_mix_16", bench_stream_decode},
+        {"advert_deserialize", bench_advert_deserialize},
+        {"advert_serialize", bench_advert_serialize},
+        {"grp_txt_deserialize", bench_grp_txt_deserialize},
+        {"grp_txt_serialize", bench_grp_txt_serialize},
+        {"request_deserialize", bench_request_deserialize},
+        {"request_serialize", bench_request_serialize},
+        {"ack_deserialize", bench_ack_deserialize},
+        {"ack_serialize", bench_ack_serialize},
+        {"trace_deserialize", bench_trace_deserialize},
+        {"trace_serialize", bench_trace_serialize},
+        {"multipart_reassembly_1024x4", bench_multipart_reassembly},
+        {"trace_forward", bench_trace_forward},
+        {"trace_collect_8_hops", bench_trace_collect},
+        {"ack_track_confirm_2048", bench_ack_track_confirm},
+        {"timer_start_cancel_4096", bench_timer_start_cancel},
+        {"timer_periodic_rearm_catch_up", bench_timer_rearm},
+        {"dedup_seen", bench_dedup},
+        {"session_find_touch_4096", bench_session_find_touch},
+        {"session_login_evict_4096", bench_session_login_evict},
+        {"lora_airtime", bench_lora_airtime},
+        {"tx_enqueue_next", bench_tx_schedule},
+        {"pool_decode_fanout_3_cached", bench_pool_fanout_cached},
+        {"pool_decode_fanout_3_shared", bench_pool_fanout_shared},
+        {"malloc_decode_copy_3", bench_malloc_copy_3},
+        {"compact_from_wire_mix", bench_compact_from_wire},
+        {"compact_grp_txt_decrypt_in_place", bench_compact_grp_txt_decrypt},
+        {"grp_txt_decrypt_copy", bench_grp_txt_decrypt_copy},
+        {"hmac_sha256_32", bench_hmac_sha256_32},
+        {"hmac_sha256_176", bench_hmac_sha256_176},
+        {"aes_init_ctx", bench_aes_init},
+        {"aes_ecb_encrypt_176", bench_aes_ecb_encrypt_176},
+        {"aes_ecb_decrypt_176", bench_aes_ecb_decrypt_176},
+        {"aes_ctr_xcrypt_176", bench_aes_ctr_176},
+        {"sign_stream_8k", bench_sign_stream_8k},
+        {"companion_parse_command_mix", bench_companion_parse_command},
+        {"companion_read_serial_command_64", bench_companion_read_serial_command},
+        {"channel_fanout_8", bench_channel_fanout},
+        {"channel_frame_per_client_8", bench_channel_frame_per_client},
+        {"contact_bundle_encode_256", bench_contact_bundle_encode},
+        {"contact_bundle_import_256", bench_contact_bundle_import},
+        {"contact_sync_frames_256", bench_contact_sync_frames},
+        {"contact_sync_batch_1024_256", bench_contact_sync_batch},
+        {"shm_publish_read_log_rx_64", bench_shm_log_rx},
+    };
+
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        if (filter == NULL || strstr(benchmarks[i].name, filter) != NULL) {
+            run(benchmarks[i].name, benchmarks[i].function);
+        }
+    }
+
+    FILE* out = stdout;
+    if (output != NULL) {
+        out = fopen(output, "w");
+        if (out == NULL) {
+            fprintf(stderr, "Failed to open %s\n", output);
+            return 1;
+        }
+    }
+    write_json(out, cpu);
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "meshcore/packet.h"
+
+// Every fuzz target implements the libFuzzer entry point. Without libFuzzer the targets are linked
+// against fuzz_driver.c, which replays a corpus and reports decode throughput.
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/// Map a frame read from a capture to an input for this target, returns false when the frame is not relevant
+bool fuzz_input_from_frame(const uint8_t* frame, size_t frame_size, const uint8_t** out_input, size_t* out_input_size);
+
+// Trap so that libFuzzer records the input as a crash
+#define FUZZ_ASSERT(condition) \
+    do {                       \
+        if (!(condition)) {    \
+            __builtin_trap();  \
+        }                      \
+    } while (0)
+
+// A payload target: decodes the input as one payload type, encodes what was decoded and decodes that again,
+// which has to give back the same fields. Captured frames of that payload type are fed as their payload.
+// name is the codec prefix (meshcore_<name>_t, meshcore_<name>_deserialize) and payload_type the suffix of its
+// MESHCORE_PAYLOAD_TYPE_ constant, the file using it includes the codec header.
+#define FUZZ_PAYLOAD_TARGET(name, payload_type)                                                                                                 \
+    int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {                                                                              \
+        if (size > MESHCORE_MAX_PAYLOAD_SIZE) {                                                                                                 \
+            return -1;                                                                                                                          \
+        }                                                                                                                                       \
+        static meshcore_##name##_t decoded;                                                                                                     \
+        if (meshcore_##name##_deserialize((uint8_t*)data, (uint8_t)size, &decoded) < 0) {                                                       \
+            return 0;                                                                                                                           \
+        }                                                                                                                                       \
+        uint8_t encoded[MESHCORE_MAX_PAYLOAD_SIZE];                                                                                             \
+        uint8_t encoded_size = 0;                                                                                                               \
+        FUZZ_ASSERT(meshcore_##name##_serialize(&decoded, encoded, &encoded_size) == 0);                                                        \
+        static meshcore_##name##_t redecoded;                                                                                                   \
+        FUZZ_ASSERT(meshcore_##name##_deserialize(encoded, encoded_size, &redecoded) == 0);                                                     \
+        FUZZ_ASSERT(memcmp(&decoded, &redecoded, sizeof(decoded)) == 0);                                                                        \
+        return 0;                                                                                                                               \
+    }                                                                                                                                           \
+                                                                                                                                                \
+    bool fuzz_input_from_frame(const uint8_t* frame, size_t frame_size, const uint8_t** out_input, size_t* out_input_size) {                    \
+        static meshcore_message_t message;                                                                                                      \
+        if (meshcore_deserialize((uint8_t*)frame, (uint8_t)frame_size, &message) < 0 || message.type != MESHCORE_PAYLOAD_TYPE_##payload_type) { \
+            return false;                                                                                                                       \
+        }                                                                                                                                       \
+        *out_input      = message.payload;                                                                                                      \
+        *out_input_size = message.payload_length;                                                                                               \
+        return true;                                                                                                                            \
+    }
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include <string.h>
+#include "fuzz.h"
+#include "meshcore/packet.h"
+#include "meshcore/payload/advert.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > MESHCORE_MAX_PAYLOAD_SIZE) {
+        return -1;
+    }
+
+    static meshcore_advert_t decoded;
+    if (meshcore_advert_deserialize((uint8_t*)data, (uint8_t)size, &decoded) < 0) {
+        return 0;
+    }
+
+    uint8_t encoded[MESHCORE_MAX_PAYLOAD_SIZE];
+    uint8_t encoded_size = 0;
+    FUZZ_ASSERT(meshcore_advert_serialize(&decoded, encoded, &encoded_size) == 0);
+
+    // Encoding a decoded payload and decoding it again has to give back the same fields
+    static meshcore_advert_t redecoded;
+    FUZZ_ASSERT(meshcore_advert_deserialize(encoded, encoded_size, &redecoded) == 0);
+    size_t name_length = strnlen(decoded.name, sizeof(decoded.name));
+    memset(&decoded.name[name_length], 0, sizeof(decoded.name) - name_length);  // Bytes after an embedded terminator are not encoded
+    FUZZ_ASSERT(memcmp(&decoded, &redecoded, sizeof(decoded)) == 0);
+
+    return 0;
+}
+
+bool fuzz_input_from_frame(const uint8_t* frame, size_t frame_size, const uint8_t** out_input, size_t* out_input_size) {
+    static meshcore_message_t message;
+    if (meshcore_deserialize((uint8_t*)frame, (uint8_t)frame_size, &message) < 0 || message.type != MESHCORE_PAYLOAD_TYPE_ADVERT) {
+        return false;
+    }
+    *out_input      = message.payload;
+    *out_input_size = message.payload_length;
+    return true;
+}
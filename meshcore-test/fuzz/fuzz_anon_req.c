@@ -0,0 +1,7 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "fuzz.h"
+#include "meshcore/payload/anon_req.h"
+
+FUZZ_PAYLOAD_TARGET(anon_req, ANON_REQ)
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include <string.h>
+#include "fuzz.h"
+#include "mc_companion_bundle.h"
+
+#define FUZZ_BUNDLE_MAX_CONTACTS 256
+
+static companion_contact_t           fuzz_bundle_contacts[FUZZ_BUNDLE_MAX_CONTACTS];
+static uint32_t                      fuzz_bundle_count;
+static uint32_t                      fuzz_bundle_checked;
+static uint8_t                       fuzz_bundle_encoded[MC_COMPANION_BUNDLE_HEADER_SIZE + (FUZZ_BUNDLE_MAX_CONTACTS + 1) * MC_COMPANION_BUNDLE_MAX_RECORD];
+static size_t                        fuzz_bundle_encoded_size;
+static mc_companion_bundle_encoder_t fuzz_bundle_encoder;
+static mc_companion_bundle_decoder_t fuzz_bundle_decoder;
+
+// Every decoded contact is encoded again, the second bundle has to decode to the same contacts
+static bool fuzz_bundle_contact(const companion_contact_t* contact, void* context) {
+    FUZZ_ASSERT(contact->out_path_len >= -1 && contact->out_path_len <= (int8_t)sizeof(contact->out_path));
+    if (fuzz_bundle_count < FUZZ_BUNDLE_MAX_CONTACTS) {
+        fuzz_bundle_contacts[fuzz_bundle_count] = *contact;
+        int written = mc_companion_bundle_encode_contact(&fuzz_bundle_encoder, contact, &fuzz_bundle_encoded[fuzz_bundle_encoded_size],
+                                                         sizeof(fuzz_bundle_encoded) - fuzz_bundle_encoded_size);
+        FUZZ_ASSERT(written > 0 && written <= MC_COMPANION_BUNDLE_MAX_RECORD);
+        fuzz_bundle_encoded_size += (size_t)written;
+    }
+    fuzz_bundle_count++;
+    return true;
+}
+
+static bool fuzz_bundle_check(const companion_contact_t* contact, void* context) {
+    FUZZ_ASSERT(fuzz_bundle_checked < fuzz_bundle_count && memcmp(contact, &fuzz_bundle_contacts[fuzz_bundle_checked], sizeof(*contact)) == 0);
+    fuzz_bundle_checked++;
+    return true;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // The first byte selects how the bundle is split into pieces, the decoder has to produce the same
+    // contacts no matter where the pieces are split
+    if (size < 1) {
+        return 0;
+    }
+
+    size_t chunk = (data[0] & 0x7F) + 1;
+    data++;
+    size--;
+
+    fuzz_bundle_count   = 0;
+    fuzz_bundle_checked = 0;
+    mc_companion_bundle_encoder_init(&fuzz_bundle_encoder);
+    fuzz_bundle_encoded_size = (size_t)mc_companion_bundle_encode_header(&fuzz_bundle_encoder, 0, fuzz_bundle_encoded, sizeof(fuzz_bundle_encoded));
+    mc_companion_bundle_decoder_init(&fuzz_bundle_decoder, fuzz_bundle_contact, NULL);
+
+    mc_companion_bundle_status_t status = MC_COMPANION_BUNDLE_IN_PROGRESS;
+    for (size_t position = 0; position < size; position += chunk) {
+        size_t length = (size - position < chunk) ? size - position : chunk;
+        status        = mc_companion_bundle_decode(&fuzz_bundle_decoder, &data[position], length);
+    }
+    FUZZ_ASSERT(status == fuzz_bundle_decoder.status);
+    if (status != MC_COMPANION_BUNDLE_COMPLETE || fuzz_bundle_count > FUZZ_BUNDLE_MAX_CONTACTS) {
+        return 0;
+    }
+
+    int written = mc_companion_bundle_encode_end(&fuzz_bundle_encoder, &fuzz_bundle_encoded[fuzz_bundle_encoded_size],
+                                                 sizeof(fuzz_bundle_encoded) - fuzz_bundle_encoded_size);
+    FUZZ_ASSERT(written > 0);
+    fuzz_bundle_encoded_size += (size_t)written;
+    mc_companion_bundle_decoder_init(&fuzz_bundle_decoder, fuzz_bundle_check, NULL);
+    FUZZ_ASSERT(mc_companion_bundle_decode(&fuzz_bundle_decoder, fuzz_bundle_encoded, fuzz_bundle_encoded_size) == MC_COMPANION_BUNDLE_COMPLETE);
+    FUZZ_ASSERT(fuzz_bundle_checked == fuzz_bundle_count);
+    return 0;
+}
+
+bool fuzz_input_from_frame(const uint8_t* frame, size_t frame_size, const uint8_t** out_input, size_t* out_input_size) {
+    // Captures hold radio frames, not contact bundles
+    return false;
+}
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include <stddef.h>
+#include <string.h>
+#include "fuzz.h"
+#include "mc_companion.h"
+#include "mc_companion_command_parser.h"
+#include "mc_companion_serial_interface.h"
+
+// Commands a framer produced, folded into a hash so that two ways of feeding the same input can be compared
+typedef struct {
+    uint32_t commands;
+    uint32_t hash;
+} fuzz_companion_result_t;
+
+static void fuzz_companion_hash(fuzz_companion_result_t* result, const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < length; i++) {
+        result->hash = (result->hash ^ bytes[i]) * 16777619u;
+    }
+}
+
+static void fuzz_companion_callback(mc_companion_framer_t* framer, companion_command_packet_t* command, mc_companion_command_parser_error_t error,
+                                    void* context) {
+    FUZZ_ASSERT(error == COMPANION_COMMAND_PARSER_ERROR_NONE || error == COMPANION_COMMAND_PARSER_ERROR_INVALID_COMMAND ||
+                error == COMPANION_COMMAND_PARSER_ERROR_INVALID_ARGUMENTS);
+
+    // Only a parsed command is fully written, after an error the packet may hold what an earlier command left
+    fuzz_companion_result_t* result = (fuzz_companion_result_t*)context;
+    result->commands++;
+    fuzz_companion_hash(result, &error, sizeof(error));
+    if (error == COMPANION_COMMAND_PARSER_ERROR_NONE) {
+        FUZZ_ASSERT(command->args_length <= sizeof(companion_command_packet_t) - offsetof(companion_command_packet_t, args));
+        fuzz_companion_hash(result, &command->command, sizeof(command->command));
+        fuzz_companion_hash(result, &command->args_length, sizeof(command->args_length));
+        fuzz_companion_hash(result, command->args, command->args_length);
+    }
+}
+
+static void fuzz_companion_feed(const uint8_t* data, size_t size, size_t chunk, uint16_t frame_size, fuzz_companion_result_t* result) {
+    // A fresh framer for every input, so that a crash reproduces from that input alone
+    static mc_companion_framer_t framer;
+    memset(result, 0, sizeof(fuzz_companion_result_t));
+    result->hash = 2166136261u;
+    mc_companion_framer_init(&framer, fuzz_companion_callback, result);
+    mc_companion_framer_set_frame_size(&framer, frame_size);
+    for (size_t position = 0; position < size; position += chunk) {
+        size_t length = (size - position < chunk) ? size - position : chunk;
+        mc_companion_framer_read(&framer, &data[position], length);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // The first byte selects how the input is split into serial reads and whether a larger frame size was
+    // negotiated, the framer has to produce the same commands as when it is fed the whole input at once
+    if (size < 1) {
+        return 0;
+    }
+
+    size_t   chunk      = (data[0] & 0x3F) + 1;
+    uint16_t frame_size = (data[0] & 0x80) ? MESHCORE_COMPANION_MAX_LINK_FRAME_SIZE : MESHCORE_COMPANION_MAX_FRAME_SIZE;
+    data++;
+    size--;
+
+    fuzz_companion_result_t split;
+    fuzz_companion_result_t whole;
+    fuzz_companion_feed(data, size, chunk, frame_size, &split);
+    fuzz_companion_feed(data, size, (size > 0) ? size : 1, frame_size, &whole);
+    FUZZ_ASSERT(split.commands == whole.commands && split.hash == whole.hash);
+
+    // Also parse the input directly as an unframed command
+    static companion_command_packet_t packet;
+    if (size <= MESHCORE_COMPANION_MAX_PAYLOAD_SIZE) {
+        mc_companion_parse_command((uint8_t*)data, (uint16_t)size, &packet);
+    }
+
+    return 0;
+}
+
+bool fuzz_input_from_frame(const uint8_t* frame, size_t frame_size, const uint8_t** out_input, size_t* out_input_size) {
+    // Captures hold radio frames, not companion traffic
+    return false;
+}
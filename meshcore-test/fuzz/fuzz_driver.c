@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+// Stand-alone driver for the fuzz targets when they are not built with libFuzzer. It runs every file
+// of a corpus (directories are read recursively, pcap-ng captures contribute their frames) through
+// the target once to check it, then replays the corpus to report decode throughput.
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "fuzz.h"
+#include "meshcore/capture.h"
+
+#define FUZZ_MAX_INPUT_SIZE 4096
+
+typedef struct {
+    uint8_t* data;
+    size_t   size;
+} fuzz_input_t;
+
+static fuzz_input_t* inputs         = NULL;
+static size_t        input_count    = 0;
+static size_t        input_capacity = 0;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void add_input(const uint8_t* data, size_t size) {
+    if (input_count == input_capacity) {
+        input_capacity = input_capacity ? input_capacity * 2 : 256;
+        inputs         = realloc(inputs, input_capacity * sizeof(fuzz_input_t));
+        if (inputs == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    inputs[input_count].data = malloc(size ? size : 1);
+    inputs[input_count].size = size;
+    memcpy(inputs[input_count].data, data, size);
+    input_count++;
+}
+
+static void load_path(const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "Failed to open %s (%i): %s\n", path, errno, strerror(errno));
+        return;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(path);
+        if (dir == NULL) {
+            return;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
+            char child[4096];
+            snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+            load_path(child);
+        }
+        closedir(dir);
+        return;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return;
+    }
+    uint8_t* data = malloc(st.st_size ? st.st_size : 1);
+    size_t   size = fread(data, 1, st.st_size, file);
+    fclose(file);
+
+    meshcore_capture_reader_t reader;
+    if (meshcore_capture_reader_init(&reader, data, size) == 0) {
+        meshcore_capture_frame_t frame;
+        while (meshcore_capture_next(&reader, &frame) > 0) {
+            const uint8_t* input;
+            size_t         input_size;
+            if (fuzz_input_from_frame(frame.data, frame.size, &input, &input_size)) {
+                add_input(input, input_size);
+            }
+        }
+    } else if (size <= FUZZ_MAX_INPUT_SIZE) {
+        add_input(data, size);
+    }
+
+    free(data);
+}
+
+int main(int argc, char* argv[]) {
+    unsigned repeat = 1000;
+    int      option;
+
+    while ((option = getopt(argc, argv, "n:")) != -1) {
+        switch (option) {
+            case 'n':
+                repeat = (unsigned)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n passes] corpus...\n", argv[0]);
+                return 1;
+        }
+    }
+
+    for (int i = optind; i < argc; i++) {
+        load_path(argv[i]);
+    }
+
+    if (input_count == 0) {
+        fprintf(stderr, "Usage: %s [-n passes] corpus...\n", argv[0]);
+        return 1;
+    }
+
+    // Targets are allowed to log, keep that out of the measurement
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        return 1;
+    }
+
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < input_count; i++) {
+        LLVMFuzzerTestOneInput(inputs[i].data, inputs[i].size);
+        bytes += inputs[i].size;
+    }
+    fprintf(stderr, "Checked %zu inputs (%" PRIu64 " bytes)\n", input_count, bytes);
+
+    if (repeat > 0) {
+        uint64_t start = monotonic_ns();
+        for (unsigned pass = 0; pass < repeat; pass++) {
+            for (size_t i = 0; i < input_count; i++) {
+                LLVMFuzzerTestOneInput(inputs[i].data, inputs[i].size);
+            }
+        }
+        uint64_t elapsed    = monotonic_ns() - start;
+        uint64_t executions = (uint64_t)repeat * input_count;
+        fprintf(stderr, "Replayed %" PRIu64 " inputs: %.1f ns/input, %.0f inputs/s, %.1f MB/s\n", executions, (double)elapsed / executions,
+                executions * 1e9 / elapsed, (double)bytes * repeat * 1e3 / elapsed);
+    }
+
+    for (size_t i = 0; i < input_count; i++) {
+        free(inputs[i].data);
+    }
+    free(inputs);
+
+    return 0;
+}
@@ -0,0 +1,7 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "fuzz.h"
+#include "meshcore/payload/grp_data.h"
+
+FUZZ_PAYLOAD_TARGET(grp_data, GRP_DATA)
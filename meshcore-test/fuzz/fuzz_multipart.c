@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include <string.h>
+#include "fuzz.h"
+#include "meshcore/multipart_reassembly.h"
+#include "meshcore/packet.h"
+#include "meshcore/payload/multipart.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > MESHCORE_MAX_PAYLOAD_SIZE) {
+        return -1;
+    }
+
+    static meshcore_multipart_t decoded;
+    if (meshcore_multipart_deserialize((uint8_t*)data, (uint8_t)size, &decoded) < 0) {
+        return 0;
+    }
+
+    uint8_t encoded[MESHCORE_MAX_PAYLOAD_SIZE];
+    uint8_t encoded_size = 0;
+    FUZZ_ASSERT(meshcore_multipart_serialize(&decoded, encoded, &encoded_size) == 0);
+
+    // Encoding a decoded payload and decoding it again has to give back the same fields
+    static meshcore_multipart_t redecoded;
+    FUZZ_ASSERT(meshcore_multipart_deserialize(encoded, encoded_size, &redecoded) == 0);
+    FUZZ_ASSERT(memcmp(&decoded, &redecoded, sizeof(decoded)) == 0);
+
+    // Fragments accumulate in the engine across inputs so that messages complete, expire and get evicted
+    static meshcore_multipart_reassembly_t reassembly;
+    static uint32_t                        now_ms = 0;
+    static bool                            initialized;
+    if (!initialized) {
+        meshcore_multipart_reassembly_init(&reassembly, 1000);
+        initialized = true;
+    }
+    now_ms += data[0];
+
+    static uint8_t               message[MESHCORE_MULTIPART_MAX_MESSAGE_SIZE];
+    meshcore_multipart_message_t info;
+    int result = meshcore_multipart_reassembly_push(&reassembly, &decoded, now_ms, message, sizeof(message), &info);
+    FUZZ_ASSERT(result >= -1 && result <= 1);
+    if (result == 1) {
+        FUZZ_ASSERT(info.length > (size_t)MESHCORE_MULTIPART_FRAGMENT_LAST(decoded.fragment) * MESHCORE_MULTIPART_FRAGMENT_SIZE);
+        FUZZ_ASSERT(info.length <= sizeof(message));
+    }
+    FUZZ_ASSERT(reassembly.active <= MESHCORE_MULTIPART_MAX_MESSAGES);
+
+    return 0;
+}
+
+bool fuzz_input_from_frame(const uint8_t* frame, size_t frame_size, const uint8_t** out_input, size_t* out_input_size) {
+    static meshcore_message_t message;
+    if (meshcore_deserialize((uint8_t*)frame, (uint8_t)frame_size, &message) < 0 || message.type != MESHCORE_PAYLOAD_TYPE_MULTIPART) {
+        return false;
+    }
+    *out_input      = message.payload;
+    *out_input_size = message.payload_length;
+    return true;
+}
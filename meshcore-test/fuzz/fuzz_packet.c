@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include <string.h>
+#include "fuzz.h"
+#include "meshcore/packet.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > MESHCORE_MAX_TRANS_UNIT) {
+        return -1;
+    }
+
+    meshcore_message_t message;
+    if (meshcore_deserialize((uint8_t*)data, (uint8_t)size, &message) < 0) {
+        return 0;
+    }
+
+    FUZZ_ASSERT(message.path_length <= MESHCORE_MAX_PATH_SIZE);
+    FUZZ_ASSERT(message.payload_length <= MESHCORE_MAX_PAYLOAD_SIZE);
+
+    // Every frame that decodes must encode back to exactly the same bytes
+    uint8_t encoded[MESHCORE_MAX_TRANS_UNIT];
+    uint8_t encoded_size = 0;
+    FUZZ_ASSERT(meshcore_serialize(&message, encoded, &encoded_size) == 0);
+    FUZZ_ASSERT(encoded_size == size && memcmp(encoded, data, size) == 0);
+
+    return 0;
+}
+
+bool fuzz_input_from_frame(const uint8_t* frame, size_t frame_size, const uint8_t** out_input, size_t* out_input_size) {
+    *out_input      = frame;
+    *out_input_size = frame_size;
+    return true;
+}
@@ -0,0 +1,7 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "fuzz.h"
+#include "meshcore/payload/path.h"
+
+FUZZ_PAYLOAD_TARGET(path, PATH)
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include <string.h>
+#include "fuzz.h"
+#include "meshcore/packet.h"
+#include "meshcore/stream_decoder.h"
+
+static int fuzz_stream_events;
+
+static bool fuzz_stream_header(meshcore_stream_decoder_t* decoder, const meshcore_message_t* message, void* context) {
+    FUZZ_ASSERT(fuzz_stream_events == 0);
+    fuzz_stream_events = 1;
+    return true;
+}
+
+static bool fuzz_stream_path(meshcore_stream_decoder_t* decoder, const meshcore_message_t* message, void* context) {
+    FUZZ_ASSERT(fuzz_stream_events == 1);
+    fuzz_stream_events = 2;
+    return true;
+}
+
+static bool fuzz_stream_payload_prefix(meshcore_stream_decoder_t* decoder, const meshcore_message_t* message, void* context) {
+    FUZZ_ASSERT(fuzz_stream_events == 2 && message->payload_length == decoder->prefix_length);
+    fuzz_stream_events = 3;
+    return true;
+}
+
+static void fuzz_stream_payload(meshcore_stream_decoder_t* decoder, const meshcore_message_t* message, void* context) {
+    FUZZ_ASSERT(fuzz_stream_events >= 2);
+    fuzz_stream_events = 4;
+}
+
+static const meshcore_stream_callbacks_t fuzz_stream_callbacks = {
+    .header         = fuzz_stream_header,
+    .path           = fuzz_stream_path,
+    .payload_prefix = fuzz_stream_payload_prefix,
+    .payload        = fuzz_stream_payload,
+};
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // The first byte selects how the frame is split into reads and whether its size is given up front, the
+    // decoder has to produce the same message as meshcore_deserialize no matter how it is fed
+    if (size < 1 || size > MESHCORE_MAX_TRANS_UNIT + 1) {
+        return 0;
+    }
+
+    size_t chunk      = (data[0] & 0x3F) + 1;
+    bool   known_size = (data[0] & 0x80) == 0;
+    data++;
+    size--;
+
+    static meshcore_stream_decoder_t decoder;
+    meshcore_stream_init(&decoder, &fuzz_stream_callbacks, NULL, 2);
+    meshcore_stream_begin(&decoder, known_size ? (uint8_t)size : 0);
+    fuzz_stream_events = 0;
+
+    meshcore_stream_status_t status = MESHCORE_STREAM_IN_PROGRESS;
+    for (size_t position = 0; position < size && status == MESHCORE_STREAM_IN_PROGRESS; position += chunk) {
+        size_t length   = (size - position < chunk) ? size - position : chunk;
+        size_t consumed = 0;
+        status          = meshcore_stream_feed(&decoder, &data[position], length, &consumed);
+        FUZZ_ASSERT(consumed <= length);
+    }
+    if (known_size && size > 0) {
+        // A frame of known size finishes on its last byte at the latest, it is never left waiting for more
+        FUZZ_ASSERT(status != MESHCORE_STREAM_IN_PROGRESS);
+    } else if (status == MESHCORE_STREAM_IN_PROGRESS) {
+        status = meshcore_stream_end(&decoder);
+    }
+
+    meshcore_message_t message;
+    if (meshcore_deserialize((uint8_t*)data, (uint8_t)size, &message) < 0) {
+        FUZZ_ASSERT(status == MESHCORE_STREAM_ERROR);
+        return 0;
+    }
+
+    FUZZ_ASSERT(status == MESHCORE_STREAM_COMPLETE && fuzz_stream_events == 4);
+    FUZZ_ASSERT(memcmp(&message, &decoder.message, sizeof(meshcore_message_t)) == 0);
+    return 0;
+}
+
+bool fuzz_input_from_frame(const uint8_t* frame, size_t frame_size, const uint8_t** out_input, size_t* out_input_size) {
+    // Feed captured frames in reads of seven bytes with the size given up front
+    static uint8_t input[MESHCORE_MAX_TRANS_UNIT + 1];
+    if (frame_size > MESHCORE_MAX_TRANS_UNIT) {
+        return false;
+    }
+    input[0] = 6;
+    memcpy(&input[1], frame, frame_size);
+    *out_input      = input;
+    *out_input_size = frame_size + 1;
+    return true;
+}
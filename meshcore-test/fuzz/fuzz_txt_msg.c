@@ -0,0 +1,7 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "fuzz.h"
+#include "meshcore/payload/txt_msg.h"
+
+FUZZ_PAYLOAD_TARGET(txt_msg, TXT_MSG)
@@ -3,6 +3,7 @@
 #include <string.h>
 #include "aes.h"
 #include "hmac_sha256.h"
+#include "meshcore/capture.h"
 #include "meshcore/packet.h"
 #include "meshcore/payload/advert.h"
 #include "meshcore/payload/grp_txt.h"
@@ -97,7 +98,42 @@ const char* role_to_string(meshcore_device_role_t role) {
     }
 }
 
+static int capture_write_file(void* context, const uint8_t* data, size_t length) {
+    return (fwrite(data, 1, length, (FILE*)context) == length) ? 0 : -1;
+}
+
+// Store the test frames in a pcap-ng capture, which can be replayed with meshcore_replay
+static int write_capture(const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        printf("Failed to open capture file %s\n", filename);
+        return -1;
+    }
+
+    static uint8_t     capture_buffer[4096];
+    meshcore_capture_t capture;
+    meshcore_capture_init(&capture, capture_buffer, sizeof(capture_buffer), capture_write_file, file);
+    capture.channel.frequency        = 869618000;
+    capture.channel.bandwidth        = 62500;
+    capture.channel.spreading_factor = 8;
+
+    uint64_t timestamp_us = 1767225600000000ull;
+    meshcore_capture_frame(&capture, timestamp_us, 0, 12 * 4, -72, packet_bin, packet_bin_len);
+    meshcore_capture_frame(&capture, timestamp_us + 250000, 0, -3 * 4, -110, test_message_rx_bin, test_message_rx_bin_len);
+    meshcore_capture_frame(&capture, timestamp_us + 500000, 1, 7 * 4, -95, advert_bin, advert_bin_len);
+
+    int result = meshcore_capture_flush(&capture);
+    fclose(file);
+
+    printf("Wrote %u frames to %s\n", capture.frames, filename);
+    return result;
+}
+
 int main(int argc, char* argv[]) {
+    if (argc > 1 && write_capture(argv[1]) < 0) {
+        return -1;
+    }
+
     printf("Input packet binary data [%zu]:\n", test_message_rx_bin_len);
     for (unsigned int i = 0; i < test_message_rx_bin_len; i++) {
         printf("%02X", test_message_rx_bin[i]);
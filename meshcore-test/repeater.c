@@ -0,0 +1,238 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+// Repeater on a virtual radio link: repeats flooded frames heard on a UDP multicast link once, with the
+// dedup table and TX scheduler a radio repeater uses. Start any number of them, together with companion
+// servers using the same link, to build a mesh of processes on one machine.
+
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "meshcore/dedup.h"
+#include "meshcore/link.h"
+#include "meshcore/link_udp.h"
+#include "meshcore/packet.h"
+#include "meshcore/stats.h"
+#include "meshcore/timer_wheel.h"
+#include "meshcore/tx_scheduler.h"
+
+#define TIMER_TICK_MS       10
+#define DEDUP_TTL_MS        60000
+#define METRICS_INTERVAL_MS 10000
+
+static volatile sig_atomic_t running = 1;
+static meshcore_stats_t      node_stats;
+
+static void stop(int signal_number) {
+    (void)signal_number;
+    running = 0;
+}
+
+static uint32_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+// Export the node statistics for a Prometheus textfile collector, replacing the file in one step
+static void write_metrics(meshcore_timer_t* timer, void* context) {
+    static char             text[4096];
+    const char*             path = (const char*)context;
+    meshcore_stats_totals_t totals;
+    meshcore_stats_snapshot(&node_stats, &totals);
+    int length = meshcore_stats_format_prometheus(&totals, text, sizeof(text));
+    if (length < 0) {
+        return;
+    }
+
+    char temporary[256];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE* file = fopen(temporary, "w");
+    if (file == NULL) {
+        printf("Failed to write metrics to %s (%i): %s\r\n", temporary, errno, strerror(errno));
+        return;
+    }
+    fwrite(text, 1, (size_t)length, file);
+    fclose(file);
+    rename(temporary, path);
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-l group:port] [-H hash] [-m max hops] [-L loss] [-d latency] [-j jitter] [-r rate] [-M metrics.prom] [-v]\r\n", name);
+    printf("  -l  multicast group and port of the link (default %s:%u)\r\n", MESHCORE_LINK_UDP_DEFAULT_GROUP, MESHCORE_LINK_UDP_DEFAULT_PORT);
+    printf("  -H  path hash of this repeater in hex (default: from the process id)\r\n");
+    printf("  -m  maximum path length of repeated floods (default 64)\r\n");
+    printf("  -L  outgoing frame loss in permille\r\n");
+    printf("  -d  outgoing frame latency in ms\r\n");
+    printf("  -j  outgoing frame jitter in ms\r\n");
+    printf("  -r  outgoing bit rate limit in bit/s\r\n");
+    printf("  -M  write node statistics to a Prometheus text file every %u s\r\n", METRICS_INTERVAL_MS / 1000);
+    printf("  -v  print every frame\r\n");
+}
+
+int main(int argc, char* argv[]) {
+    char                       group[64]  = MESHCORE_LINK_UDP_DEFAULT_GROUP;
+    uint16_t                   port       = MESHCORE_LINK_UDP_DEFAULT_PORT;
+    uint8_t                    hash       = (uint8_t)getpid();
+    uint8_t                    max_hops   = MESHCORE_MAX_PATH_SIZE;
+    bool                       verbose    = false;
+    const char*                metrics    = NULL;
+    meshcore_link_impairment_t impairment = {0};
+    int                        option;
+
+    while ((option = getopt(argc, argv, "l:H:m:L:d:j:r:M:v")) != -1) {
+        switch (option) {
+            case 'l':
+                if (meshcore_link_udp_parse(optarg, group, sizeof(group), &port) < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'H':
+                hash = (uint8_t)strtoul(optarg, NULL, 16);
+                break;
+            case 'm':
+                max_hops = (uint8_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'L':
+                impairment.loss_permille = (uint16_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                impairment.latency_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'j':
+                impairment.jitter_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                impairment.rate_bps = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'M':
+                metrics = optarg;
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind != argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    meshcore_link_t     link;
+    meshcore_link_udp_t udp;
+    if (meshcore_link_udp_open(&link, &udp, group, port, (uint32_t)getpid() * 2654435761u) < 0) {
+        printf("Failed to open link %s:%u (%i): %s\r\n", group, port, errno, strerror(errno));
+        return 1;
+    }
+    meshcore_link_set_impairment(&link, &impairment);
+
+    static meshcore_timer_wheel_t  wheel;
+    static meshcore_dedup_t        dedup;
+    static meshcore_tx_scheduler_t scheduler;
+    static meshcore_timer_t        metrics_timer;
+    meshcore_radio_params_t        params = {.frequency = 869618, .bandwidth = 62500, .spreading_factor = 8, .coding_rate = 8,
+                                             .preamble_length = MESHCORE_TX_DEFAULT_PREAMBLE_LENGTH};
+    uint32_t                       busy_until_ms = now_ms();
+    uint64_t                       repeated      = 0;
+    uint64_t                       duplicates    = 0;
+
+    meshcore_timer_wheel_init(&wheel, TIMER_TICK_MS, now_ms());
+    meshcore_dedup_init(&dedup, &wheel, DEDUP_TTL_MS);
+    meshcore_tx_scheduler_init(&scheduler, &params, 1000, 3600000, now_ms(), (uint32_t)getpid());
+
+    meshcore_stats_init(&node_stats);
+    meshcore_stats_shard_t* shard = meshcore_stats_attach(&node_stats);
+    meshcore_link_set_stats(&link, shard);
+    meshcore_tx_set_stats(&scheduler, shard);
+    if (metrics != NULL) {
+        meshcore_timer_init(&metrics_timer, write_metrics, (void*)metrics);
+        meshcore_timer_start_periodic(&wheel, &metrics_timer, now_ms() + METRICS_INTERVAL_MS, METRICS_INTERVAL_MS);
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    printf("Repeater %02X on %s:%u\r\n", hash, group, port);
+
+    while (running) {
+        uint32_t now     = now_ms();
+        uint32_t timeout = TIMER_TICK_MS;
+        uint32_t wait    = UINT32_MAX;
+
+        meshcore_timer_wheel_advance(&wheel, now);
+        meshcore_link_poll(&link, now, &wait);
+        if (wait < timeout) {
+            timeout = wait;
+        }
+
+        // The simulated radio is busy for the airtime of every frame it sends
+        if ((int32_t)(now - busy_until_ms) >= 0) {
+            uint8_t data[MESHCORE_MAX_TRANS_UNIT];
+            uint8_t size = 0;
+            if (meshcore_tx_next(&scheduler, now, data, &size, &wait) == 1) {
+                meshcore_link_send(&link, data, size, now);
+                busy_until_ms = now + meshcore_lora_airtime_us(&params, size) / 1000;
+                timeout       = 0;
+            } else if (wait < timeout) {
+                timeout = wait;
+            }
+        } else if (busy_until_ms - now < timeout) {
+            timeout = busy_until_ms - now;
+        }
+
+        struct pollfd descriptor = {.fd = link.fd, .events = POLLIN};
+        int           ready      = poll(&descriptor, 1, (int)timeout);
+        if (ready < 0 && errno != EINTR) {
+            printf("Failed to wait for the link (%i): %s\r\n", errno, strerror(errno));
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+
+        meshcore_message_t message;
+        while (meshcore_link_receive_message(&link, &message) > 0) {
+            now = now_ms();
+            if (verbose) {
+                printf("type %u route %u path %u payload %u\r\n", message.type, message.route, message.path_length, message.payload_length);
+            }
+            if (meshcore_dedup_seen(&dedup, meshcore_dedup_hash(&message), now)) {
+                duplicates++;
+                meshcore_stats_add(shard, MESHCORE_STATS_DUPLICATES, 1);
+                continue;
+            }
+            bool flood = message.route == MESHCORE_ROUTE_TYPE_FLOOD || message.route == MESHCORE_ROUTE_TYPE_TRANSPORT_FLOOD;
+            if (!flood || message.path_length >= max_hops || message.path_length >= MESHCORE_MAX_PATH_SIZE) {
+                continue;
+            }
+
+            message.path[message.path_length++] = hash;
+            uint8_t data[MESHCORE_MAX_TRANS_UNIT];
+            uint8_t size = 0;
+            if (meshcore_serialize(&message, data, &size) == 0 &&
+                meshcore_tx_enqueue(&scheduler, data, size, meshcore_tx_classify(&message), now) == 0) {
+                repeated++;
+                meshcore_stats_add(shard, MESHCORE_STATS_FORWARDED, 1);
+            }
+        }
+    }
+
+    printf("Received %" PRIu32 " frames (%" PRIu32 " malformed), repeated %" PRIu64 ", %" PRIu64 " duplicates, %" PRIu32 " lost, %" PRIu32
+           " dropped, %" PRIu32 " link errors\r\n",
+           link.stats.received, link.stats.malformed, repeated, duplicates, link.stats.lost, link.stats.dropped, link.stats.errors);
+    if (metrics != NULL) {
+        write_metrics(&metrics_timer, (void*)metrics);
+    }
+    meshcore_link_close(&link);
+    return 0;
+}
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "meshcore/capture.h"
+#include "meshcore/packet.h"
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t deadline) {
+    struct timespec ts = {
+        .tv_sec  = deadline / 1000000000ull,
+        .tv_nsec = deadline % 1000000000ull,
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-r] [-n repeat] [-v] capture.pcapng\r\n", name);
+    printf("  -r  replay in recorded real time instead of at full speed\r\n");
+    printf("  -n  number of passes over the capture (default 1)\r\n");
+    printf("  -v  print every decoded frame\r\n");
+}
+
+int main(int argc, char* argv[]) {
+    bool     realtime = false;
+    bool     verbose  = false;
+    unsigned repeat   = 1;
+    int      option;
+
+    while ((option = getopt(argc, argv, "rn:v")) != -1) {
+        switch (option) {
+            case 'r':
+                realtime = true;
+                break;
+            case 'n':
+                repeat = (unsigned)strtoul(optarg, NULL, 10);
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind != argc - 1 || repeat == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int fd = open(argv[optind], O_RDONLY);
+    if (fd < 0) {
+        printf("Failed to open capture (%i): %s\r\n", errno, strerror(errno));
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("Capture is empty or can not be read\r\n");
+        close(fd);
+        return 1;
+    }
+
+    size_t         capture_size = (size_t)st.st_size;
+    const uint8_t* capture      = mmap(NULL, capture_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (capture == MAP_FAILED) {
+        printf("Failed to map capture (%i): %s\r\n", errno, strerror(errno));
+        return 1;
+    }
+    // Advice values are not flags, each is given on its own. Both are hints, the replay works without them.
+    if (madvise((void*)capture, capture_size, MADV_SEQUENTIAL) != 0) {
+        printf("Failed to advise sequential access (%i): %s\r\n", errno, strerror(errno));
+    }
+    if (madvise((void*)capture, capture_size, MADV_WILLNEED) != 0) {
+        printf("Failed to advise read ahead (%i): %s\r\n", errno, strerror(errno));
+    }
+
+    uint64_t frames          = 0;
+    uint64_t bytes           = 0;
+    uint64_t decode_errors   = 0;
+    uint64_t type_counts[16] = {0};
+    uint64_t decode_ns       = 0;
+    int      result          = 0;
+    uint64_t start_ns        = monotonic_ns();
+
+    for (unsigned pass = 0; pass < repeat && result >= 0; pass++) {
+        meshcore_capture_reader_t reader;
+        if (meshcore_capture_reader_init(&reader, capture, capture_size) < 0) {
+            printf("Not a pcap-ng capture in host byte order\r\n");
+            munmap((void*)capture, capture_size);
+            return 1;
+        }
+
+        uint64_t                 first_timestamp_us = 0;
+        uint64_t                 pass_start_ns      = monotonic_ns();
+        meshcore_capture_frame_t frame;
+
+        while ((result = meshcore_capture_next(&reader, &frame)) > 0) {
+            if (realtime) {
+                if (first_timestamp_us == 0) {
+                    first_timestamp_us = frame.timestamp_us;
+                }
+                sleep_until_ns(pass_start_ns + (frame.timestamp_us - first_timestamp_us) * 1000ull);
+            }
+
+            meshcore_message_t message;
+            int                status;
+            if (realtime) {
+                // Frames are spaced out, time the decoder itself rather than the pass
+                uint64_t before  = monotonic_ns();
+                status           = meshcore_deserialize((uint8_t*)frame.data, frame.size, &message);
+                decode_ns       += monotonic_ns() - before;
+            } else {
+                status = meshcore_deserialize((uint8_t*)frame.data, frame.size, &message);
+            }
+
+            frames++;
+            bytes += frame.size;
+            if (status < 0) {
+                decode_errors++;
+            } else {
+                type_counts[message.type & 0x0F]++;
+            }
+
+            if (verbose) {
+                printf("%" PRIu64 ".%06" PRIu64 " link %u snr %.2f rssi %d len %u: ", frame.timestamp_us / 1000000, frame.timestamp_us % 1000000,
+                       frame.link_id, frame.snr / 4.0, frame.rssi, frame.size);
+                if (status < 0) {
+                    printf("decode error\r\n");
+                } else {
+                    printf("type %u route %u path %u payload %u\r\n", message.type, message.route, message.path_length, message.payload_length);
+                }
+            }
+        }
+
+        if (!realtime) {
+            decode_ns += monotonic_ns() - pass_start_ns;
+        }
+    }
+
+    uint64_t elapsed_ns = monotonic_ns() - start_ns;
+    munmap((void*)capture, capture_size);
+
+    if (result < 0) {
+        printf("Capture is malformed after %" PRIu64 " frames\r\n", frames);
+    }
+
+    printf("Frames: %" PRIu64 " (%" PRIu64 " bytes), decode errors: %" PRIu64 "\r\n", frames, bytes, decode_errors);
+    for (unsigned int type = 0; type < 16; type++) {
+        if (type_counts[type] > 0) {
+            printf("  type %2u: %" PRIu64 "\r\n", type, type_counts[type]);
+        }
+    }
+    if (frames > 0 && decode_ns > 0) {
+        printf("Decode: %.1f ns/frame, %.0f frames/s, %.1f MB/s\r\n", (double)decode_ns / frames, frames * 1e9 / decode_ns, bytes * 1e3 / decode_ns);
+    }
+    printf("Wall time: %.3f s\r\n", elapsed_ns / 1e9);
+
+    return (result < 0) ? 1 : 0;
+}
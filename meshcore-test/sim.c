@@ -0,0 +1,1004 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+// Discrete-event mesh simulator. Every virtual node runs the library itself: frames are built and parsed
+// with the packet and payload codecs, duplicates are dropped by a dedup table on the node's own timer wheel
+// and transmissions go through the TX scheduler, which also provides the LoRa time on air. Nodes are placed
+// at random and connected by a log-distance path loss model with per-link shadowing, a reception survives
+// when it is above the demodulation floor of the spreading factor and no overlapping signal comes within
+// the capture margin, and a node can not receive while it transmits.
+//
+// Events are processed in parallel in conservative time windows. A node decides to transmit at least one
+// turnaround time before the frame goes out, so within a window of that length nodes only interact through
+// transmissions decided in earlier windows. Each worker runs the events of its own nodes for a window, after
+// which the new transmissions are published and handed to the receivers. Nodes only touch their own state
+// within a window and everything is merged in node order, so results are the same for any number of threads.
+
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "meshcore/dedup.h"
+#include "meshcore/packet.h"
+#include "meshcore/timer_wheel.h"
+#include "meshcore/tx_scheduler.h"
+#include "meshcore/payload/txt_msg.h"
+
+// Definitions
+
+#define SIM_INCOMING         64      // Receptions a node remembers for collision checks
+#define SIM_OWN_TX           4       // Own transmissions a node remembers for half-duplex checks
+#define SIM_CAPTURE_DB       6.0     // A frame survives an overlapping one that is at least this much weaker
+#define SIM_INTERFERENCE_DB  6.0     // Links are kept down to this far below the demodulation floor as interferers
+#define SIM_DEDUP_TTL_MS     60000
+#define SIM_WHEEL_TICK_MS    100
+#define SIM_DRAIN_S          60.0    // Simulated time after the last message is generated
+#define SIM_MESSAGE_HEADER   10      // Destination node (2), message number (4), creation time in ms (4)
+
+typedef enum {
+    SIM_EVENT_TRAFFIC  = 0,  // Generate a message
+    SIM_EVENT_RX_END   = 1,  // A frame heard by the node ended, argument is the transmission id
+    SIM_EVENT_TX_CHECK = 2,  // Ask the TX scheduler for a frame
+    SIM_EVENT_TX_END   = 3,  // Own transmission ended
+} sim_event_type_t;
+
+typedef struct {
+    uint64_t time_us;
+    uint32_t sequence;  // Orders events at the same time
+    uint32_t argument;
+    uint8_t  type;
+} sim_event_t;
+
+typedef struct {
+    sim_event_t* events;
+    uint32_t     count;
+    uint32_t     capacity;
+} sim_heap_t;
+
+typedef struct {
+    uint32_t receiver;
+    float    rssi;  // dBm
+    bool     decodable;
+} sim_link_t;
+
+typedef struct {
+    uint32_t tx;
+    bool     decodable;
+    float    rssi;
+    uint64_t start_us;
+    uint64_t end_us;
+} sim_incoming_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t sender;
+    uint64_t start_us;
+    uint64_t end_us;
+    uint8_t  size;
+    uint8_t  data[MESHCORE_MAX_TRANS_UNIT];
+} sim_tx_t;
+
+typedef struct {
+    uint64_t generated;
+    uint64_t delivered;
+    uint64_t latency_total_us;
+    uint64_t latency_max_us;
+    uint64_t transmissions;
+    uint64_t airtime_us;
+    uint64_t heard_us;  // Time the channel was busy at the node: the union of every frame that reached it, decodable or not
+    uint64_t received;
+    uint64_t duplicates;
+    uint64_t collisions;
+    uint64_t half_duplex;
+    uint64_t forwarded;  // Transmissions of frames received from other nodes
+    uint64_t queue_drops;
+    uint64_t overruns;  // Frames that fell out of the incoming or transmission ring before they ended
+    uint64_t decode_errors;
+} sim_stats_t;
+
+typedef struct {
+    uint32_t                id;
+    uint8_t                 hash;
+    bool                    repeater;
+    uint32_t                random;
+    uint32_t                sequence;
+    uint32_t                event_sequence;
+    float                   x;
+    float                   y;
+    sim_link_t*             links;  // Sorted by receiver
+    uint32_t                link_count;
+    uint32_t                decodable_links;
+    sim_heap_t              heap;
+    uint64_t                busy_until_us;
+    uint64_t                check_at_us;
+    uint32_t                incoming_head;
+    sim_incoming_t          incoming[SIM_INCOMING];
+    uint32_t                own_head;
+    uint64_t                own_start_us[SIM_OWN_TX];
+    uint64_t                own_end_us[SIM_OWN_TX];
+    bool                    outbox_used;
+    sim_tx_t                outbox;
+    uint32_t*               latencies_ms;
+    uint32_t                latency_count;
+    uint32_t                latency_capacity;
+    sim_stats_t             stats;
+    meshcore_timer_wheel_t  wheel;
+    meshcore_dedup_t        dedup;
+    meshcore_tx_scheduler_t scheduler;
+} sim_node_t;
+
+typedef struct {
+    uint32_t                nodes;
+    double                  spacing_m;
+    double                  duration_s;
+    double                  interval_s;
+    uint32_t                seed;
+    unsigned                threads;
+    uint8_t                 max_hops;
+    uint8_t                 message_size;
+    uint32_t                repeater_percent;
+    uint16_t                duty_cycle_permille;
+    uint32_t                turnaround_us;
+    double                  tx_power_dbm;
+    double                  path_loss_exponent;
+    double                  shadowing_db;
+    double                  noise_figure_db;
+    meshcore_radio_params_t params;
+} sim_config_t;
+
+typedef struct sim sim_t;
+
+typedef struct {
+    sim_t*    sim;
+    pthread_t thread;
+    unsigned  index;
+    uint32_t  first;
+    uint32_t  last;
+    uint64_t  next_us;  // Earliest pending event of the worker's nodes
+    uint32_t* senders;  // Nodes that decided to transmit in the current window, in node order
+    uint32_t  sender_count;
+} sim_worker_t;
+
+struct sim {
+    sim_config_t      config;
+    sim_node_t*       nodes;
+    sim_worker_t*     workers;
+    pthread_barrier_t barrier;
+    double            floor_dbm;  // Weakest decodable signal
+    uint64_t          traffic_end_us;
+    uint64_t          end_us;
+    uint64_t          window_end_us;
+    bool              done;
+    uint64_t          windows;
+    sim_tx_t*         transmissions;  // Ring indexed by transmission id
+    uint32_t          transmission_mask;
+    uint32_t          next_tx;
+    uint32_t          published_first;
+    uint32_t          published_last;
+};
+
+// Functions
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t sim_mix(uint32_t value) {
+    value ^= value >> 16;
+    value *= 0x7FEB352Du;
+    value ^= value >> 15;
+    value *= 0x846CA68Bu;
+    value ^= value >> 16;
+    return value;
+}
+
+static uint32_t sim_random(uint32_t* state) {
+    uint32_t value = *state;
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    *state = value;
+    return value;
+}
+
+// Uniform in (0, 1]
+static double sim_uniform(uint32_t* state) {
+    return (sim_random(state) + 1.0) / 4294967296.0;
+}
+
+static bool sim_event_before(const sim_event_t* a, const sim_event_t* b) {
+    return (a->time_us != b->time_us) ? (a->time_us < b->time_us) : (a->sequence < b->sequence);
+}
+
+static void sim_heap_push(sim_heap_t* heap, const sim_event_t* event) {
+    if (heap->count == heap->capacity) {
+        heap->capacity = (heap->capacity > 0) ? heap->capacity * 2 : 16;
+        heap->events   = realloc(heap->events, heap->capacity * sizeof(sim_event_t));
+        if (heap->events == NULL) {
+            printf("Out of memory\r\n");
+            exit(1);
+        }
+    }
+
+    uint32_t position = heap->count++;
+    while (position > 0) {
+        uint32_t parent = (position - 1) / 2;
+        if (!sim_event_before(event, &heap->events[parent])) {
+            break;
+        }
+        heap->events[position] = heap->events[parent];
+        position               = parent;
+    }
+    heap->events[position] = *event;
+}
+
+static sim_event_t sim_heap_pop(sim_heap_t* heap) {
+    sim_event_t top  = heap->events[0];
+    sim_event_t last = heap->events[--heap->count];
+
+    uint32_t position = 0;
+    for (;;) {
+        uint32_t child = position * 2 + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && sim_event_before(&heap->events[child + 1], &heap->events[child])) {
+            child++;
+        }
+        if (!sim_event_before(&heap->events[child], &last)) {
+            break;
+        }
+        heap->events[position] = heap->events[child];
+        position               = child;
+    }
+    if (heap->count > 0) {
+        heap->events[position] = last;
+    }
+    return top;
+}
+
+static void sim_schedule(sim_node_t* node, uint64_t time_us, sim_event_type_t type, uint32_t argument) {
+    sim_event_t event = {
+        .time_us  = time_us,
+        .sequence = node->event_sequence++,
+        .argument = argument,
+        .type     = (uint8_t)type,
+    };
+    sim_heap_push(&node->heap, &event);
+}
+
+// Only the earliest pending scheduler check is kept, later ones are skipped when they come up
+static void sim_schedule_check(sim_node_t* node, uint64_t time_us) {
+    if (time_us < node->check_at_us) {
+        node->check_at_us = time_us;
+        sim_schedule(node, time_us, SIM_EVENT_TX_CHECK, 0);
+    }
+}
+
+static void sim_schedule_traffic(sim_t* sim, sim_node_t* node, uint64_t now_us) {
+    uint64_t delay_us = (uint64_t)(-log(sim_uniform(&node->random)) * sim->config.interval_s * 1e6);
+    if (now_us + delay_us < sim->traffic_end_us) {
+        sim_schedule(node, now_us + delay_us, SIM_EVENT_TRAFFIC, 0);
+    }
+}
+
+static void sim_put_u16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void sim_put_u32(uint8_t* out, uint32_t value) {
+    sim_put_u16(out, (uint16_t)value);
+    sim_put_u16(out + 2, (uint16_t)(value >> 16));
+}
+
+static uint32_t sim_get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static void sim_record_latency(sim_node_t* node, uint64_t latency_us) {
+    if (node->latency_count == node->latency_capacity) {
+        node->latency_capacity = (node->latency_capacity > 0) ? node->latency_capacity * 2 : 64;
+        node->latencies_ms     = realloc(node->latencies_ms, node->latency_capacity * sizeof(uint32_t));
+        if (node->latencies_ms == NULL) {
+            printf("Out of memory\r\n");
+            exit(1);
+        }
+    }
+    node->latencies_ms[node->latency_count++]  = (uint32_t)(latency_us / 1000);
+    node->stats.latency_total_us              += latency_us;
+    if (latency_us > node->stats.latency_max_us) {
+        node->stats.latency_max_us = latency_us;
+    }
+}
+
+static void sim_enqueue(sim_node_t* node, const meshcore_message_t* message, uint64_t now_us) {
+    uint8_t data[MESHCORE_MAX_TRANS_UNIT];
+    uint8_t size;
+    if (meshcore_serialize(message, data, &size) < 0) {
+        node->stats.decode_errors++;
+        return;
+    }
+    if (meshcore_tx_enqueue(&node->scheduler, data, size, meshcore_tx_classify(message), (uint32_t)(now_us / 1000)) < 0) {
+        node->stats.queue_drops++;
+        return;
+    }
+    sim_schedule_check(node, now_us);
+}
+
+// Originate a flooded text message to a random other node
+static void sim_traffic(sim_t* sim, sim_node_t* node, uint64_t now_us) {
+    uint32_t destination = sim_random(&node->random) % (sim->config.nodes - 1);
+    if (destination >= node->id) {
+        destination++;
+    }
+
+    meshcore_txt_msg_t text = {
+        .destination_hash  = sim->nodes[destination].hash,
+        .source_hash       = node->hash,
+        .ciphertext_length = sim->config.message_size,
+    };
+    for (uint8_t position = 0; position < text.ciphertext_length; position++) {
+        text.ciphertext[position] = (uint8_t)sim_random(&node->random);
+    }
+    sim_put_u16(&text.ciphertext[0], (uint16_t)destination);
+    sim_put_u32(&text.ciphertext[2], node->sequence++);
+    sim_put_u32(&text.ciphertext[6], (uint32_t)(now_us / 1000));
+
+    meshcore_message_t message = {
+        .type    = MESHCORE_PAYLOAD_TYPE_TXT_MSG,
+        .route   = MESHCORE_ROUTE_TYPE_FLOOD,
+        .version = 0,
+    };
+    if (meshcore_txt_msg_serialize(&text, message.payload, &message.payload_length) < 0) {
+        node->stats.decode_errors++;
+        return;
+    }
+
+    // The originator must not repeat its own message when it hears it back
+    meshcore_dedup_seen(&node->dedup, meshcore_dedup_hash(&message), (uint32_t)(now_us / 1000));
+    node->stats.generated++;
+    sim_enqueue(node, &message, now_us);
+    sim_schedule_traffic(sim, node, now_us);
+}
+
+static bool sim_overlaps(uint64_t start_a, uint64_t end_a, uint64_t start_b, uint64_t end_b) {
+    return start_a < end_b && start_b < end_a;
+}
+
+// Airtime of a reception that no earlier reception covered, receptions are ordered by end and then by
+// transmission. Summed over all receptions every busy moment counts once, however many frames overlap it.
+static uint64_t sim_heard_new_us(const sim_node_t* node, const sim_incoming_t* incoming) {
+    uint64_t starts[SIM_INCOMING];
+    uint64_t ends[SIM_INCOMING];
+    uint32_t count = 0;
+    for (uint32_t index = 0; index < SIM_INCOMING; index++) {
+        const sim_incoming_t* other   = &node->incoming[index];
+        bool                  earlier = other->end_us < incoming->end_us || (other->end_us == incoming->end_us && (int32_t)(other->tx - incoming->tx) < 0);
+        if (other->end_us == 0 || !earlier || !sim_overlaps(incoming->start_us, incoming->end_us, other->start_us, other->end_us)) {
+            continue;
+        }
+        // Insert sorted by start, clipped to this reception
+        uint64_t start    = (other->start_us > incoming->start_us) ? other->start_us : incoming->start_us;
+        uint32_t position = count++;
+        while (position > 0 && starts[position - 1] > start) {
+            starts[position] = starts[position - 1];
+            ends[position]   = ends[position - 1];
+            position--;
+        }
+        starts[position] = start;
+        ends[position]   = other->end_us;
+    }
+
+    uint64_t heard_us = 0;
+    uint64_t from_us  = incoming->start_us;
+    for (uint32_t index = 0; index < count && from_us < incoming->end_us; index++) {
+        if (starts[index] > from_us) {
+            heard_us += starts[index] - from_us;
+        }
+        if (ends[index] > from_us) {
+            from_us = ends[index];
+        }
+    }
+    if (from_us < incoming->end_us) {
+        heard_us += incoming->end_us - from_us;
+    }
+    return heard_us;
+}
+
+static void sim_receive(sim_t* sim, sim_node_t* node, uint32_t id, uint64_t now_us) {
+    uint32_t now_ms = (uint32_t)(now_us / 1000);
+    uint32_t slot   = 0;
+    while (slot < SIM_INCOMING && (node->incoming[slot].tx != id || node->incoming[slot].end_us != now_us)) {
+        slot++;
+    }
+    if (slot == SIM_INCOMING) {
+        node->stats.overruns++;  // Overwritten by later receptions, the ring is too small for this density
+        return;
+    }
+    const sim_incoming_t* incoming = &node->incoming[slot];
+
+    node->stats.heard_us += sim_heard_new_us(node, incoming);
+    if (!incoming->decodable) {
+        return;
+    }
+
+    for (uint32_t index = 0; index < SIM_OWN_TX; index++) {
+        if (sim_overlaps(incoming->start_us, incoming->end_us, node->own_start_us[index], node->own_end_us[index])) {
+            node->stats.half_duplex++;
+            return;
+        }
+    }
+
+    for (uint32_t index = 0; index < SIM_INCOMING; index++) {
+        const sim_incoming_t* other = &node->incoming[index];
+        if (index != slot && other->end_us != 0 && sim_overlaps(incoming->start_us, incoming->end_us, other->start_us, other->end_us) &&
+            incoming->rssi - other->rssi < SIM_CAPTURE_DB) {
+            node->stats.collisions++;
+            return;
+        }
+    }
+
+    const sim_tx_t* tx = &sim->transmissions[incoming->tx & sim->transmission_mask];
+    if (tx->id != incoming->tx) {
+        node->stats.overruns++;
+        return;
+    }
+
+    meshcore_message_t message;
+    if (meshcore_deserialize((uint8_t*)tx->data, tx->size, &message) < 0) {
+        node->stats.decode_errors++;
+        return;
+    }
+    node->stats.received++;
+
+    if (meshcore_dedup_seen(&node->dedup, meshcore_dedup_hash(&message), now_ms)) {
+        node->stats.duplicates++;
+        return;
+    }
+
+    meshcore_txt_msg_t text;
+    if (message.type == MESHCORE_PAYLOAD_TYPE_TXT_MSG && meshcore_txt_msg_deserialize(message.payload, message.payload_length, &text) >= 0 &&
+        text.destination_hash == node->hash && text.ciphertext_length >= SIM_MESSAGE_HEADER) {
+        uint32_t destination = (uint32_t)text.ciphertext[0] | ((uint32_t)text.ciphertext[1] << 8);
+        if (destination == node->id) {
+            node->stats.delivered++;
+            sim_record_latency(node, now_us - (uint64_t)sim_get_u32(&text.ciphertext[6]) * 1000);
+            return;
+        }
+    }
+
+    bool flood = message.route == MESHCORE_ROUTE_TYPE_FLOOD || message.route == MESHCORE_ROUTE_TYPE_TRANSPORT_FLOOD;
+    if (!node->repeater || !flood || message.path_length >= sim->config.max_hops || message.path_length >= MESHCORE_MAX_PATH_SIZE) {
+        return;
+    }
+
+    message.path[message.path_length++] = node->hash;
+    sim_enqueue(node, &message, now_us);
+}
+
+static void sim_check(sim_t* sim, sim_node_t* node, uint64_t now_us) {
+    node->check_at_us = UINT64_MAX;
+    if (node->busy_until_us > now_us) {
+        return;  // Checked again when the transmission ends
+    }
+
+    sim_tx_t* tx   = &node->outbox;
+    uint32_t  wait = 0;
+    if (meshcore_tx_next(&node->scheduler, (uint32_t)(now_us / 1000), tx->data, &tx->size, &wait) == 1) {
+        // The frame goes out after the turnaround time, which is what lets windows run in parallel
+        tx->sender       = node->id;
+        tx->start_us     = now_us + sim->config.turnaround_us;
+        tx->end_us       = tx->start_us + meshcore_lora_airtime_us(&sim->config.params, tx->size);
+        node->outbox_used = true;
+
+        node->own_start_us[node->own_head] = tx->start_us;
+        node->own_end_us[node->own_head]   = tx->end_us;
+        node->own_head                     = (node->own_head + 1) % SIM_OWN_TX;
+
+        // Own messages leave with an empty path, a forwarded frame carries at least the hash of this node
+        meshcore_message_t message;
+        if (meshcore_deserialize(tx->data, tx->size, &message) >= 0 && message.path_length > 0) {
+            node->stats.forwarded++;
+        }
+
+        node->busy_until_us       = tx->end_us;
+        node->stats.transmissions++;
+        node->stats.airtime_us   += tx->end_us - tx->start_us;
+        sim_schedule(node, tx->end_us, SIM_EVENT_TX_END, 0);
+    } else if (wait != UINT32_MAX) {
+        sim_schedule_check(node, now_us + (uint64_t)(wait > 0 ? wait : 1) * 1000);
+    }
+}
+
+static void sim_node_run(sim_t* sim, sim_node_t* node, uint64_t window_end_us) {
+    while (node->heap.count > 0 && node->heap.events[0].time_us < window_end_us) {
+        sim_event_t event = sim_heap_pop(&node->heap);
+        meshcore_timer_wheel_advance(&node->wheel, (uint32_t)(event.time_us / 1000));
+
+        switch (event.type) {
+            case SIM_EVENT_TRAFFIC:
+                sim_traffic(sim, node, event.time_us);
+                break;
+            case SIM_EVENT_RX_END:
+                sim_receive(sim, node, event.argument, event.time_us);
+                break;
+            case SIM_EVENT_TX_CHECK:
+                if (event.time_us == node->check_at_us) {
+                    sim_check(sim, node, event.time_us);
+                }
+                break;
+            case SIM_EVENT_TX_END:
+                sim_schedule_check(node, event.time_us);
+                break;
+        }
+    }
+}
+
+static double sim_shadowing(const sim_t* sim, uint32_t a, uint32_t b) {
+    if (sim->config.shadowing_db <= 0) {
+        return 0;
+    }
+    // Seeded by the unordered pair so that links are symmetric
+    uint32_t low   = (a < b) ? a : b;
+    uint32_t high  = (a < b) ? b : a;
+    uint32_t state = sim_mix(sim_mix(sim->config.seed ^ low) + high) | 1;
+    double   u1    = sim_uniform(&state);
+    double   u2    = sim_uniform(&state);
+    return sim->config.shadowing_db * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static void sim_build_links(sim_t* sim, sim_node_t* node) {
+    // Free space loss at 1 m, log-distance beyond
+    double   frequency_hz = sim->config.params.frequency * 1e3;
+    double   reference_db = 20.0 * log10(4.0 * M_PI * frequency_hz / 299792458.0);
+    uint32_t capacity     = 0;
+
+    for (uint32_t index = 0; index < sim->config.nodes; index++) {
+        if (index == node->id) {
+            continue;
+        }
+        const sim_node_t* other    = &sim->nodes[index];
+        double            dx       = other->x - node->x;
+        double            dy       = other->y - node->y;
+        double            distance = sqrt(dx * dx + dy * dy);
+        if (distance < 1.0) {
+            distance = 1.0;
+        }
+        double rssi = sim->config.tx_power_dbm - reference_db - 10.0 * sim->config.path_loss_exponent * log10(distance) -
+                      sim_shadowing(sim, node->id, index);
+        if (rssi < sim->floor_dbm - SIM_INTERFERENCE_DB) {
+            continue;
+        }
+
+        if (node->link_count == capacity) {
+            capacity    = (capacity > 0) ? capacity * 2 : 16;
+            node->links = realloc(node->links, capacity * sizeof(sim_link_t));
+            if (node->links == NULL) {
+                printf("Out of memory\r\n");
+                exit(1);
+            }
+        }
+        sim_link_t* link = &node->links[node->link_count++];
+        link->receiver   = index;
+        link->rssi       = (float)rssi;
+        link->decodable  = rssi >= sim->floor_dbm;
+        if (link->decodable) {
+            node->decodable_links++;
+        }
+    }
+}
+
+// Hand the transmissions published for this window to the receivers owned by a worker
+static void sim_deliver(sim_t* sim, sim_worker_t* worker) {
+    for (uint32_t id = sim->published_first; id != sim->published_last; id++) {
+        const sim_tx_t*   tx     = &sim->transmissions[id & sim->transmission_mask];
+        const sim_node_t* sender = &sim->nodes[tx->sender];
+
+        for (uint32_t index = 0; index < sender->link_count; index++) {
+            const sim_link_t* link = &sender->links[index];
+            if (link->receiver < worker->first) {
+                continue;
+            }
+            if (link->receiver >= worker->last) {
+                break;
+            }
+
+            sim_node_t* receiver     = &sim->nodes[link->receiver];
+            uint32_t    slot         = receiver->incoming_head;
+            receiver->incoming[slot] = (sim_incoming_t){
+                .tx        = id,
+                .decodable = link->decodable,
+                .rssi      = link->rssi,
+                .start_us  = tx->start_us,
+                .end_us    = tx->end_us,
+            };
+            receiver->incoming_head = (slot + 1) % SIM_INCOMING;
+            sim_schedule(receiver, tx->end_us, SIM_EVENT_RX_END, id);
+        }
+    }
+}
+
+static void sim_worker_next(sim_t* sim, sim_worker_t* worker) {
+    worker->next_us = UINT64_MAX;
+    for (uint32_t index = worker->first; index < worker->last; index++) {
+        const sim_node_t* node = &sim->nodes[index];
+        if (node->heap.count > 0 && node->heap.events[0].time_us < worker->next_us) {
+            worker->next_us = node->heap.events[0].time_us;
+        }
+    }
+}
+
+// Copy the transmissions decided in this window into the ring, in node order
+static void sim_publish(sim_t* sim) {
+    sim->published_first = sim->next_tx;
+    for (unsigned index = 0; index < sim->config.threads; index++) {
+        sim_worker_t* worker = &sim->workers[index];
+        for (uint32_t sender = 0; sender < worker->sender_count; sender++) {
+            sim_node_t* node = &sim->nodes[worker->senders[sender]];
+            uint32_t    id   = sim->next_tx++;
+            sim_tx_t*   tx   = &sim->transmissions[id & sim->transmission_mask];
+            *tx              = node->outbox;
+            tx->id           = id;
+            node->outbox_used = false;
+        }
+        worker->sender_count = 0;
+    }
+    sim->published_last = sim->next_tx;
+}
+
+static void* sim_worker(void* argument) {
+    sim_worker_t* worker = (sim_worker_t*)argument;
+    sim_t*        sim    = worker->sim;
+
+    for (uint32_t index = worker->first; index < worker->last; index++) {
+        sim_build_links(sim, &sim->nodes[index]);
+    }
+    sim_worker_next(sim, worker);
+
+    for (;;) {
+        pthread_barrier_wait(&sim->barrier);
+        if (worker->index == 0) {
+            // Skip idle time: the next window starts at the earliest pending event of any node
+            uint64_t next_us = UINT64_MAX;
+            for (unsigned index = 0; index < sim->config.threads; index++) {
+                if (sim->workers[index].next_us < next_us) {
+                    next_us = sim->workers[index].next_us;
+                }
+            }
+            sim->done          = next_us >= sim->end_us;
+            sim->window_end_us = next_us + sim->config.turnaround_us;
+            if (sim->window_end_us > sim->end_us) {
+                sim->window_end_us = sim->end_us;
+            }
+            sim->windows++;
+        }
+        pthread_barrier_wait(&sim->barrier);
+        if (sim->done) {
+            break;
+        }
+
+        for (uint32_t index = worker->first; index < worker->last; index++) {
+            sim_node_t* node = &sim->nodes[index];
+            sim_node_run(sim, node, sim->window_end_us);
+            if (node->outbox_used) {
+                worker->senders[worker->sender_count++] = index;
+            }
+        }
+
+        pthread_barrier_wait(&sim->barrier);
+        if (worker->index == 0) {
+            sim_publish(sim);
+        }
+        pthread_barrier_wait(&sim->barrier);
+
+        sim_deliver(sim, worker);
+        sim_worker_next(sim, worker);
+    }
+    return NULL;
+}
+
+static int sim_compare_u32(const void* a, const void* b) {
+    uint32_t left  = *(const uint32_t*)a;
+    uint32_t right = *(const uint32_t*)b;
+    return (left > right) - (left < right);
+}
+
+static void sim_report(const sim_t* sim, double wall_s) {
+    sim_stats_t total          = {0};
+    uint64_t    links          = 0;
+    uint64_t    decodable      = 0;
+    uint64_t    busiest_us     = 0;
+    uint32_t    latency_count  = 0;
+    uint32_t    isolated       = 0;
+    double      simulated_s    = sim->end_us / 1e6;
+
+    for (uint32_t index = 0; index < sim->config.nodes; index++) {
+        const sim_node_t*  node  = &sim->nodes[index];
+        const sim_stats_t* stats = &node->stats;
+        total.generated         += stats->generated;
+        total.delivered         += stats->delivered;
+        total.latency_total_us  += stats->latency_total_us;
+        total.transmissions     += stats->transmissions;
+        total.airtime_us        += stats->airtime_us;
+        total.heard_us          += stats->heard_us;
+        total.received          += stats->received;
+        total.duplicates        += stats->duplicates;
+        total.collisions        += stats->collisions;
+        total.half_duplex       += stats->half_duplex;
+        total.forwarded         += stats->forwarded;
+        total.queue_drops       += stats->queue_drops;
+        total.overruns          += stats->overruns;
+        total.decode_errors     += stats->decode_errors;
+        if (stats->latency_max_us > total.latency_max_us) {
+            total.latency_max_us = stats->latency_max_us;
+        }
+        if (stats->heard_us > busiest_us) {
+            busiest_us = stats->heard_us;
+        }
+        links         += node->link_count;
+        decodable     += node->decodable_links;
+        latency_count += node->latency_count;
+        isolated      += (node->decodable_links == 0);
+    }
+
+    uint32_t* latencies = malloc((latency_count > 0 ? latency_count : 1) * sizeof(uint32_t));
+    if (latencies == NULL) {
+        printf("Out of memory\r\n");
+        exit(1);
+    }
+    uint32_t position = 0;
+    for (uint32_t index = 0; index < sim->config.nodes; index++) {
+        memcpy(&latencies[position], sim->nodes[index].latencies_ms, sim->nodes[index].latency_count * sizeof(uint32_t));
+        position += sim->nodes[index].latency_count;
+    }
+    qsort(latencies, latency_count, sizeof(uint32_t), sim_compare_u32);
+
+    printf("Nodes: %" PRIu32 ", %.1f neighbours and %.1f interferers per node, %" PRIu32 " isolated\r\n", sim->config.nodes,
+           (double)decodable / sim->config.nodes, (double)(links - decodable) / sim->config.nodes, isolated);
+    printf("Radio: %.3f MHz, BW %.1f kHz, SF%u, CR4/%u, %u B message frame %u us on air\r\n", sim->config.params.frequency / 1e3,
+           sim->config.params.bandwidth / 1e3, sim->config.params.spreading_factor, sim->config.params.coding_rate,
+           sim->config.message_size + 6, meshcore_lora_airtime_us(&sim->config.params, sim->config.message_size + 6));
+    printf("Messages: %" PRIu64 " generated, %" PRIu64 " delivered, delivery ratio %.2f%%\r\n", total.generated, total.delivered,
+           total.generated > 0 ? 100.0 * total.delivered / total.generated : 0.0);
+    if (latency_count > 0) {
+        printf("Latency: mean %.0f ms, p50 %" PRIu32 " ms, p95 %" PRIu32 " ms, p99 %" PRIu32 " ms, max %" PRIu64 " ms\r\n",
+               total.latency_total_us / 1e3 / latency_count, latencies[latency_count / 2], latencies[(uint64_t)latency_count * 95 / 100],
+               latencies[(uint64_t)latency_count * 99 / 100], total.latency_max_us / 1000);
+    }
+    printf("Transmissions: %" PRIu64 " (%" PRIu64 " forwarded), %.1f s on air, %" PRIu64 " dropped by full queues\r\n", total.transmissions,
+           total.forwarded, total.airtime_us / 1e6, total.queue_drops);
+    printf("Receptions: %" PRIu64 " decoded, %" PRIu64 " duplicates, %" PRIu64 " collisions, %" PRIu64 " missed while transmitting\r\n",
+           total.received, total.duplicates, total.collisions, total.half_duplex);
+    printf("Channel utilisation: mean %.2f%%, busiest node %.2f%%, transmitting %.3f%% per node\r\n",
+           100.0 * total.heard_us / 1e6 / simulated_s / sim->config.nodes, 100.0 * busiest_us / 1e6 / simulated_s,
+           100.0 * total.airtime_us / 1e6 / simulated_s / sim->config.nodes);
+    if (total.overruns > 0 || total.decode_errors > 0) {
+        printf("Warning: %" PRIu64 " ring overruns, receptions and utilisation are inexact, %" PRIu64 " codec errors\r\n", total.overruns, total.decode_errors);
+    }
+    printf("Simulated %.0f s in %.3f s wall time (%.0fx real time), %" PRIu64 " windows on %u threads\r\n", simulated_s, wall_s,
+           simulated_s / wall_s, sim->windows, sim->config.threads);
+
+    free(latencies);
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [options]\r\n", name);
+    printf("  -n  number of nodes (default 1000)\r\n");
+    printf("  -d  mean distance between nodes in m (default 1000)\r\n");
+    printf("  -t  simulated time in s during which messages are sent (default 600)\r\n");
+    printf("  -i  mean interval between messages of one node in s (default 1800)\r\n");
+    printf("  -m  message size in bytes (default 32)\r\n");
+    printf("  -h  maximum number of hops (default 64)\r\n");
+    printf("  -r  percentage of nodes that repeat floods (default 100)\r\n");
+    printf("  -D  duty cycle in permille (default 100)\r\n");
+    printf("  -f  frequency in kHz (default 869618)\r\n");
+    printf("  -b  bandwidth in Hz (default 62500)\r\n");
+    printf("  -s  spreading factor (default 8)\r\n");
+    printf("  -c  coding rate denominator (default 8)\r\n");
+    printf("  -p  transmit power in dBm (default 22)\r\n");
+    printf("  -e  path loss exponent (default 3.5)\r\n");
+    printf("  -g  shadowing standard deviation in dB (default 4)\r\n");
+    printf("  -T  radio turnaround time in us, also the parallel window (default 10000)\r\n");
+    printf("  -S  random seed (default 1)\r\n");
+    printf("  -j  worker threads (default: number of CPUs)\r\n");
+}
+
+int main(int argc, char* argv[]) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    sim_t sim = {
+        .config =
+            {
+                .nodes               = 1000,
+                .spacing_m           = 1000.0,
+                .duration_s          = 600.0,
+                .interval_s          = 1800.0,
+                .seed                = 1,
+                .threads             = (cpus > 0) ? (unsigned)cpus : 1,
+                .max_hops            = MESHCORE_MAX_PATH_SIZE,
+                .message_size        = 32,
+                .repeater_percent    = 100,
+                .duty_cycle_permille = 100,
+                .turnaround_us       = 10000,
+                .tx_power_dbm        = 22.0,
+                .path_loss_exponent  = 3.5,
+                .shadowing_db        = 4.0,
+                .noise_figure_db     = 6.0,
+                .params =
+                    {
+                        .frequency        = 869618,
+                        .bandwidth        = 62500,
+                        .spreading_factor = 8,
+                        .coding_rate      = 8,
+                        .preamble_length  = MESHCORE_TX_DEFAULT_PREAMBLE_LENGTH,
+                    },
+            },
+    };
+    sim_config_t* config = &sim.config;
+    int           option;
+
+    while ((option = getopt(argc, argv, "n:d:t:i:m:h:r:D:f:b:s:c:p:e:g:T:S:j:")) != -1) {
+        switch (option) {
+            case 'n':
+                config->nodes = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                config->spacing_m = strtod(optarg, NULL);
+                break;
+            case 't':
+                config->duration_s = strtod(optarg, NULL);
+                break;
+            case 'i':
+                config->interval_s = strtod(optarg, NULL);
+                break;
+            case 'm':
+                config->message_size = (uint8_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+                config->max_hops = (uint8_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                config->repeater_percent = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'D':
+                config->duty_cycle_permille = (uint16_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                config->params.frequency = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                config->params.bandwidth = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                config->params.spreading_factor = (uint8_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                config->params.coding_rate = (uint8_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                config->tx_power_dbm = strtod(optarg, NULL);
+                break;
+            case 'e':
+                config->path_loss_exponent = strtod(optarg, NULL);
+                break;
+            case 'g':
+                config->shadowing_db = strtod(optarg, NULL);
+                break;
+            case 'T':
+                config->turnaround_us = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'S':
+                config->seed = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'j':
+                config->threads = (unsigned)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind != argc || config->nodes < 2 || config->nodes > 0xFFFF || config->threads == 0 || config->turnaround_us == 0 ||
+        config->interval_s <= 0 || config->message_size < SIM_MESSAGE_HEADER ||
+        config->message_size > MESHCORE_MAX_PAYLOAD_SIZE - MESHCORE_CIPHER_MAC_SIZE - 2 || config->params.spreading_factor < 6 ||
+        config->params.spreading_factor > 12 || config->params.coding_rate < 5 || config->params.coding_rate > 8 ||
+        config->params.bandwidth == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (config->threads > config->nodes) {
+        config->threads = config->nodes;
+    }
+
+    // Thermal noise over the bandwidth plus the receiver noise figure, and the SNR the spreading factor demodulates at
+    double noise_dbm   = -174.0 + 10.0 * log10(config->params.bandwidth) + config->noise_figure_db;
+    double min_snr_db  = -5.0 - 2.5 * (config->params.spreading_factor - 6);
+    sim.floor_dbm      = noise_dbm + min_snr_db;
+    sim.traffic_end_us = (uint64_t)(config->duration_s * 1e6);
+    sim.end_us         = sim.traffic_end_us + (uint64_t)(SIM_DRAIN_S * 1e6);
+
+    uint32_t ring_size = 1u << 16;
+    while (ring_size < config->nodes * 16u) {
+        ring_size <<= 1;
+    }
+    sim.transmissions     = calloc(ring_size, sizeof(sim_tx_t));
+    sim.transmission_mask = ring_size - 1;
+    sim.nodes             = calloc(config->nodes, sizeof(sim_node_t));
+    sim.workers           = calloc(config->threads, sizeof(sim_worker_t));
+    if (sim.transmissions == NULL || sim.nodes == NULL || sim.workers == NULL) {
+        printf("Out of memory\r\n");
+        return 1;
+    }
+    for (uint32_t id = 0; id < ring_size; id++) {
+        sim.transmissions[id].id = id + 1;  // Never matches an id that was not published yet
+    }
+
+    double   side_m = sqrt((double)config->nodes) * config->spacing_m;
+    uint32_t random = sim_mix(config->seed) | 1;
+    for (uint32_t id = 0; id < config->nodes; id++) {
+        sim_node_t* node    = &sim.nodes[id];
+        node->id            = id;
+        node->hash          = (uint8_t)sim_mix(config->seed + id);
+        node->random        = sim_mix(config->seed ^ (id * 0x9E3779B9u)) | 1;
+        node->repeater      = (sim_random(&random) % 100) < config->repeater_percent;
+        node->x             = (float)(sim_uniform(&random) * side_m);
+        node->y             = (float)(sim_uniform(&random) * side_m);
+        node->check_at_us   = UINT64_MAX;
+        meshcore_timer_wheel_init(&node->wheel, SIM_WHEEL_TICK_MS, 0);
+        meshcore_dedup_init(&node->dedup, &node->wheel, SIM_DEDUP_TTL_MS);
+        meshcore_tx_scheduler_init(&node->scheduler, &config->params, config->duty_cycle_permille, 3600000, 0, node->random);
+        sim_schedule_traffic(&sim, node, 0);
+    }
+
+    pthread_barrier_init(&sim.barrier, NULL, config->threads);
+    for (unsigned index = 0; index < config->threads; index++) {
+        sim_worker_t* worker = &sim.workers[index];
+        worker->sim          = &sim;
+        worker->index        = index;
+        worker->first        = (uint32_t)((uint64_t)config->nodes * index / config->threads);
+        worker->last         = (uint32_t)((uint64_t)config->nodes * (index + 1) / config->threads);
+        worker->senders      = calloc(worker->last - worker->first, sizeof(uint32_t));
+        if (worker->senders == NULL) {
+            printf("Out of memory\r\n");
+            return 1;
+        }
+    }
+
+    uint64_t start_ns = monotonic_ns();
+    for (unsigned index = 1; index < config->threads; index++) {
+        if (pthread_create(&sim.workers[index].thread, NULL, sim_worker, &sim.workers[index]) != 0) {
+            printf("Failed to start worker thread\r\n");
+            return 1;
+        }
+    }
+    sim_worker(&sim.workers[0]);
+    for (unsigned index = 1; index < config->threads; index++) {
+        pthread_join(sim.workers[index].thread, NULL);
+    }
+    double wall_s = (monotonic_ns() - start_ns) / 1e9;
+
+    sim_report(&sim, wall_s);
+
+    pthread_barrier_destroy(&sim.barrier);
+    for (uint32_t id = 0; id < config->nodes; id++) {
+        free(sim.nodes[id].links);
+        free(sim.nodes[id].heap.events);
+        free(sim.nodes[id].latencies_ms);
+    }
+    for (unsigned index = 0; index < config->threads; index++) {
+        free(sim.workers[index].senders);
+    }
+    free(sim.workers);
+    free(sim.nodes);
+    free(sim.transmissions);
+    return 0;
+}
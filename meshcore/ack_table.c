@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "ack_table.h"
+#include <stdint.h>
+#include <string.h>
+#include "sha256.h"
+
+#define MESHCORE_ACK_MAX_BACKOFF_SHIFT 16  // Doubling past this exceeds any timeout, see MESHCORE_ACK_MAX_TIMEOUT_MS
+
+uint32_t meshcore_ack_expected_crc(uint32_t timestamp, uint8_t flags, const uint8_t* text, size_t text_length, const uint8_t* sender_public_key) {
+    Sha256Context context;
+    SHA256_HASH   digest;
+    uint32_t      crc;
+
+    Sha256Initialise(&context);
+    Sha256Update(&context, &timestamp, sizeof(timestamp));
+    Sha256Update(&context, &flags, sizeof(flags));
+    Sha256Update(&context, text, (uint32_t)text_length);
+    Sha256Update(&context, sender_public_key, MESHCORE_PUB_KEY_SIZE);
+    Sha256Finalise(&context, &digest);
+
+    memcpy(&crc, digest.bytes, sizeof(crc));
+    return crc;
+}
+
+static uint32_t meshcore_ack_bucket(uint32_t crc) {
+    // The CRC is already a hash, folding it is enough
+    return (crc ^ (crc >> 16)) & (MESHCORE_ACK_BUCKETS - 1);
+}
+
+static uint16_t meshcore_ack_find(const meshcore_ack_table_t* table, uint32_t crc) {
+    uint16_t index = table->buckets[meshcore_ack_bucket(crc)];
+    while (index != MESHCORE_ACK_NONE && table->pending[index].crc != crc) {
+        index = table->pending[index].bucket_next;
+    }
+    return index;
+}
+
+static void meshcore_ack_release(meshcore_ack_table_t* table, uint16_t index) {
+    meshcore_ack_pending_t* pending = &table->pending[index];
+
+    meshcore_timer_cancel(table->wheel, &pending->timer);
+
+    uint16_t* link = &table->buckets[meshcore_ack_bucket(pending->crc)];
+    while (*link != index) {
+        link = &table->pending[*link].bucket_next;
+    }
+    *link = pending->bucket_next;
+
+    pending->used        = false;
+    pending->bucket_next = table->free;
+    table->free          = index;
+    table->active--;
+}
+
+uint32_t meshcore_ack_timeout(const meshcore_ack_table_t* table, uint8_t destination) {
+    const meshcore_ack_rtt_t* rtt = &table->rtt[destination];
+    if (rtt->samples == 0) {
+        return MESHCORE_ACK_INITIAL_TIMEOUT_MS;
+    }
+
+    uint32_t timeout = (rtt->srtt + 4 * rtt->rttvar) / 8;
+    if (timeout < MESHCORE_ACK_MIN_TIMEOUT_MS) {
+        timeout = MESHCORE_ACK_MIN_TIMEOUT_MS;
+    }
+    if (timeout > MESHCORE_ACK_MAX_TIMEOUT_MS) {
+        timeout = MESHCORE_ACK_MAX_TIMEOUT_MS;
+    }
+    return timeout;
+}
+
+static void meshcore_ack_sample(meshcore_ack_rtt_t* rtt, uint32_t rtt_ms) {
+    uint32_t sample = rtt_ms * 8;
+    if (rtt->samples == 0) {
+        rtt->srtt   = sample;
+        rtt->rttvar = sample / 2;
+    } else {
+        uint32_t deviation = (sample > rtt->srtt) ? sample - rtt->srtt : rtt->srtt - sample;
+        rtt->rttvar        = rtt->rttvar - rtt->rttvar / 4 + deviation / 4;
+        rtt->srtt          = rtt->srtt - rtt->srtt / 8 + sample / 8;
+    }
+    rtt->samples++;
+}
+
+static void meshcore_ack_expired(meshcore_timer_t* timer, void* context) {
+    meshcore_ack_table_t*   table   = (meshcore_ack_table_t*)context;
+    meshcore_ack_pending_t* pending = (meshcore_ack_pending_t*)timer;
+    uint16_t                index   = (uint16_t)(pending - table->pending);
+
+    if (pending->attempts >= pending->max_attempts) {
+        // Released before the callback, which gets a copy and may track or cancel entries as it likes
+        meshcore_ack_pending_t expired = *pending;
+        meshcore_ack_release(table, index);
+        table->stats.timeouts++;
+        table->callback(table, &expired, MESHCORE_ACK_EVENT_TIMEOUT, table->context);
+        return;
+    }
+
+    // Back off exponentially, the callback resends the message. The shift is limited and done in 64 bits so
+    // that it can not overflow before the timeout is clamped, however many attempts are allowed.
+    uint32_t now_ms   = timer->expires_ms;
+    uint8_t  exponent = (pending->attempts > MESHCORE_ACK_MAX_BACKOFF_SHIFT) ? MESHCORE_ACK_MAX_BACKOFF_SHIFT : pending->attempts;
+    uint64_t timeout  = (uint64_t)meshcore_ack_timeout(table, pending->destination) << exponent;
+    if (timeout > MESHCORE_ACK_MAX_TIMEOUT_MS) {
+        timeout = MESHCORE_ACK_MAX_TIMEOUT_MS;
+    }
+
+    pending->attempts++;
+    pending->last_sent_ms = now_ms;
+    table->stats.retries++;
+    meshcore_timer_start(table->wheel, &pending->timer, now_ms + (uint32_t)timeout);
+    table->callback(table, pending, MESHCORE_ACK_EVENT_RETRY, table->context);
+}
+
+void meshcore_ack_table_init(meshcore_ack_table_t* table, meshcore_timer_wheel_t* wheel, meshcore_ack_callback_t callback, void* context) {
+    memset(table, 0, sizeof(meshcore_ack_table_t));
+    table->wheel    = wheel;
+    table->callback = callback;
+    table->context  = context;
+
+    for (uint32_t bucket = 0; bucket < MESHCORE_ACK_BUCKETS; bucket++) {
+        table->buckets[bucket] = MESHCORE_ACK_NONE;
+    }
+    for (uint16_t index = 0; index < MESHCORE_ACK_MAX_PENDING; index++) {
+        table->pending[index].bucket_next = (index + 1 < MESHCORE_ACK_MAX_PENDING) ? index + 1 : MESHCORE_ACK_NONE;
+    }
+    table->free = 0;
+}
+
+int meshcore_ack_track(meshcore_ack_table_t* table, uint32_t crc, uint8_t destination, uint8_t max_attempts, uint32_t now_ms, void* user,
+                       uint32_t* out_timeout_ms) {
+    if (table == NULL || max_attempts == 0) {
+        return -1;
+    }
+
+    if (table->free == MESHCORE_ACK_NONE || meshcore_ack_find(table, crc) != MESHCORE_ACK_NONE) {
+        table->stats.full++;
+        return -1;
+    }
+
+    uint16_t                index   = table->free;
+    meshcore_ack_pending_t* pending = &table->pending[index];
+    table->free                     = pending->bucket_next;
+
+    uint32_t bucket        = meshcore_ack_bucket(crc);
+    pending->crc           = crc;
+    pending->bucket_next   = table->buckets[bucket];
+    table->buckets[bucket] = index;
+
+    pending->destination   = destination;
+    pending->attempts      = 1;
+    pending->max_attempts  = max_attempts;
+    pending->used          = true;
+    pending->first_sent_ms = now_ms;
+    pending->last_sent_ms  = now_ms;
+    pending->rtt_ms        = 0;
+    pending->user          = user;
+
+    uint32_t timeout = meshcore_ack_timeout(table, destination);
+    meshcore_timer_init(&pending->timer, meshcore_ack_expired, table);
+    meshcore_timer_start(table->wheel, &pending->timer, now_ms + timeout);
+
+    table->active++;
+    table->stats.tracked++;
+
+    if (out_timeout_ms != NULL) {
+        *out_timeout_ms = timeout;
+    }
+    return 0;
+}
+
+int meshcore_ack_received(meshcore_ack_table_t* table, uint32_t crc, uint32_t now_ms) {
+    uint16_t index = meshcore_ack_find(table, crc);
+    if (index == MESHCORE_ACK_NONE) {
+        table->stats.unknown++;
+        return 0;
+    }
+
+    meshcore_ack_pending_t* pending = &table->pending[index];
+    pending->rtt_ms                 = now_ms - pending->last_sent_ms;
+
+    // Only unambiguous samples are used: after a retry the ACK may belong to any of the attempts
+    if (pending->attempts == 1) {
+        meshcore_ack_sample(&table->rtt[pending->destination], pending->rtt_ms);
+    }
+
+    meshcore_ack_pending_t confirmed = *pending;
+    meshcore_ack_release(table, index);
+    table->stats.confirmed++;
+    table->callback(table, &confirmed, MESHCORE_ACK_EVENT_CONFIRMED, table->context);
+    return 1;
+}
+
+int meshcore_ack_cancel(meshcore_ack_table_t* table, uint32_t crc) {
+    uint16_t index = meshcore_ack_find(table, crc);
+    if (index == MESHCORE_ACK_NONE) {
+        return -1;
+    }
+    meshcore_ack_release(table, index);
+    return 0;
+}
@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packet.h"
+#include "timer_wheel.h"
+
+// Definitions
+
+// Pending acknowledgements. A direct text message is acknowledged with the first four bytes of
+// SHA256(timestamp, flags, text, sender public key), so the ACK a sender expects is known as soon as the
+// message is built. Pending sends are found by that CRC through a hash index, and retries and timeouts run
+// off a timer wheel shared with the rest of the node, so nothing is scanned periodically.
+
+#ifndef MESHCORE_ACK_MAX_PENDING
+#define MESHCORE_ACK_MAX_PENDING 256
+#endif
+
+_Static_assert((MESHCORE_ACK_MAX_PENDING & (MESHCORE_ACK_MAX_PENDING - 1)) == 0, "MESHCORE_ACK_MAX_PENDING must be a power of two");
+_Static_assert(MESHCORE_ACK_MAX_PENDING < 0xFFFF, "MESHCORE_ACK_MAX_PENDING too large");
+
+#define MESHCORE_ACK_BUCKETS (MESHCORE_ACK_MAX_PENDING * 2)
+#define MESHCORE_ACK_NONE    0xFFFF
+
+// Retransmission timeout limits, the timeout of a destination without RTT samples is MESHCORE_ACK_INITIAL_TIMEOUT_MS
+#define MESHCORE_ACK_INITIAL_TIMEOUT_MS 5000
+#define MESHCORE_ACK_MIN_TIMEOUT_MS     500
+#define MESHCORE_ACK_MAX_TIMEOUT_MS     60000
+
+typedef enum {
+    MESHCORE_ACK_EVENT_CONFIRMED = 0,  // The expected ACK arrived, the entry is released before the callback
+    MESHCORE_ACK_EVENT_RETRY     = 1,  // No ACK within the timeout, the message should be sent again
+    MESHCORE_ACK_EVENT_TIMEOUT   = 2,  // No ACK after the last attempt, the entry is released before the callback
+} meshcore_ack_event_t;
+
+typedef struct {
+    meshcore_timer_t timer;  // First member, the timer callback casts it back to the entry
+    uint32_t         crc;
+    uint16_t         bucket_next;
+    uint8_t          destination;  // First byte of the destination hash, selects the RTT estimate
+    uint8_t          attempts;
+    uint8_t          max_attempts;
+    bool             used;
+    uint32_t         first_sent_ms;
+    uint32_t         last_sent_ms;
+    uint32_t         rtt_ms;  // Set when confirmed
+    void*            user;
+} meshcore_ack_pending_t;
+
+// Smoothed round trip time and its mean deviation (Jacobson/Karels), both in 1/8 ms
+typedef struct {
+    uint32_t srtt;
+    uint32_t rttvar;
+    uint32_t samples;
+} meshcore_ack_rtt_t;
+
+typedef struct {
+    uint32_t tracked;
+    uint32_t confirmed;
+    uint32_t retries;
+    uint32_t timeouts;
+    uint32_t unknown;  // ACKs that matched nothing
+    uint32_t full;     // Sends that could not be tracked
+} meshcore_ack_stats_t;
+
+typedef struct meshcore_ack_table meshcore_ack_table_t;
+
+// For CONFIRMED and TIMEOUT the entry passed is a copy of one that is already released, for RETRY it is the
+// live entry. The callback may track and cancel entries, including the one it is called for.
+typedef void (*meshcore_ack_callback_t)(meshcore_ack_table_t* table, meshcore_ack_pending_t* pending, meshcore_ack_event_t event, void* context);
+
+struct meshcore_ack_table {
+    meshcore_ack_callback_t callback;
+    void*                   context;
+    uint16_t                free;
+    uint32_t                active;
+    meshcore_ack_stats_t    stats;
+    meshcore_timer_wheel_t* wheel;
+    meshcore_ack_rtt_t      rtt[256];
+    uint16_t                buckets[MESHCORE_ACK_BUCKETS];
+    meshcore_ack_pending_t  pending[MESHCORE_ACK_MAX_PENDING];
+};
+
+// Functions
+
+/// Compute the ACK CRC the recipient of a text message will answer with
+uint32_t meshcore_ack_expected_crc(uint32_t timestamp, uint8_t flags, const uint8_t* text, size_t text_length, const uint8_t* sender_public_key);
+
+/// Reset a table, callback reports confirmations, retries and timeouts. Retries and timeouts run when the wheel is advanced.
+void meshcore_ack_table_init(meshcore_ack_table_t* table, meshcore_timer_wheel_t* wheel, meshcore_ack_callback_t callback, void* context);
+
+/// Start waiting for an ACK after the first transmission, out_timeout_ms receives the timeout of the first attempt
+int meshcore_ack_track(meshcore_ack_table_t* table, uint32_t crc, uint8_t destination, uint8_t max_attempts, uint32_t now_ms, void* user,
+                       uint32_t* out_timeout_ms);
+
+/// Match a received ACK, returns 1 when it confirmed a pending send and 0 when nothing was waiting for it
+int meshcore_ack_received(meshcore_ack_table_t* table, uint32_t crc, uint32_t now_ms);
+
+/// Stop waiting for an ACK without reporting an event, returns -1 if nothing was waiting for it
+int meshcore_ack_cancel(meshcore_ack_table_t* table, uint32_t crc);
+
+/// Current retransmission timeout for a destination in milliseconds
+uint32_t meshcore_ack_timeout(const meshcore_ack_table_t* table, uint8_t destination);
@@ -0,0 +1,302 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "capture.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CAPTURE_OPTION_END     0
+#define CAPTURE_OPTION_IF_NAME 2
+
+#define CAPTURE_SHB_SIZE     28
+#define CAPTURE_IDB_SIZE     36  // Including the if_name option ("link" and up to 3 digits, padded to 8 bytes)
+#define CAPTURE_EPB_OVERHEAD 32
+#define CAPTURE_NO_INTERFACE 0xFFFF
+
+#define CAPTURE_PAD32(length) (((length) + 3) & ~((size_t)3))
+
+static void capture_put_u16(uint8_t* out, uint16_t value) {
+    memcpy(out, &value, sizeof(uint16_t));
+}
+
+static void capture_put_u32(uint8_t* out, uint32_t value) {
+    memcpy(out, &value, sizeof(uint32_t));
+}
+
+static uint16_t capture_get_u16(const uint8_t* in) {
+    uint16_t value;
+    memcpy(&value, in, sizeof(uint16_t));
+    return value;
+}
+
+static uint32_t capture_get_u32(const uint8_t* in) {
+    uint32_t value;
+    memcpy(&value, in, sizeof(uint32_t));
+    return value;
+}
+
+static int capture_reserve(meshcore_capture_t* capture, size_t length) {
+    if (capture->buffer_size - capture->buffer_position >= length) {
+        return 0;
+    }
+    return meshcore_capture_flush(capture);
+}
+
+static void capture_write_shb(meshcore_capture_t* capture) {
+    uint8_t* out = &capture->buffer[capture->buffer_position];
+    capture_put_u32(&out[0], MESHCORE_CAPTURE_BLOCK_SHB);
+    capture_put_u32(&out[4], CAPTURE_SHB_SIZE);
+    capture_put_u32(&out[8], MESHCORE_CAPTURE_BYTE_ORDER_MAGIC);
+    capture_put_u16(&out[12], 1);  // Major version
+    capture_put_u16(&out[14], 0);  // Minor version
+    memset(&out[16], 0xFF, 8);     // Section length not specified
+    capture_put_u32(&out[24], CAPTURE_SHB_SIZE);
+    capture->buffer_position += CAPTURE_SHB_SIZE;
+}
+
+static int capture_write_idb(meshcore_capture_t* capture, uint8_t link_id) {
+    if (capture_reserve(capture, CAPTURE_IDB_SIZE) < 0) {
+        return -1;
+    }
+
+    uint8_t* out = &capture->buffer[capture->buffer_position];
+    memset(out, 0, CAPTURE_IDB_SIZE);
+    capture_put_u32(&out[0], MESHCORE_CAPTURE_BLOCK_IDB);
+    capture_put_u32(&out[4], CAPTURE_IDB_SIZE);
+    capture_put_u16(&out[8], MESHCORE_CAPTURE_LINKTYPE_LORATAP);
+    capture_put_u32(&out[12], MESHCORE_CAPTURE_LORATAP_SIZE + 255);  // Snap length
+
+    char name[8] = {0};
+    int  name_length = snprintf(name, sizeof(name), "link%u", link_id);
+    capture_put_u16(&out[16], CAPTURE_OPTION_IF_NAME);
+    capture_put_u16(&out[18], (uint16_t)name_length);
+    memcpy(&out[20], name, name_length);
+    capture_put_u16(&out[28], CAPTURE_OPTION_END);
+    capture_put_u32(&out[32], CAPTURE_IDB_SIZE);
+
+    capture->buffer_position           += CAPTURE_IDB_SIZE;
+    capture->interface_ids[link_id]     = capture->interface_count;
+    capture->interface_count++;
+    return 0;
+}
+
+int meshcore_capture_init(meshcore_capture_t* capture, uint8_t* buffer, size_t buffer_size, meshcore_capture_write_t write, void* write_context) {
+    if (capture == NULL || buffer == NULL || write == NULL) {
+        return -1;
+    }
+
+    // The buffer must at least fit the section header and one interface and packet block
+    if (buffer_size < CAPTURE_SHB_SIZE + CAPTURE_IDB_SIZE + MESHCORE_CAPTURE_MAX_BLOCK_SIZE) {
+        return -1;
+    }
+
+    memset(capture, 0, sizeof(meshcore_capture_t));
+    capture->buffer        = buffer;
+    capture->buffer_size   = buffer_size;
+    capture->write         = write;
+    capture->write_context = write_context;
+    memset(capture->interface_ids, 0xFF, sizeof(capture->interface_ids));
+
+    capture_write_shb(capture);
+
+    return 0;
+}
+
+int meshcore_capture_frame(meshcore_capture_t* capture, uint64_t timestamp_us, uint8_t link_id, int8_t snr, int8_t rssi, const uint8_t* data, uint8_t size) {
+    if (capture == NULL || data == NULL) {
+        return -1;
+    }
+
+    if (capture->interface_ids[link_id] == CAPTURE_NO_INTERFACE) {
+        if (capture_write_idb(capture, link_id) < 0) {
+            return -1;
+        }
+    }
+
+    size_t captured_length = MESHCORE_CAPTURE_LORATAP_SIZE + size;
+    size_t block_length    = CAPTURE_EPB_OVERHEAD + CAPTURE_PAD32(captured_length);
+
+    if (capture_reserve(capture, block_length) < 0) {
+        return -1;
+    }
+
+    uint8_t* out = &capture->buffer[capture->buffer_position];
+    capture_put_u32(&out[0], MESHCORE_CAPTURE_BLOCK_EPB);
+    capture_put_u32(&out[4], (uint32_t)block_length);
+    capture_put_u32(&out[8], capture->interface_ids[link_id]);
+    capture_put_u32(&out[12], (uint32_t)(timestamp_us >> 32));
+    capture_put_u32(&out[16], (uint32_t)(timestamp_us & 0xFFFFFFFF));
+    capture_put_u32(&out[20], (uint32_t)captured_length);
+    capture_put_u32(&out[24], (uint32_t)captured_length);
+
+    // LoRaTap v0 pseudo header, multi-byte fields are big endian
+    uint8_t* loratap    = &out[28];
+    int      rssi_value = rssi + 139;
+    loratap[0]          = 0;  // Version
+    loratap[1]          = 0;  // Padding
+    loratap[2]          = 0;
+    loratap[3]          = MESHCORE_CAPTURE_LORATAP_SIZE;
+    loratap[4]          = (capture->channel.frequency >> 24) & 0xFF;
+    loratap[5]          = (capture->channel.frequency >> 16) & 0xFF;
+    loratap[6]          = (capture->channel.frequency >> 8) & 0xFF;
+    loratap[7]          = (capture->channel.frequency >> 0) & 0xFF;
+    loratap[8]          = capture->channel.bandwidth / 125000;  // Steps of 125 kHz, narrower channels are written as 0
+    loratap[9]          = capture->channel.spreading_factor;
+    loratap[10]         = (rssi_value < 0) ? 0 : (rssi_value > 0xFF) ? 0xFF : rssi_value;
+    loratap[11]         = 0;  // Max RSSI, unknown
+    loratap[12]         = 0;  // Current RSSI, unknown
+    loratap[13]         = (uint8_t)snr;
+    loratap[14]         = MESHCORE_CAPTURE_SYNC_WORD;
+
+    memcpy(&loratap[MESHCORE_CAPTURE_LORATAP_SIZE], data, size);
+
+    size_t padding = CAPTURE_PAD32(captured_length) - captured_length;
+    memset(&loratap[captured_length], 0, padding);
+    capture_put_u32(&out[block_length - sizeof(uint32_t)], (uint32_t)block_length);
+
+    capture->buffer_position += block_length;
+    capture->frames++;
+
+    return 0;
+}
+
+int meshcore_capture_flush(meshcore_capture_t* capture) {
+    if (capture == NULL) {
+        return -1;
+    }
+
+    if (capture->buffer_position == 0) {
+        return 0;
+    }
+
+    if (capture->write(capture->write_context, capture->buffer, capture->buffer_position) < 0) {
+        // Drop the batch so that the writer does not stall on a broken sink. The interface blocks in it are
+        // lost with it, so a new section is started and every link is described again before its next frame.
+        capture->write_errors++;
+        capture->buffer_position = 0;
+        capture->interface_count = 0;
+        memset(capture->interface_ids, 0xFF, sizeof(capture->interface_ids));
+        capture_write_shb(capture);
+        return -1;
+    }
+
+    capture->buffer_position = 0;
+    capture->flushes++;
+
+    return 0;
+}
+
+static void capture_reader_parse_idb(meshcore_capture_reader_t* reader, const uint8_t* block, uint32_t block_length) {
+    if (reader->interface_count >= MESHCORE_CAPTURE_MAX_LINKS) {
+        return;
+    }
+
+    uint16_t interface_id           = reader->interface_count++;
+    reader->linktypes[interface_id] = capture_get_u16(&block[8]);
+    reader->link_ids[interface_id]  = (uint8_t)interface_id;
+
+    // Walk the options looking for the interface name written by the capture writer
+    uint32_t position = 16;
+    while (position + 4 <= block_length - sizeof(uint32_t)) {
+        uint16_t code   = capture_get_u16(&block[position]);
+        uint16_t length = capture_get_u16(&block[position + 2]);
+        position       += 4;
+        if (code == CAPTURE_OPTION_END || position + length > block_length - sizeof(uint32_t)) {
+            break;
+        }
+        if (code == CAPTURE_OPTION_IF_NAME && length > 4 && length < 8 && memcmp(&block[position], "link", 4) == 0) {
+            unsigned int link_id = 0;
+            for (uint16_t i = 4; i < length && block[position + i] >= '0' && block[position + i] <= '9'; i++) {
+                link_id = link_id * 10 + (block[position + i] - '0');
+            }
+            if (link_id < MESHCORE_CAPTURE_MAX_LINKS) {
+                reader->link_ids[interface_id] = (uint8_t)link_id;
+            }
+        }
+        position += CAPTURE_PAD32(length);
+    }
+}
+
+int meshcore_capture_reader_init(meshcore_capture_reader_t* reader, const uint8_t* data, size_t size) {
+    if (reader == NULL || data == NULL) {
+        return -1;
+    }
+
+    memset(reader, 0, sizeof(meshcore_capture_reader_t));
+
+    if (size < CAPTURE_SHB_SIZE || capture_get_u32(&data[0]) != MESHCORE_CAPTURE_BLOCK_SHB ||
+        capture_get_u32(&data[8]) != MESHCORE_CAPTURE_BYTE_ORDER_MAGIC) {
+        // Not a pcap-ng file, or one written with a different byte order
+        return -1;
+    }
+
+    reader->data = data;
+    reader->size = size;
+
+    return 0;
+}
+
+int meshcore_capture_next(meshcore_capture_reader_t* reader, meshcore_capture_frame_t* out_frame) {
+    if (reader == NULL || out_frame == NULL) {
+        return -1;
+    }
+
+    while (reader->size - reader->position >= 12) {
+        const uint8_t* block        = &reader->data[reader->position];
+        uint32_t       block_type   = capture_get_u32(&block[0]);
+        uint32_t       block_length = capture_get_u32(&block[4]);
+
+        if (block_length < 12 || (block_length & 3) != 0 || block_length > reader->size - reader->position) {
+            return -1;
+        }
+
+        reader->position += block_length;
+
+        if (block_type == MESHCORE_CAPTURE_BLOCK_IDB && block_length >= 20) {
+            capture_reader_parse_idb(reader, block, block_length);
+        } else if (block_type == MESHCORE_CAPTURE_BLOCK_SHB) {
+            if (block_length < CAPTURE_SHB_SIZE || capture_get_u32(&block[8]) != MESHCORE_CAPTURE_BYTE_ORDER_MAGIC) {
+                return -1;
+            }
+            reader->interface_count = 0;  // Interface ids are scoped to a section
+        } else if (block_type == MESHCORE_CAPTURE_BLOCK_EPB && block_length >= CAPTURE_EPB_OVERHEAD) {
+            uint32_t interface_id    = capture_get_u32(&block[8]);
+            uint32_t captured_length = capture_get_u32(&block[20]);
+
+            if (interface_id >= reader->interface_count || captured_length > block_length - CAPTURE_EPB_OVERHEAD) {
+                return -1;
+            }
+
+            memset(out_frame, 0, sizeof(meshcore_capture_frame_t));
+            out_frame->timestamp_us = ((uint64_t)capture_get_u32(&block[12]) << 32) | capture_get_u32(&block[16]);
+            out_frame->link_id      = reader->link_ids[interface_id];
+
+            const uint8_t* packet = &block[28];
+            if (reader->linktypes[interface_id] == MESHCORE_CAPTURE_LINKTYPE_LORATAP) {
+                if (captured_length < 4) {
+                    return -1;
+                }
+                uint16_t header_length = (packet[2] << 8) | packet[3];
+                if (header_length > captured_length || header_length < MESHCORE_CAPTURE_LORATAP_SIZE) {
+                    return -1;
+                }
+                out_frame->rssi  = (int8_t)(packet[10] - 139);
+                out_frame->snr   = (int8_t)packet[13];
+                packet          += header_length;
+                captured_length -= header_length;
+            }
+
+            if (captured_length > 0xFF) {
+                return -1;
+            }
+
+            out_frame->data = packet;
+            out_frame->size = (uint8_t)captured_length;
+            return 1;
+        }
+        // Other block types are skipped
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Definitions
+
+// Captures are written as pcap-ng. Every frame is prefixed with a LoRaTap (v0) pseudo header carrying
+// the radio channel, RSSI and SNR, so the files open directly in Wireshark. Each link id gets its own
+// interface description block, the interface id of a packet block therefore identifies the link.
+
+#define MESHCORE_CAPTURE_LINKTYPE_LORATAP 270
+#define MESHCORE_CAPTURE_LORATAP_SIZE     15
+#define MESHCORE_CAPTURE_SYNC_WORD        0x12
+#define MESHCORE_CAPTURE_MAX_LINKS        256
+
+#define MESHCORE_CAPTURE_BLOCK_SHB 0x0A0D0D0A
+#define MESHCORE_CAPTURE_BLOCK_IDB 0x00000001
+#define MESHCORE_CAPTURE_BLOCK_EPB 0x00000006
+#define MESHCORE_CAPTURE_BYTE_ORDER_MAGIC 0x1A2B3C4D
+
+// Largest block written for a single frame: enhanced packet block header and trailer, pseudo header and
+// a maximum size frame padded to 32 bits
+#define MESHCORE_CAPTURE_MAX_BLOCK_SIZE (32 + ((MESHCORE_CAPTURE_LORATAP_SIZE + 255 + 3) & ~3))
+
+/// Called when the capture buffer has to be drained, must write all bytes or return a negative value
+typedef int (*meshcore_capture_write_t)(void* context, const uint8_t* data, size_t length);
+
+typedef struct {
+    uint32_t frequency;         // Hz
+    uint32_t bandwidth;         // Hz, LoRaTap v0 counts in steps of 125 kHz and can not represent narrower channels such as 62.5 kHz
+    uint8_t  spreading_factor;
+} meshcore_capture_channel_t;
+
+typedef struct {
+    uint8_t*                   buffer;
+    size_t                     buffer_size;
+    size_t                     buffer_position;
+    meshcore_capture_write_t   write;
+    void*                      write_context;
+    meshcore_capture_channel_t channel;
+    uint16_t                   interface_count;
+    uint16_t                   interface_ids[MESHCORE_CAPTURE_MAX_LINKS];  // Link id to interface id, 0xFFFF if not yet described
+    uint32_t                   frames;
+    uint32_t                   flushes;
+    uint32_t                   write_errors;
+} meshcore_capture_t;
+
+typedef struct {
+    const uint8_t* data;
+    size_t         size;
+    size_t         position;
+    uint16_t       interface_count;
+    uint16_t       linktypes[MESHCORE_CAPTURE_MAX_LINKS];
+    uint8_t        link_ids[MESHCORE_CAPTURE_MAX_LINKS];  // Interface id to link id, taken from the interface name
+} meshcore_capture_reader_t;
+
+typedef struct {
+    uint64_t       timestamp_us;
+    uint8_t        link_id;
+    int8_t         snr;   // Multiplied by 4
+    int8_t         rssi;  // dBm
+    const uint8_t* data;
+    uint8_t        size;
+} meshcore_capture_frame_t;
+
+// Functions
+
+/// Initialize a capture writer, frames are collected in buffer and handed to write in batches
+int meshcore_capture_init(meshcore_capture_t* capture, uint8_t* buffer, size_t buffer_size, meshcore_capture_write_t write, void* write_context);
+
+/// Append a raw frame to the capture, the buffer is only drained when it can not hold the frame
+int meshcore_capture_frame(meshcore_capture_t* capture, uint64_t timestamp_us, uint8_t link_id, int8_t snr, int8_t rssi, const uint8_t* data, uint8_t size);
+
+/// Write all buffered blocks
+int meshcore_capture_flush(meshcore_capture_t* capture);
+
+/// Start reading a capture held in memory (for example a mapped file)
+int meshcore_capture_reader_init(meshcore_capture_reader_t* reader, const uint8_t* data, size_t size);
+
+/// Read the next frame, returns 1 when a frame was read, 0 at the end of the capture and -1 on malformed input
+int meshcore_capture_next(meshcore_capture_reader_t* reader, meshcore_capture_frame_t* out_frame);
@@ -0,0 +1,229 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "compact.h"
+#include <stdint.h>
+#include <string.h>
+#include "aes.h"
+#include "hmac_sha256.h"
+#include "latency.h"
+
+// Header byte fields, see packet.c
+#define PACKET_HEADER_ROUTE_SHIFT 0
+#define PACKET_HEADER_ROUTE_MASK  0x03
+#define PACKET_HEADER_TYPE_SHIFT  2
+#define PACKET_HEADER_TYPE_MASK   0x0F
+#define PACKET_HEADER_VER_SHIFT   6
+#define PACKET_HEADER_VER_MASK    0x03
+
+static bool meshcore_compact_has_transport(uint8_t header) {
+    uint8_t route = (header >> PACKET_HEADER_ROUTE_SHIFT) & PACKET_HEADER_ROUTE_MASK;
+    return route == MESHCORE_ROUTE_TYPE_TRANSPORT_FLOOD || route == MESHCORE_ROUTE_TYPE_TRANSPORT_DIRECT;
+}
+
+static size_t meshcore_compact_path_offset(const meshcore_compact_message_t* message) {
+    return meshcore_compact_has_transport(message->header) ? MESHCORE_COMPACT_TRANSPORT_SIZE : 0;
+}
+
+// Offset of the cipher MAC in the payload, -1 for payload types that are not encrypted
+static int meshcore_compact_cipher_offset(meshcore_payload_type_t type) {
+    switch (type) {
+        case MESHCORE_PAYLOAD_TYPE_REQ:
+        case MESHCORE_PAYLOAD_TYPE_RESPONSE:
+        case MESHCORE_PAYLOAD_TYPE_TXT_MSG:
+        case MESHCORE_PAYLOAD_TYPE_PATH:
+            return sizeof(uint8_t) * 2;  // Destination and source hash
+        case MESHCORE_PAYLOAD_TYPE_GRP_TXT:
+        case MESHCORE_PAYLOAD_TYPE_GRP_DATA:
+            return sizeof(uint8_t);  // Channel hash
+        case MESHCORE_PAYLOAD_TYPE_ANON_REQ:
+            return sizeof(uint8_t) + MESHCORE_PUB_KEY_SIZE;  // Destination hash and ephemeral public key
+        default:
+            return -1;
+    }
+}
+
+meshcore_route_type_t meshcore_compact_route(const meshcore_compact_message_t* message) {
+    return (meshcore_route_type_t)((message->header >> PACKET_HEADER_ROUTE_SHIFT) & PACKET_HEADER_ROUTE_MASK);
+}
+
+meshcore_payload_type_t meshcore_compact_type(const meshcore_compact_message_t* message) {
+    return (meshcore_payload_type_t)((message->header >> PACKET_HEADER_TYPE_SHIFT) & PACKET_HEADER_TYPE_MASK);
+}
+
+size_t meshcore_compact_size(const meshcore_compact_message_t* message) {
+    return MESHCORE_COMPACT_HEADER_SIZE + meshcore_compact_path_offset(message) + message->path_length + message->payload_length;
+}
+
+uint8_t* meshcore_compact_path(meshcore_compact_message_t* message) {
+    return &message->data[meshcore_compact_path_offset(message)];
+}
+
+uint8_t* meshcore_compact_payload(meshcore_compact_message_t* message) {
+    return &message->data[meshcore_compact_path_offset(message) + message->path_length];
+}
+
+uint16_t meshcore_compact_transport_code(const meshcore_compact_message_t* message, uint8_t index) {
+    uint16_t code = 0;
+    if (index < 2 && meshcore_compact_has_transport(message->header)) {
+        memcpy(&code, &message->data[index * sizeof(uint16_t)], sizeof(uint16_t));
+    }
+    return code;
+}
+
+int meshcore_compact_from_wire(const uint8_t* data, uint8_t size, meshcore_compact_message_t* out_message, size_t capacity) {
+    if (data == NULL || out_message == NULL || size < 2 || capacity < MESHCORE_COMPACT_HEADER_SIZE) {
+        return -1;
+    }
+
+    // The frame after the header byte is already laid out as the data buffer, less the path length
+    uint8_t header    = data[0];
+    uint8_t position  = sizeof(uint8_t);
+    uint8_t transport = meshcore_compact_has_transport(header) ? MESHCORE_COMPACT_TRANSPORT_SIZE : 0;
+    if ((size_t)(size - position) < transport + sizeof(uint8_t)) {
+        return -1;
+    }
+    uint8_t path_length = data[position + transport];
+    if (path_length > MESHCORE_MAX_PATH_SIZE || path_length > size - position - transport - sizeof(uint8_t)) {
+        return -1;
+    }
+    uint8_t payload_length = (uint8_t)(size - position - transport - sizeof(uint8_t) - path_length);
+    if (payload_length > MESHCORE_MAX_PAYLOAD_SIZE) {
+        return -1;
+    }
+
+    size_t total = MESHCORE_COMPACT_HEADER_SIZE + transport + path_length + payload_length;
+    if (total > capacity) {
+        return -1;
+    }
+
+    out_message->header         = header;
+    out_message->flags          = 0;
+    out_message->path_length    = path_length;
+    out_message->payload_length = payload_length;
+    memcpy(out_message->data, &data[position], transport);
+    memcpy(&out_message->data[transport], &data[position + transport + sizeof(uint8_t)], path_length + payload_length);
+    return (int)total;
+}
+
+int meshcore_compact_to_wire(const meshcore_compact_message_t* message, uint8_t* out_data, uint8_t* out_size) {
+    if (message == NULL || out_data == NULL || (message->flags & MESHCORE_COMPACT_FLAG_DECRYPTED)) {
+        return -1;
+    }
+
+    size_t transport = meshcore_compact_path_offset(message);
+    size_t size      = sizeof(uint8_t) + transport + sizeof(uint8_t) + message->path_length + message->payload_length;
+    if (size > MESHCORE_MAX_TRANS_UNIT) {
+        return -1;
+    }
+
+    out_data[0] = message->header;
+    memcpy(&out_data[1], message->data, transport);
+    out_data[1 + transport] = message->path_length;
+    memcpy(&out_data[2 + transport], &message->data[transport], message->path_length + message->payload_length);
+    *out_size = (uint8_t)size;
+    return 0;
+}
+
+int meshcore_compact_from_message(const meshcore_message_t* message, meshcore_compact_message_t* out_message, size_t capacity) {
+    if (message == NULL || out_message == NULL || message->path_length > MESHCORE_MAX_PATH_SIZE ||
+        message->payload_length > MESHCORE_MAX_PAYLOAD_SIZE || capacity < MESHCORE_COMPACT_HEADER_SIZE) {
+        return -1;
+    }
+
+    uint8_t header = (uint8_t)(((message->route & PACKET_HEADER_ROUTE_MASK) << PACKET_HEADER_ROUTE_SHIFT) |
+                               ((message->type & PACKET_HEADER_TYPE_MASK) << PACKET_HEADER_TYPE_SHIFT) |
+                               ((message->version & PACKET_HEADER_VER_MASK) << PACKET_HEADER_VER_SHIFT));
+    size_t  transport = meshcore_compact_has_transport(header) ? MESHCORE_COMPACT_TRANSPORT_SIZE : 0;
+    size_t  total     = MESHCORE_COMPACT_HEADER_SIZE + transport + message->path_length + message->payload_length;
+    if (total > capacity) {
+        return -1;
+    }
+
+    out_message->header         = header;
+    out_message->flags          = 0;
+    out_message->path_length    = message->path_length;
+    out_message->payload_length = message->payload_length;
+    memcpy(out_message->data, message->transport_codes, transport);
+    memcpy(&out_message->data[transport], message->path, message->path_length);
+    memcpy(&out_message->data[transport + message->path_length], message->payload, message->payload_length);
+    return (int)total;
+}
+
+int meshcore_compact_to_message(const meshcore_compact_message_t* message, meshcore_message_t* out_message) {
+    if (message == NULL || out_message == NULL) {
+        return -1;
+    }
+
+    size_t transport = meshcore_compact_path_offset(message);
+    memset(out_message, 0, sizeof(meshcore_message_t));
+    out_message->route          = meshcore_compact_route(message);
+    out_message->type           = meshcore_compact_type(message);
+    out_message->version        = (message->header >> PACKET_HEADER_VER_SHIFT) & PACKET_HEADER_VER_MASK;
+    out_message->path_length    = message->path_length;
+    out_message->payload_length = message->payload_length;
+    memcpy(out_message->transport_codes, message->data, transport);
+    memcpy(out_message->path, &message->data[transport], message->path_length);
+    memcpy(out_message->payload, &message->data[transport + message->path_length], message->payload_length);
+    return 0;
+}
+
+int meshcore_compact_decrypt(meshcore_compact_message_t* message, const uint8_t* key, size_t key_size) {
+    if (message == NULL || key == NULL || key_size < MESHCORE_CIPHER_KEY_SIZE || (message->flags & MESHCORE_COMPACT_FLAG_DECRYPTED)) {
+        return -1;
+    }
+
+    int offset = meshcore_compact_cipher_offset(meshcore_compact_type(message));
+    if (offset < 0 || message->payload_length < offset + MESHCORE_CIPHER_MAC_SIZE) {
+        return -1;
+    }
+
+    uint8_t* mac               = &meshcore_compact_payload(message)[offset];
+    uint8_t* ciphertext        = &mac[MESHCORE_CIPHER_MAC_SIZE];
+    size_t   ciphertext_length = message->payload_length - offset - MESHCORE_CIPHER_MAC_SIZE;
+    if (ciphertext_length == 0 || ciphertext_length % MESHCORE_CIPHER_BLOCK_SIZE != 0) {
+        return -1;
+    }
+
+    MESHCORE_LATENCY_START(mac_start);
+    uint8_t expected[MESHCORE_CIPHER_MAC_SIZE];
+    hmac_sha256(key, key_size, ciphertext, ciphertext_length, expected, sizeof(expected));
+    MESHCORE_LATENCY_END(MESHCORE_LATENCY_MAC_VERIFY, mac_start);
+    if (memcmp(expected, mac, MESHCORE_CIPHER_MAC_SIZE) != 0) {
+        return -1;
+    }
+
+    MESHCORE_LATENCY_START(decrypt_start);
+    struct AES_ctx ctx;
+    AES_init_ctx(&ctx, key);
+    for (size_t block = 0; block < ciphertext_length; block += MESHCORE_CIPHER_BLOCK_SIZE) {
+        AES_ECB_decrypt(&ctx, &ciphertext[block]);
+    }
+    MESHCORE_LATENCY_END(MESHCORE_LATENCY_DECRYPT, decrypt_start);
+    message->flags |= MESHCORE_COMPACT_FLAG_DECRYPTED;
+    return 0;
+}
+
+int meshcore_compact_grp_txt(meshcore_compact_message_t* message, meshcore_compact_grp_txt_t* out_grp_txt) {
+    size_t header = sizeof(uint8_t) + MESHCORE_CIPHER_MAC_SIZE;
+    if (message == NULL || out_grp_txt == NULL || meshcore_compact_type(message) != MESHCORE_PAYLOAD_TYPE_GRP_TXT ||
+        !(message->flags & MESHCORE_COMPACT_FLAG_DECRYPTED) || message->payload_length < header + sizeof(uint32_t) + sizeof(uint8_t)) {
+        return -1;
+    }
+
+    const uint8_t* payload   = meshcore_compact_payload(message);
+    const uint8_t* plaintext = &payload[header];
+    uint8_t        length    = (uint8_t)(message->payload_length - header - sizeof(uint32_t) - sizeof(uint8_t));
+
+    out_grp_txt->channel_hash = payload[0];
+    memcpy(&out_grp_txt->timestamp, plaintext, sizeof(uint32_t));
+    out_grp_txt->text_type = plaintext[sizeof(uint32_t)];
+    out_grp_txt->text      = (const char*)&plaintext[sizeof(uint32_t) + sizeof(uint8_t)];
+
+    // The text is padded with zeroes to the cipher block size
+    while (length > 0 && out_grp_txt->text[length - 1] == '\0') {
+        length--;
+    }
+    out_grp_txt->text_length = length;
+    return 0;
+}
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packet.h"
+
+// Definitions
+
+// Compact in-memory packet. meshcore_message_t reserves room for the largest path and payload, which makes
+// every packet take 260 bytes however small it is. The compact form keeps the header byte as it is on the
+// wire and stores the transport codes (transport routes only), path and payload back to back in a buffer
+// sized to the packet, so a typical packet takes a few dozen bytes. It has no alignment requirement and can
+// be stored at any offset in a history buffer, meshcore_compact_size gives its length.
+//
+// Encrypted payloads can be verified and decrypted in place: the ciphertext is overwritten by the plaintext
+// and the packet is marked decrypted, no second copy of the data is made.
+
+#define MESHCORE_COMPACT_HEADER_SIZE     4
+#define MESHCORE_COMPACT_TRANSPORT_SIZE  (sizeof(uint16_t) * 2)
+#define MESHCORE_COMPACT_MAX_SIZE        (MESHCORE_COMPACT_HEADER_SIZE + MESHCORE_COMPACT_TRANSPORT_SIZE + MESHCORE_MAX_PATH_SIZE + MESHCORE_MAX_PAYLOAD_SIZE)
+#define MESHCORE_COMPACT_FLAG_DECRYPTED  0x01  // The ciphertext of the payload was replaced by the plaintext
+
+typedef struct {
+    uint8_t header;  // Route, payload type and version, as on the wire
+    uint8_t flags;
+    uint8_t path_length;
+    uint8_t payload_length;
+    uint8_t data[];  // Transport codes for transport routes, path and payload
+} meshcore_compact_message_t;
+
+_Static_assert(sizeof(meshcore_compact_message_t) == MESHCORE_COMPACT_HEADER_SIZE, "meshcore_compact_message_t must not be padded");
+
+typedef struct {
+    uint8_t     channel_hash;
+    uint32_t    timestamp;
+    uint8_t     text_type;
+    const char* text;  // Points into the decrypted payload, not terminated
+    uint8_t     text_length;
+} meshcore_compact_grp_txt_t;
+
+// Functions
+
+/// Route of a compact packet
+meshcore_route_type_t meshcore_compact_route(const meshcore_compact_message_t* message);
+
+/// Payload type of a compact packet
+meshcore_payload_type_t meshcore_compact_type(const meshcore_compact_message_t* message);
+
+/// Number of bytes a compact packet occupies
+size_t meshcore_compact_size(const meshcore_compact_message_t* message);
+
+/// Path of a compact packet
+uint8_t* meshcore_compact_path(meshcore_compact_message_t* message);
+
+/// Payload of a compact packet
+uint8_t* meshcore_compact_payload(meshcore_compact_message_t* message);
+
+/// Read transport code 0 or 1, returns 0 for routes without transport codes
+uint16_t meshcore_compact_transport_code(const meshcore_compact_message_t* message, uint8_t index);
+
+/// Decode a received frame into out_message, which has room for capacity bytes. Returns the size of the
+/// compact packet or -1 when the frame is malformed or does not fit.
+int meshcore_compact_from_wire(const uint8_t* data, uint8_t size, meshcore_compact_message_t* out_message, size_t capacity);
+
+/// Encode a compact packet for transmission, fails for packets that were decrypted
+int meshcore_compact_to_wire(const meshcore_compact_message_t* message, uint8_t* out_data, uint8_t* out_size);
+
+/// Convert a message to its compact form, returns the size of the compact packet or -1
+int meshcore_compact_from_message(const meshcore_message_t* message, meshcore_compact_message_t* out_message, size_t capacity);
+
+/// Expand a compact packet to a message
+int meshcore_compact_to_message(const meshcore_compact_message_t* message, meshcore_message_t* out_message);
+
+/// Verify the MAC of an encrypted payload and decrypt it in place with a 16 byte key (the MAC is keyed with
+/// key_size bytes of key). Returns 0 on success and -1 for payloads that are not encrypted, already
+/// decrypted or fail verification, which are left untouched.
+int meshcore_compact_decrypt(meshcore_compact_message_t* message, const uint8_t* key, size_t key_size);
+
+/// Read a decrypted group text message, returns -1 for other packets
+int meshcore_compact_grp_txt(meshcore_compact_message_t* message, meshcore_compact_grp_txt_t* out_grp_txt);
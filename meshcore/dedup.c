@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "dedup.h"
+#include <stdint.h>
+#include <string.h>
+
+#define MESHCORE_DEDUP_MASK (MESHCORE_DEDUP_CAPACITY - 1)
+
+uint32_t meshcore_dedup_hash(const meshcore_message_t* message) {
+    // FNV-1a over the payload type and payload, the route and path change from hop to hop
+    uint32_t hash = 2166136261u;
+    hash          = (hash ^ (uint8_t)message->type) * 16777619u;
+    for (uint8_t position = 0; position < message->payload_length; position++) {
+        hash = (hash ^ message->payload[position]) * 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t meshcore_dedup_bucket(uint32_t hash) {
+    return (hash ^ (hash >> 16)) & (MESHCORE_DEDUP_BUCKETS - 1);
+}
+
+// Remove the oldest entry
+static void meshcore_dedup_pop(meshcore_dedup_t* dedup) {
+    uint16_t  index = (uint16_t)dedup->head;
+    uint16_t* link  = &dedup->buckets[meshcore_dedup_bucket(dedup->hashes[index])];
+    while (*link != index) {
+        link = &dedup->bucket_next[*link];
+    }
+    *link = dedup->bucket_next[index];
+
+    dedup->head = (dedup->head + 1) & MESHCORE_DEDUP_MASK;
+    dedup->count--;
+}
+
+static void meshcore_dedup_expired(meshcore_timer_t* timer, void* context) {
+    meshcore_dedup_t* dedup  = (meshcore_dedup_t*)context;
+    uint32_t          now_ms = timer->expires_ms;
+
+    while (dedup->count > 0 && (int32_t)(now_ms - dedup->seen_ms[dedup->head] - dedup->ttl_ms) >= 0) {
+        meshcore_dedup_pop(dedup);
+        dedup->stats.expired++;
+    }
+    if (dedup->count > 0) {
+        meshcore_timer_start(dedup->wheel, &dedup->timer, dedup->seen_ms[dedup->head] + dedup->ttl_ms);
+    }
+}
+
+void meshcore_dedup_init(meshcore_dedup_t* dedup, meshcore_timer_wheel_t* wheel, uint32_t ttl_ms) {
+    memset(dedup, 0, sizeof(meshcore_dedup_t));
+    dedup->wheel  = wheel;
+    dedup->ttl_ms = ttl_ms;
+    meshcore_timer_init(&dedup->timer, meshcore_dedup_expired, dedup);
+    for (uint32_t bucket = 0; bucket < MESHCORE_DEDUP_BUCKETS; bucket++) {
+        dedup->buckets[bucket] = MESHCORE_DEDUP_NONE;
+    }
+}
+
+bool meshcore_dedup_seen(meshcore_dedup_t* dedup, uint32_t hash, uint32_t now_ms) {
+    uint32_t bucket = meshcore_dedup_bucket(hash);
+    for (uint16_t index = dedup->buckets[bucket]; index != MESHCORE_DEDUP_NONE; index = dedup->bucket_next[index]) {
+        if (dedup->hashes[index] == hash) {
+            dedup->stats.duplicates++;
+            return true;
+        }
+    }
+
+    if (dedup->count == MESHCORE_DEDUP_CAPACITY) {
+        meshcore_dedup_pop(dedup);
+        dedup->stats.evicted++;
+    }
+
+    uint16_t index            = (uint16_t)((dedup->head + dedup->count) & MESHCORE_DEDUP_MASK);
+    dedup->hashes[index]      = hash;
+    dedup->seen_ms[index]     = now_ms;
+    dedup->bucket_next[index] = dedup->buckets[bucket];
+    dedup->buckets[bucket]    = index;
+    dedup->count++;
+
+    if (!meshcore_timer_active(&dedup->timer)) {
+        meshcore_timer_start(dedup->wheel, &dedup->timer, dedup->seen_ms[dedup->head] + dedup->ttl_ms);
+    }
+    return false;
+}
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packet.h"
+#include "timer_wheel.h"
+
+// Definitions
+
+// Recently seen packets, used to drop the copies of a flooded packet that arrive over different paths.
+// Entries are kept in a ring in arrival order and all live for the same time, so the oldest entry is always
+// the next to expire: a single timer on the shared wheel tracks it. A hash index makes lookups O(1).
+
+#ifndef MESHCORE_DEDUP_CAPACITY
+#define MESHCORE_DEDUP_CAPACITY 256
+#endif
+
+_Static_assert((MESHCORE_DEDUP_CAPACITY & (MESHCORE_DEDUP_CAPACITY - 1)) == 0, "MESHCORE_DEDUP_CAPACITY must be a power of two");
+_Static_assert(MESHCORE_DEDUP_CAPACITY < 0xFFFF, "MESHCORE_DEDUP_CAPACITY too large");
+
+#define MESHCORE_DEDUP_BUCKETS (MESHCORE_DEDUP_CAPACITY * 2)
+#define MESHCORE_DEDUP_NONE    0xFFFF
+
+typedef struct {
+    uint32_t duplicates;
+    uint32_t expired;
+    uint32_t evicted;  // Overwritten before they expired because the ring was full
+} meshcore_dedup_stats_t;
+
+typedef struct {
+    meshcore_timer_wheel_t* wheel;
+    meshcore_timer_t        timer;  // Expiry of the oldest entry
+    uint32_t                ttl_ms;
+    uint32_t                head;
+    uint32_t                count;
+    meshcore_dedup_stats_t  stats;
+    uint32_t                hashes[MESHCORE_DEDUP_CAPACITY];
+    uint32_t                seen_ms[MESHCORE_DEDUP_CAPACITY];
+    uint16_t                bucket_next[MESHCORE_DEDUP_CAPACITY];
+    uint16_t                buckets[MESHCORE_DEDUP_BUCKETS];
+} meshcore_dedup_t;
+
+// Functions
+
+/// Hash identifying a packet regardless of the path it took
+uint32_t meshcore_dedup_hash(const meshcore_message_t* message);
+
+/// Reset a dedup table, entries are forgotten ttl_ms after they were first seen
+void meshcore_dedup_init(meshcore_dedup_t* dedup, meshcore_timer_wheel_t* wheel, uint32_t ttl_ms);
+
+/// Check whether a packet hash was seen before, records it when it was not
+bool meshcore_dedup_seen(meshcore_dedup_t* dedup, uint32_t hash, uint32_t now_ms);
@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "latency.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// The histograms take several kilobytes of RAM, nothing here is built unless instrumentation is enabled
+#if MESHCORE_LATENCY_ENABLE
+
+#define MESHCORE_LATENCY_NAME(id, name, help) #name,
+
+static const char* const meshcore_latency_names[MESHCORE_LATENCY_STAGE_COUNT] = {MESHCORE_LATENCY_STAGES(MESHCORE_LATENCY_NAME)};
+
+static meshcore_latency_histogram_t meshcore_latency_histograms[MESHCORE_LATENCY_STAGE_COUNT];
+
+static uint32_t meshcore_latency_bucket(uint64_t value) {
+    if (value < MESHCORE_LATENCY_SUB_BUCKETS) {
+        return (uint32_t)value;
+    }
+    uint32_t magnitude = 63 - (uint32_t)__builtin_clzll(value);
+    if (magnitude >= MESHCORE_LATENCY_MAGNITUDES) {
+        return MESHCORE_LATENCY_BUCKETS - 1;
+    }
+    uint32_t sub = (uint32_t)(value >> (magnitude - MESHCORE_LATENCY_SUB_BITS)) & (MESHCORE_LATENCY_SUB_BUCKETS - 1);
+    return (magnitude - MESHCORE_LATENCY_SUB_BITS + 1) * MESHCORE_LATENCY_SUB_BUCKETS + sub;
+}
+
+// Smallest value that falls in a bucket
+static uint64_t meshcore_latency_bucket_value(uint32_t bucket) {
+    if (bucket < MESHCORE_LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+    uint32_t magnitude = bucket / MESHCORE_LATENCY_SUB_BUCKETS + MESHCORE_LATENCY_SUB_BITS - 1;
+    uint64_t sub       = bucket % MESHCORE_LATENCY_SUB_BUCKETS;
+    return (1ull << magnitude) | (sub << (magnitude - MESHCORE_LATENCY_SUB_BITS));
+}
+
+uint64_t meshcore_latency_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void meshcore_latency_record(meshcore_latency_stage_t stage, uint64_t value) {
+    if (stage >= MESHCORE_LATENCY_STAGE_COUNT) {
+        return;
+    }
+    meshcore_latency_histogram_t* histogram = &meshcore_latency_histograms[stage];
+    atomic_fetch_add_explicit(&histogram->buckets[meshcore_latency_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum, value, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    while (value > max && !atomic_compare_exchange_weak_explicit(&histogram->max, &max, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void meshcore_latency_reset(void) {
+    for (uint32_t stage = 0; stage < MESHCORE_LATENCY_STAGE_COUNT; stage++) {
+        meshcore_latency_histogram_t* histogram = &meshcore_latency_histograms[stage];
+        atomic_store_explicit(&histogram->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&histogram->sum, 0, memory_order_relaxed);
+        atomic_store_explicit(&histogram->max, 0, memory_order_relaxed);
+        for (uint32_t bucket = 0; bucket < MESHCORE_LATENCY_BUCKETS; bucket++) {
+            atomic_store_explicit(&histogram->buckets[bucket], 0, memory_order_relaxed);
+        }
+    }
+}
+
+void meshcore_latency_summary(meshcore_latency_stage_t stage, meshcore_latency_summary_t* out_summary) {
+    *out_summary = (meshcore_latency_summary_t){0};
+    if (stage >= MESHCORE_LATENCY_STAGE_COUNT) {
+        return;
+    }
+
+    // Other threads may record while the buckets are read, the percentiles are taken from the total of the
+    // buckets as they are read and may be off by the samples recorded in the meantime
+    meshcore_latency_histogram_t* histogram = &meshcore_latency_histograms[stage];
+    uint64_t                      total     = 0;
+    for (uint32_t bucket = 0; bucket < MESHCORE_LATENCY_BUCKETS; bucket++) {
+        total += atomic_load_explicit(&histogram->buckets[bucket], memory_order_relaxed);
+    }
+    if (total == 0) {
+        return;
+    }
+
+    static const uint32_t permille[] = {500, 900, 990, 999};
+    uint64_t*             values[]   = {&out_summary->p50, &out_summary->p90, &out_summary->p99, &out_summary->p999};
+    uint64_t              seen       = 0;
+    uint32_t              next       = 0;
+    for (uint32_t bucket = 0; bucket < MESHCORE_LATENCY_BUCKETS && next < 4; bucket++) {
+        seen += atomic_load_explicit(&histogram->buckets[bucket], memory_order_relaxed);
+        while (next < 4 && seen * 1000 >= total * permille[next]) {
+            *values[next++] = meshcore_latency_bucket_value(bucket);
+        }
+    }
+    // Percentiles not reached because the buckets changed while they were read are reported as the maximum
+    while (next < 4) {
+        *values[next++] = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    }
+
+    uint64_t count     = atomic_load_explicit(&histogram->count, memory_order_relaxed);
+    out_summary->count = total;
+    out_summary->mean  = (count > 0) ? atomic_load_explicit(&histogram->sum, memory_order_relaxed) / count : 0;
+    out_summary->max   = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+}
+
+const char* meshcore_latency_name(meshcore_latency_stage_t stage) {
+    return (stage < MESHCORE_LATENCY_STAGE_COUNT) ? meshcore_latency_names[stage] : "unknown";
+}
+
+int meshcore_latency_format(char* out, size_t size) {
+    size_t position = 0;
+    int    length   = snprintf(out, size, "%-12s %10s %10s %10s %10s %10s %10s %10s\n", "stage", "count", "mean", "p50", "p90", "p99", "p99.9",
+                               "max");
+    if (length < 0 || (size_t)length >= size) {
+        return -1;
+    }
+    position += (size_t)length;
+
+    for (uint32_t stage = 0; stage < MESHCORE_LATENCY_STAGE_COUNT; stage++) {
+        meshcore_latency_summary_t summary;
+        meshcore_latency_summary((meshcore_latency_stage_t)stage, &summary);
+        if (summary.count == 0) {
+            continue;
+        }
+        length = snprintf(&out[position], size - position,
+                          "%-12s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+                          meshcore_latency_names[stage], summary.count, summary.mean, summary.p50, summary.p90, summary.p99, summary.p999,
+                          summary.max);
+        if (length < 0 || (size_t)length >= size - position) {
+            return -1;
+        }
+        position += (size_t)length;
+    }
+    return (int)position;
+}
+
+#endif
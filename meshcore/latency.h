@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Definitions
+
+// Latency histograms for the receive path, from a frame arriving on the companion serial port or the radio to
+// the response written back. Each stage has a log-linear histogram: values are grouped by their power of two
+// and every group is split into MESHCORE_LATENCY_SUB_BUCKETS linear buckets, which keeps the relative error
+// below 1 / MESHCORE_LATENCY_SUB_BUCKETS over the whole range with a few hundred counters. Recording is a
+// relaxed atomic increment, so stages can be recorded from any thread without a lock.
+//
+// Instrumentation is compiled in only when MESHCORE_LATENCY_ENABLE is 1, otherwise the macros below expand
+// to nothing, the hot paths are unchanged and the functions below are not built. Time comes from
+// CLOCK_MONOTONIC in nanoseconds, define MESHCORE_LATENCY_NOW() to read a cycle counter instead (the TSC,
+// or the DWT cycle counter on a Cortex-M), values are then in cycles.
+
+#ifndef MESHCORE_LATENCY_ENABLE
+#define MESHCORE_LATENCY_ENABLE 0
+#endif
+
+#define MESHCORE_LATENCY_STAGES(STAGE)                                          \
+    STAGE(FRAME, frame, "Serial frame, from its start byte to its last byte")   \
+    STAGE(PARSE, parse, "Companion command parsing")                            \
+    STAGE(DECODE, decode, "Radio packet deserialization")                       \
+    STAGE(MAC_VERIFY, mac_verify, "Cipher MAC verification")                    \
+    STAGE(DECRYPT, decrypt, "Payload decryption")                               \
+    STAGE(DISPATCH, dispatch, "Command handler, including the response")        \
+    STAGE(RESPONSE, response, "Response framing")
+
+#define MESHCORE_LATENCY_ENUM(id, name, help) MESHCORE_LATENCY_##id,
+
+typedef enum {
+    MESHCORE_LATENCY_STAGES(MESHCORE_LATENCY_ENUM) MESHCORE_LATENCY_STAGE_COUNT,
+} meshcore_latency_stage_t;
+
+#define MESHCORE_LATENCY_SUB_BITS    4
+#define MESHCORE_LATENCY_SUB_BUCKETS (1 << MESHCORE_LATENCY_SUB_BITS)
+#define MESHCORE_LATENCY_MAGNITUDES  40  // Values up to 2^40 (about 18 minutes in ns), larger ones are clamped
+#define MESHCORE_LATENCY_BUCKETS     ((MESHCORE_LATENCY_MAGNITUDES - MESHCORE_LATENCY_SUB_BITS + 1) * MESHCORE_LATENCY_SUB_BUCKETS)
+
+typedef struct {
+    atomic_uint_least64_t count;
+    atomic_uint_least64_t sum;
+    atomic_uint_least64_t max;
+    atomic_uint_least32_t buckets[MESHCORE_LATENCY_BUCKETS];
+} meshcore_latency_histogram_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t mean;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+} meshcore_latency_summary_t;
+
+#if MESHCORE_LATENCY_ENABLE
+#ifndef MESHCORE_LATENCY_NOW
+#define MESHCORE_LATENCY_NOW() meshcore_latency_now()
+#endif
+/// Take a timestamp into a new variable
+#define MESHCORE_LATENCY_START(timestamp) uint64_t timestamp = MESHCORE_LATENCY_NOW()
+/// Take a timestamp into an existing variable
+#define MESHCORE_LATENCY_MARK(timestamp) ((timestamp) = MESHCORE_LATENCY_NOW())
+/// Record the time since a timestamp for a stage
+#define MESHCORE_LATENCY_END(stage, timestamp) meshcore_latency_record((stage), MESHCORE_LATENCY_NOW() - (timestamp))
+#else
+#define MESHCORE_LATENCY_START(timestamp)
+#define MESHCORE_LATENCY_MARK(timestamp)
+#define MESHCORE_LATENCY_END(stage, timestamp)
+#endif
+
+// Functions
+
+/// Monotonic time in nanoseconds
+uint64_t meshcore_latency_now(void);
+
+/// Add a sample to the histogram of a stage
+void meshcore_latency_record(meshcore_latency_stage_t stage, uint64_t value);
+
+/// Clear all histograms
+void meshcore_latency_reset(void);
+
+/// Summarize the histogram of a stage, percentiles are the lower bound of the bucket they fall in
+void meshcore_latency_summary(meshcore_latency_stage_t stage, meshcore_latency_summary_t* out_summary);
+
+/// Name of a stage
+const char* meshcore_latency_name(meshcore_latency_stage_t stage);
+
+/// Write a table with the summary of every stage that has samples, returns the length written or -1 when
+/// out does not have room for all of it
+int meshcore_latency_format(char* out, size_t size);
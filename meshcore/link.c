@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "link.h"
+#include <stdint.h>
+#include <string.h>
+
+static uint32_t meshcore_link_random(meshcore_link_t* link) {
+    // xorshift32
+    uint32_t x    = link->random;
+    x            ^= x << 13;
+    x            ^= x >> 17;
+    x            ^= x << 5;
+    link->random  = x;
+    return x;
+}
+
+static int meshcore_link_transmit(meshcore_link_t* link, const uint8_t* data, uint8_t size) {
+    if (link->ops->send(link, data, size) < 0) {
+        link->stats.errors++;
+        meshcore_stats_add(link->node_stats, MESHCORE_STATS_TX_ERRORS, 1);
+        return -1;
+    }
+    link->stats.sent++;
+    link->stats.bytes_sent += size;
+    meshcore_stats_frame(link->node_stats, true, data, size);
+    return 0;
+}
+
+void meshcore_link_init(meshcore_link_t* link, const meshcore_link_ops_t* ops, void* context, int fd, uint32_t seed) {
+    memset(link, 0, sizeof(meshcore_link_t));
+    link->ops     = ops;
+    link->context = context;
+    link->fd      = fd;
+    link->random  = (seed != 0) ? seed : 0x2545F491;
+    for (uint8_t index = 0; index < MESHCORE_LINK_QUEUE_SIZE; index++) {
+        link->queue[index] = index;
+    }
+}
+
+void meshcore_link_set_impairment(meshcore_link_t* link, const meshcore_link_impairment_t* impairment) {
+    link->impairment = *impairment;
+}
+
+void meshcore_link_set_stats(meshcore_link_t* link, meshcore_stats_shard_t* shard) {
+    link->node_stats = shard;
+}
+
+int meshcore_link_send(meshcore_link_t* link, const uint8_t* data, uint8_t size, uint32_t now_ms) {
+    if (link == NULL || data == NULL || size == 0) {
+        return -1;
+    }
+
+    const meshcore_link_impairment_t* impairment = &link->impairment;
+    if (impairment->loss_permille > 0 && meshcore_link_random(link) % 1000 < impairment->loss_permille) {
+        link->stats.lost++;
+        return 0;
+    }
+
+    uint32_t due_ms = now_ms + impairment->latency_ms;
+    if (impairment->jitter_ms > 0) {
+        due_ms += meshcore_link_random(link) % (impairment->jitter_ms + 1);
+    }
+    if (impairment->rate_bps > 0) {
+        // The frame leaves once the previous one is through and arrives when its last bit is
+        if ((int32_t)(link->rate_free_ms - due_ms) > 0) {
+            due_ms = link->rate_free_ms;
+        }
+        due_ms             += (uint32_t)(((uint64_t)size * 8000 + impairment->rate_bps - 1) / impairment->rate_bps);
+        link->rate_free_ms  = due_ms;
+    }
+
+    // Nothing to wait for: skip the queue
+    if ((int32_t)(due_ms - now_ms) <= 0 && link->queue_count == 0) {
+        return meshcore_link_transmit(link, data, size);
+    }
+
+    if (link->queue_count == MESHCORE_LINK_QUEUE_SIZE) {
+        link->stats.dropped++;
+        return -1;
+    }
+
+    // Keep the queue ordered by due time, after frames due at the same time
+    uint8_t position = link->queue_count;
+    while (position > 0 && (int32_t)(link->frames[link->queue[position - 1]].due_ms - due_ms) > 0) {
+        position--;
+    }
+    uint8_t index = link->queue[link->queue_count];
+    memmove(&link->queue[position + 1], &link->queue[position], link->queue_count - position);
+    link->queue[position] = index;
+    link->queue_count++;
+
+    meshcore_link_frame_t* frame = &link->frames[index];
+    frame->due_ms                = due_ms;
+    frame->size                  = size;
+    memcpy(frame->data, data, size);
+    link->stats.delayed++;
+    return 0;
+}
+
+int meshcore_link_send_message(meshcore_link_t* link, const meshcore_message_t* message, uint32_t now_ms) {
+    uint8_t data[MESHCORE_MAX_TRANS_UNIT];
+    uint8_t size = 0;
+    if (meshcore_serialize(message, data, &size) < 0) {
+        return -1;
+    }
+    return meshcore_link_send(link, data, size, now_ms);
+}
+
+int meshcore_link_poll(meshcore_link_t* link, uint32_t now_ms, uint32_t* out_wait_ms) {
+    int sent = 0;
+    while (link->queue_count > 0) {
+        uint8_t                index = link->queue[0];
+        meshcore_link_frame_t* frame = &link->frames[index];
+        if ((int32_t)(frame->due_ms - now_ms) > 0) {
+            break;
+        }
+        if (meshcore_link_transmit(link, frame->data, frame->size) == 0) {
+            sent++;
+        }
+        link->queue_count--;
+        memmove(&link->queue[0], &link->queue[1], link->queue_count);
+        link->queue[link->queue_count] = index;
+    }
+
+    if (out_wait_ms != NULL) {
+        *out_wait_ms = (link->queue_count > 0) ? link->frames[link->queue[0]].due_ms - now_ms : UINT32_MAX;
+    }
+    return sent;
+}
+
+int meshcore_link_receive(meshcore_link_t* link, uint8_t* out_data, uint8_t* out_size) {
+    int result = link->ops->receive(link, out_data, out_size);
+    if (result < 0) {
+        link->stats.errors++;
+    } else if (result > 0) {
+        link->stats.received++;
+        link->stats.bytes_received += *out_size;
+        meshcore_stats_frame(link->node_stats, false, out_data, *out_size);
+    }
+    return result;
+}
+
+int meshcore_link_receive_message(meshcore_link_t* link, meshcore_message_t* out_message) {
+    uint8_t data[MESHCORE_MAX_TRANS_UNIT];
+    uint8_t size = 0;
+    int     result;
+    while ((result = meshcore_link_receive(link, data, &size)) > 0) {
+        if (meshcore_deserialize(data, size, out_message) >= 0) {
+            return 1;
+        }
+        link->stats.malformed++;
+        meshcore_stats_add(link->node_stats, MESHCORE_STATS_RX_ERRORS, 1);
+    }
+    return result;
+}
+
+void meshcore_link_close(meshcore_link_t* link) {
+    if (link->ops != NULL && link->ops->close != NULL) {
+        link->ops->close(link);
+    }
+    link->fd = -1;
+}
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packet.h"
+#include "stats.h"
+
+// Definitions
+
+// Radio link abstraction. A link carries raw serialized frames, one frame per send or receive, through a
+// backend: a radio driver on a device, or a datagram socket on a host (see link_udp.h). Outgoing frames can
+// be impaired to mimic a radio channel: frames are lost with a given probability, held back for a latency
+// with jitter, and limited to a bit rate, frames that would exceed the rate wait in the delay queue.
+//
+// Like the timer wheel, the link has no clock of its own, the caller passes the time in milliseconds.
+
+#ifndef MESHCORE_LINK_QUEUE_SIZE
+#define MESHCORE_LINK_QUEUE_SIZE 32
+#endif
+
+_Static_assert(MESHCORE_LINK_QUEUE_SIZE < 0xFF, "MESHCORE_LINK_QUEUE_SIZE too large");
+
+typedef struct meshcore_link meshcore_link_t;
+
+typedef struct {
+    /// Transmit a frame now, returns -1 on error
+    int (*send)(meshcore_link_t* link, const uint8_t* data, uint8_t size);
+    /// Fetch a received frame without blocking, returns 1 with a frame, 0 when there is none and -1 on error
+    int (*receive)(meshcore_link_t* link, uint8_t* out_data, uint8_t* out_size);
+    /// Release the backend
+    void (*close)(meshcore_link_t* link);
+} meshcore_link_ops_t;
+
+typedef struct {
+    uint16_t loss_permille;  // Share of outgoing frames that is dropped
+    uint32_t latency_ms;     // Delay added to every outgoing frame
+    uint32_t jitter_ms;      // Random extra delay of 0 to jitter_ms
+    uint32_t rate_bps;       // Bit rate limit, 0 for no limit
+} meshcore_link_impairment_t;
+
+typedef struct {
+    uint32_t sent;
+    uint32_t received;
+    uint32_t lost;       // Dropped by the loss impairment
+    uint32_t dropped;    // Delay queue full
+    uint32_t delayed;    // Held back by latency or the rate limit
+    uint32_t errors;     // Backend failures
+    uint32_t malformed;  // Received frames that failed to decode
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+} meshcore_link_stats_t;
+
+typedef struct {
+    uint32_t due_ms;
+    uint8_t  size;
+    uint8_t  data[MESHCORE_MAX_TRANS_UNIT];
+} meshcore_link_frame_t;
+
+struct meshcore_link {
+    const meshcore_link_ops_t* ops;
+    void*                      context;
+    int                        fd;  // Descriptor to wait on for received frames, -1 if the backend has none
+    meshcore_link_impairment_t impairment;
+    uint32_t                   random;
+    uint32_t                   rate_free_ms;  // The rate limit allows the next frame from this time on
+    uint8_t                    queue_count;
+    uint8_t                    queue[MESHCORE_LINK_QUEUE_SIZE];  // Frame indices, the first queue_count by due time and the rest free
+    meshcore_link_stats_t      stats;
+    meshcore_stats_shard_t*    node_stats;  // Node statistics shard of the thread using the link, NULL when not counted
+    meshcore_link_frame_t      frames[MESHCORE_LINK_QUEUE_SIZE];
+};
+
+// Functions
+
+/// Prepare a link for a backend, seed initializes the loss and jitter generator and should differ between nodes
+void meshcore_link_init(meshcore_link_t* link, const meshcore_link_ops_t* ops, void* context, int fd, uint32_t seed);
+
+/// Change the impairments, applies to frames sent from now on
+void meshcore_link_set_impairment(meshcore_link_t* link, const meshcore_link_impairment_t* impairment);
+
+/// Count the frames sent and received on the link in a node statistics shard, NULL to stop counting
+void meshcore_link_set_stats(meshcore_link_t* link, meshcore_stats_shard_t* shard);
+
+/// Send a serialized frame, returns 0 when it was sent, queued or lost on purpose and -1 on error
+int meshcore_link_send(meshcore_link_t* link, const uint8_t* data, uint8_t size, uint32_t now_ms);
+
+/// Serialize and send a message
+int meshcore_link_send_message(meshcore_link_t* link, const meshcore_message_t* message, uint32_t now_ms);
+
+/// Send the queued frames that are due, returns the number sent. out_wait_ms is set to the time until the
+/// next queued frame is due, UINT32_MAX when the queue is empty.
+int meshcore_link_poll(meshcore_link_t* link, uint32_t now_ms, uint32_t* out_wait_ms);
+
+/// Fetch a received frame, returns 1 with a frame, 0 when there is none and -1 on error
+int meshcore_link_receive(meshcore_link_t* link, uint8_t* out_data, uint8_t* out_size);
+
+/// Fetch and deserialize a received frame, frames that do not decode are skipped
+int meshcore_link_receive_message(meshcore_link_t* link, meshcore_message_t* out_message);
+
+/// Release the backend
+void meshcore_link_close(meshcore_link_t* link);
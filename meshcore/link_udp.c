@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "link_udp.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int meshcore_link_udp_send(meshcore_link_t* link, const uint8_t* data, uint8_t size) {
+    meshcore_link_udp_t* udp = (meshcore_link_udp_t*)link->context;
+    ssize_t              sent;
+    do {
+        sent = sendto(udp->tx_fd, data, size, 0, (const struct sockaddr*)&udp->group, sizeof(udp->group));
+    } while (sent < 0 && errno == EINTR);
+    return (sent == size) ? 0 : -1;
+}
+
+static int meshcore_link_udp_receive(meshcore_link_t* link, uint8_t* out_data, uint8_t* out_size) {
+    meshcore_link_udp_t* udp = (meshcore_link_udp_t*)link->context;
+    for (;;) {
+        struct sockaddr_in source;
+        socklen_t          source_length = sizeof(source);
+        ssize_t received = recvfrom(udp->rx_fd, out_data, MESHCORE_MAX_TRANS_UNIT, MSG_DONTWAIT | MSG_TRUNC, (struct sockaddr*)&source, &source_length);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        if (source.sin_port == udp->tx_port && source.sin_addr.s_addr == htonl(INADDR_LOOPBACK)) {
+            continue;  // Looped back own frame
+        }
+        if (received == 0 || received > MESHCORE_MAX_TRANS_UNIT) {
+            continue;  // Not a frame
+        }
+        *out_size = (uint8_t)received;
+        return 1;
+    }
+}
+
+static void meshcore_link_udp_close(meshcore_link_t* link) {
+    meshcore_link_udp_t* udp = (meshcore_link_udp_t*)link->context;
+    if (udp->rx_fd >= 0) {
+        close(udp->rx_fd);
+    }
+    if (udp->tx_fd >= 0) {
+        close(udp->tx_fd);
+    }
+    udp->rx_fd = -1;
+    udp->tx_fd = -1;
+}
+
+// Undo a partial open, keeping the errno of the step that failed
+static int meshcore_link_udp_fail(meshcore_link_udp_t* udp) {
+    int error = errno;
+    meshcore_link_t link = {.context = udp};
+    meshcore_link_udp_close(&link);
+    errno = error;
+    return -1;
+}
+
+static const meshcore_link_ops_t meshcore_link_udp_ops = {
+    .send    = meshcore_link_udp_send,
+    .receive = meshcore_link_udp_receive,
+    .close   = meshcore_link_udp_close,
+};
+
+int meshcore_link_udp_open(meshcore_link_t* link, meshcore_link_udp_t* udp, const char* group, uint16_t port, uint32_t seed) {
+    memset(udp, 0, sizeof(meshcore_link_udp_t));
+    udp->rx_fd            = -1;
+    udp->tx_fd            = -1;
+    udp->group.sin_family = AF_INET;
+    udp->group.sin_port   = htons(port);
+    if (inet_pton(AF_INET, group, &udp->group.sin_addr) != 1 || !IN_MULTICAST(ntohl(udp->group.sin_addr.s_addr))) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    udp->rx_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    udp->tx_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (udp->rx_fd < 0 || udp->tx_fd < 0) {
+        return meshcore_link_udp_fail(udp);
+    }
+
+    // Every node on the machine binds the same port
+    int enable = 1;
+    setsockopt(udp->rx_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    setsockopt(udp->rx_fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+
+    struct sockaddr_in bind_address = {
+        .sin_family = AF_INET,
+        .sin_port   = htons(port),
+        .sin_addr   = udp->group.sin_addr,
+    };
+    if (bind(udp->rx_fd, (const struct sockaddr*)&bind_address, sizeof(bind_address)) != 0) {
+        return meshcore_link_udp_fail(udp);
+    }
+
+    struct ip_mreq membership = {
+        .imr_multiaddr.s_addr = udp->group.sin_addr.s_addr,
+        .imr_interface.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (setsockopt(udp->rx_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+        return meshcore_link_udp_fail(udp);
+    }
+
+    // Send on the loopback interface only, and loop frames back to the other processes on it
+    struct in_addr interface = {.s_addr = htonl(INADDR_LOOPBACK)};
+    unsigned char  loop      = 1;
+    unsigned char  ttl       = 0;
+    if (setsockopt(udp->tx_fd, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface)) != 0 ||
+        setsockopt(udp->tx_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0 ||
+        setsockopt(udp->tx_fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0) {
+        return meshcore_link_udp_fail(udp);
+    }
+
+    struct sockaddr_in source = {
+        .sin_family      = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t source_length = sizeof(source);
+    if (bind(udp->tx_fd, (const struct sockaddr*)&source, sizeof(source)) != 0 ||
+        getsockname(udp->tx_fd, (struct sockaddr*)&source, &source_length) != 0) {
+        return meshcore_link_udp_fail(udp);
+    }
+    udp->tx_port = source.sin_port;
+
+    meshcore_link_init(link, &meshcore_link_udp_ops, udp, udp->rx_fd, seed);
+    return 0;
+}
+
+int meshcore_link_udp_parse(const char* address, char* out_group, size_t group_size, uint16_t* out_port) {
+    const char* colon        = strchr(address, ':');
+    size_t      group_length = (colon != NULL) ? (size_t)(colon - address) : strlen(address);
+
+    if (group_length > 0) {
+        if (group_length >= group_size) {
+            return -1;
+        }
+        memcpy(out_group, address, group_length);
+        out_group[group_length] = '\0';
+    }
+
+    if (colon != NULL && colon[1] != '\0') {
+        char*         end;
+        unsigned long port = strtoul(colon + 1, &end, 10);
+        if (*end != '\0' || port == 0 || port > 0xFFFF) {
+            return -1;
+        }
+        *out_port = (uint16_t)port;
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <netinet/in.h>
+#include <stdint.h>
+#include "link.h"
+
+// Definitions
+
+// Link backend for POSIX hosts that stands in for the radio channel with UDP multicast on the loopback
+// interface. Every process joined to the same group and port hears every frame sent by the others, one
+// datagram per frame, so repeaters, gateways and companion servers can share a mesh on one machine.
+// Frames are sent from a separate socket, which is how a node recognizes and skips its own frames.
+
+#define MESHCORE_LINK_UDP_DEFAULT_GROUP "239.77.67.1"
+#define MESHCORE_LINK_UDP_DEFAULT_PORT  4730
+
+typedef struct {
+    int                rx_fd;
+    int                tx_fd;
+    uint16_t           tx_port;  // Source port of own frames, network order
+    struct sockaddr_in group;
+} meshcore_link_udp_t;
+
+// Functions
+
+/// Join a multicast group on the loopback interface and attach it to a link, returns -1 with errno set on failure
+int meshcore_link_udp_open(meshcore_link_t* link, meshcore_link_udp_t* udp, const char* group, uint16_t port, uint32_t seed);
+
+/// Parse "group:port", "group", ":port" or ":" into its parts, missing parts are left untouched. Returns -1 if malformed.
+int meshcore_link_udp_parse(const char* address, char* out_group, size_t group_size, uint16_t* out_port);
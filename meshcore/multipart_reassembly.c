@@ -0,0 +1,259 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "multipart_reassembly.h"
+#include <stdint.h>
+#include <string.h>
+
+_Static_assert(MESHCORE_MULTIPART_MAX_SLABS >= MESHCORE_MULTIPART_MAX_FRAGMENTS, "slab pool can not hold a complete message");
+
+#define MESHCORE_MULTIPART_KEY(source_hash, message_id) (((uint32_t)(source_hash) << 16) | (message_id))
+
+static uint32_t meshcore_multipart_bucket(uint32_t key) {
+    return ((key * 0x9E3779B1u) >> 8) & (MESHCORE_MULTIPART_BUCKETS - 1);
+}
+
+static uint16_t meshcore_multipart_find(meshcore_multipart_reassembly_t* reassembly, uint32_t key) {
+    uint16_t index = reassembly->buckets[meshcore_multipart_bucket(key)];
+    while (index != MESHCORE_MULTIPART_NONE && reassembly->entries[index].key != key) {
+        index = reassembly->entries[index].bucket_next;
+    }
+    return index;
+}
+
+static uint8_t meshcore_multipart_count(uint16_t mask) {
+    uint8_t count = 0;
+    while (mask) {
+        mask &= mask - 1;
+        count++;
+    }
+    return count;
+}
+
+// Return an entry and its slabs to the free lists
+static void meshcore_multipart_release(meshcore_multipart_reassembly_t* reassembly, uint16_t index) {
+    meshcore_multipart_entry_t* entry = &reassembly->entries[index];
+
+    for (uint8_t fragment = 0; fragment <= entry->last_index; fragment++) {
+        uint16_t slab = entry->slabs[fragment];
+        if (slab != MESHCORE_MULTIPART_NONE) {
+            reassembly->slabs[slab].next = reassembly->free_slab;
+            reassembly->free_slab        = slab;
+        }
+    }
+
+    uint16_t* link = &reassembly->buckets[meshcore_multipart_bucket(entry->key)];
+    while (*link != index) {
+        link = &reassembly->entries[*link].bucket_next;
+    }
+    *link = entry->bucket_next;
+
+    if (entry->older != MESHCORE_MULTIPART_NONE) {
+        reassembly->entries[entry->older].newer = entry->newer;
+    } else {
+        reassembly->oldest = entry->newer;
+    }
+    if (entry->newer != MESHCORE_MULTIPART_NONE) {
+        reassembly->entries[entry->newer].older = entry->older;
+    } else {
+        reassembly->newest = entry->older;
+    }
+
+    entry->bucket_next     = reassembly->free_entry;
+    reassembly->free_entry = index;
+    reassembly->active--;
+}
+
+// Drop an incomplete message, accounting for the fragments that never arrived
+static void meshcore_multipart_drop(meshcore_multipart_reassembly_t* reassembly, uint16_t index) {
+    meshcore_multipart_entry_t* entry = &reassembly->entries[index];
+
+    reassembly->stats.fragments_lost += (uint32_t)(entry->last_index + 1) - meshcore_multipart_count(entry->received);
+    meshcore_multipart_release(reassembly, index);
+}
+
+// Make room by dropping the oldest message other than keep
+static bool meshcore_multipart_evict(meshcore_multipart_reassembly_t* reassembly, uint16_t keep) {
+    uint16_t victim = reassembly->oldest;
+    if (victim == keep && victim != MESHCORE_MULTIPART_NONE) {
+        victim = reassembly->entries[victim].newer;
+    }
+    if (victim == MESHCORE_MULTIPART_NONE) {
+        return false;
+    }
+    reassembly->stats.messages_evicted++;
+    meshcore_multipart_drop(reassembly, victim);
+    return true;
+}
+
+void meshcore_multipart_reassembly_init(meshcore_multipart_reassembly_t* reassembly, uint32_t timeout_ms) {
+    memset(&reassembly->stats, 0, sizeof(reassembly->stats));
+    reassembly->timeout_ms = timeout_ms;
+    reassembly->oldest     = MESHCORE_MULTIPART_NONE;
+    reassembly->newest     = MESHCORE_MULTIPART_NONE;
+    reassembly->active     = 0;
+
+    for (uint32_t bucket = 0; bucket < MESHCORE_MULTIPART_BUCKETS; bucket++) {
+        reassembly->buckets[bucket] = MESHCORE_MULTIPART_NONE;
+    }
+
+    for (uint16_t index = 0; index < MESHCORE_MULTIPART_MAX_MESSAGES; index++) {
+        reassembly->entries[index].bucket_next = (index + 1 < MESHCORE_MULTIPART_MAX_MESSAGES) ? index + 1 : MESHCORE_MULTIPART_NONE;
+    }
+    reassembly->free_entry = 0;
+
+    for (uint16_t index = 0; index < MESHCORE_MULTIPART_MAX_SLABS; index++) {
+        reassembly->slabs[index].next = (index + 1 < MESHCORE_MULTIPART_MAX_SLABS) ? index + 1 : MESHCORE_MULTIPART_NONE;
+    }
+    reassembly->free_slab = 0;
+}
+
+uint32_t meshcore_multipart_reassembly_expire(meshcore_multipart_reassembly_t* reassembly, uint32_t now_ms) {
+    uint32_t expired = 0;
+
+    // Entries are kept in order of arrival of their first fragment, so only the oldest end needs checking
+    while (reassembly->oldest != MESHCORE_MULTIPART_NONE && now_ms - reassembly->entries[reassembly->oldest].first_seen >= reassembly->timeout_ms) {
+        meshcore_multipart_drop(reassembly, reassembly->oldest);
+        reassembly->stats.messages_expired++;
+        expired++;
+    }
+
+    return expired;
+}
+
+static void meshcore_multipart_complete(meshcore_multipart_reassembly_t* reassembly, const meshcore_multipart_t* fragment, uint32_t latency_ms,
+                                        size_t length, meshcore_multipart_message_t* out_message) {
+    reassembly->stats.messages_completed++;
+    reassembly->stats.latency_total_ms += latency_ms;
+    if (latency_ms > reassembly->stats.latency_max_ms) {
+        reassembly->stats.latency_max_ms = latency_ms;
+    }
+
+    if (out_message != NULL) {
+        out_message->source_hash  = fragment->source_hash;
+        out_message->message_id   = fragment->message_id;
+        out_message->payload_type = fragment->payload_type;
+        out_message->length       = length;
+        out_message->latency_ms   = latency_ms;
+    }
+}
+
+int meshcore_multipart_reassembly_push(meshcore_multipart_reassembly_t* reassembly, const meshcore_multipart_t* fragment, uint32_t now_ms,
+                                       uint8_t* out_data, size_t out_data_size, meshcore_multipart_message_t* out_message) {
+    if (reassembly == NULL || fragment == NULL || out_data == NULL) {
+        return -1;
+    }
+
+    reassembly->stats.fragments_received++;
+
+    uint8_t index      = MESHCORE_MULTIPART_FRAGMENT_INDEX(fragment->fragment);
+    uint8_t last_index = MESHCORE_MULTIPART_FRAGMENT_LAST(fragment->fragment);
+
+    // Every fragment but the last is full, which fixes the offset of each fragment in the message
+    if (index > last_index || fragment->data_length == 0 || fragment->data_length > MESHCORE_MULTIPART_FRAGMENT_SIZE ||
+        (index < last_index && fragment->data_length != MESHCORE_MULTIPART_FRAGMENT_SIZE)) {
+        reassembly->stats.fragments_invalid++;
+        return -1;
+    }
+
+    meshcore_multipart_reassembly_expire(reassembly, now_ms);
+
+    // A message that fits in one fragment needs no reassembly state
+    if (last_index == 0) {
+        if (out_data_size < fragment->data_length) {
+            return -1;
+        }
+        memcpy(out_data, fragment->data, fragment->data_length);
+        meshcore_multipart_complete(reassembly, fragment, 0, fragment->data_length, out_message);
+        return 1;
+    }
+
+    uint32_t key   = MESHCORE_MULTIPART_KEY(fragment->source_hash, fragment->message_id);
+    uint16_t entry = meshcore_multipart_find(reassembly, key);
+    uint16_t bit   = (uint16_t)(1u << index);
+    uint16_t full  = (uint16_t)((1u << (last_index + 1)) - 1);
+
+    if (entry != MESHCORE_MULTIPART_NONE) {
+        meshcore_multipart_entry_t* existing = &reassembly->entries[entry];
+        if (existing->last_index != last_index || existing->payload_type != fragment->payload_type) {
+            reassembly->stats.fragments_invalid++;
+            return -1;
+        }
+        if (existing->received & bit) {
+            reassembly->stats.fragments_duplicate++;
+            return 0;
+        }
+
+        if ((existing->received | bit) == full) {
+            // Last missing fragment: copy the stored fragments straight into place next to it
+            size_t length = (size_t)last_index * MESHCORE_MULTIPART_FRAGMENT_SIZE;
+            if (index == last_index) {
+                length += fragment->data_length;
+            } else {
+                length += reassembly->slabs[existing->slabs[last_index]].length;
+            }
+            if (out_data_size < length) {
+                return -1;
+            }
+
+            for (uint8_t part = 0; part <= last_index; part++) {
+                uint8_t* destination = &out_data[(size_t)part * MESHCORE_MULTIPART_FRAGMENT_SIZE];
+                if (part == index) {
+                    memcpy(destination, fragment->data, fragment->data_length);
+                } else {
+                    const meshcore_multipart_slab_t* slab = &reassembly->slabs[existing->slabs[part]];
+                    memcpy(destination, slab->data, slab->length);
+                }
+            }
+
+            meshcore_multipart_complete(reassembly, fragment, now_ms - existing->first_seen, length, out_message);
+            meshcore_multipart_release(reassembly, entry);
+            return 1;
+        }
+    } else {
+        if (reassembly->free_entry == MESHCORE_MULTIPART_NONE) {
+            meshcore_multipart_evict(reassembly, MESHCORE_MULTIPART_NONE);
+        }
+
+        entry                                 = reassembly->free_entry;
+        meshcore_multipart_entry_t* created   = &reassembly->entries[entry];
+        reassembly->free_entry                = created->bucket_next;
+        created->key                          = key;
+        created->first_seen                   = now_ms;
+        created->received                     = 0;
+        created->last_index                   = last_index;
+        created->payload_type                 = fragment->payload_type;
+        uint32_t bucket                       = meshcore_multipart_bucket(key);
+        created->bucket_next                  = reassembly->buckets[bucket];
+        reassembly->buckets[bucket]           = entry;
+        created->older                        = reassembly->newest;
+        created->newer                        = MESHCORE_MULTIPART_NONE;
+        for (uint8_t part = 0; part < MESHCORE_MULTIPART_MAX_FRAGMENTS; part++) {
+            created->slabs[part] = MESHCORE_MULTIPART_NONE;
+        }
+        if (reassembly->newest != MESHCORE_MULTIPART_NONE) {
+            reassembly->entries[reassembly->newest].newer = entry;
+        } else {
+            reassembly->oldest = entry;
+        }
+        reassembly->newest = entry;
+        reassembly->active++;
+    }
+
+    // Store the fragment until the rest of the message arrives
+    while (reassembly->free_slab == MESHCORE_MULTIPART_NONE) {
+        meshcore_multipart_evict(reassembly, entry);
+    }
+
+    uint16_t                   slab_index = reassembly->free_slab;
+    meshcore_multipart_slab_t* slab       = &reassembly->slabs[slab_index];
+    reassembly->free_slab                 = slab->next;
+    slab->length                          = fragment->data_length;
+    memcpy(slab->data, fragment->data, fragment->data_length);
+
+    meshcore_multipart_entry_t* pending  = &reassembly->entries[entry];
+    pending->slabs[index]                = slab_index;
+    pending->received                   |= bit;
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "payload/multipart.h"
+
+// Definitions
+
+// Capacity is fixed at compile time so that reassembly never allocates. The defaults suit a small
+// node, gateways can raise them (for example -DMESHCORE_MULTIPART_MAX_MESSAGES=4096).
+#ifndef MESHCORE_MULTIPART_MAX_MESSAGES
+#define MESHCORE_MULTIPART_MAX_MESSAGES 64
+#endif
+
+#ifndef MESHCORE_MULTIPART_MAX_SLABS
+#define MESHCORE_MULTIPART_MAX_SLABS (MESHCORE_MULTIPART_MAX_MESSAGES * 4)
+#endif
+
+#define MESHCORE_MULTIPART_NONE 0xFFFF
+
+_Static_assert(MESHCORE_MULTIPART_MAX_MESSAGES < MESHCORE_MULTIPART_NONE, "multipart message table too large");
+_Static_assert(MESHCORE_MULTIPART_MAX_SLABS < MESHCORE_MULTIPART_NONE, "multipart slab pool too large");
+
+// Number of hash buckets, a power of two of at least twice the number of messages
+#define MESHCORE_MULTIPART_BUCKETS                                                              \
+    ((MESHCORE_MULTIPART_MAX_MESSAGES <= 32)     ? 64                                           \
+     : (MESHCORE_MULTIPART_MAX_MESSAGES <= 256)  ? 512                                          \
+     : (MESHCORE_MULTIPART_MAX_MESSAGES <= 2048) ? 4096                                         \
+     : (MESHCORE_MULTIPART_MAX_MESSAGES <= 8192) ? 16384                                        \
+                                                 : 65536)
+
+typedef struct {
+    uint16_t next;  // Next free slab
+    uint8_t  length;
+    uint8_t  data[MESHCORE_MULTIPART_FRAGMENT_SIZE];
+} meshcore_multipart_slab_t;
+
+typedef struct {
+    uint32_t key;  // Source hash and message id
+    uint32_t first_seen;
+    uint16_t received;  // Bitmask of received fragment indices
+    uint8_t  last_index;
+    uint8_t  payload_type;
+    uint16_t bucket_next;
+    uint16_t older;
+    uint16_t newer;
+    uint16_t slabs[MESHCORE_MULTIPART_MAX_FRAGMENTS];
+} meshcore_multipart_entry_t;
+
+typedef struct {
+    uint32_t fragments_received;
+    uint32_t fragments_duplicate;
+    uint32_t fragments_invalid;
+    uint32_t messages_completed;
+    uint32_t messages_expired;  // Not completed before the timeout
+    uint32_t messages_evicted;  // Dropped to make room for newer messages
+    uint32_t fragments_lost;    // Fragments missing from expired and evicted messages
+    uint64_t latency_total_ms;  // First fragment to completion
+    uint32_t latency_max_ms;
+} meshcore_multipart_stats_t;
+
+typedef struct {
+    uint32_t                   timeout_ms;
+    uint16_t                   free_entry;
+    uint16_t                   free_slab;
+    uint16_t                   oldest;
+    uint16_t                   newest;
+    uint32_t                   active;
+    meshcore_multipart_stats_t stats;
+    uint16_t                   buckets[MESHCORE_MULTIPART_BUCKETS];
+    meshcore_multipart_entry_t entries[MESHCORE_MULTIPART_MAX_MESSAGES];
+    meshcore_multipart_slab_t  slabs[MESHCORE_MULTIPART_MAX_SLABS];
+} meshcore_multipart_reassembly_t;
+
+typedef struct {
+    uint8_t  source_hash;
+    uint16_t message_id;
+    uint8_t  payload_type;
+    size_t   length;
+    uint32_t latency_ms;
+} meshcore_multipart_message_t;
+
+// Functions
+
+/// Reset a reassembly engine, partial messages are discarded after timeout_ms
+void meshcore_multipart_reassembly_init(meshcore_multipart_reassembly_t* reassembly, uint32_t timeout_ms);
+
+/// Add a received fragment. Returns 1 when it completed a message, which is then written to out_data,
+/// 0 when more fragments are needed and -1 when the fragment is invalid or out_data is too small.
+int meshcore_multipart_reassembly_push(meshcore_multipart_reassembly_t* reassembly, const meshcore_multipart_t* fragment, uint32_t now_ms,
+                                       uint8_t* out_data, size_t out_data_size, meshcore_multipart_message_t* out_message);
+
+/// Discard partial messages that have been waiting longer than the timeout, returns the number discarded
+uint32_t meshcore_multipart_reassembly_expire(meshcore_multipart_reassembly_t* reassembly, uint32_t now_ms);
@@ -5,6 +5,7 @@
 #include "packet.h"
 #include <stdint.h>
 #include <string.h>
+#include "latency.h"
 
 #define member_size(type, member) (sizeof(((type*)0)->member))
 
@@ -44,8 +45,8 @@ int meshcore_serialize(const meshcore_message_t* message, uint8_t* out_data, uin
     if (message->route == MESHCORE_ROUTE_TYPE_TRANSPORT_FLOOD ||
         message->route == MESHCORE_ROUTE_TYPE_TRANSPORT_DIRECT) {
         // The message has transport codes
-        memcpy(&out_data[position], message->transport_codes, member_size(meshcore_line_header_t, transport_codes));
-        position += sizeof(uint16_t);
+        memcpy(&out_data[position], message->transport_codes, member_size(meshcore_message_t, transport_codes));
+        position += member_size(meshcore_message_t, transport_codes);
     }
 
     out_data[position]  = message->path_length;
@@ -67,6 +68,8 @@ int meshcore_deserialize(uint8_t* data, uint8_t size, meshcore_message_t* out_me
         return -1;
     }
 
+    MESHCORE_LATENCY_START(decode_start);
+
     memset(out_message, 0, sizeof(meshcore_message_t));
 
     uint8_t position = 0;
@@ -84,11 +87,11 @@ int meshcore_deserialize(uint8_t* data, uint8_t size, meshcore_message_t* out_me
     if (out_message->route == MESHCORE_ROUTE_TYPE_TRANSPORT_FLOOD ||
         out_message->route == MESHCORE_ROUTE_TYPE_TRANSPORT_DIRECT) {
         // The message has transport codes
-        if (size - position < sizeof(uint16_t)) {
+        if (size - position < member_size(meshcore_message_t, transport_codes)) {
             return -1;
         }
-        memcpy(out_message->transport_codes, line_header->transport_codes, sizeof(uint16_t));
-        position += sizeof(uint16_t);
+        memcpy(out_message->transport_codes, line_header->transport_codes, member_size(meshcore_message_t, transport_codes));
+        position += member_size(meshcore_message_t, transport_codes);
     }
 
     if (size - position < sizeof(uint8_t)) {
@@ -98,13 +101,13 @@ int meshcore_deserialize(uint8_t* data, uint8_t size, meshcore_message_t* out_me
     out_message->path_length  = data[position];
     position                 += sizeof(uint8_t);
 
-    uint8_t* path  = &data[position];
-    position      += out_message->path_length;
-
-    if (out_message->path_length > MESHCORE_MAX_PATH_SIZE) {
+    if (out_message->path_length > MESHCORE_MAX_PATH_SIZE || out_message->path_length > size - position) {
         return -1;
     }
 
+    uint8_t* path  = &data[position];
+    position      += out_message->path_length;
+
     memcpy(out_message->path, path, out_message->path_length);
 
     out_message->payload_length = size - position;
@@ -116,5 +119,6 @@ int meshcore_deserialize(uint8_t* data, uint8_t size, meshcore_message_t* out_me
 
     memcpy(out_message->payload, payload, out_message->payload_length);
 
+    MESHCORE_LATENCY_END(MESHCORE_LATENCY_DECODE, decode_start);
     return 0;
 }
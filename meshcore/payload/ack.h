@@ -7,14 +7,14 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "layout.h"
 
 // Definitions
 
-typedef struct {
-    uint32_t crc;
-} meshcore_ack_t;
+#define MESHCORE_ACK_LAYOUT(FIELD, BYTES, TAIL) FIELD(uint32_t, crc)
+
+MESHCORE_LAYOUT_STRUCT(meshcore_ack_t, MESHCORE_ACK_LAYOUT);
 
 // Functions
 
-int meshcore_ack_serialize(const meshcore_ack_t* ack, uint8_t* out_payload, uint8_t* out_size);
-int meshcore_ack_deserialize(uint8_t* payload, uint8_t size, meshcore_ack_t* out_ack);
+MESHCORE_LAYOUT_PROTOTYPES(ack, meshcore_ack_t);
@@ -84,6 +84,10 @@ int meshcore_advert_deserialize(uint8_t* data, uint8_t size, meshcore_advert_t*
 
     memset(out_advert, 0, sizeof(meshcore_advert_t));
 
+    if (size < MESHCORE_PUB_KEY_SIZE + sizeof(uint32_t) + MESHCORE_SIGNATURE_SIZE) {
+        return -1;
+    }
+
     uint8_t position = 0;
 
     memcpy(out_advert->pub_key, &data[position], MESHCORE_PUB_KEY_SIZE);
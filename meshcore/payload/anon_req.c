@@ -0,0 +1,8 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "anon_req.h"
+#include <stdint.h>
+#include <string.h>
+
+MESHCORE_LAYOUT_CODEC(anon_req, meshcore_anon_req_t, MESHCORE_ANON_REQ_LAYOUT)
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "layout.h"
+#include "packet.h"
+
+// Definitions
+
+// Anonymous request, carries the ephemeral public key of the sender instead of a source hash
+#define MESHCORE_ANON_REQ_LAYOUT(FIELD, BYTES, TAIL)                                                                                    \
+    FIELD(uint8_t, destination_hash)                                                                                                    \
+    BYTES(pub_key, MESHCORE_PUB_KEY_SIZE)                                                                                               \
+    BYTES(cipher_mac, MESHCORE_CIPHER_MAC_SIZE)                                                                                         \
+    TAIL(ciphertext, ciphertext_length, MESHCORE_MAX_PAYLOAD_SIZE - MESHCORE_PUB_KEY_SIZE - MESHCORE_CIPHER_MAC_SIZE - sizeof(uint8_t))
+
+MESHCORE_LAYOUT_STRUCT(meshcore_anon_req_t, MESHCORE_ANON_REQ_LAYOUT);
+
+// Functions
+
+MESHCORE_LAYOUT_PROTOTYPES(anon_req, meshcore_anon_req_t);
@@ -0,0 +1,8 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "grp_data.h"
+#include <stdint.h>
+#include <string.h>
+
+MESHCORE_LAYOUT_CODEC(grp_data, meshcore_grp_data_t, MESHCORE_GRP_DATA_LAYOUT)
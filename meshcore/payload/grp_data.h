@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "layout.h"
+#include "packet.h"
+
+// Definitions
+
+// Unverified group datagram, encrypted data holds the timestamp and blob
+#define MESHCORE_GRP_DATA_LAYOUT(FIELD, BYTES, TAIL)                                                \
+    FIELD(uint8_t, channel_hash)                                                                    \
+    BYTES(mac, MESHCORE_CIPHER_MAC_SIZE)                                                            \
+    TAIL(data, data_length, MESHCORE_MAX_PAYLOAD_SIZE - sizeof(uint8_t) - MESHCORE_CIPHER_MAC_SIZE)
+
+MESHCORE_LAYOUT_STRUCT(meshcore_grp_data_t, MESHCORE_GRP_DATA_LAYOUT);
+
+// Functions
+
+MESHCORE_LAYOUT_PROTOTYPES(grp_data, meshcore_grp_data_t);
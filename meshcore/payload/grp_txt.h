@@ -7,10 +7,16 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "layout.h"
 #include "packet.h"
 
 // Definitions
 
+#define MESHCORE_GRP_TXT_LAYOUT(FIELD, BYTES, TAIL)                                                 \
+    FIELD(uint8_t, channel_hash)                                                                    \
+    BYTES(mac, MESHCORE_CIPHER_MAC_SIZE)                                                            \
+    TAIL(data, data_length, MESHCORE_MAX_PAYLOAD_SIZE - sizeof(uint8_t) - MESHCORE_CIPHER_MAC_SIZE)
+
 typedef struct {
     uint8_t  data_length;
     uint8_t  data[MESHCORE_MAX_PAYLOAD_SIZE - sizeof(uint8_t) - MESHCORE_CIPHER_MAC_SIZE];
@@ -29,5 +35,4 @@ typedef struct {
 
 // Functions
 
-int meshcore_grp_txt_serialize(const meshcore_grp_txt_t* grp_text, uint8_t* out_payload, uint8_t* out_size);
-int meshcore_grp_txt_deserialize(uint8_t* payload, uint8_t size, meshcore_grp_txt_t* out_grp_text);
+MESHCORE_LAYOUT_PROTOTYPES(grp_txt, meshcore_grp_txt_t);
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "packet.h"
+
+// Declarative payload layouts
+//
+// A payload type is described once as an X-macro table listing its wire fields in order:
+//
+//   #define MESHCORE_EXAMPLE_LAYOUT(FIELD, BYTES, TAIL)
+//       FIELD(uint8_t, destination_hash)
+//       BYTES(cipher_mac, MESHCORE_CIPHER_MAC_SIZE)
+//       TAIL(ciphertext, ciphertext_length, 100)
+//
+// FIELD(type, name)              a scalar, copied in host byte order like the rest of the codec
+// BYTES(name, size)              a fixed size byte array
+// TAIL(name, length, capacity)   the rest of the payload, at most capacity bytes, must be the last entry
+//
+// The fixed part of a layout is a compile-time constant, so the generated decoder does one bounds
+// check for all fixed fields and one for the tail, followed by straight-line copies.
+
+#define MESHCORE_LAYOUT_NONE(...)
+
+// Structure generation
+
+#define MESHCORE_LAYOUT_STRUCT_FIELD(type, name) type name;
+#define MESHCORE_LAYOUT_STRUCT_BYTES(name, size) uint8_t name[size];
+#define MESHCORE_LAYOUT_STRUCT_TAIL(name, length, capacity) \
+    uint8_t length;                                         \
+    uint8_t name[capacity];
+
+/// Declare a structure holding every field of a layout, tails are preceded by their length
+#define MESHCORE_LAYOUT_STRUCT(type, LAYOUT)                                                            \
+    typedef struct {                                                                                    \
+        LAYOUT(MESHCORE_LAYOUT_STRUCT_FIELD, MESHCORE_LAYOUT_STRUCT_BYTES, MESHCORE_LAYOUT_STRUCT_TAIL) \
+    } type
+
+// Size of the fixed part of a layout
+
+#define MESHCORE_LAYOUT_SIZE_FIELD(type, name) +sizeof(type)
+#define MESHCORE_LAYOUT_SIZE_BYTES(name, size) +(size)
+
+#define MESHCORE_LAYOUT_FIXED_SIZE(LAYOUT) (0 LAYOUT(MESHCORE_LAYOUT_SIZE_FIELD, MESHCORE_LAYOUT_SIZE_BYTES, MESHCORE_LAYOUT_NONE))
+
+// Largest encoded size of a layout
+
+#define MESHCORE_LAYOUT_CAPACITY_TAIL(name, length, capacity) +(capacity)
+
+#define MESHCORE_LAYOUT_MAX_SIZE(LAYOUT)                                                                                         \
+    (MESHCORE_LAYOUT_FIXED_SIZE(LAYOUT) + (0 LAYOUT(MESHCORE_LAYOUT_NONE, MESHCORE_LAYOUT_NONE, MESHCORE_LAYOUT_CAPACITY_TAIL)))
+
+// Encoder and decoder generation
+
+#define MESHCORE_LAYOUT_CHECK_TAIL(name, length, capacity) \
+    if (in->length > (capacity)) {                         \
+        return -1;                                         \
+    }
+
+#define MESHCORE_LAYOUT_ENCODE_FIELD(type, name)             \
+    memcpy(&out_payload[position], &in->name, sizeof(type)); \
+    position += sizeof(type);
+#define MESHCORE_LAYOUT_ENCODE_BYTES(name, size)      \
+    memcpy(&out_payload[position], in->name, (size)); \
+    position += (size);
+#define MESHCORE_LAYOUT_ENCODE_TAIL(name, length, capacity) \
+    memcpy(&out_payload[position], in->name, in->length);   \
+    position += in->length;
+
+#define MESHCORE_LAYOUT_DECODE_FIELD(type, name)          \
+    memcpy(&out->name, &payload[position], sizeof(type)); \
+    position += sizeof(type);
+#define MESHCORE_LAYOUT_DECODE_BYTES(name, size)   \
+    memcpy(out->name, &payload[position], (size)); \
+    position += (size);
+#define MESHCORE_LAYOUT_DECODE_TAIL(name, length, capacity) \
+    out->length = size - position;                          \
+    if (out->length > (capacity)) {                         \
+        return -1;                                          \
+    }                                                       \
+    memcpy(out->name, &payload[position], out->length);     \
+    position += out->length;
+
+/// Declare the serialize and deserialize functions of a payload type
+#define MESHCORE_LAYOUT_PROTOTYPES(prefix, type)                                                \
+    int meshcore_##prefix##_serialize(const type* in, uint8_t* out_payload, uint8_t* out_size); \
+    int meshcore_##prefix##_deserialize(uint8_t* payload, uint8_t size, type* out)
+
+/// Define the serialize and deserialize functions of a payload type, type has to contain the layout fields
+#define MESHCORE_LAYOUT_CODEC(prefix, type, LAYOUT)                                                                                    \
+    _Static_assert(MESHCORE_LAYOUT_MAX_SIZE(LAYOUT) <= MESHCORE_MAX_PAYLOAD_SIZE, #prefix " layout exceeds the maximum payload size"); \
+                                                                                                                                       \
+    int meshcore_##prefix##_serialize(const type* in, uint8_t* out_payload, uint8_t* out_size) {                                       \
+        if (in == NULL || out_payload == NULL || out_size == NULL) {                                                                   \
+            return -1;                                                                                                                 \
+        }                                                                                                                              \
+        LAYOUT(MESHCORE_LAYOUT_NONE, MESHCORE_LAYOUT_NONE, MESHCORE_LAYOUT_CHECK_TAIL)                                                 \
+        uint8_t position = 0;                                                                                                          \
+        LAYOUT(MESHCORE_LAYOUT_ENCODE_FIELD, MESHCORE_LAYOUT_ENCODE_BYTES, MESHCORE_LAYOUT_ENCODE_TAIL)                                \
+        *out_size = position;                                                                                                          \
+        return 0;                                                                                                                      \
+    }                                                                                                                                  \
+                                                                                                                                       \
+    int meshcore_##prefix##_deserialize(uint8_t* payload, uint8_t size, type* out) {                                                   \
+        if (out == NULL || payload == NULL) {                                                                                          \
+            return -1;                                                                                                                 \
+        }                                                                                                                              \
+        memset(out, 0, sizeof(type));                                                                                                  \
+        if (size < MESHCORE_LAYOUT_FIXED_SIZE(LAYOUT)) {                                                                               \
+            return -1;                                                                                                                 \
+        }                                                                                                                              \
+        uint8_t position = 0;                                                                                                          \
+        LAYOUT(MESHCORE_LAYOUT_DECODE_FIELD, MESHCORE_LAYOUT_DECODE_BYTES, MESHCORE_LAYOUT_DECODE_TAIL)                                \
+        (void)position;                                                                                                                \
+        return 0;                                                                                                                      \
+    }
@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "multipart.h"
+#include <stdint.h>
+#include <string.h>
+
+MESHCORE_LAYOUT_CODEC(multipart, meshcore_multipart_t, MESHCORE_MULTIPART_LAYOUT)
+
+int meshcore_multipart_fragment(uint8_t source_hash, uint16_t message_id, uint8_t payload_type, const uint8_t* data, size_t length, uint8_t index,
+                                meshcore_multipart_t* out_fragment) {
+    if (data == NULL || out_fragment == NULL || length == 0 || length > MESHCORE_MULTIPART_MAX_MESSAGE_SIZE) {
+        return -1;
+    }
+
+    size_t last_index = (length - 1) / MESHCORE_MULTIPART_FRAGMENT_SIZE;
+    if (index > last_index) {
+        return -1;
+    }
+
+    size_t offset       = (size_t)index * MESHCORE_MULTIPART_FRAGMENT_SIZE;
+    size_t chunk_length = length - offset;
+    if (chunk_length > MESHCORE_MULTIPART_FRAGMENT_SIZE) {
+        chunk_length = MESHCORE_MULTIPART_FRAGMENT_SIZE;
+    }
+
+    out_fragment->source_hash  = source_hash;
+    out_fragment->message_id   = message_id;
+    out_fragment->fragment     = (uint8_t)((index << 4) | last_index);
+    out_fragment->payload_type = payload_type;
+    out_fragment->data_length  = (uint8_t)chunk_length;
+    memcpy(out_fragment->data, &data[offset], chunk_length);
+
+    return 0;
+}
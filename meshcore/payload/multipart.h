@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "layout.h"
+#include "packet.h"
+
+// Definitions
+
+#define MESHCORE_MULTIPART_MAX_FRAGMENTS    16
+#define MESHCORE_MULTIPART_HEADER_SIZE      (sizeof(uint8_t) * 3 + sizeof(uint16_t))
+#define MESHCORE_MULTIPART_FRAGMENT_SIZE    (MESHCORE_MAX_PAYLOAD_SIZE - MESHCORE_MULTIPART_HEADER_SIZE)
+#define MESHCORE_MULTIPART_MAX_MESSAGE_SIZE (MESHCORE_MULTIPART_MAX_FRAGMENTS * MESHCORE_MULTIPART_FRAGMENT_SIZE)
+
+// One fragment of a message that does not fit in a single packet. Fragments are identified by the
+// hash of the sender and a message id chosen by the sender. The fragment byte holds the index of
+// this fragment in the high nibble and the index of the last fragment in the low nibble, so every
+// fragment tells how many there are. payload_type is the type of the reassembled payload.
+#define MESHCORE_MULTIPART_LAYOUT(FIELD, BYTES, TAIL)         \
+    FIELD(uint8_t, source_hash)                               \
+    FIELD(uint16_t, message_id)                               \
+    FIELD(uint8_t, fragment)                                  \
+    FIELD(uint8_t, payload_type)                              \
+    TAIL(data, data_length, MESHCORE_MULTIPART_FRAGMENT_SIZE)
+
+MESHCORE_LAYOUT_STRUCT(meshcore_multipart_t, MESHCORE_MULTIPART_LAYOUT);
+
+#define MESHCORE_MULTIPART_FRAGMENT_INDEX(fragment) (((fragment) >> 4) & 0x0F)
+#define MESHCORE_MULTIPART_FRAGMENT_LAST(fragment)  ((fragment) & 0x0F)
+
+// Functions
+
+MESHCORE_LAYOUT_PROTOTYPES(multipart, meshcore_multipart_t);
+
+/// Build fragment index of a message that is split into fragments of MESHCORE_MULTIPART_FRAGMENT_SIZE bytes
+int meshcore_multipart_fragment(uint8_t source_hash, uint16_t message_id, uint8_t payload_type, const uint8_t* data, size_t length, uint8_t index,
+                                meshcore_multipart_t* out_fragment);
@@ -0,0 +1,8 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "path.h"
+#include <stdint.h>
+#include <string.h>
+
+MESHCORE_LAYOUT_CODEC(path, meshcore_path_t, MESHCORE_PATH_LAYOUT)
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "layout.h"
+#include "packet.h"
+
+// Definitions
+
+// Returned path, encrypted data holds the path and an optional extra payload
+#define MESHCORE_PATH_LAYOUT(FIELD, BYTES, TAIL)                                                                    \
+    FIELD(uint8_t, destination_hash)                                                                                \
+    FIELD(uint8_t, source_hash)                                                                                     \
+    BYTES(cipher_mac, MESHCORE_CIPHER_MAC_SIZE)                                                                     \
+    TAIL(ciphertext, ciphertext_length, MESHCORE_MAX_PAYLOAD_SIZE - MESHCORE_CIPHER_MAC_SIZE - sizeof(uint8_t) * 2)
+
+MESHCORE_LAYOUT_STRUCT(meshcore_path_t, MESHCORE_PATH_LAYOUT);
+
+// Functions
+
+MESHCORE_LAYOUT_PROTOTYPES(path, meshcore_path_t);
@@ -0,0 +1,8 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "response.h"
+#include <stdint.h>
+#include <string.h>
+
+MESHCORE_LAYOUT_CODEC(response, meshcore_response_t, MESHCORE_RESPONSE_LAYOUT)
@@ -0,0 +1,8 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "trace.h"
+#include <stdint.h>
+#include <string.h>
+
+MESHCORE_LAYOUT_CODEC(trace, meshcore_trace_t, MESHCORE_TRACE_LAYOUT)
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "layout.h"
+#include "packet.h"
+
+// Definitions
+
+// Path trace, lists the hashes of the hops to visit. The SNR of every hop is collected in the packet path
+#define MESHCORE_TRACE_LAYOUT(FIELD, BYTES, TAIL)                                               \
+    FIELD(uint32_t, tag)                                                                        \
+    FIELD(uint32_t, auth_code)                                                                  \
+    FIELD(uint8_t, flags)                                                                       \
+    TAIL(path, path_length, MESHCORE_MAX_PAYLOAD_SIZE - sizeof(uint32_t) * 2 - sizeof(uint8_t))
+
+MESHCORE_LAYOUT_STRUCT(meshcore_trace_t, MESHCORE_TRACE_LAYOUT);
+
+// Functions
+
+MESHCORE_LAYOUT_PROTOTYPES(trace, meshcore_trace_t);
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "layout.h"
+#include "packet.h"
+
+// Definitions
+
+// Plain text message, encrypted data holds the timestamp, flags and text
+#define MESHCORE_TXT_MSG_LAYOUT(FIELD, BYTES, TAIL)                                                                 \
+    FIELD(uint8_t, destination_hash)                                                                                \
+    FIELD(uint8_t, source_hash)                                                                                     \
+    BYTES(cipher_mac, MESHCORE_CIPHER_MAC_SIZE)                                                                     \
+    TAIL(ciphertext, ciphertext_length, MESHCORE_MAX_PAYLOAD_SIZE - MESHCORE_CIPHER_MAC_SIZE - sizeof(uint8_t) * 2)
+
+MESHCORE_LAYOUT_STRUCT(meshcore_txt_msg_t, MESHCORE_TXT_MSG_LAYOUT);
+
+// Functions
+
+MESHCORE_LAYOUT_PROTOTYPES(txt_msg, meshcore_txt_msg_t);
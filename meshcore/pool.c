@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "pool.h"
+#include <stdint.h>
+#include <string.h>
+
+static meshcore_pool_slot_t* meshcore_pool_link(const meshcore_pool_t* pool, uint16_t slot) {
+    return (meshcore_pool_slot_t*)(pool->storage + (size_t)slot * pool->stride + pool->link_offset);
+}
+
+static uint16_t meshcore_pool_slot(const meshcore_pool_t* pool, const void* object) {
+    return (uint16_t)(((const uint8_t*)object - pool->storage) / pool->stride);
+}
+
+// Push a chain of slots, linked from first to last, onto the free stack
+static void meshcore_pool_push(meshcore_pool_t* pool, uint16_t first, uint16_t last) {
+    meshcore_pool_slot_t* link = meshcore_pool_link(pool, last);
+    uint32_t              head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    uint32_t              next;
+    do {
+        atomic_store_explicit(&link->next, (uint16_t)head, memory_order_relaxed);
+        next = (((head >> 16) + 1) << 16) | first;
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head, next, memory_order_release, memory_order_relaxed));
+}
+
+static uint16_t meshcore_pool_pop(meshcore_pool_t* pool) {
+    uint32_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    uint32_t next;
+    do {
+        uint16_t slot = (uint16_t)head;
+        if (slot == MESHCORE_POOL_NONE) {
+            return MESHCORE_POOL_NONE;
+        }
+        // The slot may be taken by another thread before the exchange, then the tag has changed and this
+        // stale link is never installed
+        uint16_t link = atomic_load_explicit(&meshcore_pool_link(pool, slot)->next, memory_order_relaxed);
+        next          = (((head >> 16) + 1) << 16) | link;
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head, next, memory_order_acquire, memory_order_acquire));
+    return (uint16_t)head;
+}
+
+int meshcore_pool_init(meshcore_pool_t* pool, void* storage, size_t storage_size, size_t object_size) {
+    if (pool == NULL || storage == NULL || object_size == 0 || ((uintptr_t)storage & (MESHCORE_POOL_ALIGN - 1)) != 0) {
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(meshcore_pool_t));
+    pool->storage     = (uint8_t*)storage;
+    pool->object_size = (uint32_t)object_size;
+    pool->link_offset = (uint32_t)((object_size + 3) / 4 * 4);
+    pool->stride      = (uint32_t)MESHCORE_POOL_STRIDE(object_size);
+
+    size_t capacity = storage_size / pool->stride;
+    if (capacity == 0) {
+        return -1;
+    }
+    pool->capacity = (uint16_t)((capacity > MESHCORE_POOL_MAX_CAPACITY) ? MESHCORE_POOL_MAX_CAPACITY : capacity);
+
+    for (uint16_t slot = 0; slot < pool->capacity; slot++) {
+        meshcore_pool_slot_t* link = meshcore_pool_link(pool, slot);
+        atomic_init(&link->references, 0);
+        atomic_init(&link->next, (slot + 1 < pool->capacity) ? (uint16_t)(slot + 1) : MESHCORE_POOL_NONE);
+    }
+    atomic_init(&pool->exhausted, 0);
+    atomic_init(&pool->head, 0);
+    return 0;
+}
+
+void meshcore_pool_cache_init(meshcore_pool_cache_t* cache, meshcore_pool_t* pool) {
+    cache->pool  = pool;
+    cache->count = 0;
+}
+
+void meshcore_pool_cache_flush(meshcore_pool_cache_t* cache) {
+    if (cache->count == 0) {
+        return;
+    }
+    for (uint8_t index = 0; index + 1 < cache->count; index++) {
+        atomic_store_explicit(&meshcore_pool_link(cache->pool, cache->slots[index])->next, cache->slots[index + 1], memory_order_relaxed);
+    }
+    meshcore_pool_push(cache->pool, cache->slots[0], cache->slots[cache->count - 1]);
+    cache->count = 0;
+}
+
+void* meshcore_pool_alloc(meshcore_pool_t* pool, meshcore_pool_cache_t* cache) {
+    uint16_t slot = MESHCORE_POOL_NONE;
+    if (cache != NULL) {
+        if (cache->count == 0) {
+            // Refill half the cache, the other half is room for releases
+            while (cache->count < MESHCORE_POOL_CACHE_SIZE / 2) {
+                uint16_t refill = meshcore_pool_pop(pool);
+                if (refill == MESHCORE_POOL_NONE) {
+                    break;
+                }
+                cache->slots[cache->count++] = refill;
+            }
+        }
+        if (cache->count > 0) {
+            slot = cache->slots[--cache->count];
+        }
+    } else {
+        slot = meshcore_pool_pop(pool);
+    }
+
+    if (slot == MESHCORE_POOL_NONE) {
+        atomic_fetch_add_explicit(&pool->exhausted, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    uint8_t* object = pool->storage + (size_t)slot * pool->stride;
+    memset(object, 0, pool->object_size);
+    atomic_store_explicit(&meshcore_pool_link(pool, slot)->references, 1, memory_order_relaxed);
+    return object;
+}
+
+void meshcore_pool_retain(meshcore_pool_t* pool, void* object) {
+    atomic_fetch_add_explicit(&meshcore_pool_link(pool, meshcore_pool_slot(pool, object))->references, 1, memory_order_relaxed);
+}
+
+bool meshcore_pool_release(meshcore_pool_t* pool, meshcore_pool_cache_t* cache, void* object) {
+    uint16_t slot = meshcore_pool_slot(pool, object);
+    // Release orders this thread's use of the object before the free, acquire orders the free after the
+    // use by the threads that released their references earlier
+    if (atomic_fetch_sub_explicit(&meshcore_pool_link(pool, slot)->references, 1, memory_order_acq_rel) != 1) {
+        return false;
+    }
+
+    if (cache == NULL) {
+        meshcore_pool_push(pool, slot, slot);
+        return true;
+    }
+
+    if (cache->count == MESHCORE_POOL_CACHE_SIZE) {
+        // Spill the older half of the cache in one push
+        uint8_t spill = MESHCORE_POOL_CACHE_SIZE / 2;
+        for (uint8_t index = 0; index + 1 < spill; index++) {
+            atomic_store_explicit(&meshcore_pool_link(pool, cache->slots[index])->next, cache->slots[index + 1], memory_order_relaxed);
+        }
+        meshcore_pool_push(pool, cache->slots[0], cache->slots[spill - 1]);
+        memmove(&cache->slots[0], &cache->slots[spill], (cache->count - spill) * sizeof(uint16_t));
+        cache->count -= spill;
+    }
+    cache->slots[cache->count++] = slot;
+    return true;
+}
+
+uint32_t meshcore_pool_references(const meshcore_pool_t* pool, const void* object) {
+    return atomic_load_explicit(&meshcore_pool_link(pool, meshcore_pool_slot(pool, object))->references, memory_order_relaxed);
+}
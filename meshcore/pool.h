@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packet.h"
+
+// Definitions
+
+// Fixed-size object pools. A pool hands out objects of one size from storage supplied by the caller, every
+// object starts on its own cache line so objects used by different threads never share one. Free objects
+// are kept on a lock-free stack, shared by all threads. The head of the stack carries a tag that changes
+// on every update, so a thread that was preempted halfway through a pop can not be fooled by an object
+// that was popped and pushed back in the meantime.
+//
+// To keep threads off the shared stack, each thread can use a cache of its own: objects are allocated from
+// and released to the cache, which is refilled from and spilled to the shared stack half a cache at a time.
+// A cache belongs to one thread (declare it _Thread_local or keep it in a task), objects can be released
+// to a different cache than the one they were allocated from.
+//
+// Objects are reference counted: allocation returns an object with one reference, meshcore_pool_retain adds
+// one and the object returns to the pool when the last reference is released. One received frame can thus
+// be passed to the forwarder, a logger and the application, each releasing it when done.
+
+#ifndef MESHCORE_POOL_ALIGN
+#define MESHCORE_POOL_ALIGN 64
+#endif
+
+#ifndef MESHCORE_POOL_CACHE_SIZE
+#define MESHCORE_POOL_CACHE_SIZE 16
+#endif
+
+_Static_assert((MESHCORE_POOL_ALIGN & (MESHCORE_POOL_ALIGN - 1)) == 0, "MESHCORE_POOL_ALIGN must be a power of two");
+_Static_assert(MESHCORE_POOL_CACHE_SIZE >= 2 && MESHCORE_POOL_CACHE_SIZE < 0xFF, "MESHCORE_POOL_CACHE_SIZE out of range");
+
+#define MESHCORE_POOL_NONE         0xFFFF
+#define MESHCORE_POOL_MAX_CAPACITY 0xFFFE
+
+// Every object is followed by its reference count and free stack link, the slot is padded to the alignment
+#define MESHCORE_POOL_STRIDE(object_size) \
+    ((((object_size) + 3) / 4 * 4 + sizeof(meshcore_pool_slot_t) + MESHCORE_POOL_ALIGN - 1) / MESHCORE_POOL_ALIGN * MESHCORE_POOL_ALIGN)
+
+/// Declare storage for capacity objects of a type, pass it to meshcore_pool_init with its size
+#define MESHCORE_POOL_STORAGE(name, type, capacity) _Alignas(MESHCORE_POOL_ALIGN) uint8_t name[(capacity) * MESHCORE_POOL_STRIDE(sizeof(type))]
+
+typedef struct {
+    atomic_uint_least32_t references;
+    atomic_uint_least16_t next;  // Next free slot while the slot is on the free stack
+} meshcore_pool_slot_t;
+
+typedef struct {
+    uint8_t*              storage;
+    uint32_t              object_size;
+    uint32_t              link_offset;  // Offset of the meshcore_pool_slot_t in a slot
+    uint32_t              stride;
+    uint16_t              capacity;
+    atomic_uint_least32_t exhausted;  // Allocations that failed because the pool was empty
+    // The free stack head, tag << 16 | slot, on a cache line of its own
+    _Alignas(MESHCORE_POOL_ALIGN) atomic_uint_least32_t head;
+    uint8_t padding[MESHCORE_POOL_ALIGN - sizeof(atomic_uint_least32_t)];
+} meshcore_pool_t;
+
+typedef struct {
+    meshcore_pool_t* pool;
+    uint8_t          count;
+    uint16_t         slots[MESHCORE_POOL_CACHE_SIZE];
+} meshcore_pool_cache_t;
+
+// Functions
+
+/// Set up a pool in storage declared with MESHCORE_POOL_STORAGE, returns -1 when storage is misaligned or
+/// holds no object
+int meshcore_pool_init(meshcore_pool_t* pool, void* storage, size_t storage_size, size_t object_size);
+
+/// Prepare a cache for the calling thread
+void meshcore_pool_cache_init(meshcore_pool_cache_t* cache, meshcore_pool_t* pool);
+
+/// Return the objects held by a cache to the pool, call before the owning thread exits
+void meshcore_pool_cache_flush(meshcore_pool_cache_t* cache);
+
+/// Allocate a zeroed object with one reference, cache may be NULL. Returns NULL when the pool is empty.
+void* meshcore_pool_alloc(meshcore_pool_t* pool, meshcore_pool_cache_t* cache);
+
+/// Add a reference to an object
+void meshcore_pool_retain(meshcore_pool_t* pool, void* object);
+
+/// Drop a reference, the object returns to the pool (through cache when not NULL) once none are left.
+/// Returns true when the object was freed.
+bool meshcore_pool_release(meshcore_pool_t* pool, meshcore_pool_cache_t* cache, void* object);
+
+/// Number of references to an object
+uint32_t meshcore_pool_references(const meshcore_pool_t* pool, const void* object);
+
+/// Typed wrappers around a pool of one type: meshcore_<name>_pool_t with _init, _alloc, _retain and _release
+#define MESHCORE_POOL_TYPE(name, type)                                                                                       \
+    typedef struct {                                                                                                         \
+        meshcore_pool_t base;                                                                                                \
+    } meshcore_##name##_pool_t;                                                                                              \
+    static inline int meshcore_##name##_pool_init(meshcore_##name##_pool_t* pool, void* storage, size_t storage_size) {      \
+        return meshcore_pool_init(&pool->base, storage, storage_size, sizeof(type));                                         \
+    }                                                                                                                        \
+    static inline type* meshcore_##name##_pool_alloc(meshcore_##name##_pool_t* pool, meshcore_pool_cache_t* cache) {         \
+        return (type*)meshcore_pool_alloc(&pool->base, cache);                                                               \
+    }                                                                                                                        \
+    static inline void meshcore_##name##_pool_retain(meshcore_##name##_pool_t* pool, type* object) {                         \
+        meshcore_pool_retain(&pool->base, object);                                                                           \
+    }                                                                                                                        \
+    static inline bool meshcore_##name##_pool_release(meshcore_##name##_pool_t* pool, meshcore_pool_cache_t* cache, type* object) { \
+        return meshcore_pool_release(&pool->base, cache, object);                                                            \
+    }
+
+MESHCORE_POOL_TYPE(message, meshcore_message_t)
@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "session.h"
+#include <stdint.h>
+#include <string.h>
+
+static uint32_t meshcore_session_bucket(const uint8_t* public_key) {
+    // Public keys are uniformly distributed, their first bytes are hash enough
+    uint32_t key = (uint32_t)public_key[0] | ((uint32_t)public_key[1] << 8) | ((uint32_t)public_key[2] << 16) | ((uint32_t)public_key[3] << 24);
+    return (key ^ (key >> 16)) & (MESHCORE_SESSION_BUCKETS - 1);
+}
+
+static uint16_t meshcore_session_index(const meshcore_session_table_t* table, const meshcore_session_t* session) {
+    return (uint16_t)(session - table->sessions);
+}
+
+static void meshcore_session_lru_unlink(meshcore_session_table_t* table, uint16_t index) {
+    meshcore_session_t* session = &table->sessions[index];
+    if (session->lru_prev != MESHCORE_SESSION_NONE) {
+        table->sessions[session->lru_prev].lru_next = session->lru_next;
+    } else {
+        table->lru_head = session->lru_next;
+    }
+    if (session->lru_next != MESHCORE_SESSION_NONE) {
+        table->sessions[session->lru_next].lru_prev = session->lru_prev;
+    } else {
+        table->lru_tail = session->lru_prev;
+    }
+}
+
+static void meshcore_session_lru_push(meshcore_session_table_t* table, uint16_t index) {
+    meshcore_session_t* session = &table->sessions[index];
+    session->lru_prev           = MESHCORE_SESSION_NONE;
+    session->lru_next           = table->lru_head;
+    if (table->lru_head != MESHCORE_SESSION_NONE) {
+        table->sessions[table->lru_head].lru_prev = index;
+    } else {
+        table->lru_tail = index;
+    }
+    table->lru_head = index;
+}
+
+static void meshcore_session_release(meshcore_session_table_t* table, uint16_t index) {
+    meshcore_session_t* session = &table->sessions[index];
+
+    uint16_t* link = &table->buckets[meshcore_session_bucket(session->public_key)];
+    while (*link != index) {
+        link = &table->sessions[*link].bucket_next;
+    }
+    *link = session->bucket_next;
+
+    if (session->hash_prev != MESHCORE_SESSION_NONE) {
+        table->sessions[session->hash_prev].hash_next = session->hash_next;
+    } else {
+        table->hashes[session->public_key[0]] = session->hash_next;
+    }
+    if (session->hash_next != MESHCORE_SESSION_NONE) {
+        table->sessions[session->hash_next].hash_prev = session->hash_prev;
+    }
+
+    meshcore_session_lru_unlink(table, index);
+
+    // The timer is left running, it finds the next session to expire when it fires
+    memset(session->secret, 0, sizeof(session->secret));
+    session->used        = false;
+    session->bucket_next = table->free;
+    table->free          = index;
+    table->active--;
+}
+
+static void meshcore_session_expired(meshcore_timer_t* timer, void* context) {
+    // Sessions are judged by the time of the tick being processed, the timer may have been rounded up to it
+    meshcore_session_table_t* table  = (meshcore_session_table_t*)context;
+    uint32_t                  now_ms = table->wheel->time_ms;
+
+    while (table->lru_tail != MESHCORE_SESSION_NONE) {
+        uint16_t            index   = table->lru_tail;
+        meshcore_session_t* session = &table->sessions[index];
+        if ((int32_t)(now_ms - session->last_activity_ms - table->timeout_ms) < 0) {
+            meshcore_timer_start(table->wheel, &table->timer, session->last_activity_ms + table->timeout_ms);
+            return;
+        }
+        table->stats.expired++;
+        if (table->callback != NULL) {
+            table->callback(table, session, MESHCORE_SESSION_EVENT_EXPIRED, table->context);
+        }
+        meshcore_session_release(table, index);
+    }
+}
+
+void meshcore_session_table_init(meshcore_session_table_t* table, meshcore_timer_wheel_t* wheel, uint32_t timeout_ms, meshcore_session_callback_t callback,
+                                 void* context) {
+    memset(table, 0, sizeof(meshcore_session_table_t));
+    table->wheel      = wheel;
+    table->timeout_ms = timeout_ms;
+    table->callback   = callback;
+    table->context    = context;
+    table->lru_head   = MESHCORE_SESSION_NONE;
+    table->lru_tail   = MESHCORE_SESSION_NONE;
+    meshcore_timer_init(&table->timer, meshcore_session_expired, table);
+
+    for (uint32_t bucket = 0; bucket < MESHCORE_SESSION_BUCKETS; bucket++) {
+        table->buckets[bucket] = MESHCORE_SESSION_NONE;
+    }
+    for (uint32_t hash = 0; hash < 256; hash++) {
+        table->hashes[hash] = MESHCORE_SESSION_NONE;
+    }
+    for (uint16_t index = 0; index < MESHCORE_SESSION_MAX_SESSIONS; index++) {
+        table->sessions[index].bucket_next = (index + 1 < MESHCORE_SESSION_MAX_SESSIONS) ? index + 1 : MESHCORE_SESSION_NONE;
+    }
+    table->free = 0;
+}
+
+static uint16_t meshcore_session_lookup(const meshcore_session_table_t* table, const uint8_t* prefix, size_t prefix_length) {
+    uint16_t index = table->buckets[meshcore_session_bucket(prefix)];
+    while (index != MESHCORE_SESSION_NONE && memcmp(table->sessions[index].public_key, prefix, prefix_length) != 0) {
+        index = table->sessions[index].bucket_next;
+    }
+    return index;
+}
+
+meshcore_session_t* meshcore_session_find(meshcore_session_table_t* table, const uint8_t* prefix, size_t prefix_length) {
+    if (prefix_length < MESHCORE_SESSION_MIN_PREFIX || prefix_length > MESHCORE_PUB_KEY_SIZE) {
+        return NULL;
+    }
+
+    uint16_t index = meshcore_session_lookup(table, prefix, prefix_length);
+    if (index == MESHCORE_SESSION_NONE) {
+        table->stats.misses++;
+        return NULL;
+    }
+    table->stats.hits++;
+    return &table->sessions[index];
+}
+
+meshcore_session_t* meshcore_session_login(meshcore_session_table_t* table, const uint8_t* public_key, const uint8_t* secret, uint8_t permissions,
+                                           uint32_t now_ms) {
+    if (table == NULL || public_key == NULL || secret == NULL) {
+        return NULL;
+    }
+
+    meshcore_session_t* session  = NULL;
+    uint16_t            existing = meshcore_session_lookup(table, public_key, MESHCORE_PUB_KEY_SIZE);
+    if (existing != MESHCORE_SESSION_NONE) {
+        session = &table->sessions[existing];
+        table->stats.refreshed++;
+    } else {
+        if (table->free == MESHCORE_SESSION_NONE) {
+            uint16_t evicted = table->lru_tail;
+            table->stats.evicted++;
+            if (table->callback != NULL) {
+                table->callback(table, &table->sessions[evicted], MESHCORE_SESSION_EVENT_EVICTED, table->context);
+            }
+            meshcore_session_release(table, evicted);
+        }
+
+        uint16_t index = table->free;
+        session        = &table->sessions[index];
+        table->free    = session->bucket_next;
+
+        uint32_t bucket        = meshcore_session_bucket(public_key);
+        session->bucket_next   = table->buckets[bucket];
+        table->buckets[bucket] = index;
+
+        session->hash_prev = MESHCORE_SESSION_NONE;
+        session->hash_next = table->hashes[public_key[0]];
+        if (session->hash_next != MESHCORE_SESSION_NONE) {
+            table->sessions[session->hash_next].hash_prev = index;
+        }
+        table->hashes[public_key[0]] = index;
+        meshcore_session_lru_push(table, index);
+
+        memcpy(session->public_key, public_key, MESHCORE_PUB_KEY_SIZE);
+        session->used     = true;
+        session->login_ms = now_ms;
+        session->user     = NULL;
+        table->active++;
+        table->stats.logins++;
+    }
+
+    memcpy(session->secret, secret, MESHCORE_SESSION_SECRET_SIZE);
+    session->permissions = permissions;
+    meshcore_session_touch(table, session, now_ms);
+    return session;
+}
+
+meshcore_session_t* meshcore_session_first(meshcore_session_table_t* table, uint8_t hash) {
+    uint16_t index = table->hashes[hash];
+    return (index != MESHCORE_SESSION_NONE) ? &table->sessions[index] : NULL;
+}
+
+meshcore_session_t* meshcore_session_next(meshcore_session_table_t* table, const meshcore_session_t* session) {
+    uint16_t index = session->hash_next;
+    return (index != MESHCORE_SESSION_NONE) ? &table->sessions[index] : NULL;
+}
+
+void meshcore_session_touch(meshcore_session_table_t* table, meshcore_session_t* session, uint32_t now_ms) {
+    uint16_t index            = meshcore_session_index(table, session);
+    session->last_activity_ms = now_ms;
+    if (table->lru_head != index) {
+        meshcore_session_lru_unlink(table, index);
+        meshcore_session_lru_push(table, index);
+    }
+
+    // A session that moved away from the tail keeps the timer, it fires for it and moves on to the new tail
+    if (!meshcore_timer_active(&table->timer)) {
+        uint32_t expires_ms = table->sessions[table->lru_tail].last_activity_ms + table->timeout_ms;
+        meshcore_timer_start(table->wheel, &table->timer, expires_ms);
+    }
+}
+
+void meshcore_session_logout(meshcore_session_table_t* table, meshcore_session_t* session) {
+    if (session == NULL || !session->used) {
+        return;
+    }
+    table->stats.logouts++;
+    meshcore_session_release(table, meshcore_session_index(table, session));
+}
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packet.h"
+#include "timer_wheel.h"
+
+// Definitions
+
+// Logged in clients of a repeater or room server. A session holds the public key of the client, the shared
+// secret agreed with it at login and its permissions, so every later request is decrypted with the cached
+// secret instead of an ECDH exchange per message. The caller derives the secret, this table only keeps it.
+//
+// Sessions are found by public key prefix through a hash index, and by the one byte source hash that
+// requests carry through a chain per hash value, to try the secrets of the clients that share it. Sessions
+// are kept in order of last activity: a session idle for timeout_ms expires, and when the table is full the
+// least recently active one makes room for a new login. All sessions share the same idle timeout, so the
+// least recently active session is always the next to expire and a single timer on the shared wheel tracks
+// it, touching a session on every request is O(1) and starts no timer.
+
+#ifndef MESHCORE_SESSION_MAX_SESSIONS
+#define MESHCORE_SESSION_MAX_SESSIONS 256
+#endif
+
+_Static_assert((MESHCORE_SESSION_MAX_SESSIONS & (MESHCORE_SESSION_MAX_SESSIONS - 1)) == 0, "MESHCORE_SESSION_MAX_SESSIONS must be a power of two");
+_Static_assert(MESHCORE_SESSION_MAX_SESSIONS < 0xFFFF, "MESHCORE_SESSION_MAX_SESSIONS too large");
+
+#define MESHCORE_SESSION_BUCKETS     (MESHCORE_SESSION_MAX_SESSIONS * 2)
+#define MESHCORE_SESSION_NONE        0xFFFF
+#define MESHCORE_SESSION_SECRET_SIZE 32
+#define MESHCORE_SESSION_MIN_PREFIX  4  // Shortest public key prefix a session can be found by
+
+#define MESHCORE_SESSION_DEFAULT_TIMEOUT_MS (60 * 60 * 1000)
+
+// Permissions granted at login, as room servers and repeaters assign them
+typedef enum {
+    MESHCORE_SESSION_GUEST      = 0,
+    MESHCORE_SESSION_READ_ONLY  = 1,
+    MESHCORE_SESSION_READ_WRITE = 2,
+    MESHCORE_SESSION_ADMIN      = 3,
+} meshcore_session_permissions_t;
+
+typedef enum {
+    MESHCORE_SESSION_EVENT_EXPIRED = 0,  // Idle for the timeout
+    MESHCORE_SESSION_EVENT_EVICTED = 1,  // Least recently active when the table was full
+} meshcore_session_event_t;
+
+typedef struct {
+    uint8_t  public_key[MESHCORE_PUB_KEY_SIZE];
+    uint8_t  secret[MESHCORE_SESSION_SECRET_SIZE];
+    uint8_t  permissions;
+    bool     used;
+    uint16_t bucket_next;
+    uint16_t hash_prev;  // Previous session whose public key starts with the same byte
+    uint16_t hash_next;  // Next session whose public key starts with the same byte
+    uint16_t lru_prev;   // More recently active session
+    uint16_t lru_next;   // Less recently active session
+    uint32_t login_ms;
+    uint32_t last_activity_ms;
+    void*    user;
+} meshcore_session_t;
+
+typedef struct {
+    uint32_t logins;
+    uint32_t refreshed;  // Logins of clients that already had a session
+    uint32_t logouts;
+    uint32_t expired;
+    uint32_t evicted;
+    uint32_t hits;
+    uint32_t misses;
+} meshcore_session_stats_t;
+
+typedef struct meshcore_session_table meshcore_session_table_t;
+
+typedef void (*meshcore_session_callback_t)(meshcore_session_table_t* table, meshcore_session_t* session, meshcore_session_event_t event,
+                                            void* context);
+
+struct meshcore_session_table {
+    meshcore_session_callback_t callback;
+    void*                       context;
+    meshcore_timer_wheel_t*     wheel;
+    meshcore_timer_t            timer;  // Expiry of the least recently active session
+    uint32_t                    timeout_ms;
+    uint16_t                    free;
+    uint16_t                    lru_head;  // Most recently active
+    uint16_t                    lru_tail;  // Least recently active
+    uint32_t                    active;
+    meshcore_session_stats_t    stats;
+    uint16_t                    hashes[256];
+    uint16_t                    buckets[MESHCORE_SESSION_BUCKETS];
+    meshcore_session_t          sessions[MESHCORE_SESSION_MAX_SESSIONS];
+};
+
+// Functions
+
+/// Reset a table, sessions expire after timeout_ms without activity. The callback, which may be NULL, is
+/// told about sessions that expire or are evicted before they are released.
+void meshcore_session_table_init(meshcore_session_table_t* table, meshcore_timer_wheel_t* wheel, uint32_t timeout_ms, meshcore_session_callback_t callback,
+                                 void* context);
+
+/// Start a session, or refresh the secret and permissions of the existing session of the same client.
+/// Evicts the least recently active session when the table is full.
+meshcore_session_t* meshcore_session_login(meshcore_session_table_t* table, const uint8_t* public_key, const uint8_t* secret, uint8_t permissions,
+                                           uint32_t now_ms);
+
+/// Find the session of a client by a public key prefix of at least MESHCORE_SESSION_MIN_PREFIX bytes,
+/// returns NULL when there is none
+meshcore_session_t* meshcore_session_find(meshcore_session_table_t* table, const uint8_t* prefix, size_t prefix_length);
+
+/// First session whose public key starts with a source hash, returns NULL when there is none
+meshcore_session_t* meshcore_session_first(meshcore_session_table_t* table, uint8_t hash);
+
+/// Next session with the same source hash as session, returns NULL after the last one
+meshcore_session_t* meshcore_session_next(meshcore_session_table_t* table, const meshcore_session_t* session);
+
+/// Record activity of a client, which restarts its idle timeout
+void meshcore_session_touch(meshcore_session_table_t* table, meshcore_session_t* session, uint32_t now_ms);
+
+/// End a session without reporting an event
+void meshcore_session_logout(meshcore_session_table_t* table, meshcore_session_t* session);
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "stats.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "packet.h"
+
+#define MESHCORE_STATS_NAME(id, name, help) #name,
+#define MESHCORE_STATS_HELP(id, name, help) help,
+
+static const char* const meshcore_stats_names[MESHCORE_STATS_COUNT] = {MESHCORE_STATS_COUNTERS(MESHCORE_STATS_NAME)};
+static const char* const meshcore_stats_help[MESHCORE_STATS_COUNT]  = {MESHCORE_STATS_COUNTERS(MESHCORE_STATS_HELP)};
+
+void meshcore_stats_init(meshcore_stats_t* stats) {
+    atomic_init(&stats->shard_count, 0);
+    for (uint32_t shard = 0; shard < MESHCORE_STATS_MAX_SHARDS; shard++) {
+        for (uint32_t counter = 0; counter < MESHCORE_STATS_COUNT; counter++) {
+            atomic_init(&stats->shards[shard].counters[counter], 0);
+        }
+    }
+}
+
+meshcore_stats_shard_t* meshcore_stats_attach(meshcore_stats_t* stats) {
+    uint32_t shard = atomic_fetch_add_explicit(&stats->shard_count, 1, memory_order_relaxed);
+    return (shard < MESHCORE_STATS_MAX_SHARDS) ? &stats->shards[shard] : NULL;
+}
+
+void meshcore_stats_frame(meshcore_stats_shard_t* shard, bool tx, const uint8_t* data, uint8_t size) {
+    if (shard == NULL || size == 0) {
+        return;
+    }
+    // The route is in the low bits of the header byte, see packet.c
+    uint8_t route  = data[0] & 0x03;
+    bool    direct = route == MESHCORE_ROUTE_TYPE_DIRECT || route == MESHCORE_ROUTE_TYPE_TRANSPORT_DIRECT;
+    if (tx) {
+        meshcore_stats_add(shard, MESHCORE_STATS_TX_PACKETS, 1);
+        meshcore_stats_add(shard, direct ? MESHCORE_STATS_TX_DIRECT : MESHCORE_STATS_TX_FLOOD, 1);
+        meshcore_stats_add(shard, MESHCORE_STATS_TX_BYTES, size);
+    } else {
+        meshcore_stats_add(shard, MESHCORE_STATS_RX_PACKETS, 1);
+        meshcore_stats_add(shard, direct ? MESHCORE_STATS_RX_DIRECT : MESHCORE_STATS_RX_FLOOD, 1);
+        meshcore_stats_add(shard, MESHCORE_STATS_RX_BYTES, size);
+    }
+}
+
+void meshcore_stats_snapshot(meshcore_stats_t* stats, meshcore_stats_totals_t* out_totals) {
+    uint32_t shards = atomic_load_explicit(&stats->shard_count, memory_order_relaxed);
+    if (shards > MESHCORE_STATS_MAX_SHARDS) {
+        shards = MESHCORE_STATS_MAX_SHARDS;
+    }
+
+    memset(out_totals, 0, sizeof(meshcore_stats_totals_t));
+    for (uint32_t shard = 0; shard < shards; shard++) {
+        for (uint32_t counter = 0; counter < MESHCORE_STATS_COUNT; counter++) {
+            out_totals->counters[counter] += atomic_load_explicit(&stats->shards[shard].counters[counter], memory_order_relaxed);
+        }
+    }
+}
+
+const char* meshcore_stats_name(meshcore_stats_counter_t counter) {
+    return (counter < MESHCORE_STATS_COUNT) ? meshcore_stats_names[counter] : "unknown";
+}
+
+int meshcore_stats_format_prometheus(const meshcore_stats_totals_t* totals, char* out, size_t size) {
+    size_t position = 0;
+    for (uint32_t counter = 0; counter < MESHCORE_STATS_COUNT; counter++) {
+        const char* name   = meshcore_stats_names[counter];
+        int         length = snprintf(&out[position], size - position,
+                                      "# HELP meshcore_%s_total %s\n# TYPE meshcore_%s_total counter\nmeshcore_%s_total %" PRIu32 "\n", name,
+                                      meshcore_stats_help[counter], name, name, totals->counters[counter]);
+        if (length < 0 || (size_t)length >= size - position) {
+            return -1;
+        }
+        position += (size_t)length;
+    }
+    return (int)position;
+}
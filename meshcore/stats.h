@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Definitions
+
+// Node statistics. Every thread that counts events attaches a shard of its own: a set of counters on
+// separate cache lines that only that thread writes, with a plain load and store instead of an atomic
+// read-modify-write, so counting costs about as much as incrementing a local variable. Readers sum the
+// shards when statistics are requested, which is rare compared with the events being counted.
+//
+// The link, TX scheduler and the tools count into a shard when one is set, NULL turns counting off.
+
+#define MESHCORE_STATS_COUNTERS(COUNTER)                                                  \
+    COUNTER(RX_PACKETS, rx_packets, "Frames received")                                    \
+    COUNTER(RX_FLOOD, rx_flood, "Flooded frames received")                                \
+    COUNTER(RX_DIRECT, rx_direct, "Directly routed frames received")                      \
+    COUNTER(RX_BYTES, rx_bytes, "Bytes received")                                         \
+    COUNTER(RX_ERRORS, rx_errors, "Received frames that failed to decode")                \
+    COUNTER(TX_PACKETS, tx_packets, "Frames transmitted")                                 \
+    COUNTER(TX_FLOOD, tx_flood, "Flooded frames transmitted")                             \
+    COUNTER(TX_DIRECT, tx_direct, "Directly routed frames transmitted")                   \
+    COUNTER(TX_BYTES, tx_bytes, "Bytes transmitted")                                      \
+    COUNTER(TX_ERRORS, tx_errors, "Frames the radio failed to transmit")                  \
+    COUNTER(TX_DROPPED, tx_dropped, "Frames dropped from a full transmit queue")          \
+    COUNTER(TX_AIRTIME_MS, tx_airtime_ms, "Time spent transmitting in milliseconds")      \
+    COUNTER(FORWARDED, forwarded, "Frames repeated for other nodes")                      \
+    COUNTER(DUPLICATES, duplicates, "Received frames dropped because they were seen before")
+
+#define MESHCORE_STATS_ENUM(id, name, help) MESHCORE_STATS_##id,
+
+typedef enum {
+    MESHCORE_STATS_COUNTERS(MESHCORE_STATS_ENUM) MESHCORE_STATS_COUNT,
+} meshcore_stats_counter_t;
+
+#ifndef MESHCORE_STATS_MAX_SHARDS
+#define MESHCORE_STATS_MAX_SHARDS 8
+#endif
+
+#ifndef MESHCORE_STATS_ALIGN
+#define MESHCORE_STATS_ALIGN 64
+#endif
+
+_Static_assert(MESHCORE_STATS_MAX_SHARDS > 0, "MESHCORE_STATS_MAX_SHARDS must be at least 1");
+
+typedef struct {
+    // The alignment pads the shard to whole cache lines, so neighbouring shards never share one
+    _Alignas(MESHCORE_STATS_ALIGN) atomic_uint_least32_t counters[MESHCORE_STATS_COUNT];
+} meshcore_stats_shard_t;
+
+typedef struct {
+    atomic_uint_least32_t  shard_count;
+    meshcore_stats_shard_t shards[MESHCORE_STATS_MAX_SHARDS];
+} meshcore_stats_t;
+
+typedef struct {
+    uint32_t counters[MESHCORE_STATS_COUNT];
+} meshcore_stats_totals_t;
+
+// Functions
+
+/// Reset all counters and detach all shards
+void meshcore_stats_init(meshcore_stats_t* stats);
+
+/// Claim a shard for the calling thread, returns NULL when all shards are taken
+meshcore_stats_shard_t* meshcore_stats_attach(meshcore_stats_t* stats);
+
+/// Add to a counter of the calling thread's shard, shard may be NULL
+static inline void meshcore_stats_add(meshcore_stats_shard_t* shard, meshcore_stats_counter_t counter, uint32_t value) {
+    if (shard != NULL) {
+        // Only the owning thread writes, readers may see the old or the new value but never a torn one
+        atomic_uint_least32_t* slot = &shard->counters[counter];
+        atomic_store_explicit(slot, atomic_load_explicit(slot, memory_order_relaxed) + value, memory_order_relaxed);
+    }
+}
+
+/// Count a serialized frame that was received (tx false) or transmitted (tx true)
+void meshcore_stats_frame(meshcore_stats_shard_t* shard, bool tx, const uint8_t* data, uint8_t size);
+
+/// Sum the counters of all shards
+void meshcore_stats_snapshot(meshcore_stats_t* stats, meshcore_stats_totals_t* out_totals);
+
+/// Name of a counter, as used in the text export
+const char* meshcore_stats_name(meshcore_stats_counter_t counter);
+
+/// Write totals in the Prometheus text exposition format, every counter named meshcore_<name>_total. Returns
+/// the length written or -1 when out does not have room for all of it.
+int meshcore_stats_format_prometheus(const meshcore_stats_totals_t* totals, char* out, size_t size);
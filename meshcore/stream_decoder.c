@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "stream_decoder.h"
+#include <stdint.h>
+#include <string.h>
+
+// Header byte fields, see packet.c
+#define PACKET_HEADER_ROUTE_SHIFT 0
+#define PACKET_HEADER_ROUTE_MASK  0x03
+#define PACKET_HEADER_TYPE_SHIFT  2
+#define PACKET_HEADER_TYPE_MASK   0x0F
+#define PACKET_HEADER_VER_SHIFT   6
+#define PACKET_HEADER_VER_MASK    0x03
+
+static meshcore_stream_status_t meshcore_stream_finish(meshcore_stream_decoder_t* decoder, meshcore_stream_status_t status) {
+    decoder->status = status;
+    decoder->state  = (status == MESHCORE_STREAM_DROPPED && decoder->frame_size != decoder->received) ? MESHCORE_STREAM_STATE_SKIP
+                                                                                                       : MESHCORE_STREAM_STATE_DONE;
+    return status;
+}
+
+static meshcore_stream_status_t meshcore_stream_complete(meshcore_stream_decoder_t* decoder) {
+    if (decoder->callbacks != NULL && decoder->callbacks->payload != NULL) {
+        decoder->callbacks->payload(decoder, &decoder->message, decoder->context);
+    }
+    return meshcore_stream_finish(decoder, MESHCORE_STREAM_COMPLETE);
+}
+
+// Raise an event, returns false when the frame was dropped
+static bool meshcore_stream_event(meshcore_stream_decoder_t* decoder,
+                                  bool (*event)(meshcore_stream_decoder_t*, const meshcore_message_t*, void*)) {
+    if (event != NULL && !event(decoder, &decoder->message, decoder->context)) {
+        meshcore_stream_finish(decoder, MESHCORE_STREAM_DROPPED);
+        return false;
+    }
+    return true;
+}
+
+// The path is complete, with a known frame size the payload length follows from it
+static void meshcore_stream_path_done(meshcore_stream_decoder_t* decoder) {
+    if (!meshcore_stream_event(decoder, decoder->callbacks != NULL ? decoder->callbacks->path : NULL)) {
+        return;
+    }
+    decoder->state          = MESHCORE_STREAM_STATE_PAYLOAD;
+    decoder->field_position = 0;
+    if (decoder->frame_size > 0) {
+        if (decoder->frame_size - decoder->received > MESHCORE_MAX_PAYLOAD_SIZE) {
+            meshcore_stream_finish(decoder, MESHCORE_STREAM_ERROR);
+        } else if (decoder->frame_size == decoder->received) {
+            meshcore_stream_complete(decoder);
+        }
+    }
+}
+
+void meshcore_stream_init(meshcore_stream_decoder_t* decoder, const meshcore_stream_callbacks_t* callbacks, void* context, uint8_t prefix_length) {
+    memset(decoder, 0, sizeof(meshcore_stream_decoder_t));
+    decoder->callbacks     = callbacks;
+    decoder->context       = context;
+    decoder->prefix_length = prefix_length;
+    decoder->state         = MESHCORE_STREAM_STATE_IDLE;
+    decoder->status        = MESHCORE_STREAM_DROPPED;
+}
+
+void meshcore_stream_begin(meshcore_stream_decoder_t* decoder, uint8_t frame_size) {
+    memset(&decoder->message, 0, sizeof(meshcore_message_t));
+    decoder->frame_size     = frame_size;
+    decoder->received       = 0;
+    decoder->field_position = 0;
+    decoder->state          = MESHCORE_STREAM_STATE_HEADER;
+    decoder->status         = MESHCORE_STREAM_IN_PROGRESS;
+    if (frame_size == 1) {
+        // Too short to hold the path length
+        meshcore_stream_finish(decoder, MESHCORE_STREAM_ERROR);
+    }
+}
+
+meshcore_stream_status_t meshcore_stream_feed(meshcore_stream_decoder_t* decoder, const uint8_t* data, size_t length, size_t* out_consumed) {
+    meshcore_message_t* message  = &decoder->message;
+    size_t              position = 0;
+
+    if (decoder->frame_size > 0 && length > (size_t)(decoder->frame_size - decoder->received)) {
+        length = decoder->frame_size - decoder->received;
+    }
+
+    while (position < length && decoder->state != MESHCORE_STREAM_STATE_DONE && decoder->state != MESHCORE_STREAM_STATE_IDLE) {
+        size_t available = length - position;
+        switch (decoder->state) {
+            case MESHCORE_STREAM_STATE_HEADER: {
+                uint8_t header   = data[position++];
+                message->route   = (header >> PACKET_HEADER_ROUTE_SHIFT) & PACKET_HEADER_ROUTE_MASK;
+                message->type    = (header >> PACKET_HEADER_TYPE_SHIFT) & PACKET_HEADER_TYPE_MASK;
+                message->version = (header >> PACKET_HEADER_VER_SHIFT) & PACKET_HEADER_VER_MASK;
+                decoder->received++;
+                if (message->route == MESHCORE_ROUTE_TYPE_TRANSPORT_FLOOD || message->route == MESHCORE_ROUTE_TYPE_TRANSPORT_DIRECT) {
+                    // A frame of known size has to hold the transport codes and the path length, or it would never finish
+                    if (decoder->frame_size > 0 && decoder->frame_size - decoder->received < sizeof(message->transport_codes) + 1) {
+                        meshcore_stream_finish(decoder, MESHCORE_STREAM_ERROR);
+                    } else {
+                        decoder->state = MESHCORE_STREAM_STATE_TRANSPORT;
+                    }
+                } else {
+                    decoder->state = MESHCORE_STREAM_STATE_PATH_LENGTH;
+                    meshcore_stream_event(decoder, decoder->callbacks != NULL ? decoder->callbacks->header : NULL);
+                }
+                break;
+            }
+            case MESHCORE_STREAM_STATE_TRANSPORT: {
+                size_t needed = sizeof(message->transport_codes) - decoder->field_position;
+                size_t take   = (available < needed) ? available : needed;
+                memcpy((uint8_t*)message->transport_codes + decoder->field_position, &data[position], take);
+                position                += take;
+                decoder->received       += (uint8_t)take;
+                decoder->field_position += (uint8_t)take;
+                if (decoder->field_position == sizeof(message->transport_codes)) {
+                    decoder->field_position = 0;
+                    decoder->state          = MESHCORE_STREAM_STATE_PATH_LENGTH;
+                    meshcore_stream_event(decoder, decoder->callbacks != NULL ? decoder->callbacks->header : NULL);
+                }
+                break;
+            }
+            case MESHCORE_STREAM_STATE_PATH_LENGTH:
+                message->path_length = data[position++];
+                decoder->received++;
+                if (message->path_length > MESHCORE_MAX_PATH_SIZE ||
+                    (decoder->frame_size > 0 && message->path_length > decoder->frame_size - decoder->received)) {
+                    meshcore_stream_finish(decoder, MESHCORE_STREAM_ERROR);
+                } else if (message->path_length == 0) {
+                    meshcore_stream_path_done(decoder);
+                } else {
+                    decoder->state = MESHCORE_STREAM_STATE_PATH;
+                }
+                break;
+            case MESHCORE_STREAM_STATE_PATH: {
+                size_t needed = message->path_length - decoder->field_position;
+                size_t take   = (available < needed) ? available : needed;
+                memcpy(&message->path[decoder->field_position], &data[position], take);
+                position                += take;
+                decoder->received       += (uint8_t)take;
+                decoder->field_position += (uint8_t)take;
+                if (decoder->field_position == message->path_length) {
+                    meshcore_stream_path_done(decoder);
+                }
+                break;
+            }
+            case MESHCORE_STREAM_STATE_PAYLOAD: {
+                if (available > (size_t)(MESHCORE_MAX_PAYLOAD_SIZE - message->payload_length)) {
+                    meshcore_stream_finish(decoder, MESHCORE_STREAM_ERROR);
+                    break;
+                }
+                // Copy up to the prefix first so that its event is raised as soon as it is complete
+                size_t take = available;
+                if (message->payload_length < decoder->prefix_length && take > (size_t)(decoder->prefix_length - message->payload_length)) {
+                    take = decoder->prefix_length - message->payload_length;
+                }
+                memcpy(&message->payload[message->payload_length], &data[position], take);
+                position                += take;
+                decoder->received       += (uint8_t)take;
+                message->payload_length += (uint8_t)take;
+                if (message->payload_length == decoder->prefix_length &&
+                    !meshcore_stream_event(decoder, decoder->callbacks != NULL ? decoder->callbacks->payload_prefix : NULL)) {
+                    break;
+                }
+                if (decoder->frame_size > 0 && decoder->received == decoder->frame_size) {
+                    meshcore_stream_complete(decoder);
+                }
+                break;
+            }
+            case MESHCORE_STREAM_STATE_SKIP:
+                decoder->received += (uint8_t)available;
+                position           = length;
+                if (decoder->frame_size > 0 && decoder->received == decoder->frame_size) {
+                    decoder->state = MESHCORE_STREAM_STATE_DONE;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (out_consumed != NULL) {
+        *out_consumed = position;
+    }
+    return decoder->status;
+}
+
+meshcore_stream_status_t meshcore_stream_end(meshcore_stream_decoder_t* decoder) {
+    switch (decoder->state) {
+        case MESHCORE_STREAM_STATE_PAYLOAD:
+            return meshcore_stream_complete(decoder);
+        case MESHCORE_STREAM_STATE_SKIP:
+            decoder->state = MESHCORE_STREAM_STATE_DONE;
+            return decoder->status;
+        case MESHCORE_STREAM_STATE_DONE:
+        case MESHCORE_STREAM_STATE_IDLE:
+            return decoder->status;
+        default:
+            // Ended inside the header or path
+            return meshcore_stream_finish(decoder, MESHCORE_STREAM_ERROR);
+    }
+}
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packet.h"
+
+// Definitions
+
+// Incremental packet decoder for radios that hand over a frame in pieces, over SPI or USB. Bytes are fed in
+// chunks of any size and an event is raised as soon as a field is complete: the header (with the transport
+// codes), the path, the first prefix_length bytes of the payload and the full payload. Each event can drop
+// the frame, the rest of it is then skipped without being copied, so a receiver can decide on the header,
+// path or destination hash while the payload is still arriving.
+//
+// The frame size is passed to meshcore_stream_begin when the radio knows it up front, which lets the decoder
+// finish on the last byte and reject a payload that will not fit before it arrives. With a frame size of 0
+// the frame ends when meshcore_stream_end is called. A complete frame leaves the same message in the decoder
+// as meshcore_deserialize would.
+
+typedef enum {
+    MESHCORE_STREAM_IN_PROGRESS = 0,  // More bytes are needed
+    MESHCORE_STREAM_COMPLETE    = 1,  // The frame was decoded, message holds it
+    MESHCORE_STREAM_DROPPED     = 2,  // An event callback dropped the frame, or the decoder is idle
+    MESHCORE_STREAM_ERROR       = 3,  // The frame is malformed
+} meshcore_stream_status_t;
+
+typedef enum {
+    MESHCORE_STREAM_STATE_IDLE,
+    MESHCORE_STREAM_STATE_HEADER,
+    MESHCORE_STREAM_STATE_TRANSPORT,
+    MESHCORE_STREAM_STATE_PATH_LENGTH,
+    MESHCORE_STREAM_STATE_PATH,
+    MESHCORE_STREAM_STATE_PAYLOAD,
+    MESHCORE_STREAM_STATE_SKIP,  // Dropped, the rest of the frame is discarded
+    MESHCORE_STREAM_STATE_DONE,  // Finished, status holds the outcome
+} meshcore_stream_state_t;
+
+typedef struct meshcore_stream_decoder meshcore_stream_decoder_t;
+
+// Event callbacks, any may be NULL. A callback returns false to drop the frame.
+typedef struct {
+    /// Route, type, version and transport codes are known
+    bool (*header)(meshcore_stream_decoder_t* decoder, const meshcore_message_t* message, void* context);
+    /// The path is known
+    bool (*path)(meshcore_stream_decoder_t* decoder, const meshcore_message_t* message, void* context);
+    /// The first prefix_length bytes of the payload are known, skipped for shorter payloads
+    bool (*payload_prefix)(meshcore_stream_decoder_t* decoder, const meshcore_message_t* message, void* context);
+    /// The frame is complete
+    void (*payload)(meshcore_stream_decoder_t* decoder, const meshcore_message_t* message, void* context);
+} meshcore_stream_callbacks_t;
+
+struct meshcore_stream_decoder {
+    const meshcore_stream_callbacks_t* callbacks;
+    void*                              context;
+    uint8_t                            prefix_length;
+    meshcore_stream_state_t            state;
+    meshcore_stream_status_t           status;
+    uint8_t                            frame_size;  // 0 when the frame ends with meshcore_stream_end
+    uint8_t                            received;
+    uint8_t                            field_position;
+    meshcore_message_t                 message;
+};
+
+// Functions
+
+/// Prepare a decoder, prefix_length selects how much of the payload is passed to the payload_prefix event
+void meshcore_stream_init(meshcore_stream_decoder_t* decoder, const meshcore_stream_callbacks_t* callbacks, void* context, uint8_t prefix_length);
+
+/// Start a new frame of frame_size bytes, or of unknown size when 0, abandoning a frame in progress
+void meshcore_stream_begin(meshcore_stream_decoder_t* decoder, uint8_t frame_size);
+
+/// Feed the next bytes of the frame. Bytes past the end of the frame are not consumed, out_consumed (may
+/// be NULL) is set to the number of bytes taken. Returns the status of the frame.
+meshcore_stream_status_t meshcore_stream_feed(meshcore_stream_decoder_t* decoder, const uint8_t* data, size_t length, size_t* out_consumed);
+
+/// Mark the end of a frame of unknown size, returns the final status of the frame
+meshcore_stream_status_t meshcore_stream_end(meshcore_stream_decoder_t* decoder);
@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "timer_wheel.h"
+#include <stdint.h>
+#include <string.h>
+
+#define MESHCORE_TIMER_WHEEL_MASK  (MESHCORE_TIMER_WHEEL_SLOTS - 1)
+#define MESHCORE_TIMER_WHEEL_RANGE (1ull << (MESHCORE_TIMER_WHEEL_SLOT_BITS * MESHCORE_TIMER_WHEEL_LEVELS))
+
+static void meshcore_timer_list_init(meshcore_timer_t* head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static void meshcore_timer_insert(meshcore_timer_t* head, meshcore_timer_t* timer) {
+    timer->next      = head;
+    timer->prev      = head->prev;
+    head->prev->next = timer;
+    head->prev       = timer;
+}
+
+static void meshcore_timer_unlink(meshcore_timer_t* timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next       = NULL;
+    timer->prev       = NULL;
+}
+
+// Move the contents of a list to a detached head, so that callbacks can safely add to the original list
+static bool meshcore_timer_list_take(meshcore_timer_t* head, meshcore_timer_t* out_list) {
+    if (head->next == head) {
+        return false;
+    }
+    out_list->next       = head->next;
+    out_list->prev       = head->prev;
+    out_list->next->prev = out_list;
+    out_list->prev->next = out_list;
+    meshcore_timer_list_init(head);
+    return true;
+}
+
+// Place a timer on the lowest level whose range covers its expiry, relative to the current tick
+static void meshcore_timer_place(meshcore_timer_wheel_t* wheel, meshcore_timer_t* timer) {
+    uint32_t delta = timer->expires_tick - wheel->current_tick;
+    uint32_t tick  = timer->expires_tick;
+    uint8_t  level = 0;
+
+    if ((uint64_t)delta >= MESHCORE_TIMER_WHEEL_RANGE) {
+        tick  = wheel->current_tick + (uint32_t)(MESHCORE_TIMER_WHEEL_RANGE - 1);
+        delta = (uint32_t)(MESHCORE_TIMER_WHEEL_RANGE - 1);
+    }
+    while (level < MESHCORE_TIMER_WHEEL_LEVELS - 1 && delta >= (1u << (MESHCORE_TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+
+    uint32_t slot = (tick >> (MESHCORE_TIMER_WHEEL_SLOT_BITS * level)) & MESHCORE_TIMER_WHEEL_MASK;
+    timer->level  = level;
+    meshcore_timer_insert(&wheel->slots[level][slot], timer);
+    wheel->level_count[level]++;
+}
+
+void meshcore_timer_wheel_init(meshcore_timer_wheel_t* wheel, uint32_t tick_ms, uint32_t now_ms) {
+    memset(wheel, 0, sizeof(meshcore_timer_wheel_t));
+    wheel->tick_ms = (tick_ms > 0) ? tick_ms : 1;
+    wheel->time_ms = now_ms;
+    meshcore_timer_list_init(&wheel->due);
+    for (uint8_t level = 0; level < MESHCORE_TIMER_WHEEL_LEVELS; level++) {
+        for (uint32_t slot = 0; slot < MESHCORE_TIMER_WHEEL_SLOTS; slot++) {
+            meshcore_timer_list_init(&wheel->slots[level][slot]);
+        }
+    }
+}
+
+void meshcore_timer_init(meshcore_timer_t* timer, meshcore_timer_callback_t callback, void* context) {
+    memset(timer, 0, sizeof(meshcore_timer_t));
+    timer->callback = callback;
+    timer->context  = context;
+}
+
+bool meshcore_timer_active(const meshcore_timer_t* timer) {
+    return timer->next != NULL;
+}
+
+void meshcore_timer_cancel(meshcore_timer_wheel_t* wheel, meshcore_timer_t* timer) {
+    if (meshcore_timer_active(timer)) {
+        meshcore_timer_unlink(timer);
+        wheel->level_count[timer->level]--;
+        wheel->pending--;
+    }
+}
+
+static void meshcore_timer_schedule(meshcore_timer_wheel_t* wheel, meshcore_timer_t* timer, uint32_t expires_ms) {
+    int32_t delta_ms  = (int32_t)(expires_ms - wheel->time_ms);
+    timer->expires_ms = expires_ms;
+    wheel->pending++;
+
+    if (delta_ms <= 0) {
+        // Already due, fires on the next advance without waiting for a tick
+        timer->level = MESHCORE_TIMER_WHEEL_DUE;
+        meshcore_timer_insert(&wheel->due, timer);
+        wheel->level_count[MESHCORE_TIMER_WHEEL_DUE]++;
+        return;
+    }
+
+    // Round up so that a timer never fires before its expiry
+    timer->expires_tick = wheel->current_tick + ((uint32_t)delta_ms + wheel->tick_ms - 1) / wheel->tick_ms;
+    meshcore_timer_place(wheel, timer);
+}
+
+void meshcore_timer_start(meshcore_timer_wheel_t* wheel, meshcore_timer_t* timer, uint32_t expires_ms) {
+    meshcore_timer_cancel(wheel, timer);
+    timer->interval_ms = 0;
+    meshcore_timer_schedule(wheel, timer, expires_ms);
+}
+
+void meshcore_timer_start_periodic(meshcore_timer_wheel_t* wheel, meshcore_timer_t* timer, uint32_t first_ms, uint32_t interval_ms) {
+    meshcore_timer_cancel(wheel, timer);
+    timer->interval_ms = interval_ms;
+    meshcore_timer_schedule(wheel, timer, first_ms);
+}
+
+// Fire every timer of a detached list
+static uint32_t meshcore_timer_fire(meshcore_timer_wheel_t* wheel, meshcore_timer_t* list) {
+    uint32_t fired = 0;
+    while (list->next != list) {
+        meshcore_timer_t* timer = list->next;
+        meshcore_timer_unlink(timer);
+        wheel->level_count[timer->level]--;
+        wheel->pending--;
+        fired++;
+
+        // Periodic timers are rearmed before the callback, which may still cancel or restart them
+        if (timer->interval_ms != 0) {
+            meshcore_timer_schedule(wheel, timer, timer->expires_ms + timer->interval_ms);
+        }
+        timer->callback(timer, timer->context);
+    }
+    return fired;
+}
+
+// Move the timers of a slot one or more levels down now that the wheel has reached it
+static void meshcore_timer_cascade(meshcore_timer_wheel_t* wheel, uint8_t level) {
+    uint32_t         slot = (wheel->current_tick >> (MESHCORE_TIMER_WHEEL_SLOT_BITS * level)) & MESHCORE_TIMER_WHEEL_MASK;
+    meshcore_timer_t list;
+    if (!meshcore_timer_list_take(&wheel->slots[level][slot], &list)) {
+        return;
+    }
+    while (list.next != &list) {
+        meshcore_timer_t* timer = list.next;
+        meshcore_timer_unlink(timer);
+        wheel->level_count[level]--;
+        meshcore_timer_place(wheel, timer);
+    }
+}
+
+uint32_t meshcore_timer_wheel_advance(meshcore_timer_wheel_t* wheel, uint32_t now_ms) {
+    uint32_t         fired = 0;
+    meshcore_timer_t list;
+
+    if (meshcore_timer_list_take(&wheel->due, &list)) {
+        fired += meshcore_timer_fire(wheel, &list);
+    }
+
+    int32_t elapsed_ms = (int32_t)(now_ms - wheel->time_ms);
+    if (elapsed_ms < (int32_t)wheel->tick_ms) {
+        return fired;
+    }
+
+    // The time follows the tick being processed, so that callbacks start and rearm timers relative to it
+    uint32_t ticks = (uint32_t)elapsed_ms / wheel->tick_ms;
+    while (ticks > 0) {
+        wheel->current_tick++;
+        wheel->time_ms += wheel->tick_ms;
+        ticks--;
+
+        uint32_t tick = wheel->current_tick;
+        for (uint8_t level = 1; level < MESHCORE_TIMER_WHEEL_LEVELS; level++) {
+            if ((tick & ((1u << (MESHCORE_TIMER_WHEEL_SLOT_BITS * level)) - 1)) != 0) {
+                break;
+            }
+            meshcore_timer_cascade(wheel, level);
+        }
+
+        if (meshcore_timer_list_take(&wheel->slots[0][tick & MESHCORE_TIMER_WHEEL_MASK], &list)) {
+            fired += meshcore_timer_fire(wheel, &list);
+        }
+
+        // Nothing on the lowest level: skip straight to the next cascade or the end
+        if (wheel->level_count[0] == 0) {
+            uint32_t skip = MESHCORE_TIMER_WHEEL_MASK - (wheel->current_tick & MESHCORE_TIMER_WHEEL_MASK);
+            if (skip > ticks) {
+                skip = ticks;
+            }
+            wheel->current_tick += skip;
+            wheel->time_ms      += skip * wheel->tick_ms;
+            ticks               -= skip;
+        }
+    }
+
+    return fired;
+}
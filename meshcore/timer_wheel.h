@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Definitions
+
+// Hierarchical timer wheel. Level 0 has one slot per tick, every next level has slots that span a full
+// revolution of the level below. A timer is placed on the lowest level that reaches its expiry and moves
+// down a level each time the wheel passes the start of its slot, so starting and cancelling a timer is O(1)
+// and advancing the wheel touches each timer at most once per level.
+//
+// The wheel has no clock of its own: the caller passes a monotonic time in milliseconds to every call, which
+// keeps it deterministic in tests and lets it run from a tick interrupt or a host event loop alike. The
+// clock is 32 bits and may wrap, timers can be set up to 2^31 ms ahead. Timers beyond the range of the top
+// level are parked in its last slot and re-placed when it comes around.
+
+#define MESHCORE_TIMER_WHEEL_LEVELS    4
+#define MESHCORE_TIMER_WHEEL_SLOT_BITS 6
+#define MESHCORE_TIMER_WHEEL_SLOTS     (1 << MESHCORE_TIMER_WHEEL_SLOT_BITS)
+#define MESHCORE_TIMER_WHEEL_DUE       MESHCORE_TIMER_WHEEL_LEVELS  // Level of timers that were already due when started
+
+typedef struct meshcore_timer meshcore_timer_t;
+
+typedef void (*meshcore_timer_callback_t)(meshcore_timer_t* timer, void* context);
+
+struct meshcore_timer {
+    meshcore_timer_t*         next;
+    meshcore_timer_t*         prev;
+    uint32_t                  expires_ms;
+    uint32_t                  expires_tick;
+    uint32_t                  interval_ms;  // Restarted interval_ms after every expiry when not 0
+    uint8_t                   level;
+    meshcore_timer_callback_t callback;
+    void*                     context;
+};
+
+typedef struct {
+    uint32_t         tick_ms;
+    uint32_t         time_ms;       // Time at the start of current_tick
+    uint32_t         current_tick;  // Last tick processed
+    uint32_t         pending;
+    uint32_t         level_count[MESHCORE_TIMER_WHEEL_LEVELS + 1];
+    meshcore_timer_t due;  // List head
+    meshcore_timer_t slots[MESHCORE_TIMER_WHEEL_LEVELS][MESHCORE_TIMER_WHEEL_SLOTS];  // List heads
+} meshcore_timer_wheel_t;
+
+// Functions
+
+/// Reset a wheel with a resolution of tick_ms, starting at now_ms
+void meshcore_timer_wheel_init(meshcore_timer_wheel_t* wheel, uint32_t tick_ms, uint32_t now_ms);
+
+/// Prepare a timer, the callback is called from meshcore_timer_wheel_advance once the timer expires
+void meshcore_timer_init(meshcore_timer_t* timer, meshcore_timer_callback_t callback, void* context);
+
+/// (Re)start a timer to expire once at expires_ms
+void meshcore_timer_start(meshcore_timer_wheel_t* wheel, meshcore_timer_t* timer, uint32_t expires_ms);
+
+/// (Re)start a timer to expire at first_ms and every interval_ms after that, without accumulating drift
+void meshcore_timer_start_periodic(meshcore_timer_wheel_t* wheel, meshcore_timer_t* timer, uint32_t first_ms, uint32_t interval_ms);
+
+/// Stop a timer, does nothing if it is not running
+void meshcore_timer_cancel(meshcore_timer_wheel_t* wheel, meshcore_timer_t* timer);
+
+/// Check if a timer is running
+bool meshcore_timer_active(const meshcore_timer_t* timer);
+
+/// Run the callbacks of all timers expired at now_ms, returns the number of timers that fired. Timers that
+/// expire within the same tick fire in one batch, callbacks may start and cancel any timer.
+uint32_t meshcore_timer_wheel_advance(meshcore_timer_wheel_t* wheel, uint32_t now_ms);
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "trace_monitor.h"
+#include <stdint.h>
+#include <string.h>
+
+#define MESHCORE_TRACE_BUCKET(snr) ((uint8_t)(((int16_t)(snr) + 128) >> 2))
+
+int meshcore_trace_forward(meshcore_message_t* message, const uint8_t* self_hash, int8_t snr) {
+    if (message == NULL || self_hash == NULL || message->type != MESHCORE_PAYLOAD_TYPE_TRACE) {
+        return -1;
+    }
+
+    // Traces follow the route listed in the payload, flooded copies are not forwarded
+    if (message->route != MESHCORE_ROUTE_TYPE_DIRECT && message->route != MESHCORE_ROUTE_TYPE_TRANSPORT_DIRECT) {
+        return MESHCORE_TRACE_IGNORE;
+    }
+
+    if (message->payload_length < MESHCORE_TRACE_HEADER_SIZE) {
+        return -1;
+    }
+
+    uint8_t hash_size = MESHCORE_TRACE_HASH_SIZE(message->payload[MESHCORE_TRACE_FLAGS_OFFSET]);
+    size_t  offset    = MESHCORE_TRACE_HEADER_SIZE + (size_t)message->path_length * hash_size;
+
+    if (offset + hash_size > message->payload_length) {
+        return MESHCORE_TRACE_COMPLETE;
+    }
+
+    if (memcmp(&message->payload[offset], self_hash, hash_size) != 0) {
+        return MESHCORE_TRACE_IGNORE;
+    }
+
+    if (message->path_length >= MESHCORE_MAX_PATH_SIZE) {
+        return -1;
+    }
+
+    message->path[message->path_length] = (uint8_t)snr;
+    message->path_length++;
+    return MESHCORE_TRACE_FORWARD;
+}
+
+void meshcore_trace_collector_init(meshcore_trace_collector_t* collector) {
+    memset(collector, 0, sizeof(meshcore_trace_collector_t));
+}
+
+static uint32_t meshcore_trace_slot(uint8_t from, uint8_t to) {
+    uint32_t key = ((uint32_t)from << 8) | to;
+    return ((key * 0x9E3779B1u) >> 16) & (MESHCORE_TRACE_MAX_LINKS - 1);
+}
+
+static meshcore_trace_link_t* meshcore_trace_lookup(meshcore_trace_collector_t* collector, uint8_t from, uint8_t to, bool create) {
+    // Open addressing with linear probing, links are never removed so a free slot ends the search
+    uint32_t slot = meshcore_trace_slot(from, to);
+    for (uint32_t probe = 0; probe < MESHCORE_TRACE_MAX_LINKS; probe++) {
+        meshcore_trace_link_t* link = &collector->links[slot];
+        if (!link->used) {
+            // Keep a quarter of the table free so probe sequences stay short
+            if (!create || collector->links_used >= MESHCORE_TRACE_MAX_LINKS - MESHCORE_TRACE_MAX_LINKS / 4) {
+                return NULL;
+            }
+            link->used = true;
+            link->from = from;
+            link->to   = to;
+            collector->links_used++;
+            return link;
+        }
+        if (link->from == from && link->to == to) {
+            return link;
+        }
+        slot = (slot + 1) & (MESHCORE_TRACE_MAX_LINKS - 1);
+    }
+    return NULL;
+}
+
+int meshcore_trace_collector_add(meshcore_trace_collector_t* collector, uint8_t from, uint8_t to, int8_t snr, uint32_t now_ms) {
+    meshcore_trace_link_t* link = meshcore_trace_lookup(collector, from, to, true);
+    if (link == NULL) {
+        collector->dropped++;
+        return -1;
+    }
+
+    if (link->samples == 0) {
+        link->mean    = (int32_t)snr * 256;
+        link->min_snr = snr;
+        link->max_snr = snr;
+    } else {
+        link->mean += ((int32_t)snr * 256 - link->mean) / (1 << MESHCORE_TRACE_MEAN_SHIFT);
+        if (snr < link->min_snr) {
+            link->min_snr = snr;
+        }
+        if (snr > link->max_snr) {
+            link->max_snr = snr;
+        }
+    }
+
+    if (link->histogram_total >= MESHCORE_TRACE_WINDOW) {
+        link->histogram_total = 0;
+        for (uint8_t bucket = 0; bucket < MESHCORE_TRACE_HISTOGRAM_BUCKETS; bucket++) {
+            link->histogram[bucket]  /= 2;
+            link->histogram_total   += link->histogram[bucket];
+        }
+    }
+    link->histogram[MESHCORE_TRACE_BUCKET(snr)]++;
+    link->histogram_total++;
+
+    link->last_snr  = snr;
+    link->last_seen = now_ms;
+    link->samples++;
+    collector->samples++;
+    return 0;
+}
+
+int meshcore_trace_collect(meshcore_trace_collector_t* collector, uint8_t self_hash, const meshcore_message_t* message, int8_t snr, uint32_t now_ms) {
+    if (collector == NULL || message == NULL || message->type != MESHCORE_PAYLOAD_TYPE_TRACE || message->payload_length < MESHCORE_TRACE_HEADER_SIZE) {
+        return -1;
+    }
+
+    uint8_t        hash_size = MESHCORE_TRACE_HASH_SIZE(message->payload[MESHCORE_TRACE_FLAGS_OFFSET]);
+    const uint8_t* hashes    = &message->payload[MESHCORE_TRACE_HEADER_SIZE];
+    size_t         hops      = (message->payload_length - MESHCORE_TRACE_HEADER_SIZE) / hash_size;
+
+    if (message->path_length != hops) {
+        return -1;
+    }
+
+    // Hop i received the trace from hop i - 1, the first hop from this node and this node from the last hop
+    int     links = 0;
+    uint8_t from  = self_hash;
+    for (size_t hop = 0; hop < hops; hop++) {
+        uint8_t to = hashes[hop * hash_size];
+        if (meshcore_trace_collector_add(collector, from, to, (int8_t)message->path[hop], now_ms) == 0) {
+            links++;
+        }
+        from = to;
+    }
+    if (meshcore_trace_collector_add(collector, from, self_hash, snr, now_ms) == 0) {
+        links++;
+    }
+
+    collector->traces++;
+    return links;
+}
+
+const meshcore_trace_link_t* meshcore_trace_collector_find(const meshcore_trace_collector_t* collector, uint8_t from, uint8_t to) {
+    return meshcore_trace_lookup((meshcore_trace_collector_t*)collector, from, to, false);
+}
+
+int8_t meshcore_trace_link_mean(const meshcore_trace_link_t* link) {
+    int32_t mean = link->mean;
+    return (int8_t)((mean >= 0) ? (mean + 128) / 256 : (mean - 128) / 256);
+}
+
+int8_t meshcore_trace_link_percentile(const meshcore_trace_link_t* link, uint8_t percent) {
+    if (link->histogram_total == 0) {
+        return 0;
+    }
+    if (percent > 100) {
+        percent = 100;
+    }
+
+    uint32_t rank  = ((uint32_t)link->histogram_total * percent + 99) / 100;
+    uint32_t count = 0;
+    uint8_t  bucket;
+    for (bucket = 0; bucket < MESHCORE_TRACE_HISTOGRAM_BUCKETS - 1; bucket++) {
+        count += link->histogram[bucket];
+        if (count >= rank && count > 0) {
+            break;
+        }
+    }
+
+    // Middle of the bucket, clamped to the observed range
+    int16_t snr = (int16_t)bucket * 4 - 128 + 2;
+    if (snr < link->min_snr) {
+        snr = link->min_snr;
+    }
+    if (snr > link->max_snr) {
+        snr = link->max_snr;
+    }
+    return (int8_t)snr;
+}
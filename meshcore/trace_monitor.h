@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packet.h"
+
+// Definitions
+
+// A TRACE payload (see payload/trace.h) lists the hashes of the hops to visit. Each hop that finds its own
+// hash at the position given by the packet path length appends the SNR it received the packet with to the
+// packet path and retransmits it, so after the last hop the path holds one SNR per link. SNR values are
+// signed and in quarter dB, like everywhere else in MeshCore.
+
+#define MESHCORE_TRACE_HEADER_SIZE         (sizeof(uint32_t) * 2 + sizeof(uint8_t))
+#define MESHCORE_TRACE_FLAGS_OFFSET        (sizeof(uint32_t) * 2)
+#define MESHCORE_TRACE_HASH_SIZE(flags)    (1u << ((flags) & 0x03))
+
+typedef enum {
+    MESHCORE_TRACE_IGNORE   = 0,  // Not addressed to this node
+    MESHCORE_TRACE_FORWARD  = 1,  // SNR appended, retransmit the packet
+    MESHCORE_TRACE_COMPLETE = 2,  // Every hop has been visited, the trace has reached its destination
+} meshcore_trace_action_t;
+
+// Link statistics
+
+#ifndef MESHCORE_TRACE_MAX_LINKS
+#define MESHCORE_TRACE_MAX_LINKS 1024
+#endif
+
+_Static_assert((MESHCORE_TRACE_MAX_LINKS & (MESHCORE_TRACE_MAX_LINKS - 1)) == 0, "MESHCORE_TRACE_MAX_LINKS must be a power of two");
+
+// The histogram has one bucket per dB over the full quarter dB SNR range. Once it holds
+// MESHCORE_TRACE_WINDOW samples all buckets are halved, so percentiles follow recent samples.
+#define MESHCORE_TRACE_HISTOGRAM_BUCKETS 64
+#define MESHCORE_TRACE_WINDOW            256
+
+// The mean is an exponentially weighted moving average with weight 1/2^MESHCORE_TRACE_MEAN_SHIFT for new
+// samples, kept in quarter dB with 8 fractional bits
+#define MESHCORE_TRACE_MEAN_SHIFT 3
+
+typedef struct {
+    uint8_t  from;  // First byte of the transmitting hop's hash
+    uint8_t  to;    // First byte of the receiving hop's hash
+    bool     used;
+    int8_t   last_snr;
+    int8_t   min_snr;
+    int8_t   max_snr;
+    uint16_t histogram_total;
+    int32_t  mean;
+    uint32_t samples;
+    uint32_t last_seen;
+    uint16_t histogram[MESHCORE_TRACE_HISTOGRAM_BUCKETS];
+} meshcore_trace_link_t;
+
+typedef struct {
+    uint32_t              links_used;
+    uint32_t              traces;
+    uint32_t              samples;
+    uint32_t              dropped;  // Samples of new links while the table was full
+    meshcore_trace_link_t links[MESHCORE_TRACE_MAX_LINKS];
+} meshcore_trace_collector_t;
+
+// Functions
+
+/// Handle a received TRACE packet in place, appending snr to the packet path when self_hash is the next hop
+int meshcore_trace_forward(meshcore_message_t* message, const uint8_t* self_hash, int8_t snr);
+
+/// Reset a collector
+void meshcore_trace_collector_init(meshcore_trace_collector_t* collector);
+
+/// Add the hops of a completed trace that was sent by this node, snr is the SNR the trace was received
+/// back with. Returns the number of links updated or -1 when the trace is malformed.
+int meshcore_trace_collect(meshcore_trace_collector_t* collector, uint8_t self_hash, const meshcore_message_t* message, int8_t snr, uint32_t now_ms);
+
+/// Record a single SNR sample for the link from one hop to the next, returns -1 when the table is full
+int meshcore_trace_collector_add(meshcore_trace_collector_t* collector, uint8_t from, uint8_t to, int8_t snr, uint32_t now_ms);
+
+/// Find the statistics of a link, NULL if it has not been seen
+const meshcore_trace_link_t* meshcore_trace_collector_find(const meshcore_trace_collector_t* collector, uint8_t from, uint8_t to);
+
+/// Rolling mean SNR of a link in quarter dB
+int8_t meshcore_trace_link_mean(const meshcore_trace_link_t* link);
+
+/// Approximate SNR percentile (0 to 100) of a link in quarter dB, resolution is one histogram bucket
+int8_t meshcore_trace_link_percentile(const meshcore_trace_link_t* link, uint8_t percent);
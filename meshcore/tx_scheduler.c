@@ -0,0 +1,271 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#include "tx_scheduler.h"
+#include <stdint.h>
+#include <string.h>
+
+uint32_t meshcore_lora_airtime_us(const meshcore_radio_params_t* params, uint8_t size) {
+    // Semtech LoRa modem time on air (AN1200.13), in quarter symbols to keep the 4.25 preamble symbols exact
+    uint32_t spreading_factor = params->spreading_factor;
+    uint32_t bandwidth        = params->bandwidth;
+    uint32_t coding_rate      = params->coding_rate;
+    if (spreading_factor < 6 || spreading_factor > 12 || bandwidth == 0) {
+        return 0;
+    }
+    if (coding_rate < 5 || coding_rate > 8) {
+        coding_rate = 5;
+    }
+
+    // Low data rate optimization is mandatory once a symbol takes 16 ms or longer
+    uint32_t low_data_rate = ((1000u << spreading_factor) / bandwidth >= 16) ? 1 : 0;
+
+    int32_t numerator   = 8 * (int32_t)size - 4 * (int32_t)spreading_factor + 28 + 16;
+    int32_t denominator = 4 * ((int32_t)spreading_factor - 2 * (int32_t)low_data_rate);
+    int32_t blocks      = (numerator > 0) ? (numerator + denominator - 1) / denominator : 0;
+
+    uint64_t quarter_symbols = (uint64_t)params->preamble_length * 4 + 17 + (8 + (uint64_t)blocks * coding_rate) * 4;
+    return (uint32_t)((quarter_symbols * (1000000ull << spreading_factor)) / (4ull * bandwidth));
+}
+
+meshcore_tx_class_t meshcore_tx_classify(const meshcore_message_t* message) {
+    if (message->type == MESHCORE_PAYLOAD_TYPE_ACK) {
+        return MESHCORE_TX_CLASS_ACK;
+    }
+    if (message->type == MESHCORE_PAYLOAD_TYPE_ADVERT) {
+        return MESHCORE_TX_CLASS_ADVERT;
+    }
+    if (message->route == MESHCORE_ROUTE_TYPE_DIRECT || message->route == MESHCORE_ROUTE_TYPE_TRANSPORT_DIRECT) {
+        return MESHCORE_TX_CLASS_DIRECT;
+    }
+    return MESHCORE_TX_CLASS_FLOOD;
+}
+
+static uint32_t meshcore_tx_random(meshcore_tx_scheduler_t* scheduler) {
+    // xorshift32
+    uint32_t x         = scheduler->random;
+    x                 ^= x << 13;
+    x                 ^= x >> 17;
+    x                 ^= x << 5;
+    scheduler->random  = x;
+    return x;
+}
+
+// Forget the airtime of buckets that have left the window
+static void meshcore_tx_window_advance(meshcore_tx_scheduler_t* scheduler, uint32_t now_ms) {
+    uint32_t elapsed = now_ms - scheduler->bucket_start_ms;
+    if ((int32_t)elapsed < 0 || elapsed < scheduler->bucket_ms) {
+        return;
+    }
+
+    uint32_t buckets = elapsed / scheduler->bucket_ms;
+    if (buckets >= MESHCORE_TX_WINDOW_BUCKETS) {
+        memset(scheduler->window_us, 0, sizeof(scheduler->window_us));
+        scheduler->window_used_us  = 0;
+        scheduler->bucket_start_ms = now_ms;
+        return;
+    }
+
+    for (uint32_t i = 0; i < buckets; i++) {
+        scheduler->bucket                        = (scheduler->bucket + 1) % MESHCORE_TX_WINDOW_BUCKETS;
+        scheduler->window_used_us               -= scheduler->window_us[scheduler->bucket];
+        scheduler->window_us[scheduler->bucket]  = 0;
+    }
+    scheduler->bucket_start_ms += buckets * scheduler->bucket_ms;
+}
+
+// Time until enough airtime has left the window to send airtime_us more
+static uint32_t meshcore_tx_budget_wait(const meshcore_tx_scheduler_t* scheduler, uint32_t airtime_us, uint32_t now_ms) {
+    uint64_t used   = scheduler->window_used_us;
+    uint32_t offset = now_ms - scheduler->bucket_start_ms;
+    for (uint32_t i = 1; i < MESHCORE_TX_WINDOW_BUCKETS; i++) {
+        used -= scheduler->window_us[(scheduler->bucket + i) % MESHCORE_TX_WINDOW_BUCKETS];
+        if (used + airtime_us <= scheduler->budget_us) {
+            return i * scheduler->bucket_ms - offset;
+        }
+    }
+    return MESHCORE_TX_WINDOW_BUCKETS * scheduler->bucket_ms - offset;
+}
+
+void meshcore_tx_scheduler_init(meshcore_tx_scheduler_t* scheduler, const meshcore_radio_params_t* params, uint16_t duty_cycle_permille,
+                                uint32_t window_ms, uint32_t now_ms, uint32_t seed) {
+    memset(scheduler, 0, sizeof(meshcore_tx_scheduler_t));
+    scheduler->params          = *params;
+    scheduler->budget_us       = (duty_cycle_permille >= 1000) ? 0 : (uint64_t)duty_cycle_permille * window_ms;
+    scheduler->bucket_ms       = (window_ms >= MESHCORE_TX_WINDOW_BUCKETS) ? window_ms / MESHCORE_TX_WINDOW_BUCKETS : 1;
+    scheduler->bucket_start_ms = now_ms;
+    scheduler->random          = (seed != 0) ? seed : 0x2545F491;
+
+    for (uint8_t tx_class = 0; tx_class < MESHCORE_TX_CLASSES; tx_class++) {
+        scheduler->head[tx_class] = MESHCORE_TX_NONE;
+        scheduler->tail[tx_class] = MESHCORE_TX_NONE;
+    }
+    for (uint8_t index = 0; index < MESHCORE_TX_QUEUE_SIZE; index++) {
+        scheduler->frames[index].next = (index + 1 < MESHCORE_TX_QUEUE_SIZE) ? index + 1 : MESHCORE_TX_NONE;
+    }
+    scheduler->free = 0;
+}
+
+void meshcore_tx_set_params(meshcore_tx_scheduler_t* scheduler, const meshcore_radio_params_t* params) {
+    scheduler->params = *params;
+}
+
+void meshcore_tx_set_stats(meshcore_tx_scheduler_t* scheduler, meshcore_stats_shard_t* shard) {
+    scheduler->node_stats = shard;
+}
+
+// Unlink a frame from its class queue, previous is the frame before it or MESHCORE_TX_NONE
+static void meshcore_tx_unlink(meshcore_tx_scheduler_t* scheduler, uint8_t index, uint8_t previous) {
+    meshcore_tx_frame_t* frame    = &scheduler->frames[index];
+    uint8_t              tx_class = frame->tx_class;
+
+    if (previous == MESHCORE_TX_NONE) {
+        scheduler->head[tx_class] = frame->next;
+    } else {
+        scheduler->frames[previous].next = frame->next;
+    }
+    if (scheduler->tail[tx_class] == index) {
+        scheduler->tail[tx_class] = previous;
+    }
+    scheduler->count[tx_class]--;
+
+    frame->next     = scheduler->free;
+    scheduler->free = index;
+}
+
+// Drop the newest frame of the lowest class below tx_class
+static bool meshcore_tx_make_room(meshcore_tx_scheduler_t* scheduler, meshcore_tx_class_t tx_class) {
+    for (int victim_class = MESHCORE_TX_CLASSES - 1; victim_class > (int)tx_class; victim_class--) {
+        if (scheduler->count[victim_class] == 0) {
+            continue;
+        }
+        uint8_t previous = MESHCORE_TX_NONE;
+        uint8_t index    = scheduler->head[victim_class];
+        while (index != scheduler->tail[victim_class]) {
+            previous = index;
+            index    = scheduler->frames[index].next;
+        }
+        meshcore_tx_unlink(scheduler, index, previous);
+        scheduler->stats.dropped[victim_class]++;
+        meshcore_stats_add(scheduler->node_stats, MESHCORE_STATS_TX_DROPPED, 1);
+        return true;
+    }
+    return false;
+}
+
+int meshcore_tx_enqueue(meshcore_tx_scheduler_t* scheduler, const uint8_t* data, uint8_t size, meshcore_tx_class_t tx_class, uint32_t now_ms) {
+    if (scheduler == NULL || data == NULL || size == 0 || tx_class >= MESHCORE_TX_CLASSES) {
+        return -1;
+    }
+
+    uint32_t airtime_us = meshcore_lora_airtime_us(&scheduler->params, size);
+
+    // A frame that can never fit in the budget would block its class forever
+    if (scheduler->budget_us != 0 && airtime_us > scheduler->budget_us) {
+        scheduler->stats.dropped[tx_class]++;
+        meshcore_stats_add(scheduler->node_stats, MESHCORE_STATS_TX_DROPPED, 1);
+        return -1;
+    }
+
+    if (scheduler->free == MESHCORE_TX_NONE && !meshcore_tx_make_room(scheduler, tx_class)) {
+        scheduler->stats.dropped[tx_class]++;
+        meshcore_stats_add(scheduler->node_stats, MESHCORE_STATS_TX_DROPPED, 1);
+        return -1;
+    }
+
+    uint8_t              index = scheduler->free;
+    meshcore_tx_frame_t* frame = &scheduler->frames[index];
+    scheduler->free            = frame->next;
+
+    frame->next          = MESHCORE_TX_NONE;
+    frame->tx_class      = tx_class;
+    frame->size          = size;
+    frame->airtime_us    = airtime_us;
+    frame->enqueued_ms   = now_ms;
+    frame->not_before_ms = now_ms;
+    memcpy(frame->data, data, size);
+
+    if (tx_class == MESHCORE_TX_CLASS_FLOOD || tx_class == MESHCORE_TX_CLASS_ADVERT) {
+        uint32_t slot         = meshcore_tx_random(scheduler) % MESHCORE_TX_FLOOD_BACKOFF_SLOTS;
+        frame->not_before_ms += slot * ((airtime_us + 999) / 1000);
+    }
+
+    if (scheduler->tail[tx_class] == MESHCORE_TX_NONE) {
+        scheduler->head[tx_class] = index;
+    } else {
+        scheduler->frames[scheduler->tail[tx_class]].next = index;
+    }
+    scheduler->tail[tx_class] = index;
+    scheduler->count[tx_class]++;
+    scheduler->stats.enqueued[tx_class]++;
+    return 0;
+}
+
+int meshcore_tx_next(meshcore_tx_scheduler_t* scheduler, uint32_t now_ms, uint8_t* out_data, uint8_t* out_size, uint32_t* out_wait_ms) {
+    uint32_t wait_ms = UINT32_MAX;
+
+    meshcore_tx_window_advance(scheduler, now_ms);
+
+    for (uint8_t tx_class = 0; tx_class < MESHCORE_TX_CLASSES; tx_class++) {
+        // Oldest frame of the class that has finished its back-off
+        uint8_t previous = MESHCORE_TX_NONE;
+        uint8_t index    = scheduler->head[tx_class];
+        while (index != MESHCORE_TX_NONE) {
+            int32_t remaining = (int32_t)(scheduler->frames[index].not_before_ms - now_ms);
+            if (remaining <= 0) {
+                break;
+            }
+            if ((uint32_t)remaining < wait_ms) {
+                wait_ms = (uint32_t)remaining;
+            }
+            previous = index;
+            index    = scheduler->frames[index].next;
+        }
+        if (index == MESHCORE_TX_NONE) {
+            continue;
+        }
+
+        meshcore_tx_frame_t* frame = &scheduler->frames[index];
+        if (scheduler->budget_us != 0 && scheduler->window_used_us + frame->airtime_us > scheduler->budget_us) {
+            // Lower classes do not get to overtake a frame that is waiting for budget
+            scheduler->stats.budget_waits++;
+            uint32_t budget_wait = meshcore_tx_budget_wait(scheduler, frame->airtime_us, now_ms);
+            if (out_wait_ms != NULL) {
+                *out_wait_ms = (budget_wait < wait_ms) ? budget_wait : wait_ms;
+            }
+            return 0;
+        }
+
+        memcpy(out_data, frame->data, frame->size);
+        *out_size = frame->size;
+
+        scheduler->window_us[scheduler->bucket] += frame->airtime_us;
+        scheduler->window_used_us               += frame->airtime_us;
+        scheduler->stats.sent[tx_class]++;
+        scheduler->stats.airtime_us             += frame->airtime_us;
+        scheduler->stats.queue_delay_ms         += now_ms - frame->enqueued_ms;
+        scheduler->node_airtime_rest_us         += frame->airtime_us;
+        meshcore_stats_add(scheduler->node_stats, MESHCORE_STATS_TX_AIRTIME_MS, scheduler->node_airtime_rest_us / 1000);
+        scheduler->node_airtime_rest_us %= 1000;
+
+        meshcore_tx_unlink(scheduler, index, previous);
+        if (out_wait_ms != NULL) {
+            *out_wait_ms = 0;
+        }
+        return 1;
+    }
+
+    if (out_wait_ms != NULL) {
+        *out_wait_ms = wait_ms;
+    }
+    return 0;
+}
+
+uint32_t meshcore_tx_budget_remaining(meshcore_tx_scheduler_t* scheduler, uint32_t now_ms) {
+    if (scheduler->budget_us == 0) {
+        return UINT32_MAX;
+    }
+    meshcore_tx_window_advance(scheduler, now_ms);
+    uint64_t remaining = (scheduler->window_used_us < scheduler->budget_us) ? scheduler->budget_us - scheduler->window_used_us : 0;
+    return (remaining > UINT32_MAX) ? UINT32_MAX : (uint32_t)remaining;
+}
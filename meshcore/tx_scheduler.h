@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2026 Nicolai Electronics
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packet.h"
+#include "stats.h"
+
+// Definitions
+
+// Transmit scheduling. Frames wait in one FIFO per priority class and the highest class with a frame that
+// is ready goes first. Every frame is charged its LoRa time on air against a duty-cycle budget over a
+// sliding window, and flooded frames are held back for a random number of airtime slots so that nodes
+// repeating the same flood do not all transmit at once.
+
+#define MESHCORE_TX_DEFAULT_PREAMBLE_LENGTH 16
+
+#ifndef MESHCORE_TX_QUEUE_SIZE
+#define MESHCORE_TX_QUEUE_SIZE 32
+#endif
+
+_Static_assert(MESHCORE_TX_QUEUE_SIZE < 0xFF, "MESHCORE_TX_QUEUE_SIZE too large");
+
+// The duty-cycle window is split into buckets, airtime older than the window is forgotten a bucket at a time
+#define MESHCORE_TX_WINDOW_BUCKETS 60
+
+// Flooded frames wait 0 to MESHCORE_TX_FLOOD_BACKOFF_SLOTS - 1 times their own airtime
+#define MESHCORE_TX_FLOOD_BACKOFF_SLOTS 6
+
+#define MESHCORE_TX_NONE 0xFF
+
+typedef struct {
+    uint32_t frequency;         // kHz
+    uint32_t bandwidth;         // Hz
+    uint8_t  spreading_factor;  // 6 to 12
+    uint8_t  coding_rate;       // Denominator of the 4/x coding rate, 5 to 8
+    uint16_t preamble_length;   // Symbols
+} meshcore_radio_params_t;
+
+typedef enum {
+    MESHCORE_TX_CLASS_ACK    = 0,
+    MESHCORE_TX_CLASS_DIRECT = 1,
+    MESHCORE_TX_CLASS_FLOOD  = 2,
+    MESHCORE_TX_CLASS_ADVERT = 3,
+    MESHCORE_TX_CLASSES,
+} meshcore_tx_class_t;
+
+typedef struct {
+    uint8_t  next;
+    uint8_t  tx_class;
+    uint8_t  size;
+    uint32_t airtime_us;
+    uint32_t enqueued_ms;
+    uint32_t not_before_ms;  // Flood back-off
+    uint8_t  data[MESHCORE_MAX_TRANS_UNIT];
+} meshcore_tx_frame_t;
+
+typedef struct {
+    uint32_t enqueued[MESHCORE_TX_CLASSES];
+    uint32_t sent[MESHCORE_TX_CLASSES];
+    uint32_t dropped[MESHCORE_TX_CLASSES];  // Queue full, or pushed out by a frame of a higher class
+    uint64_t airtime_us;
+    uint64_t queue_delay_ms;
+    uint32_t budget_waits;  // Times a ready frame was held back by the duty-cycle budget
+} meshcore_tx_stats_t;
+
+typedef struct {
+    meshcore_radio_params_t params;
+    uint64_t                budget_us;  // Airtime allowed per window, 0 for no limit
+    uint32_t                bucket_ms;
+    uint32_t                bucket_start_ms;
+    uint8_t                 bucket;
+    uint64_t                window_used_us;
+    uint32_t                window_us[MESHCORE_TX_WINDOW_BUCKETS];
+    uint32_t                random;
+    uint8_t                 free;
+    uint8_t                 head[MESHCORE_TX_CLASSES];
+    uint8_t                 tail[MESHCORE_TX_CLASSES];
+    uint8_t                 count[MESHCORE_TX_CLASSES];
+    meshcore_tx_stats_t     stats;
+    meshcore_stats_shard_t* node_stats;            // Node statistics shard, NULL when not counted
+    uint32_t                node_airtime_rest_us;  // Airtime not yet counted in whole milliseconds
+    meshcore_tx_frame_t     frames[MESHCORE_TX_QUEUE_SIZE];
+} meshcore_tx_scheduler_t;
+
+// Functions
+
+/// LoRa time on air in microseconds of a frame of size bytes, explicit header and CRC enabled
+uint32_t meshcore_lora_airtime_us(const meshcore_radio_params_t* params, uint8_t size);
+
+/// Priority class of a message, from its payload and route type
+meshcore_tx_class_t meshcore_tx_classify(const meshcore_message_t* message);
+
+/// Reset a scheduler. duty_cycle_permille of every window_ms may be spent transmitting (1000 for no limit),
+/// seed initializes the back-off generator and should differ between nodes.
+void meshcore_tx_scheduler_init(meshcore_tx_scheduler_t* scheduler, const meshcore_radio_params_t* params, uint16_t duty_cycle_permille,
+                                uint32_t window_ms, uint32_t now_ms, uint32_t seed);
+
+/// Change the radio parameters, applies to frames queued from now on
+void meshcore_tx_set_params(meshcore_tx_scheduler_t* scheduler, const meshcore_radio_params_t* params);
+
+/// Count drops and airtime in a node statistics shard, NULL to stop counting
+void meshcore_tx_set_stats(meshcore_tx_scheduler_t* scheduler, meshcore_stats_shard_t* shard);
+
+/// Queue a serialized frame. When the queue is full the newest frame of a lower class is dropped to make
+/// room, returns -1 if there is none.
+int meshcore_tx_enqueue(meshcore_tx_scheduler_t* scheduler, const uint8_t* data, uint8_t size, meshcore_tx_class_t tx_class, uint32_t now_ms);
+
+/// Take the next frame to transmit and charge its airtime. Returns 1 with the frame in out_data, or 0 when
+/// nothing may be sent yet with out_wait_ms set to the time until the next frame could be ready.
+int meshcore_tx_next(meshcore_tx_scheduler_t* scheduler, uint32_t now_ms, uint8_t* out_data, uint8_t* out_size, uint32_t* out_wait_ms);
+
+/// Airtime left in the current duty-cycle window in microseconds
+uint32_t meshcore_tx_budget_remaining(meshcore_tx_scheduler_t* scheduler, uint32_t now_ms);